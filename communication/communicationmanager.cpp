@@ -50,8 +50,7 @@ void CommunicationManager::openConnection(int type, const QString &address, int
         m_simTimer = new QTimer(this);
         connect(m_simTimer, &QTimer::timeout, this, &CommunicationManager::handleSimTimeout);
         
-        m_simState.status = DeviceStatus::Idle;
-        m_simState.position_mm = 0.0;
+        m_simDevice.reset();
         m_simTimer->start(100); // 10Hz
         
         m_isConnected = true;
@@ -149,33 +148,31 @@ void CommunicationManager::processCommand(ControlCommand cmd)
     
     if (m_currentType == Simulation) {
         // 仿真逻辑
-        if (cmd.type == ControlCommand::MoveForward) {
-            m_simState.status = DeviceStatus::MovingForward;
-            m_simTargetSpeed = cmd.param;
-            LOG_INFO << "仿真: 开始向前移动，目标速度: " << cmd.param << " mm/s";
-        } else if (cmd.type == ControlCommand::MoveBackward) {
-            m_simState.status = DeviceStatus::MovingBackward;
-            m_simTargetSpeed = cmd.param;
-            LOG_INFO << "仿真: 开始向后移动，目标速度: " << cmd.param << " mm/s";
-        } else if (cmd.type == ControlCommand::Stop) {
-            m_simState.status = DeviceStatus::Idle;
-            m_simTargetSpeed = 0.0;
-            LOG_INFO << "仿真: 停止运动";
-        } else if (cmd.type == ControlCommand::SetSpeed) {
-            // 仅在运动中生效
-             if (m_simState.status != DeviceStatus::Idle) {
-                 m_simTargetSpeed = cmd.param;
-                 LOG_INFO << "仿真: 设置速度为: " << cmd.param << " mm/s";
-             } else {
-                 LOG_INFO << "仿真: 设备空闲，忽略速度设置指令";
-             }
-        }
+        m_simDevice.handleCommand(cmd);
         return;
     }
 
     QByteArray packet = Protocol::pack(cmd);
     LOG_INFO << "指令已打包，数据包大小: " << packet.size() << " 字节";
-    
+    writePacket(packet);
+}
+
+void CommunicationManager::uploadProgram(ScanProgram program)
+{
+    LOG_INFO << "下发扫描程序 - 指令数: " << program.instructions.size() << ", 周期数: " << program.cycles;
+
+    if (m_currentType == Simulation) {
+        m_simDevice.loadProgram(program);
+        return;
+    }
+
+    QByteArray packet = Protocol::packProgram(program);
+    LOG_INFO << "程序已打包，数据包大小: " << packet.size() << " 字节";
+    writePacket(packet);
+}
+
+void CommunicationManager::writePacket(const QByteArray &packet)
+{
     if (m_currentType == Serial && m_serial && m_serial->isOpen()) {
         qint64 written = m_serial->write(packet);
         LOG_INFO << "串口发送: " << written << " 字节";
@@ -209,89 +206,20 @@ void CommunicationManager::handleTcpReadyRead()
 
 void CommunicationManager::parseBuffer()
 {
-    // 简单的解包逻辑 (假设 Protocol 类有解包方法，这里暂时手动实现或简化)
-    // 实际项目中应使用 Protocol::unpack 或类似的流解析器处理粘包/分包
-    
-    // 这里简单查找帧头帧尾 (仅作为示例，需与 protocol.h 配合)
-    // 假设数据包固定长度为 header(1)+...
-    
-    // 简易处理：尝试找到一帧完整数据
-    // 假设 Protocol 还没提供 unpack，我们先简单模拟
-    // 实际上 protocol.h 里没有 unpack，只有 pack。
-    // 为了稳健性，这里应该实现一个环形缓冲解析，但为了演示，这里假设一次收发完整
-    
-    // 临时逻辑：如果缓冲区有足够数据，且包含帧头帧尾
-    while (m_rxBuffer.size() >= 15) { // 最小长度估计
-        int headIdx = m_rxBuffer.indexOf((char)FRAME_HEADER);
-        if (headIdx == -1) {
-            m_rxBuffer.clear();
-            break;
-        }
-        
-        // 丢弃头部之前的垃圾数据
-        if (headIdx > 0) {
-            m_rxBuffer.remove(0, headIdx);
-        }
-        
-        // 检查是否有足够长度 (Command packet is small, Feedback might be larger)
-        // Feedback structure: [Header] [Type] [Len] [Payload...] [Checksum] [Footer]
-        // 这里需要 Protocol 定义 Feedback 的封包格式。
-        // 由于 protocol.h 中没有 define feedback packet layout，我们这里假设接收到的是 MotionFeedback 结构体的直接二进制 (不推荐) 
-        // 或者我们假设下位机发送格式与 Command 类似。
-        
-        // 既然这是一个 Mock 实现，我们先假设接收到了数据并解析
-        // TODO: 完善 Protocol::unpackFeedback
-        
-        // 模拟解析成功
-        MotionFeedback fb;
-        // 简单从 buffer 模拟提取 (实际需按协议解包)
-        // 此处为了兼容性，暂时不深入实现解包细节，而是假设 buffer 里就是 raw struct (仅作演示)
-        if (m_rxBuffer.size() >= (int)sizeof(MotionFeedback)) {
-             // 实际上这行不通，因为有字节对齐和端序问题。
-             // 我们假设下位机发来的是标准协议包。
-             // 暂时略过详细解包，直接清空 buffer
-             m_rxBuffer.clear();
-        } else {
-            break; // 数据不够
-        }
+    // 按 Protocol::parse 定义的 25 字节反馈帧解包，自动处理粘包/分包与帧间垃圾数据。
+    // 下位机程序执行时的监控 (programActive 标志) 也依赖这里的完整解包。
+    MotionFeedback fb;
+    while (Protocol::parse(m_rxBuffer, fb)) {
+        emit feedbackReceived(fb);
     }
 }
 
 void CommunicationManager::handleSimTimeout()
 {
-    // 简单的运动学模拟
-    double dt = 0.1; // 100ms
-    
-    if (m_simState.status == DeviceStatus::MovingForward) {
-        m_simState.speed_mm_s = m_simTargetSpeed;
-        m_simState.position_mm += m_simState.speed_mm_s * dt;
-    } 
-    else if (m_simState.status == DeviceStatus::MovingBackward) {
-        m_simState.speed_mm_s = m_simTargetSpeed;
-        m_simState.position_mm -= m_simState.speed_mm_s * dt;
-    }
-    else {
-        m_simState.speed_mm_s = 0.0;
-    }
-    
-    // 模拟限位 - 使用配置中的实际限位值
-    double maxPos = ConfigManager::instance().maxPosition();
-    if (m_simState.position_mm >= maxPos) {
-        m_simState.position_mm = maxPos;
-        m_simState.rightLimit = true;
-        // m_simState.status = DeviceStatus::Idle; // 碰到限位停止？
-    } else {
-        m_simState.rightLimit = false;
-    }
-    
-    if (m_simState.position_mm <= 0.0) {
-        m_simState.position_mm = 0.0;
-        m_simState.leftLimit = true;
-    } else {
-        m_simState.leftLimit = false;
-    }
-    
-    emit feedbackReceived(m_simState);
+    // 运动学模拟 (含下位机程序解释执行)，限位使用配置中的实际限位值
+    const double dt = 0.1; // 100ms
+    m_simDevice.step(dt, ConfigManager::instance().maxPosition());
+    emit feedbackReceived(m_simDevice.state());
 }
 
 QString CommunicationManager::getSerialErrorMessage(QSerialPort::SerialPortError error)
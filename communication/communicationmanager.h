@@ -7,6 +7,7 @@
 #include <QTimer>
 #include <QThread>
 #include "protocol.h"
+#include "simulateddevice.h"
 
 /**
  * @brief 通信管理类
@@ -49,6 +50,11 @@ public slots:
      */
     void processCommand(ControlCommand cmd);
 
+    /**
+     * @brief 下发扫描程序 (由下位机自主执行，见 ControlCommand::ProgramRun)
+     */
+    void uploadProgram(ScanProgram program);
+
 signals:
     void connectionOpened(bool success);
     void connectionError(const QString &msg);
@@ -64,6 +70,7 @@ private slots:
 private:
     void cleanup();
     void parseBuffer();
+    void writePacket(const QByteArray &packet);
     QString getSerialErrorMessage(QSerialPort::SerialPortError error);
     QString getTcpErrorMessage(QAbstractSocket::SocketError error);
 
@@ -81,8 +88,7 @@ private:
 
     // Simulation
     QTimer *m_simTimer = nullptr;
-    MotionFeedback m_simState;
-    double m_simTargetSpeed = 0.0;
+    SimulatedDevice m_simDevice;
 };
 
 #endif // COMMUNICATIONMANAGER_H
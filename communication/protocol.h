@@ -5,6 +5,7 @@
 #include <QByteArray>
 #include <QDataStream>
 #include <QIODevice>
+#include <QVector>
 
 /**
  * @brief 协议定义头文件
@@ -44,6 +45,7 @@ struct MotionFeedback {
     bool emergencyStop = false; ///< 急停按下
     bool overCurrent = false;   ///< 过流报警
     bool stalled = false;       ///< 堵转报警
+    bool programActive = false; ///< 下位机程序执行中 (Flags bit5)
 };
 
 /**
@@ -58,13 +60,47 @@ struct ControlCommand {
         Stop = 0x01,           ///< 停止运动
         MoveForward = 0x02,    ///< 向前移动
         MoveBackward = 0x03,   ///< 向后移动
-        SetSpeed = 0x04        ///< 设置速度
+        SetSpeed = 0x04,       ///< 设置速度
+        ProgramUpload = 0x05,  ///< 下发扫描程序 (变长帧，见 Protocol::packProgram)
+        ProgramRun = 0x06,     ///< 启动已下发的扫描程序
+        ProgramAbort = 0x07    ///< 中止正在执行的扫描程序
     };
     
     Type type;          ///< 指令类型
     double param = 0.0; ///< 指令参数 (如速度值或距离值)
 };
 
+/**
+ * @brief 扫描程序指令
+ * 由上位机编译后整体下发，下位机按顺序执行，无需逐次往返确认。
+ */
+struct ProgramInstruction {
+    /**
+     * @brief 指令操作码
+     */
+    enum OpCode : uint8_t {
+        MoveTo = 0x01,   ///< 移动到绝对位置 (param1=目标mm, param2=速度mm/s, <=0 沿用当前速度)
+        Wait = 0x02,     ///< 原地等待 (param1=ms)
+        SetSpeed = 0x03  ///< 设置后续 MoveTo 的默认速度 (param1=mm/s)
+    };
+
+    OpCode op = MoveTo;
+    double param1 = 0.0;
+    double param2 = 0.0;
+};
+
+/**
+ * @brief 扫描程序
+ * 指令序列整体重复执行 cycles 次 (<=0 表示无限循环，直到收到 ProgramAbort)。
+ */
+struct ScanProgram {
+    QVector<ProgramInstruction> instructions;
+    int cycles = 1;           ///< 循环次数
+    double tolerance = 0.2;   ///< 到位容差 (mm)
+
+    bool isEmpty() const { return instructions.isEmpty(); }
+};
+
 /**
  * @brief 协议处理类
  * 提供静态方法用于数据的打包和解包。
@@ -106,6 +142,44 @@ public:
         return packet;
     }
 
+    /**
+     * @brief 打包扫描程序下发帧
+     * 格式: [Header(1)] [Cmd=0x05(1)] [Len(4)] [Cycles(4)] [Tol(8)] [Count(2)]
+     *       { [Op(1)] [Param1(8)] [Param2(8)] } * Count [Checksum(1)] [Footer(1)]
+     * Len 为 Len 字段之后、Checksum 之前的字节数。
+     */
+    static QByteArray packProgram(const ScanProgram &program) {
+        QByteArray payload;
+        QDataStream body(&payload, QIODevice::WriteOnly);
+        body.setFloatingPointPrecision(QDataStream::DoublePrecision);
+        body.setByteOrder(QDataStream::LittleEndian);
+
+        body << (int32_t)program.cycles;
+        body << program.tolerance;
+        body << (uint16_t)program.instructions.size();
+        for (const ProgramInstruction &ins : program.instructions) {
+            body << (uint8_t)ins.op << ins.param1 << ins.param2;
+        }
+
+        QByteArray packet;
+        QDataStream stream(&packet, QIODevice::WriteOnly);
+        stream.setByteOrder(QDataStream::LittleEndian);
+
+        stream << (uint8_t)FRAME_HEADER;
+        stream << (uint8_t)ControlCommand::ProgramUpload;
+        stream << (uint32_t)payload.size();
+        stream.writeRawData(payload.constData(), payload.size());
+
+        uint8_t checksum = 0;
+        for (char c : packet) {
+            checksum += (uint8_t)c;
+        }
+        stream << checksum;
+        stream << (uint8_t)FRAME_FOOTER;
+
+        return packet;
+    }
+
     /**
      * @brief 尝试从缓冲区解析一帧数据
      * @param buffer 输入/输出缓冲区，解析成功后会移除已处理的数据
@@ -178,6 +252,7 @@ public:
             outFeedback.emergencyStop = (flags & 0x04);
             outFeedback.overCurrent = (flags & 0x08);
             outFeedback.stalled = (flags & 0x10);
+            outFeedback.programActive = (flags & 0x20);
             
             switch (statusByte) {
                 case 0: outFeedback.status = DeviceStatus::Idle; break;
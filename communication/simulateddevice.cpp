@@ -0,0 +1,214 @@
+#include "simulateddevice.h"
+#include "../utils/logger.h"
+#include <QtMath>
+
+SimulatedDevice::SimulatedDevice()
+{
+    reset();
+}
+
+void SimulatedDevice::reset()
+{
+    m_state = MotionFeedback();
+    m_state.status = DeviceStatus::Idle;
+    m_state.position_mm = 0.0;
+    m_targetSpeed = 0.0;
+    m_program = ScanProgram();
+    m_programRunning = false;
+    m_pc = 0;
+    m_completedCycles = 0;
+    m_waitElapsedMs = 0.0;
+}
+
+void SimulatedDevice::handleCommand(const ControlCommand &cmd)
+{
+    // 程序执行期间只接受中止/停止指令，与真实下位机保持一致
+    if (m_programRunning && cmd.type != ControlCommand::ProgramAbort && cmd.type != ControlCommand::Stop) {
+        LOG_WARN << "仿真: 程序执行中，忽略指令 " << cmd.type;
+        return;
+    }
+
+    switch (cmd.type) {
+    case ControlCommand::MoveForward:
+        m_state.status = DeviceStatus::MovingForward;
+        m_targetSpeed = cmd.param;
+        LOG_INFO << "仿真: 开始向前移动，目标速度: " << cmd.param << " mm/s";
+        break;
+    case ControlCommand::MoveBackward:
+        m_state.status = DeviceStatus::MovingBackward;
+        m_targetSpeed = cmd.param;
+        LOG_INFO << "仿真: 开始向后移动，目标速度: " << cmd.param << " mm/s";
+        break;
+    case ControlCommand::Stop:
+        if (m_programRunning) {
+            LOG_INFO << "仿真: 收到停止指令，中止程序";
+            finishProgram();
+        }
+        m_state.status = DeviceStatus::Idle;
+        m_targetSpeed = 0.0;
+        LOG_INFO << "仿真: 停止运动";
+        break;
+    case ControlCommand::SetSpeed:
+        // 仅在运动中生效
+        if (m_state.status != DeviceStatus::Idle) {
+            m_targetSpeed = cmd.param;
+            LOG_INFO << "仿真: 设置速度为: " << cmd.param << " mm/s";
+        } else {
+            LOG_INFO << "仿真: 设备空闲，忽略速度设置指令";
+        }
+        break;
+    case ControlCommand::ProgramRun:
+        startProgram();
+        break;
+    case ControlCommand::ProgramAbort:
+        if (m_programRunning) {
+            LOG_INFO << "仿真: 程序已中止 (PC=" << m_pc << ", 已完成周期=" << m_completedCycles << ")";
+            finishProgram();
+        }
+        break;
+    case ControlCommand::ProgramUpload:
+        // 程序内容通过 loadProgram() 传入，此处无需处理
+        break;
+    }
+}
+
+void SimulatedDevice::loadProgram(const ScanProgram &program)
+{
+    if (m_programRunning) {
+        LOG_WARN << "仿真: 程序执行中，拒绝覆盖程序";
+        return;
+    }
+    m_program = program;
+    LOG_INFO << "仿真: 已载入扫描程序，指令数: " << program.instructions.size()
+             << ", 周期数: " << program.cycles;
+}
+
+void SimulatedDevice::startProgram()
+{
+    if (m_program.isEmpty()) {
+        LOG_WARN << "仿真: 未载入程序，忽略 ProgramRun";
+        return;
+    }
+    m_programRunning = true;
+    m_state.programActive = true;
+    m_pc = 0;
+    m_completedCycles = 0;
+    m_programSpeed = m_targetSpeed > 0.0 ? m_targetSpeed : 20.0;
+    LOG_INFO << "仿真: 开始执行扫描程序";
+    enterInstruction();
+}
+
+void SimulatedDevice::finishProgram()
+{
+    m_programRunning = false;
+    m_state.programActive = false;
+    m_state.status = DeviceStatus::Idle;
+    m_targetSpeed = 0.0;
+}
+
+/**
+ * @brief 进入当前指令 (设置运动方向/等待计时)
+ *
+ * SetSpeed 这类零耗时指令会连续执行，最多执行一轮，防止空程序死循环。
+ */
+void SimulatedDevice::enterInstruction()
+{
+    for (int guard = 0; guard <= m_program.instructions.size() && m_programRunning; ++guard) {
+        const ProgramInstruction &ins = m_program.instructions.at(m_pc);
+        switch (ins.op) {
+        case ProgramInstruction::MoveTo: {
+            m_targetSpeed = ins.param2 > 0.0 ? ins.param2 : m_programSpeed;
+            if (qAbs(m_state.position_mm - ins.param1) <= m_program.tolerance) {
+                advanceProgram();
+                continue;
+            }
+            m_state.status = ins.param1 > m_state.position_mm ? DeviceStatus::MovingForward
+                                                              : DeviceStatus::MovingBackward;
+            return;
+        }
+        case ProgramInstruction::Wait:
+            m_state.status = DeviceStatus::Idle;
+            m_waitElapsedMs = 0.0;
+            return;
+        case ProgramInstruction::SetSpeed:
+            if (ins.param1 > 0.0) m_programSpeed = ins.param1;
+            advanceProgram();
+            continue;
+        }
+    }
+}
+
+/**
+ * @brief 指令指针后移，到达末尾时计一个周期
+ */
+void SimulatedDevice::advanceProgram()
+{
+    ++m_pc;
+    if (m_pc < m_program.instructions.size()) return;
+
+    ++m_completedCycles;
+    if (m_program.cycles > 0 && m_completedCycles >= m_program.cycles) {
+        LOG_INFO << "仿真: 扫描程序执行完成，周期数: " << m_completedCycles;
+        finishProgram();
+        return;
+    }
+    m_pc = 0;
+}
+
+void SimulatedDevice::stepProgram(double dtSec)
+{
+    const ProgramInstruction &ins = m_program.instructions.at(m_pc);
+
+    if (ins.op == ProgramInstruction::Wait) {
+        m_state.speed_mm_s = 0.0;
+        m_waitElapsedMs += dtSec * 1000.0;
+        if (m_waitElapsedMs >= ins.param1) {
+            advanceProgram();
+            enterInstruction();
+        }
+        return;
+    }
+
+    // MoveTo：设备侧闭环，越过目标即视为到位，直接在本周期内换向
+    const double target = ins.param1;
+    const double dir = m_state.status == DeviceStatus::MovingForward ? 1.0 : -1.0;
+    m_state.speed_mm_s = m_targetSpeed;
+    const double next = m_state.position_mm + dir * m_targetSpeed * dtSec;
+    if ((dir > 0 && next >= target - m_program.tolerance) || (dir < 0 && next <= target + m_program.tolerance)) {
+        m_state.position_mm = target;
+        advanceProgram();
+        enterInstruction();
+    } else {
+        m_state.position_mm = next;
+    }
+}
+
+void SimulatedDevice::step(double dtSec, double maxPos)
+{
+    if (m_programRunning) {
+        stepProgram(dtSec);
+    } else if (m_state.status == DeviceStatus::MovingForward) {
+        m_state.speed_mm_s = m_targetSpeed;
+        m_state.position_mm += m_state.speed_mm_s * dtSec;
+    } else if (m_state.status == DeviceStatus::MovingBackward) {
+        m_state.speed_mm_s = m_targetSpeed;
+        m_state.position_mm -= m_state.speed_mm_s * dtSec;
+    } else {
+        m_state.speed_mm_s = 0.0;
+    }
+
+    // 模拟限位
+    if (m_state.position_mm >= maxPos) {
+        m_state.position_mm = maxPos;
+        m_state.rightLimit = true;
+    } else {
+        m_state.rightLimit = false;
+    }
+
+    if (m_state.position_mm <= 0.0) {
+        m_state.position_mm = 0.0;
+        m_state.leftLimit = true;
+    } else {
+        m_state.leftLimit = false;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef SIMULATEDDEVICE_H
+#define SIMULATEDDEVICE_H
+
+#include "protocol.h"
+
+/**
+ * @brief 仿真设备 (运动学模型)
+ *
+ * 模拟下位机对控制指令的响应，供 CommunicationManager 的仿真模式使用。
+ * 除了逐条指令 (MoveForward/MoveBackward/Stop/SetSpeed) 外，
+ * 还实现了下位机程序执行：上传的 ScanProgram 在 step() 中就地解释执行，
+ * 到位判断与换向均在"设备侧"完成，不依赖上位机往返。
+ *
+ * 本类不依赖 Qt 事件循环，时间推进完全由调用方通过 step(dt) 驱动。
+ */
+class SimulatedDevice
+{
+public:
+    SimulatedDevice();
+
+    /**
+     * @brief 复位到初始状态 (位置 0，空闲，清除程序)
+     */
+    void reset();
+
+    /**
+     * @brief 处理一条控制指令
+     */
+    void handleCommand(const ControlCommand &cmd);
+
+    /**
+     * @brief 载入扫描程序 (不会立即执行，需再收到 ProgramRun)
+     */
+    void loadProgram(const ScanProgram &program);
+
+    /**
+     * @brief 推进仿真时间
+     * @param dtSec 时间步长 (秒)
+     * @param maxPos 右限位位置 (mm)
+     */
+    void step(double dtSec, double maxPos);
+
+    /**
+     * @brief 直接设置当前位置 (离线仿真设定起始位置用)
+     */
+    void setPosition(double positionMm) { m_state.position_mm = positionMm; }
+
+    const MotionFeedback &state() const { return m_state; }
+    bool isProgramRunning() const { return m_programRunning; }
+
+private:
+    void startProgram();
+    void finishProgram();
+    void enterInstruction();
+    void advanceProgram();
+    void stepProgram(double dtSec);
+
+    MotionFeedback m_state;
+    double m_targetSpeed = 0.0;
+
+    // --- 程序执行状态 ---
+    ScanProgram m_program;
+    bool m_programRunning = false;
+    int m_pc = 0;                 ///< 当前指令索引
+    int m_completedCycles = 0;
+    double m_programSpeed = 20.0; ///< SetSpeed 设置的默认速度
+    double m_waitElapsedMs = 0.0;
+};
+
+#endif // SIMULATEDDEVICE_H
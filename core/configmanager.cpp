@@ -78,6 +78,56 @@ void ConfigManager::setDataStoragePath(const QString &path)
     m_settings.setValue("Data/StoragePath", path); 
 }
 
+QString ConfigManager::motionLogEngine() const
+{
+    return m_settings.value("Data/MotionLogEngine", "sqlite").toString();
+}
+
+void ConfigManager::setMotionLogEngine(const QString &engine)
+{
+    m_settings.setValue("Data/MotionLogEngine", engine);
+}
+
+int ConfigManager::motionLogRetentionDays() const
+{
+    return m_settings.value("Data/MotionLogRetentionDays", 30).toInt();
+}
+
+void ConfigManager::setMotionLogRetentionDays(int days)
+{
+    m_settings.setValue("Data/MotionLogRetentionDays", days);
+}
+
+int ConfigManager::taskRetentionDays() const
+{
+    return m_settings.value("Data/TaskRetentionDays", 30).toInt();
+}
+
+void ConfigManager::setTaskRetentionDays(int days)
+{
+    m_settings.setValue("Data/TaskRetentionDays", days);
+}
+
+int ConfigManager::archiveRetentionDays() const
+{
+    return m_settings.value("Data/ArchiveRetentionDays", 365).toInt();
+}
+
+void ConfigManager::setArchiveRetentionDays(int days)
+{
+    m_settings.setValue("Data/ArchiveRetentionDays", days);
+}
+
+double ConfigManager::chartWindowSec() const
+{
+    return qBound(1.0, m_settings.value("Display/ChartWindowSec", 10.0).toDouble(), 600.0);
+}
+
+void ConfigManager::setChartWindowSec(double sec)
+{
+    m_settings.setValue("Display/ChartWindowSec", sec);
+}
+
 // 辅助: 确保数据目录存在
 void ConfigManager::ensureDataDirExists() 
 {
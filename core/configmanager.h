@@ -32,6 +32,25 @@ public:
     QString dataStoragePath() const;
     void setDataStoragePath(const QString &path);
 
+    // 运动日志存储引擎: "sqlite" (MotionLog 表) 或 "columnar" (每任务一个列式采样文件)
+    QString motionLogEngine() const;
+    void setMotionLogEngine(const QString &engine);
+
+    // 数据保留天数 (按表)：MotionLog 行、未归档的任务记录、归档 (压缩采样文件)
+    int motionLogRetentionDays() const;
+    void setMotionLogRetentionDays(int days);
+
+    int taskRetentionDays() const;
+    void setTaskRetentionDays(int days);
+
+    int archiveRetentionDays() const;
+    void setArchiveRetentionDays(int days);
+
+    // --- 显示配置 ---
+    // 实时曲线显示的时间窗口 (秒)
+    double chartWindowSec() const;
+    void setChartWindowSec(double sec);
+
     // 辅助: 确保数据目录存在
     void ensureDataDirExists();
 
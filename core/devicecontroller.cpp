@@ -4,6 +4,21 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QDateTime>
+#include <QPromise>
+
+/**
+ * @brief 已有结果的 QFuture (同步判断出的失败等)
+ */
+template <typename T>
+static QFuture<T> readyFuture(T value)
+{
+    QPromise<T> promise;
+    QFuture<T> future = promise.future();
+    promise.start();
+    promise.addResult(std::move(value));
+    promise.finish();
+    return future;
+}
 
 DeviceController::DeviceController(QObject *parent) : QObject(parent)
 {
@@ -41,6 +56,7 @@ void DeviceController::init()
     connect(this, &DeviceController::cmdOpenConnection, m_commManager, &CommunicationManager::openConnection);
     connect(this, &DeviceController::cmdCloseConnection, m_commManager, &CommunicationManager::closeConnection);
     connect(this, &DeviceController::cmdSendPacket, m_commManager, &CommunicationManager::processCommand);
+    connect(this, &DeviceController::cmdUploadProgram, m_commManager, &CommunicationManager::uploadProgram);
 
     // 2. CommManager -> Controller
     connect(m_commManager, &CommunicationManager::connectionOpened, this, [this](bool success){
@@ -71,27 +87,41 @@ void DeviceController::init()
         emit cmdSendPacket(cmd);
     });
 
+    connect(m_taskManager, &TaskManager::requestSetSpeed, this, [this](double speed){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::SetSpeed;
+        cmd.param = speed;
+        emit cmdSendPacket(cmd);
+    });
+
     connect(m_taskManager, &TaskManager::requestStop, this, [this](){
         ControlCommand cmd;
         cmd.type = ControlCommand::Stop;
         emit cmdSendPacket(cmd);
     });
+
+    // 下位机程序：下发/启动/中止
+    connect(m_taskManager, &TaskManager::requestUploadProgram, this, [this](const ScanProgram &program){
+        emit cmdUploadProgram(program);
+    });
+
+    connect(m_taskManager, &TaskManager::requestRunProgram, this, [this](){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::ProgramRun;
+        emit cmdSendPacket(cmd);
+    });
+
+    connect(m_taskManager, &TaskManager::requestAbortProgram, this, [this](){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::ProgramAbort;
+        emit cmdSendPacket(cmd);
+    });
     
     // 处理任务完成
     connect(m_taskManager, &TaskManager::taskCompleted, this, [this](){
         if (m_currentTaskId != -1) {
-            // 生成执行结果JSON
-            QJsonObject result;
-            result["completionTime"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-            result["status"] = "success";
-            result["message"] = "任务执行完成";
-            
-            QJsonDocument doc(result);
-            QString resultJson = doc.toJson(QJsonDocument::Compact);
-            
             // 更新数据库中的任务状态和执行结果
-            updateTaskStatus(m_currentTaskId, "completed");
-            m_dataManager->updateTaskExecutionResult(m_currentTaskId, resultJson);
+            writeTaskResult(m_currentTaskId, "completed", "任务执行完成");
             
             LOG_INFO << "任务完成: ID=" << m_currentTaskId;
             
@@ -101,23 +131,15 @@ void DeviceController::init()
             m_currentTaskId = -1;
             emit taskStateChanged(completedTaskId);
         }
+        clearCheckpoint();
+        onQueueTaskFinished(true);
     });
     
     // 处理任务失败
     connect(m_taskManager, &TaskManager::taskFailed, this, [this](const QString& reason){
         if (m_currentTaskId != -1) {
-            // 生成失败结果JSON
-            QJsonObject result;
-            result["completionTime"] = QDateTime::currentDateTime().toString(Qt::ISODate);
-            result["status"] = "failed";
-            result["message"] = reason;
-            
-            QJsonDocument doc(result);
-            QString resultJson = doc.toJson(QJsonDocument::Compact);
-            
             // 更新数据库中的任务状态和执行结果
-            updateTaskStatus(m_currentTaskId, "failed");
-            m_dataManager->updateTaskExecutionResult(m_currentTaskId, resultJson);
+            writeTaskResult(m_currentTaskId, "failed", reason);
             
             LOG_ERR << "任务失败: ID=" << m_currentTaskId << " 原因:" << reason;
             
@@ -127,11 +149,83 @@ void DeviceController::init()
             m_currentTaskId = -1;
             emit taskStateChanged(failedTaskId);
         }
+        clearCheckpoint();
+        onQueueTaskFinished(false);
+    });
+
+    // 检查点：定时写入，周期结束时立即写入
+    m_checkpointTimer.setInterval(1000);
+    connect(&m_checkpointTimer, &QTimer::timeout, this, &DeviceController::writeCheckpoint);
+    connect(m_taskManager, &TaskManager::progressChanged, this, [this](int, int){
+        if (m_checkpointTimer.isActive()) writeCheckpoint();
+    });
+
+    // 周期耗时：任务结束时写入执行结果
+    connect(m_taskManager, &TaskManager::cycleTimeMeasured, this, [this](int, qint64 elapsedMs, bool deviceDriven){
+        CycleTimes &c = m_cycleTimes;
+        c.minMs = c.cycles == 0 ? elapsedMs : qMin(c.minMs, elapsedMs);
+        c.maxMs = qMax(c.maxMs, elapsedMs);
+        c.totalMs += elapsedMs;
+        c.deviceDriven = deviceDriven;
+        ++c.cycles;
+    });
+
+    // 任务队列：回零到位后启动下一个任务
+    connect(m_taskManager, &TaskManager::homingFinished, this, [this](){
+        if (m_queueRunning && m_queueHoming) {
+            m_queueHoming = false;
+            startQueueEntry();
+        }
+    });
+}
+
+/**
+ * @brief 写入任务执行结果
+ * @param status 任务状态 (completed/failed)，结果 JSON 中 completed 记为 success
+ * 结果 JSON 的 stats 字段为任务扫描统计 (见 TaskStats::toJson)。
+ * cycleTime 字段为周期耗时统计 (mode: host 上位机驱动 / device 下位机执行)，可按任务对比两种执行方式。
+ */
+void DeviceController::writeTaskResult(int taskId, const QString &status, const QString &message)
+{
+    // 生成执行结果JSON
+    QJsonObject result;
+    result["completionTime"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["status"] = (status == "completed") ? QString("success") : status;
+    result["message"] = message;
+    if (m_taskStartMs > 0) {
+        result["durationMs"] = QDateTime::currentMSecsSinceEpoch() - m_taskStartMs;
+    }
+    if (m_cycleTimes.cycles > 0) {
+        QJsonObject cycleTime;
+        cycleTime["mode"] = m_cycleTimes.deviceDriven ? QString("device") : QString("host");
+        cycleTime["cycles"] = m_cycleTimes.cycles;
+        cycleTime["avgMs"] = double(m_cycleTimes.totalMs) / m_cycleTimes.cycles;
+        cycleTime["minMs"] = m_cycleTimes.minMs;
+        cycleTime["maxMs"] = m_cycleTimes.maxMs;
+        result["cycleTime"] = cycleTime;
+    }
+    if (m_queueRunning) {
+        result["queueIndex"] = m_queueIndex;
+        result["queueSize"] = m_queue.size();
+    }
+
+    updateTaskStatus(taskId, status);
+
+    // 扫描统计由写入线程维护，写完已采集的数据后取最终值并入结果
+    m_dataManager->taskStatsAsync(taskId).then(this, [this, taskId, result](TaskStats stats) mutable {
+        if (stats.isValid()) {
+            result["stats"] = stats.toJson();
+        }
+        const QString resultJson = QJsonDocument(result).toJson(QJsonDocument::Compact);
+        m_dataManager->updateTaskExecutionResultAsync(taskId, resultJson).then(this, [this, taskId](bool ok) {
+            if (ok) emit taskRecordChanged(taskId);
+        });
     });
 }
 
 void DeviceController::startAutoScan(double min, double max, double speed, int cycles) {
     if(!m_taskManager->isRunning()) {
+        m_taskManager->clearSpeedMap();
         m_taskManager->startAutoScan(min, max, speed, cycles);
     }
 }
@@ -139,7 +233,12 @@ void DeviceController::startAutoScan(double min, double max, double speed, int c
 void DeviceController::pauseAutoScan() { m_taskManager->pause(); }
 void DeviceController::resumeAutoScan() { m_taskManager->resume(); }
 void DeviceController::resetAutoScan() { m_taskManager->resetTask(); }
-void DeviceController::stopAutoScan() { m_taskManager->stopAll(); }
+void DeviceController::stopAutoScan()
+{
+    stopTaskQueue();
+    m_taskManager->stopAll();
+    clearCheckpoint();
+}
 
 void DeviceController::requestConnect(int type, const QString &addr, int portOrBaud)
 {
@@ -186,14 +285,14 @@ void DeviceController::onFeedbackReceived(MotionFeedback fb)
         // 左限位保护：超出左限位容差范围
         if (fb.status == DeviceStatus::MovingBackward && fb.position_mm < (0.0 - tolerance)) {
             stopMotion();
-            m_taskManager->stopAll();
+            m_taskManager->abortTask(QString("超出左限位保护范围 (%1mm)").arg(0.0 - tolerance));
             emit errorMessage(QString("⚠️ 超出左限位保护范围 (%1mm)，自动停止！").arg(0.0 - tolerance));
         }
         
         // 右限位保护：超出右限位容差范围
         if (fb.status == DeviceStatus::MovingForward && fb.position_mm > (maxPos + tolerance)) {
             stopMotion();
-            m_taskManager->stopAll();
+            m_taskManager->abortTask(QString("超出右限位保护范围 (%1mm)").arg(maxPos + tolerance));
             emit errorMessage(QString("⚠️ 超出右限位保护范围 (%1mm)，自动停止！").arg(maxPos + tolerance));
         }
     } else {
@@ -211,22 +310,21 @@ void DeviceController::onFeedbackReceived(MotionFeedback fb)
         }
     }
 
-    QMetaObject::invokeMethod(m_dataManager, "logMotionData", 
-                              Qt::QueuedConnection, 
-                              Q_ARG(MotionFeedback, fb),
-                              Q_ARG(int, m_currentTaskId));
+    // 入队即返回，实际写入由 DataManager 的写入线程批量完成
+    m_dataManager->logMotionData(fb, m_currentTaskId);
 
     m_taskManager->updateFeedback(fb);
     emit deviceStateUpdated(fb);
     
     if (fb.emergencyStop || fb.overCurrent || fb.stalled) {
-        m_taskManager->stopAll();
-        stopMotion();
-        
         QString reason;
         if (fb.emergencyStop) reason += "[急停按钮按下] ";
         if (fb.overCurrent) reason += "[电机过流] ";
         if (fb.stalled) reason += "[电机堵转] ";
+
+        // 经故障路径中止，任务结果、检查点和队列由 taskFailed 回调收尾
+        m_taskManager->abortTask("报警停止: " + reason.trimmed());
+        stopMotion();
         
         static qint64 lastAlarmTime = 0;
         qint64 now = QDateTime::currentMSecsSinceEpoch();
@@ -248,52 +346,491 @@ void DeviceController::activateTask(int taskId)
 
 void DeviceController::startNewTask(const QString &operatorName, const QString &tubeId)
 {
-    int newId = m_dataManager->createDetectionTask(operatorName, tubeId);
-    if (newId != -1) {
-        m_currentTaskId = newId;
-        LOG_INFO << "任务开始: ID=" << newId << " 操作员=" << operatorName << " 管号=" << tubeId;
-        // 先发送创建信号，方便 UI 更新列表
-        emit taskCreated(newId, operatorName, tubeId);
-        // 再发送状态变更信号
-        emit taskStateChanged(m_currentTaskId);
-    } else {
-        LOG_ERR << "创建任务失败";
-        emit errorMessage("创建任务记录失败，数据将不会关联到具体管道！");
-    }
+    m_dataManager->createDetectionTaskAsync(operatorName, tubeId).then(this, [this, operatorName, tubeId](int newId) {
+        if (newId != -1) {
+            m_currentTaskId = newId;
+            LOG_INFO << "任务开始: ID=" << newId << " 操作员=" << operatorName << " 管号=" << tubeId;
+            // 先发送创建信号，方便 UI 更新列表
+            emit taskCreated(newId, operatorName, tubeId);
+            // 再发送状态变更信号
+            emit taskStateChanged(m_currentTaskId);
+        } else {
+            LOG_ERR << "创建任务失败";
+            emit errorMessage("创建任务记录失败，数据将不会关联到具体管道！");
+        }
+    });
 }
 
 void DeviceController::endCurrentTask()
 {
     if (m_currentTaskId != -1) {
         LOG_INFO << "任务结束: ID=" << m_currentTaskId;
-        if (m_dataManager) {
-            m_dataManager->updateDetectionTaskStatus(m_currentTaskId, "stop");
-        }
+        updateTaskStatus(m_currentTaskId, "stop");
+        clearCheckpoint();
         m_currentTaskId = -1;
         emit taskStateChanged(m_currentTaskId);
     }
 }
 
-bool DeviceController::updateTaskStatus(int taskId, const QString &status)
+QFuture<bool> DeviceController::updateTaskStatus(int taskId, const QString &status)
 {
-    if (!m_dataManager) return false;
-    return m_dataManager->updateDetectionTaskStatus(taskId, status);
+    if (!m_dataManager) return QFuture<bool>();
+    return m_dataManager->updateDetectionTaskStatusAsync(taskId, status).then(this, [this, taskId](bool ok) {
+        if (ok) emit taskRecordChanged(taskId);
+        return ok;
+    });
 }
 
-bool DeviceController::deleteTask(int taskId)
+QFuture<QString> DeviceController::executeTask(int taskId)
 {
-    if (!m_dataManager) return false;
+    if (m_taskManager->isRunning()) return readyFuture(QString("已有任务正在运行，请先停止"));
 
-    if (taskId == m_currentTaskId) {
+    auto promise = std::make_shared<QPromise<QString>>();
+    promise->start();
+    auto finish = [promise](const QString &error) {
+        promise->addResult(error);
+        promise->finish();
+    };
+
+    loadQueueEntry(taskId).then(this, [this, finish](QueueEntry entry) {
+        if (!entry.error.isEmpty()) {
+            finish(entry.error);
+            return;
+        }
+        prepareSpeedMap(entry.taskId, entry.plan).then(this, [this, finish, entry](SpeedMapResult speedMap) {
+            finish(startTask(entry, speedMap));
+        });
+    });
+    return promise->future();
+}
+
+/**
+ * @brief 启动已读取配置的任务 (配置与速度表在数据库线程中准备好之后调用)
+ * @return 失败原因，空字符串表示任务已启动
+ */
+QString DeviceController::startTask(const QueueEntry &entry, const SpeedMapResult &speedMap)
+{
+    // 读取配置期间可能已有其他任务启动
+    if (m_taskManager->isRunning()) return "已有任务正在运行，请先停止";
+
+    // 速度表：不使用时清除，避免沿用上一个任务的设置
+    if (speedMap.ok) {
+        m_taskManager->setSpeedMap(speedMap.map);
+    } else {
+        m_taskManager->clearSpeedMap();
+        if (!speedMap.error.isEmpty()) return speedMap.error;
+    }
+
+    // 激活任务并更新状态为运行中
+    const int taskId = entry.taskId;
+    activateTask(taskId);
+    updateTaskStatus(taskId, "running");
+    m_taskStartMs = QDateTime::currentMSecsSinceEpoch();
+    m_cycleTimes = CycleTimes();
+
+    m_taskManager->startPlan(entry.plan);
+
+    // 参数校验失败时 TaskManager 不会进入运行状态
+    if (!m_taskManager->isRunning()) {
+        if (m_currentTaskId == taskId) {
+            writeTaskResult(taskId, "failed", "任务启动失败");
+            m_currentTaskId = -1;
+            emit taskStateChanged(taskId);
+        }
+        return "任务启动失败，请检查任务配置";
+    }
+
+    startCheckpointing(entry.taskType, entry.taskConfig);
+    return QString();
+}
+
+/**
+ * @brief 开始为当前任务定期写检查点
+ * 每秒一次，另外在每个周期结束时立即写入。
+ */
+void DeviceController::startCheckpointing(const QString &taskType, const QString &taskConfig)
+{
+    m_checkpointTaskType = taskType;
+    m_checkpointTaskConfig = taskConfig;
+    writeCheckpoint();
+    m_checkpointTimer.start();
+}
+
+void DeviceController::writeCheckpoint()
+{
+    const TaskManager::State state = m_taskManager->state();
+    if (m_currentTaskId == -1 || m_checkpointTaskType.isEmpty()
+        || state == TaskManager::State::Idle || state == TaskManager::State::Fault) {
+        return;
+    }
+
+    TaskCheckpoint::Record record;
+    record.taskId = m_currentTaskId;
+    record.taskType = m_checkpointTaskType;
+    record.taskConfig = m_checkpointTaskConfig;
+    record.snapshot = m_taskManager->snapshot();
+    record.savedAt = QDateTime::currentDateTime();
+    m_checkpoint.save(record);
+}
+
+void DeviceController::clearCheckpoint()
+{
+    m_checkpointTimer.stop();
+    m_checkpointTaskType.clear();
+    m_checkpointTaskConfig.clear();
+    m_checkpoint.clear();
+}
+
+bool DeviceController::pendingCheckpoint(TaskCheckpoint::Record &record) const
+{
+    return m_checkpoint.load(record);
+}
+
+void DeviceController::discardCheckpoint()
+{
+    TaskCheckpoint::Record record;
+    if (m_checkpoint.load(record)) {
+        LOG_INFO << "放弃任务检查点: ID=" << record.taskId;
+    }
+    clearCheckpoint();
+}
+
+QFuture<QString> DeviceController::resumeFromCheckpoint()
+{
+    TaskCheckpoint::Record record;
+    if (!m_checkpoint.load(record)) return readyFuture(QString("没有可恢复的任务"));
+    if (m_taskManager->isRunning()) return readyFuture(QString("已有任务正在运行，请先停止"));
+
+    TaskManager::TaskPlan plan;
+    QString error;
+    if (!TaskManager::parseTaskPlan(record.taskType, record.taskConfig, plan, &error)) {
+        return readyFuture(error);
+    }
+
+    // 速度表所需的历史数据在数据库线程中读取，之后再恢复任务
+    return prepareSpeedMap(record.taskId, plan).then(this, [this, record, plan](SpeedMapResult speedMap) -> QString {
+        if (m_taskManager->isRunning()) return "已有任务正在运行，请先停止";
+
+        LOG_INFO << "恢复任务: ID=" << record.taskId << " 检查点时间=" << record.savedAt.toString(Qt::ISODate);
+
+        // 沿用原任务ID，后续 MotionLog 继续关联到同一任务
+        activateTask(record.taskId);
+        updateTaskStatus(record.taskId, "running");
+        m_taskStartMs = QDateTime::currentMSecsSinceEpoch();
+        m_cycleTimes = CycleTimes();
+
+        if (speedMap.ok) {
+            m_taskManager->setSpeedMap(speedMap.map);
+        } else {
+            m_taskManager->clearSpeedMap();
+        }
+
+        if (!m_taskManager->resumePlan(plan, record.snapshot)) {
+            if (m_currentTaskId == record.taskId) {
+                writeTaskResult(record.taskId, "failed", "任务恢复失败");
+                m_currentTaskId = -1;
+                emit taskStateChanged(record.taskId);
+            }
+            clearCheckpoint();
+            return "任务恢复失败，请检查任务配置";
+        }
+
+        startCheckpointing(record.taskType, record.taskConfig);
+        return QString();
+    });
+}
+
+QFuture<DeviceController::SpeedMapResult> DeviceController::prepareSpeedMap(int taskId, const TaskManager::TaskPlan &plan)
+{
+    // 限速并记录日志
+    auto finish = [taskId](SpeedMapResult result) {
+        if (result.ok) {
+            result.map.clampSpeeds(ConfigManager::instance().maxSpeed());
+            LOG_INFO << "任务 " << taskId << " 使用速度表: 重点区域 " << result.map.regions().size() << " 个";
+        }
+        return result;
+    };
+
+    SpeedMapResult result;
+    if (plan.type != "auto_scan" || plan.deviceExecution) return readyFuture(result);
+
+    if (!plan.speedMapFile.isEmpty()) {
+        result.ok = SpeedMap::loadFromFile(plan.speedMapFile, plan.speed, result.map, &result.error);
+        return readyFuture(finish(result));
+    }
+    if (!plan.adaptiveSpeed) return readyFuture(result);
+
+    return m_dataManager->previousScanPositionsAsync(taskId).then(this, [taskId, plan, finish](QVector<double> positions) {
+        SpeedMapResult result;
+        if (positions.isEmpty()) {
+            LOG_INFO << "任务 " << taskId << " 无同管道历史扫描数据，按恒定速度扫描";
+            return result;
+        }
+        result.ok = true;
+        result.map = SpeedMap::fromDwellHistory(positions, plan.speed, plan.roiSpeed);
+        return finish(result);
+    });
+}
+
+/**
+ * @brief 在数据库线程中读取队列项的任务配置，回到本线程解析
+ */
+QFuture<DeviceController::QueueEntry> DeviceController::loadQueueEntry(int taskId)
+{
+    return m_dataManager->getTaskConfigAsync(taskId).then(this, [taskId](DataManager::TaskConfigResult config) {
+        QueueEntry entry;
+        entry.taskId = taskId;
+        entry.loaded = true;
+        if (!config.ok) {
+            entry.error = QString("无法获取任务 %1 的配置").arg(taskId);
+            return entry;
+        }
+        entry.taskType = config.taskType;
+        entry.taskConfig = config.taskConfig;
+        TaskManager::parseTaskPlan(entry.taskType, entry.taskConfig, entry.plan, &entry.error);
+        return entry;
+    });
+}
+
+bool DeviceController::startTaskQueue(const QList<int> &taskIds, bool homeBetween, QString *error)
+{
+    if (m_queueRunning) {
+        if (error) *error = "任务队列正在执行";
+        return false;
+    }
+    if (m_taskManager->isRunning()) {
+        if (error) *error = "已有任务正在运行，请先停止";
+        return false;
+    }
+    if (taskIds.isEmpty()) {
+        if (error) *error = "任务队列为空";
+        return false;
+    }
+
+    m_queue.clear();
+    for (int taskId : taskIds) {
+        QueueEntry entry;
+        entry.taskId = taskId;
+        m_queue.append(entry);
+    }
+
+    // 首个任务的配置在 startQueueEntry 中读取，后续任务在执行期间预加载
+    m_queueRunning = true;
+    m_queueHomeBetween = homeBetween;
+    m_queueHoming = false;
+    m_queueIndex = 0;
+    m_queueStats = QueueStats();
+    m_queueStats.total = m_queue.size();
+    m_queueStartMs = QDateTime::currentMSecsSinceEpoch();
+    m_lastTaskEndMs = 0;
+
+    LOG_INFO << "任务队列开始: 共 " << m_queue.size() << " 个任务, 任务间回零=" << homeBetween;
+    startQueueEntry();
+    return true;
+}
+
+void DeviceController::stopTaskQueue()
+{
+    if (!m_queueRunning) return;
+    LOG_INFO << "任务队列被停止: 已执行到第 " << (m_queueIndex + 1) << "/" << m_queue.size() << " 个";
+    if (m_queueHoming) {
+        m_queueHoming = false;
         m_taskManager->stopAll();
-        stopMotion();
-        m_currentTaskId = -1;
-        emit taskStateChanged(m_currentTaskId);
+    }
+    finishQueue();
+}
+
+/**
+ * @brief 启动队列中的当前任务，并预加载下一个任务的配置
+ */
+void DeviceController::startQueueEntry()
+{
+    if (!m_queueRunning) return;
+
+    QueueEntry &entry = m_queue[m_queueIndex];
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_lastTaskEndMs > 0) {
+        const qint64 gap = now - m_lastTaskEndMs;
+        m_queueStats.idleMs += gap;
+        m_queueStats.maxIdleGapMs = qMax(m_queueStats.maxIdleGapMs, gap);
+    }
+
+    emit queueProgress(m_queueIndex, m_queue.size(), entry.taskId);
+
+    if (entry.loaded) {
+        startQueueTask(entry);
+        return;
+    }
+
+    // 预加载尚未完成 (或是首个任务)：读取后再启动
+    const int index = m_queueIndex;
+    const int generation = m_queueGeneration;
+    loadQueueEntry(entry.taskId).then(this, [this, index, generation](QueueEntry loaded) {
+        if (!isQueueAt(index, generation)) return;
+        m_queue[index] = loaded;
+        startQueueTask(loaded);
+    });
+}
+
+/**
+ * @brief 启动已读取配置的队列任务 (速度表准备好之后)，并预加载下一个任务的配置
+ */
+void DeviceController::startQueueTask(const QueueEntry &entry)
+{
+    if (!entry.error.isEmpty()) {
+        failQueueStart(entry.taskId, entry.error);
+        return;
+    }
+
+    const int index = m_queueIndex;
+    const int generation = m_queueGeneration;
+    prepareSpeedMap(entry.taskId, entry.plan).then(this, [this, index, generation, entry](SpeedMapResult speedMap) {
+        if (!isQueueAt(index, generation)) return;
+        const QString error = startTask(entry, speedMap);
+        if (!error.isEmpty()) {
+            // 启动时已进入故障的情况已由 taskFailed 回调结束队列
+            if (!m_queueRunning) return;
+            failQueueStart(entry.taskId, error);
+            return;
+        }
+        preloadNextQueueEntry();
+    });
+}
+
+void DeviceController::failQueueStart(int taskId, const QString &error)
+{
+    LOG_ERR << "队列任务启动失败: ID=" << taskId << " 原因:" << error;
+    emit errorMessage(QString("批量执行中止：任务 %1 启动失败 (%2)").arg(taskId).arg(error));
+    ++m_queueStats.failed;
+    finishQueue();
+}
+
+bool DeviceController::isQueueAt(int index, int generation) const
+{
+    return m_queueRunning && m_queueGeneration == generation && m_queueIndex == index;
+}
+
+void DeviceController::preloadNextQueueEntry()
+{
+    const int next = m_queueIndex + 1;
+    if (next >= m_queue.size() || m_queue[next].loaded) return;
+
+    const int generation = m_queueGeneration;
+    loadQueueEntry(m_queue[next].taskId).then(this, [this, next, generation](QueueEntry entry) {
+        if (!m_queueRunning || m_queueGeneration != generation || next >= m_queue.size()) return;
+        if (!entry.error.isEmpty()) {
+            LOG_WARN << "预加载任务配置失败: ID=" << entry.taskId << " 原因:" << entry.error;
+        }
+        m_queue[next] = entry;
+    });
+}
+
+/**
+ * @brief 队列中的任务结束 (完成或失败)
+ *
+ * 在 TaskManager 的信号回调中调用，下一个任务延后到事件循环中启动，
+ * 避免在状态机回调内重入。
+ */
+void DeviceController::onQueueTaskFinished(bool success)
+{
+    if (!m_queueRunning) return;
+
+    if (m_queueHoming) {
+        // 回零过程中故障
+        m_queueHoming = false;
+        emit errorMessage("批量执行中止：任务间回零失败");
+        finishQueue();
+        return;
+    }
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_queueStats.busyMs += now - m_taskStartMs;
+    m_lastTaskEndMs = now;
+    m_taskStartMs = 0;
+
+    if (!success) {
+        ++m_queueStats.failed;
+        finishQueue();
+        return;
+    }
+
+    ++m_queueStats.completed;
+    ++m_queueIndex;
+    if (m_queueIndex >= m_queue.size()) {
+        finishQueue();
+        return;
+    }
+
+    if (m_queueHomeBetween) {
+        m_queueHoming = true;
+        QTimer::singleShot(0, this, [this](){
+            if (m_queueRunning && m_queueHoming) m_taskManager->home();
+        });
+    } else {
+        QTimer::singleShot(0, this, &DeviceController::startQueueEntry);
+    }
+}
+
+void DeviceController::finishQueue()
+{
+    m_queueRunning = false;
+    ++m_queueGeneration;
+    m_queueHoming = false;
+
+    m_queueStats.elapsedMs = QDateTime::currentMSecsSinceEpoch() - m_queueStartMs;
+    if (m_queueStats.elapsedMs > 0) {
+        m_queueStats.tubesPerHour = m_queueStats.completed * 3600000.0 / m_queueStats.elapsedMs;
+    }
+
+    LOG_INFO << "任务队列结束: 完成 " << m_queueStats.completed << "/" << m_queueStats.total
+             << ", 失败 " << m_queueStats.failed
+             << ", 总耗时 " << m_queueStats.elapsedMs << " ms"
+             << ", 空闲 " << m_queueStats.idleMs << " ms (最大间隔 " << m_queueStats.maxIdleGapMs << " ms)"
+             << ", 吞吐 " << m_queueStats.tubesPerHour << " 管/小时";
+
+    m_queue.clear();
+    m_queueIndex = -1;
+    emit queueFinished(m_queueStats);
+}
+
+/**
+ * @brief 当前任务即将被删除：中止运行并结束检查点与任务队列
+ * 先清除当前任务ID，taskFailed 回调不再为已删除的任务写入结果。
+ */
+void DeviceController::abortDeletedTask()
+{
+    m_currentTaskId = -1;
+    m_taskManager->abortTask("任务已被删除");
+    stopMotion();
+    // 任务未在运行 (如队列正在加载下一个任务) 时 taskFailed 不会发出，这里兜底收尾
+    clearCheckpoint();
+    stopTaskQueue();
+    emit taskStateChanged(m_currentTaskId);
+}
+
+QFuture<bool> DeviceController::deleteTask(int taskId)
+{
+    if (!m_dataManager) return QFuture<bool>();
+
+    if (taskId == m_currentTaskId) {
+        abortDeletedTask();
     }
 
-    const bool ok = m_dataManager->deleteDetectionTask(taskId);
-    if (ok) {
-        LOG_INFO << "任务删除: ID=" << taskId;
+    return m_dataManager->deleteDetectionTaskAsync(taskId).then(this, [taskId](bool ok) {
+        if (ok) {
+            LOG_INFO << "任务删除: ID=" << taskId;
+        }
+        return ok;
+    });
+}
+
+QFuture<DataManager::BulkResult> DeviceController::deleteTasks(const QList<int> &taskIds)
+{
+    if (!m_dataManager) return QFuture<DataManager::BulkResult>();
+
+    if (m_currentTaskId != -1 && taskIds.contains(m_currentTaskId)) {
+        abortDeletedTask();
     }
-    return ok;
+
+    return m_dataManager->deleteDetectionTasksAsync(taskIds);
 }
@@ -7,6 +7,8 @@
 #include "../communication/protocol.h"
 #include "../data/datamanager.h"
 #include "../core/taskmanager.h"
+#include "../core/taskcheckpoint.h"
+#include <QTimer>
 
 /**
  * @brief 设备控制器类
@@ -18,6 +20,20 @@ class DeviceController : public QObject
 {
     Q_OBJECT
 public:
+    /**
+     * @brief 批量执行 (任务队列) 统计
+     */
+    struct QueueStats {
+        int total = 0;              ///< 队列任务数
+        int completed = 0;          ///< 成功完成数
+        int failed = 0;             ///< 失败数
+        qint64 elapsedMs = 0;       ///< 队列总耗时
+        qint64 busyMs = 0;          ///< 任务执行累计时间
+        qint64 idleMs = 0;          ///< 任务间空闲累计时间 (含回零)
+        qint64 maxIdleGapMs = 0;    ///< 最大单次空闲间隔
+        double tubesPerHour = 0.0;  ///< 吞吐量 (完成管数/小时)
+    };
+
     explicit DeviceController(QObject *parent = nullptr);
     ~DeviceController();
 
@@ -76,13 +92,74 @@ public slots:
     // 获取/设置当前任务ID
     int currentTaskId() const { return m_currentTaskId; }
     void activateTask(int taskId);
+    // 任务记录的写操作均为异步 (在 DataManager 数据库线程中执行)，完成后发出 taskRecordChanged
     void startNewTask(const QString &operatorName, const QString &tubeId);
     void endCurrentTask();
-    bool deleteTask(int taskId);
-    bool updateTaskStatus(int taskId, const QString &status);
+    QFuture<bool> deleteTask(int taskId);
+    QFuture<DataManager::BulkResult> deleteTasks(const QList<int> &taskIds);
+    QFuture<bool> updateTaskStatus(int taskId, const QString &status);
+
+    /**
+     * @brief 执行单个已配置的任务
+     * 在数据库线程中读取任务配置 (及速度表所需的历史数据)，完成后激活任务并启动 TaskManager。
+     * @return 失败原因，空字符串表示任务已启动
+     */
+    QFuture<QString> executeTask(int taskId);
+
+    /**
+     * @brief 速度表准备结果
+     */
+    struct SpeedMapResult {
+        bool ok = false;        ///< false 表示任务不使用速度表或准备失败 (error 非空时为失败)
+        SpeedMap map;
+        QString error;
+    };
+
+    /**
+     * @brief 为往返扫描任务准备速度表
+     * 优先使用配置中的速度表文件，其次按同一管道上次扫描的数据推导 (在数据库线程中读取)。
+     */
+    QFuture<SpeedMapResult> prepareSpeedMap(int taskId, const TaskManager::TaskPlan &plan);
+
+    /**
+     * @brief 按顺序批量执行任务
+     * 当前任务执行期间预先读取下一个任务的配置，任务结束后立即衔接，
+     * 无需操作员逐个点击执行。任一任务失败时队列停止 (通过 errorMessage 通知)。
+     * @param taskIds 任务ID列表 (按执行顺序)
+     * @param homeBetween 任务之间是否回零
+     * @param error 可选：失败原因
+     * @return true 队列已启动 (首个任务的配置在后台读取后启动)
+     */
+    bool startTaskQueue(const QList<int> &taskIds, bool homeBetween, QString *error = nullptr);
+
+    /**
+     * @brief 停止任务队列 (不影响当前任务，由调用方决定是否停止运动)
+     */
+    void stopTaskQueue();
+
+    bool isQueueRunning() const { return m_queueRunning; }
+
+    /**
+     * @brief 查询上次异常退出遗留的任务检查点
+     * @return true 存在可恢复的任务
+     */
+    bool pendingCheckpoint(TaskCheckpoint::Record &record) const;
+
+    /**
+     * @brief 按检查点恢复任务 (沿用原 task_id，数据继续关联到该任务)
+     * @return 失败原因，空字符串表示任务已恢复
+     */
+    QFuture<QString> resumeFromCheckpoint();
+
+    /**
+     * @brief 放弃检查点
+     */
+    void discardCheckpoint();
 
 signals:
     void taskCreated(int taskId, const QString& op, const QString& tube);
+    // 任务记录 (状态/执行结果) 已写入数据库，UI 可刷新列表
+    void taskRecordChanged(int taskId);
     // --- 向下层 (通信层) 发送的指令 ---
     // 通过信号槽机制跨线程调用 CommunicationManager 的方法
 
@@ -101,6 +178,11 @@ signals:
      */
     void cmdSendPacket(ControlCommand cmd);
 
+    /**
+     * @brief 命令：下发下位机扫描程序
+     */
+    void cmdUploadProgram(ScanProgram program);
+
     // --- 向上层 (UI) 反馈的状态 ---
 
     /**
@@ -127,6 +209,19 @@ signals:
      */
     void taskStateChanged(int taskId);
 
+    /**
+     * @brief 任务队列进度通知
+     * @param index 当前任务序号 (从 0 开始)
+     * @param total 队列任务总数
+     * @param taskId 当前任务ID
+     */
+    void queueProgress(int index, int total, int taskId);
+
+    /**
+     * @brief 任务队列结束通知 (全部完成、失败中止或被停止)
+     */
+    void queueFinished(const DeviceController::QueueStats &stats);
+
 private slots:
     /**
      * @brief 处理从 CommunicationManager 接收到的反馈数据
@@ -135,12 +230,69 @@ private slots:
     void onFeedbackReceived(MotionFeedback fb);
 
 private:
+    /**
+     * @brief 队列中的一项 (配置预加载后缓存于此)
+     */
+    struct QueueEntry {
+        int taskId = -1;
+        bool loaded = false;
+        QString error;
+        QString taskType;
+        QString taskConfig;
+        TaskManager::TaskPlan plan;
+    };
+
+    QFuture<QueueEntry> loadQueueEntry(int taskId);
+    QString startTask(const QueueEntry &entry, const SpeedMapResult &speedMap);
+    void preloadNextQueueEntry();
+    void startQueueEntry();
+    void startQueueTask(const QueueEntry &entry);
+    void failQueueStart(int taskId, const QString &error);
+    bool isQueueAt(int index, int generation) const;
+    void onQueueTaskFinished(bool success);
+    void finishQueue();
+    void abortDeletedTask();
+    void writeTaskResult(int taskId, const QString &status, const QString &message);
+    void startCheckpointing(const QString &taskType, const QString &taskConfig);
+    void writeCheckpoint();
+    void clearCheckpoint();
+
     QThread m_workerThread;             ///< 负责通信的后台工作线程
     CommunicationManager *m_commManager; ///< 通信管理器实例
     DataManager *m_dataManager;         ///< 数据管理器实例
     TaskManager *m_taskManager;         ///< 任务管理器实例
     
     int m_currentTaskId = -1;           ///< 当前活动的任务ID (-1表示无任务)
+    qint64 m_taskStartMs = 0;           ///< 当前任务开始时间
+
+    /**
+     * @brief 当前任务的周期耗时统计 (写入执行结果，用于对比上位机驱动与下位机执行)
+     */
+    struct CycleTimes {
+        int cycles = 0;
+        qint64 totalMs = 0;
+        qint64 minMs = 0;
+        qint64 maxMs = 0;
+        bool deviceDriven = false;
+    };
+    CycleTimes m_cycleTimes;
+
+    // --- 崩溃恢复检查点 ---
+    TaskCheckpoint m_checkpoint;
+    QTimer m_checkpointTimer;
+    QString m_checkpointTaskType;
+    QString m_checkpointTaskConfig;
+
+    // --- 任务队列 ---
+    QList<QueueEntry> m_queue;
+    int m_queueIndex = -1;
+    int m_queueGeneration = 0;          ///< 队列结束时递增，丢弃已结束队列的异步结果
+    bool m_queueRunning = false;
+    bool m_queueHomeBetween = false;
+    bool m_queueHoming = false;
+    qint64 m_queueStartMs = 0;
+    qint64 m_lastTaskEndMs = 0;
+    QueueStats m_queueStats;
 };
 
 #endif // DEVICECONTROLLER_H
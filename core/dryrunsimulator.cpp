@@ -0,0 +1,188 @@
+#include "dryrunsimulator.h"
+#include "configmanager.h"
+#include "../communication/simulateddevice.h"
+#include "../utils/logger.h"
+#include <QElapsedTimer>
+#include <QtMath>
+
+DryRunSimulator::DryRunSimulator()
+{
+}
+
+DryRunSimulator::DryRunSimulator(const Options &options)
+    : m_options(options)
+{
+}
+
+QString DryRunSimulator::Report::summary() const
+{
+    const qint64 totalSec = durationMs / 1000;
+    QString text = QString("预计耗时: %1:%2:%3\n预计行程: %4 mm\n换向次数: %5")
+                       .arg(totalSec / 3600, 2, 10, QChar('0'))
+                       .arg((totalSec / 60) % 60, 2, 10, QChar('0'))
+                       .arg(totalSec % 60, 2, 10, QChar('0'))
+                       .arg(distanceMm, 0, 'f', 1)
+                       .arg(reversals);
+    if (targetCycles > 0) {
+        text += QString("\n完成周期: %1/%2").arg(completedCycles).arg(targetCycles);
+    }
+    return text;
+}
+
+DryRunSimulator::Report DryRunSimulator::runConfig(const QString &taskType, const QString &configJson) const
+{
+    TaskManager::TaskPlan plan;
+    QString error;
+    if (!TaskManager::parseTaskPlan(taskType, configJson, plan, &error)) {
+        Report report;
+        report.message = error;
+        return report;
+    }
+    return run(plan);
+}
+
+/**
+ * @brief 执行仿真
+ *
+ * 每一帧依次：推进虚拟时钟 -> 设备运动学步进 -> 反馈送入 TaskManager -> tick()，
+ * 与实时运行时"定时反馈 + 看门狗"的调用顺序一致。
+ * 所有信号均为同线程直连，不经过事件循环。
+ */
+DryRunSimulator::Report DryRunSimulator::run(const TaskManager::TaskPlan &plan) const
+{
+    Report report;
+    report.targetCycles = plan.cycles;
+
+    if (plan.cycles <= 0) {
+        report.message = "无限循环任务无法预估耗时";
+        return report;
+    }
+    if (m_options.frameIntervalMs <= 0) {
+        report.message = "仿真帧间隔必须大于 0";
+        return report;
+    }
+
+    QElapsedTimer wallTimer;
+    wallTimer.start();
+
+    const double maxPos = m_options.maxPosition >= 0.0 ? m_options.maxPosition
+                                                       : ConfigManager::instance().maxPosition();
+    const double dtSec = m_options.frameIntervalMs / 1000.0;
+
+    VirtualTaskClock clock;
+    SimulatedDevice device;
+    device.setPosition(m_options.startPosition);
+
+    TaskManager tm;
+    tm.setClock(&clock);
+    tm.setPositionLogging(false);
+
+    if (m_options.useSpeedMap) {
+        tm.setSpeedMap(m_options.speedMap);
+    } else if (!plan.speedMapFile.isEmpty()) {
+        SpeedMap map;
+        if (!SpeedMap::loadFromFile(plan.speedMapFile, plan.speed, map, &report.message)) {
+            report.wallMs = wallTimer.elapsed();
+            return report;
+        }
+        tm.setSpeedMap(map);
+    }
+
+    bool finished = false;
+
+    QObject::connect(&tm, &TaskManager::requestMoveForward, [&device](double speed){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::MoveForward;
+        cmd.param = speed;
+        device.handleCommand(cmd);
+    });
+    QObject::connect(&tm, &TaskManager::requestMoveBackward, [&device](double speed){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::MoveBackward;
+        cmd.param = speed;
+        device.handleCommand(cmd);
+    });
+    QObject::connect(&tm, &TaskManager::requestSetSpeed, [&device](double speed){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::SetSpeed;
+        cmd.param = speed;
+        device.handleCommand(cmd);
+    });
+    QObject::connect(&tm, &TaskManager::requestStop, [&device](){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::Stop;
+        device.handleCommand(cmd);
+    });
+    QObject::connect(&tm, &TaskManager::requestUploadProgram, [&device](const ScanProgram &program){
+        device.loadProgram(program);
+    });
+    QObject::connect(&tm, &TaskManager::requestRunProgram, [&device](){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::ProgramRun;
+        device.handleCommand(cmd);
+    });
+    QObject::connect(&tm, &TaskManager::requestAbortProgram, [&device](){
+        ControlCommand cmd;
+        cmd.type = ControlCommand::ProgramAbort;
+        device.handleCommand(cmd);
+    });
+    QObject::connect(&tm, &TaskManager::progressChanged, [&report](int completed, int){
+        report.completedCycles = completed;
+    });
+    QObject::connect(&tm, &TaskManager::taskCompleted, [&](){
+        report.ok = true;
+        finished = true;
+    });
+    QObject::connect(&tm, &TaskManager::taskFailed, [&](const QString &reason){
+        report.message = reason;
+        finished = true;
+    });
+    QObject::connect(&tm, &TaskManager::fault, [&](const QString &reason){
+        report.message = reason;
+        finished = true;
+    });
+
+    // 先送一帧初始位置，再启动任务
+    tm.updateFeedback(device.state());
+    tm.startPlan(plan);
+    if (!tm.isRunning() && !finished) {
+        report.message = "任务参数无效，未能启动";
+        report.wallMs = wallTimer.elapsed();
+        return report;
+    }
+
+    double lastPos = device.state().position_mm;
+    int lastDir = 0;
+
+    while (!finished && clock.nowMs() < m_options.maxSimMs) {
+        clock.advance(m_options.frameIntervalMs);
+        device.step(dtSec, maxPos);
+
+        const double pos = device.state().position_mm;
+        const double delta = pos - lastPos;
+        if (!qFuzzyIsNull(delta)) {
+            const int dir = delta > 0.0 ? 1 : -1;
+            if (lastDir != 0 && dir != lastDir) {
+                ++report.reversals;
+            }
+            lastDir = dir;
+            report.distanceMm += qAbs(delta);
+            lastPos = pos;
+        }
+
+        tm.updateFeedback(device.state());
+        tm.tick();
+    }
+
+    report.durationMs = clock.nowMs();
+    if (!finished) {
+        report.timedOut = true;
+        report.message = "超过仿真时间上限，任务未完成";
+        tm.stopAll();
+    }
+    report.wallMs = wallTimer.elapsed();
+
+    LOG_INFO << "离线仿真完成: " << plan.type << ", 预计耗时 " << report.durationMs << " ms, 行程 "
+             << report.distanceMm << " mm, 换向 " << report.reversals << " 次, 仿真用时 " << report.wallMs << " ms";
+    return report;
+}
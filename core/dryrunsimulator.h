@@ -0,0 +1,71 @@
+#ifndef DRYRUNSIMULATOR_H
+#define DRYRUNSIMULATOR_H
+
+#include <QString>
+#include "taskmanager.h"
+
+/**
+ * @brief 离线仿真器 (Dry-Run)
+ *
+ * 在虚拟时钟下，用 SimulatedDevice 运动学模型驱动一个独立的 TaskManager，
+ * 不依赖事件循环与实时定时器，可远快于实时地预估任务耗时、行程与换向次数。
+ *
+ * 使用方式：
+ *   DryRunSimulator::Report r = DryRunSimulator().runConfig(taskType, taskConfig);
+ *   if (r.ok) qDebug() << r.summary();
+ */
+class DryRunSimulator
+{
+public:
+    /**
+     * @brief 仿真参数
+     */
+    struct Options {
+        qint64 frameIntervalMs = 100;            ///< 反馈帧间隔，与实时仿真模式一致 (10Hz)
+        qint64 maxSimMs = 24LL * 3600 * 1000;    ///< 虚拟时间上限，超过视为无法完成
+        double startPosition = 0.0;              ///< 起始位置 (mm)
+        double maxPosition = -1.0;               ///< 右限位 (mm)，<0 表示使用配置值
+        bool useSpeedMap = false;                ///< 是否使用下面的速度表 (否则按配置中的速度表文件)
+        SpeedMap speedMap;                       ///< 往返扫描速度表
+    };
+
+    /**
+     * @brief 仿真结果
+     */
+    struct Report {
+        bool ok = false;           ///< 任务是否正常完成
+        bool timedOut = false;     ///< 是否达到虚拟时间上限
+        QString message;           ///< 失败原因
+        qint64 durationMs = 0;     ///< 预估执行时长 (虚拟时间)
+        double distanceMm = 0.0;   ///< 累计行程
+        int reversals = 0;         ///< 换向次数
+        int completedCycles = 0;
+        int targetCycles = 0;
+        qint64 wallMs = 0;         ///< 仿真本身消耗的真实时间
+
+        /**
+         * @brief 生成可读的结果摘要
+         */
+        QString summary() const;
+    };
+
+    DryRunSimulator();
+    explicit DryRunSimulator(const Options &options);
+
+    /**
+     * @brief 仿真一个任务计划
+     */
+    Report run(const TaskManager::TaskPlan &plan) const;
+
+    /**
+     * @brief 仿真 DetectionTask 中保存的任务配置
+     * @param taskType 任务类型 (auto_scan/sequence)
+     * @param configJson task_config 字段内容
+     */
+    Report runConfig(const QString &taskType, const QString &configJson) const;
+
+private:
+    Options m_options;
+};
+
+#endif // DRYRUNSIMULATOR_H
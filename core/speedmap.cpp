@@ -0,0 +1,162 @@
+#include "speedmap.h"
+#include <QFile>
+#include <QTextStream>
+#include <QRegularExpression>
+#include <QtMath>
+#include <algorithm>
+
+SpeedMap::SpeedMap(double defaultSpeed)
+    : m_defaultSpeed(defaultSpeed)
+{
+}
+
+void SpeedMap::setDefaultSpeed(double speed)
+{
+    m_defaultSpeed = speed;
+    rebuild();
+}
+
+void SpeedMap::addRegion(double startMm, double endMm, double speed)
+{
+    if (speed <= 0.0 || qFuzzyCompare(startMm, endMm)) return;
+
+    Region region;
+    region.startMm = qMin(startMm, endMm);
+    region.endMm = qMax(startMm, endMm);
+    region.speed = speed;
+    m_regions.append(region);
+    rebuild();
+}
+
+void SpeedMap::clampSpeeds(double maxSpeed)
+{
+    m_defaultSpeed = qMin(m_defaultSpeed, maxSpeed);
+    for (Region &region : m_regions) {
+        region.speed = qMin(region.speed, maxSpeed);
+    }
+    rebuild();
+}
+
+/**
+ * @brief 将区域展开为互不重叠的有序分段
+ *
+ * 区域数量很少 (通常不超过几十个)，此处用简单的 O(n^2) 展开即可；
+ * 展开只在区域变化时进行，不影响逐帧查询。
+ */
+void SpeedMap::rebuild()
+{
+    m_bounds.clear();
+    m_speeds.clear();
+    if (m_regions.isEmpty()) return;
+
+    QVector<double> bounds;
+    bounds.reserve(m_regions.size() * 2);
+    for (const Region &region : m_regions) {
+        bounds.append(region.startMm);
+        bounds.append(region.endMm);
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+
+    for (int i = 0; i + 1 < bounds.size(); ++i) {
+        const double mid = (bounds.at(i) + bounds.at(i + 1)) / 2.0;
+        double speed = m_defaultSpeed;
+        for (const Region &region : m_regions) {
+            if (mid >= region.startMm && mid < region.endMm) {
+                speed = qMin(speed, region.speed);
+            }
+        }
+
+        // 合并相邻的同速分段
+        if (!m_speeds.isEmpty() && qFuzzyCompare(m_speeds.last(), speed)) {
+            continue;
+        }
+        m_bounds.append(bounds.at(i));
+        m_speeds.append(speed);
+    }
+    m_bounds.append(bounds.last());
+}
+
+double SpeedMap::speedAt(double positionMm) const
+{
+    if (m_speeds.isEmpty()) return m_defaultSpeed;
+
+    const auto it = std::upper_bound(m_bounds.cbegin(), m_bounds.cend(), positionMm);
+    const int index = static_cast<int>(it - m_bounds.cbegin()) - 1;
+    if (index < 0 || index >= m_speeds.size()) {
+        return m_defaultSpeed;
+    }
+    return m_speeds.at(index);
+}
+
+bool SpeedMap::loadFromFile(const QString &path, double defaultSpeed, SpeedMap &map, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error) *error = QString("无法打开速度表文件: %1").arg(path);
+        return false;
+    }
+
+    SpeedMap result(defaultSpeed);
+    static const QRegularExpression separator("[,;\\s]+");
+    QTextStream in(&file);
+    int lineNo = 0;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        ++lineNo;
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        const QStringList fields = line.split(separator, Qt::SkipEmptyParts);
+        bool ok1 = false, ok2 = false, ok3 = false;
+        const double start = fields.value(0).toDouble(&ok1);
+        const double end = fields.value(1).toDouble(&ok2);
+        const double speed = fields.value(2).toDouble(&ok3);
+        if (fields.size() < 3 || !ok1 || !ok2 || !ok3 || speed <= 0.0) {
+            if (error) *error = QString("速度表第 %1 行格式错误: %2").arg(lineNo).arg(line);
+            return false;
+        }
+        result.addRegion(start, end, speed);
+    }
+
+    map = result;
+    return true;
+}
+
+SpeedMap SpeedMap::fromDwellHistory(const QVector<double> &positions, double defaultSpeed, double roiSpeed,
+                                    double binMm, double densityFactor)
+{
+    SpeedMap map(defaultSpeed);
+    if (positions.isEmpty() || binMm <= 0.0) return map;
+
+    const auto [minIt, maxIt] = std::minmax_element(positions.cbegin(), positions.cend());
+    const double origin = *minIt;
+    const int binCount = static_cast<int>((*maxIt - origin) / binMm) + 1;
+
+    QVector<int> counts(binCount, 0);
+    for (double pos : positions) {
+        counts[static_cast<int>((pos - origin) / binMm)]++;
+    }
+
+    QVector<int> nonZero;
+    for (int count : counts) {
+        if (count > 0) nonZero.append(count);
+    }
+    std::nth_element(nonZero.begin(), nonZero.begin() + nonZero.size() / 2, nonZero.end());
+    const int median = nonZero.at(nonZero.size() / 2);
+    const double threshold = qMax(3.0, median * densityFactor);
+
+    // 合并相邻的高密度桶，并各向外扩展一个桶
+    int runStart = -1;
+    for (int i = 0; i <= binCount; ++i) {
+        const bool dense = (i < binCount) && counts.at(i) >= threshold;
+        if (dense && runStart < 0) {
+            runStart = i;
+        } else if (!dense && runStart >= 0) {
+            const double start = origin + (runStart - 1) * binMm;
+            const double end = origin + (i + 1) * binMm;
+            map.addRegion(start, end, roiSpeed);
+            runStart = -1;
+        }
+    }
+    return map;
+}
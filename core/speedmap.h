@@ -0,0 +1,79 @@
+#ifndef SPEEDMAP_H
+#define SPEEDMAP_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 按位置分段的扫描速度表
+ *
+ * 重点区域 (支撑板、历史缺陷指示等) 慢速扫描，其余区域使用默认速度。
+ * 区域可重叠，重叠处取较慢的速度。区域变化时预先展开为有序的分段表，
+ * 每帧查询 speedAt() 只需一次二分查找。
+ */
+class SpeedMap
+{
+public:
+    /**
+     * @brief 速度区域 [startMm, endMm)
+     */
+    struct Region {
+        double startMm = 0.0;
+        double endMm = 0.0;
+        double speed = 0.0;
+    };
+
+    SpeedMap() = default;
+    explicit SpeedMap(double defaultSpeed);
+
+    void setDefaultSpeed(double speed);
+    double defaultSpeed() const { return m_defaultSpeed; }
+
+    /**
+     * @brief 添加速度区域 (start/end 顺序无关)
+     */
+    void addRegion(double startMm, double endMm, double speed);
+
+    /**
+     * @brief 将所有速度限制在 maxSpeed 以内
+     */
+    void clampSpeeds(double maxSpeed);
+
+    bool isEmpty() const { return m_regions.isEmpty(); }
+    const QVector<Region> &regions() const { return m_regions; }
+
+    /**
+     * @brief 查询指定位置的速度 (O(log n))
+     */
+    double speedAt(double positionMm) const;
+
+    /**
+     * @brief 从文本文件导入速度表
+     *
+     * 每行一个区域：起点,终点,速度 (mm, mm, mm/s)，分隔符可为逗号、分号或空白；
+     * 以 # 开头的行和空行忽略。
+     * @param defaultSpeed 区域外使用的速度
+     */
+    static bool loadFromFile(const QString &path, double defaultSpeed, SpeedMap &map, QString *error = nullptr);
+
+    /**
+     * @brief 由历史扫描位置样本推导重点区域
+     *
+     * 按 binMm 将位置分桶统计样本数：等间隔采样下，样本密度高的位置
+     * 即为上次扫描中停留或慢速通过的区域 (操作员复查、支撑板等)。
+     * 样本数达到非空桶中位数 densityFactor 倍的桶判为重点区域，
+     * 相邻重点桶合并，并向两侧各扩展一个桶作为余量。
+     */
+    static SpeedMap fromDwellHistory(const QVector<double> &positions, double defaultSpeed, double roiSpeed,
+                                     double binMm = 5.0, double densityFactor = 2.0);
+
+private:
+    void rebuild();
+
+    QVector<Region> m_regions;
+    QVector<double> m_bounds;   ///< 有序分段边界
+    QVector<double> m_speeds;   ///< m_speeds[i] 对应 [m_bounds[i], m_bounds[i+1])
+    double m_defaultSpeed = 20.0;
+};
+
+#endif // SPEEDMAP_H
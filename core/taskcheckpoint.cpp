@@ -0,0 +1,92 @@
+#include "taskcheckpoint.h"
+#include "configmanager.h"
+#include "../utils/logger.h"
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+static const int kCheckpointVersion = 1;
+
+TaskCheckpoint::TaskCheckpoint(const QString &path)
+    : m_path(path.isEmpty() ? defaultPath() : path)
+{
+}
+
+QString TaskCheckpoint::defaultPath()
+{
+    return QDir(ConfigManager::instance().dataStoragePath()).filePath("task_checkpoint.json");
+}
+
+bool TaskCheckpoint::save(const Record &record)
+{
+    QJsonObject obj;
+    obj["version"] = kCheckpointVersion;
+    obj["taskId"] = record.taskId;
+    obj["taskType"] = record.taskType;
+    obj["taskConfig"] = record.taskConfig;
+    obj["state"] = static_cast<int>(record.snapshot.state);
+    obj["completedCycles"] = record.snapshot.completedCycles;
+    obj["targetCycles"] = record.snapshot.targetCycles;
+    obj["stepIndex"] = record.snapshot.stepIndex;
+    obj["position"] = record.snapshot.position;
+    obj["savedAt"] = record.savedAt.toString(Qt::ISODateWithMs);
+
+    // QSaveFile::commit() 会在重命名前把数据同步到磁盘
+    QSaveFile file(m_path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_ERR << "检查点写入失败: " << file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    if (!file.commit()) {
+        LOG_ERR << "检查点提交失败: " << file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool TaskCheckpoint::load(Record &record) const
+{
+    QFile file(m_path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) {
+        LOG_WARN << "检查点内容无效，已忽略: " << m_path;
+        return false;
+    }
+
+    const QJsonObject obj = doc.object();
+    if (obj["version"].toInt() != kCheckpointVersion || obj["taskId"].toInt(-1) < 0) {
+        LOG_WARN << "检查点版本不匹配或任务ID无效，已忽略";
+        return false;
+    }
+
+    record.taskId = obj["taskId"].toInt();
+    record.taskType = obj["taskType"].toString();
+    record.taskConfig = obj["taskConfig"].toString();
+    record.snapshot.state = static_cast<TaskManager::State>(obj["state"].toInt());
+    record.snapshot.completedCycles = obj["completedCycles"].toInt();
+    record.snapshot.targetCycles = obj["targetCycles"].toInt();
+    record.snapshot.stepIndex = obj["stepIndex"].toInt(-1);
+    record.snapshot.position = obj["position"].toDouble();
+    record.savedAt = QDateTime::fromString(obj["savedAt"].toString(), Qt::ISODateWithMs);
+    return true;
+}
+
+void TaskCheckpoint::clear()
+{
+    if (QFile::exists(m_path) && !QFile::remove(m_path)) {
+        LOG_WARN << "删除检查点失败: " << m_path;
+    }
+}
+
+bool TaskCheckpoint::exists() const
+{
+    return QFile::exists(m_path);
+}
@@ -0,0 +1,63 @@
+#ifndef TASKCHECKPOINT_H
+#define TASKCHECKPOINT_H
+
+#include <QString>
+#include <QDateTime>
+#include "taskmanager.h"
+
+/**
+ * @brief 任务检查点 (崩溃恢复日志)
+ *
+ * 运行中的任务定期把 TaskManager 快照写入数据目录下的一个小文件。
+ * 写入使用 QSaveFile：先写临时文件、同步到磁盘后再原子替换，
+ * 因此任意时刻崩溃，磁盘上要么是上一次完整的检查点，要么是新的检查点。
+ * 任务正常结束 (完成/失败/手动停止) 时删除检查点。
+ */
+class TaskCheckpoint
+{
+public:
+    /**
+     * @brief 检查点内容
+     */
+    struct Record {
+        int taskId = -1;
+        QString taskType;             ///< 任务类型 (恢复时按原配置执行)
+        QString taskConfig;           ///< 任务配置 JSON
+        TaskManager::Snapshot snapshot;
+        QDateTime savedAt;
+    };
+
+    /**
+     * @param path 日志文件路径，为空时使用 defaultPath()
+     */
+    explicit TaskCheckpoint(const QString &path = QString());
+
+    /**
+     * @brief 默认日志路径 (数据存储目录下的 task_checkpoint.json)
+     */
+    static QString defaultPath();
+
+    /**
+     * @brief 写入检查点 (原子替换并同步到磁盘)
+     */
+    bool save(const Record &record);
+
+    /**
+     * @brief 读取检查点
+     * @return false 表示不存在或内容无效
+     */
+    bool load(Record &record) const;
+
+    /**
+     * @brief 删除检查点
+     */
+    void clear();
+
+    bool exists() const;
+    QString path() const { return m_path; }
+
+private:
+    QString m_path;
+};
+
+#endif // TASKCHECKPOINT_H
@@ -0,0 +1,49 @@
+#ifndef TASKCLOCK_H
+#define TASKCLOCK_H
+
+#include <QtGlobal>
+#include <QDateTime>
+
+/**
+ * @brief 任务时钟接口
+ *
+ * TaskManager 的超时/等待判断统一通过该接口取时间，
+ * 便于在离线仿真 (DryRunSimulator) 中替换为虚拟时钟。
+ */
+class TaskClock
+{
+public:
+    virtual ~TaskClock() = default;
+
+    /**
+     * @brief 当前时间戳 (毫秒)
+     */
+    virtual qint64 nowMs() const = 0;
+};
+
+/**
+ * @brief 系统时钟 (墙上时间)
+ */
+class SystemTaskClock final : public TaskClock
+{
+public:
+    qint64 nowMs() const override { return QDateTime::currentMSecsSinceEpoch(); }
+};
+
+/**
+ * @brief 虚拟时钟
+ * 时间只随 advance() 推进，与真实时间无关，可远快于实时运行。
+ */
+class VirtualTaskClock final : public TaskClock
+{
+public:
+    explicit VirtualTaskClock(qint64 startMs = 0) : m_nowMs(startMs) {}
+
+    qint64 nowMs() const override { return m_nowMs; }
+    void advance(qint64 ms) { m_nowMs += ms; }
+
+private:
+    qint64 m_nowMs;
+};
+
+#endif // TASKCLOCK_H
@@ -3,16 +3,14 @@
 #include <QDateTime>
 #include <QtMath>
 #include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 
 #include "../communication/protocol.h"
 #include "../utils/logger.h"
 #include "configmanager.h"
 
-// 获取当前时间戳（毫秒）的辅助函数
-static qint64 nowMs()
-{
-    return QDateTime::currentMSecsSinceEpoch();
-}
 
 TaskManager::TaskManager(QObject* parent)
     : QObject(parent)
@@ -34,7 +32,8 @@ bool TaskManager::isRunning() const
         || m_state == State::AutoBackward
         || m_state == State::Stopping
         || m_state == State::StepExecution
-        || m_state == State::Resetting;
+        || m_state == State::Resetting
+        || m_state == State::DeviceProgram;
 }
 
 void TaskManager::setPositionTolerance(double tol)
@@ -57,6 +56,153 @@ int TaskManager::edgeTimeoutMs() const
     return m_edgeTimeoutMs;
 }
 
+void TaskManager::setClock(TaskClock *clock)
+{
+    m_clock = clock;
+    if (m_clock && m_watchdog.isActive()) {
+        // 外部时钟驱动时不再使用实时定时器，由 tick() 推进
+        m_watchdog.stop();
+    }
+}
+
+void TaskManager::setSpeedMap(const SpeedMap &map)
+{
+    m_speedMap = map;
+    m_useSpeedMap = true;
+    LOG_INFO << "已设置速度表: 区域数=" << map.regions().size() << ", 默认速度=" << map.defaultSpeed() << " mm/s";
+}
+
+void TaskManager::clearSpeedMap()
+{
+    m_speedMap = SpeedMap();
+    m_useSpeedMap = false;
+}
+
+void TaskManager::setPositionLogging(bool enabled)
+{
+    m_logPositions = enabled;
+}
+
+qint64 TaskManager::nowMs() const
+{
+    return m_clock ? m_clock->nowMs() : QDateTime::currentMSecsSinceEpoch();
+}
+
+/**
+ * @brief 外部时钟模式下推进一次内部定时逻辑
+ *
+ * 依次处理延迟执行的下一步与看门狗检查，等价于实时模式下的
+ * QTimer::singleShot(0) 回调与 m_watchdog 超时回调。
+ */
+void TaskManager::tick()
+{
+    if (m_deferredNextStep) {
+        m_deferredNextStep = false;
+        if (m_state == State::StepExecution) {
+            executeNextStep();
+        }
+    }
+    if (m_watchdogActive) {
+        onWatchdogTick();
+    }
+}
+
+void TaskManager::startWatchdog()
+{
+    m_watchdogActive = true;
+    if (!m_clock) {
+        m_watchdog.start();
+    }
+}
+
+void TaskManager::stopWatchdog()
+{
+    m_watchdogActive = false;
+    m_watchdog.stop();
+}
+
+void TaskManager::deferNextStep()
+{
+    if (m_clock) {
+        m_deferredNextStep = true;
+    } else {
+        QTimer::singleShot(0, this, [this](){ executeNextStep(); });
+    }
+}
+
+/**
+ * @brief 解析 DetectionTask.task_config 中保存的任务配置
+ *
+ * 缺省值与任务配置对话框保持一致。
+ */
+bool TaskManager::parseTaskPlan(const QString &taskType, const QString &configJson, TaskPlan &plan, QString *error)
+{
+    if (taskType != "auto_scan" && taskType != "sequence") {
+        if (error) *error = QString("不支持的任务类型: %1").arg(taskType);
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(configJson.toUtf8(), &parseError);
+    if (parseError.error != QJsonParseError::NoError) {
+        if (error) *error = "任务配置格式错误";
+        return false;
+    }
+
+    QJsonObject config = doc.object();
+    plan = TaskPlan();
+    plan.type = taskType;
+    plan.deviceExecution = config["deviceExecution"].toBool(false);
+
+    if (taskType == "auto_scan") {
+        plan.minPos = config["minPos"].toDouble(0.0);
+        plan.maxPos = config["maxPos"].toDouble(100.0);
+        plan.speed = config["speed"].toDouble(20.0);
+        plan.cycles = config["cycles"].toInt(5);
+        plan.adaptiveSpeed = config["adaptiveSpeed"].toBool(false);
+        plan.roiSpeed = config["roiSpeed"].toDouble(5.0);
+        plan.speedMapFile = config["speedMapFile"].toString();
+        return true;
+    }
+
+    plan.cycles = config["cycles"].toInt(1);
+    const QJsonArray stepsArray = config["steps"].toArray();
+    for (const QJsonValue &stepValue : stepsArray) {
+        QJsonObject stepObj = stepValue.toObject();
+        TaskStep step;
+        step.type = static_cast<StepType>(stepObj["type"].toInt());
+        step.param1 = stepObj["param1"].toDouble();
+        step.param2 = stepObj["param2"].toDouble();
+
+        // 生成描述
+        if (step.type == StepType::MoveTo) {
+            step.description = QString("MoveTo %1mm @ %2%").arg(step.param1).arg(step.param2);
+        } else if (step.type == StepType::Wait) {
+            step.description = QString("Wait %1ms").arg(step.param1);
+        }
+
+        plan.steps.append(step);
+    }
+    return true;
+}
+
+void TaskManager::startPlan(const TaskPlan &plan)
+{
+    if (plan.type == "auto_scan") {
+        if (plan.deviceExecution) {
+            startAutoScanOnDevice(plan.minPos, plan.maxPos, plan.speed, plan.cycles);
+        } else {
+            startAutoScan(plan.minPos, plan.maxPos, plan.speed, plan.cycles);
+        }
+    } else if (plan.type == "sequence") {
+        if (plan.deviceExecution) {
+            startTaskSequenceOnDevice(plan.steps, plan.cycles);
+        } else {
+            startTaskSequence(plan.steps, plan.cycles);
+        }
+    }
+}
+
 /**
  * @brief 启动自动扫描任务
  * 
@@ -65,49 +211,111 @@ int TaskManager::edgeTimeoutMs() const
  * 3. 决定初始运动方向（离哪边远就往哪边跑，或者固定策略）。
  * 4. 启动看门狗并发送运动指令。
  */
-void TaskManager::startAutoScan(double minPos, double maxPos, double speed, int cycles)
+TaskManager::Snapshot TaskManager::snapshot() const
 {
-    LOG_INFO << "========== 启动自动扫描任务 ==========";
-    LOG_INFO << "参数 - 最小位置: " << minPos << " mm, 最大位置: " << maxPos << " mm";
-    LOG_INFO << "参数 - 速度: " << speed << " mm/s, 周期数: " << cycles;
-    
+    Snapshot snap;
+    snap.state = (m_state == State::Paused) ? m_lastMotionState : m_state;
+    snap.completedCycles = m_completedCycles;
+    snap.targetCycles = m_targetCycles;
+    snap.stepIndex = (snap.state == State::StepExecution) ? m_currentStepIndex : -1;
+    snap.position = m_position;
+    return snap;
+}
+
+bool TaskManager::resumePlan(const TaskPlan &plan, const Snapshot &snap)
+{
+    LOG_INFO << "========== 从检查点恢复任务 ==========";
+    LOG_INFO << "类型: " << plan.type << ", 已完成周期: " << snap.completedCycles
+             << ", 步骤: " << snap.stepIndex << ", 中断位置: " << snap.position << " mm";
+
     if (m_state != State::Idle && m_state != State::Fault) {
-        LOG_WARN << "任务启动失败: 当前状态不是Idle或Fault (当前状态: " << (int)m_state << ")";
         emit message("任务正在运行，请先停止");
-        return;
+        return false;
+    }
+    if (plan.cycles > 0 && snap.completedCycles >= plan.cycles) {
+        emit message("检查点显示任务已完成全部周期，无需恢复");
+        return false;
     }
 
-    // 参数校验
-    if (qIsNaN(minPos) || qIsNaN(maxPos) || qIsNaN(speed)) {
-        LOG_ERR << "参数校验失败: 存在NaN值";
-        enterFault("startAutoScan: parameter is NaN.");
-        return;
+    // 下位机程序无法从中间指令续跑，按剩余周期重新下发
+    if (plan.deviceExecution) {
+        TaskPlan rest = plan;
+        if (plan.cycles > 0) {
+            rest.cycles = plan.cycles - snap.completedCycles;
+        }
+        startPlan(rest);
+        if (!isRunning()) {
+            return false;
+        }
+        // 周期计数仍按原计划累计，检查点中的已完成周期在再次中断后保持正确
+        m_completedCycles = snap.completedCycles;
+        m_targetCycles = plan.cycles;
+        emit progressChanged(m_completedCycles, m_targetCycles);
+        return true;
     }
 
-    // 参数校验：检查最大行程限制
-    double limitPos = ConfigManager::instance().maxPosition();
-    if (maxPos > limitPos) {
-        LOG_ERR << "参数校验失败: 目标位置 " << maxPos << " mm 超过系统限制 " << limitPos << " mm";
-        emit fault(QString("目标位置 %1 mm 超过系统最大行程限制 %2 mm").arg(maxPos).arg(limitPos));
-        return;
+    if (plan.type == "auto_scan") {
+        if (!validateAutoScan(plan.minPos, plan.maxPos, plan.speed)) {
+            return false;
+        }
+        m_minPos = plan.minPos;
+        m_maxPos = plan.maxPos;
+        m_speed  = plan.speed;
+        m_targetCycles = plan.cycles;
+        m_completedCycles = snap.completedCycles;
+        m_sequenceSteps.clear();
+        m_cycleStartMs = nowMs();
+
+        emit progressChanged(m_completedCycles, m_targetCycles);
+        startWatchdog();
+
+        // 按中断前的方向继续，保证周期计数与往返次序一致
+        if (snap.state == State::AutoBackward) {
+            startMovingToMin();
+        } else {
+            startMovingToMax();
+        }
+        emit message(QString("自动扫描已恢复：从第 %1 个周期继续").arg(m_completedCycles + 1));
+        return true;
     }
-    
-    // 参数校验：检查最大速度限制
-    double limitSpeed = ConfigManager::instance().maxSpeed();
-    if (speed > limitSpeed) {
-        LOG_ERR << "参数校验失败: 目标速度 " << speed << " mm/s 超过系统限制 " << limitSpeed << " mm/s";
-        emit fault(QString("目标速度 %1 mm/s 超过系统最大速度限制 %2 mm/s").arg(speed).arg(limitSpeed));
-        return;
+
+    if (plan.steps.isEmpty()) {
+        emit fault("任务序列为空");
+        return false;
     }
 
-    if (maxPos <= minPos) {
-        LOG_ERR << "参数校验失败: maxPos <= minPos";
-        enterFault("startAutoScan: maxPos must be greater than minPos.");
+    m_sequenceSteps = plan.steps;
+    m_targetCycles = plan.cycles;
+    m_completedCycles = snap.completedCycles;
+    // executeNextStep 会先自增，从中断的步骤重新执行
+    m_currentStepIndex = qBound(0, snap.stepIndex, plan.steps.size() - 1) - 1;
+    m_isStepWaiting = false;
+    m_cycleStartMs = nowMs();
+
+    emit progressChanged(m_completedCycles, m_targetCycles);
+
+    setState(State::StepExecution);
+    startWatchdog();
+    emit message(QString("任务序列已恢复：周期 %1, 步骤 %2")
+                 .arg(m_completedCycles + 1).arg(m_currentStepIndex + 2));
+
+    executeNextStep();
+    return true;
+}
+
+void TaskManager::startAutoScan(double minPos, double maxPos, double speed, int cycles)
+{
+    LOG_INFO << "========== 启动自动扫描任务 ==========";
+    LOG_INFO << "参数 - 最小位置: " << minPos << " mm, 最大位置: " << maxPos << " mm";
+    LOG_INFO << "参数 - 速度: " << speed << " mm/s, 周期数: " << cycles;
+    
+    if (m_state != State::Idle && m_state != State::Fault) {
+        LOG_WARN << "任务启动失败: 当前状态不是Idle或Fault (当前状态: " << (int)m_state << ")";
+        emit message("任务正在运行，请先停止");
         return;
     }
-    if (speed <= 0.0) {
-        LOG_ERR << "参数校验失败: speed <= 0";
-        enterFault("startAutoScan: speed must be > 0.");
+
+    if (!validateAutoScan(minPos, maxPos, speed)) {
         return;
     }
 
@@ -118,6 +326,7 @@ void TaskManager::startAutoScan(double minPos, double maxPos, double speed, int
     m_speed  = speed;
     m_targetCycles = cycles;
     m_completedCycles = 0;
+    m_cycleStartMs = nowMs();
 
     emit progressChanged(m_completedCycles, m_targetCycles);
 
@@ -129,7 +338,7 @@ void TaskManager::startAutoScan(double minPos, double maxPos, double speed, int
     LOG_INFO << "当前位置: " << m_position << " mm";
     LOG_INFO << "到最小位置距离: " << distToMin << " mm, 到最大位置距离: " << distToMax << " mm";
 
-    m_watchdog.start();
+    startWatchdog();
     LOG_INFO << "看门狗定时器已启动";
 
     if (distToMax < distToMin) {
@@ -144,6 +353,48 @@ void TaskManager::startAutoScan(double minPos, double maxPos, double speed, int
                  .arg(m_minPos).arg(m_maxPos).arg(m_speed).arg(m_targetCycles));
 }
 
+/**
+ * @brief 往返扫描参数校验 (主机驱动与下位机程序共用)
+ */
+bool TaskManager::validateAutoScan(double minPos, double maxPos, double speed)
+{
+    // 参数校验
+    if (qIsNaN(minPos) || qIsNaN(maxPos) || qIsNaN(speed)) {
+        LOG_ERR << "参数校验失败: 存在NaN值";
+        enterFault("startAutoScan: parameter is NaN.");
+        return false;
+    }
+
+    // 参数校验：检查最大行程限制
+    double limitPos = ConfigManager::instance().maxPosition();
+    if (maxPos > limitPos) {
+        LOG_ERR << "参数校验失败: 目标位置 " << maxPos << " mm 超过系统限制 " << limitPos << " mm";
+        emit fault(QString("目标位置 %1 mm 超过系统最大行程限制 %2 mm").arg(maxPos).arg(limitPos));
+        return false;
+    }
+    
+    // 参数校验：检查最大速度限制
+    double limitSpeed = ConfigManager::instance().maxSpeed();
+    if (speed > limitSpeed) {
+        LOG_ERR << "参数校验失败: 目标速度 " << speed << " mm/s 超过系统限制 " << limitSpeed << " mm/s";
+        emit fault(QString("目标速度 %1 mm/s 超过系统最大速度限制 %2 mm/s").arg(speed).arg(limitSpeed));
+        return false;
+    }
+
+    if (maxPos <= minPos) {
+        LOG_ERR << "参数校验失败: maxPos <= minPos";
+        enterFault("startAutoScan: maxPos must be greater than minPos.");
+        return false;
+    }
+    if (speed <= 0.0) {
+        LOG_ERR << "参数校验失败: speed <= 0";
+        enterFault("startAutoScan: speed must be > 0.");
+        return false;
+    }
+
+    return true;
+}
+
 void TaskManager::startTaskSequence(const QList<TaskStep> &steps, int cycles)
 {
     LOG_INFO << "========== 启动任务序列 ==========";
@@ -173,12 +424,13 @@ void TaskManager::startTaskSequence(const QList<TaskStep> &steps, int cycles)
     m_completedCycles = 0;
     m_currentStepIndex = -1; // 将在 executeNextStep 中自增为 0
     m_isStepWaiting = false;
+    m_cycleStartMs = nowMs();
 
     emit progressChanged(m_completedCycles, m_targetCycles);
     
     // 开始执行
     setState(State::StepExecution);
-    m_watchdog.start();
+    startWatchdog();
     LOG_INFO << "看门狗定时器已启动";
     
     emit message(QString("高级任务序列已启动：步骤数=%1, 周期=%2").arg(steps.size()).arg(cycles));
@@ -194,6 +446,11 @@ void TaskManager::pause()
     LOG_INFO << "========== 暂停任务 ==========";
     LOG_INFO << "当前状态: " << (int)m_state;
     
+    if (m_state == State::DeviceProgram) {
+        LOG_WARN << "暂停失败: 下位机程序执行中不支持暂停，请使用停止";
+        emit message("下位机程序执行中不支持暂停，如需中断请停止任务。");
+        return;
+    }
     if (m_state != State::AutoForward && m_state != State::AutoBackward && m_state != State::StepExecution) {
         LOG_WARN << "暂停失败: 当前状态不支持暂停操作";
         return;
@@ -258,12 +515,16 @@ void TaskManager::stopAll()
         LOG_INFO << "当前已是Idle状态，无需停止";
         return;
     }
+    const bool wasDeviceProgram = (m_state == State::DeviceProgram);
     setState(State::Stopping);
+    if (wasDeviceProgram) {
+        emit requestAbortProgram();
+    }
     emit requestStop();
 
     // 立即回到 Idle（如果需要等设备确认停稳，可把这个延后到 status 回调中处理）
     setState(State::Idle);
-    m_watchdog.stop();
+    stopWatchdog();
     LOG_INFO << "看门狗定时器已停止";
 
     emit message("任务已停止。");
@@ -302,13 +563,14 @@ void TaskManager::resetTask()
     if (reached(m_position, m_resetTargetPos)) {
         // 已经在目标位置，直接完成重置
         setState(State::Idle);
-        m_watchdog.stop();
+        stopWatchdog();
         emit message("任务已重置完成。");
+        emit homingFinished();
         return;
     }
     
     // 启动看门狗
-    m_watchdog.start();
+    startWatchdog();
     m_motionStartMs = nowMs();
     
     // 根据当前位置决定移动方向
@@ -321,6 +583,35 @@ void TaskManager::resetTask()
     }
 }
 
+/**
+ * @brief 回零
+ * 复用 Resetting 状态：到位判断、超时检测与重置流程一致。
+ */
+void TaskManager::home(double position, double speed)
+{
+    if (m_state != State::Idle) {
+        emit message("只能在空闲状态下回零");
+        return;
+    }
+
+    m_resetTargetPos = position;
+    if (reached(m_position, m_resetTargetPos)) {
+        emit homingFinished();
+        return;
+    }
+
+    setState(State::Resetting);
+    startWatchdog();
+    m_motionStartMs = nowMs();
+
+    if (m_position > m_resetTargetPos) {
+        emit requestMoveBackward(speed);
+    } else {
+        emit requestMoveForward(speed);
+    }
+    emit message(QString("回零中，正在移动到 %1mm...").arg(m_resetTargetPos));
+}
+
 /**
  * @brief 核心逻辑：位置更新回调
  * 
@@ -330,10 +621,9 @@ void TaskManager::resetTask()
 void TaskManager::onPositionUpdated(double position)
 {
     // 只在位置有明显变化时才记录日志，避免日志泛滥
-    static double lastLoggedPos = -999.0;
-    if (qAbs(position - lastLoggedPos) > 1.0) { // 每移动1mm记录一次
+    if (m_logPositions && qAbs(position - m_lastLoggedPos) > 1.0) { // 每移动1mm记录一次
         LOG_INFO << "位置更新: " << position << " mm (状态: " << (int)m_state << ")";
-        lastLoggedPos = position;
+        m_lastLoggedPos = position;
     }
     
     m_position = position;
@@ -341,26 +631,27 @@ void TaskManager::onPositionUpdated(double position)
     // 只有运行状态下才做边界判断
     if (m_state == State::StepExecution) {
         checkStepCompletion(m_position);
+    } else if (m_state == State::DeviceProgram) {
+        trackDeviceProgram(m_position);
     } else if (m_state == State::AutoForward) {
         if (reached(m_position, m_maxPos)) {
             LOG_INFO << "已到达最大位置: " << m_maxPos << " mm";
             // 到达 max：开始向 min
             startMovingToMin();
         }
+        applySpeedMap();
     } else if (m_state == State::AutoBackward) {
         if (reached(m_position, m_minPos)) {
             LOG_INFO << "已到达最小位置: " << m_minPos << " mm";
             // 到达 min：完成一次往返
-            m_completedCycles++;
-            LOG_INFO << "完成周期: " << m_completedCycles << " / " << m_targetCycles;
-            emit progressChanged(m_completedCycles, m_targetCycles);
+            finishCycle(false);
 
             // 检查是否完成所有周期
             if (m_targetCycles > 0 && m_completedCycles >= m_targetCycles) {
                 LOG_INFO << "所有周期已完成，停止任务";
                 emit requestStop();
                 setState(State::Idle);
-                m_watchdog.stop();
+                stopWatchdog();
                 emit message("自动扫描已完成。");
                 emit taskCompleted(); // 通知任务完成
                 return;
@@ -370,14 +661,16 @@ void TaskManager::onPositionUpdated(double position)
             LOG_INFO << "开始下一周期";
             startMovingToMax();
         }
+        applySpeedMap();
     } else if (m_state == State::Resetting) {
         // 检查是否到达重置目标位置
         if (reached(m_position, m_resetTargetPos)) {
             LOG_INFO << "已到达重置目标位置: " << m_resetTargetPos << " mm";
             emit requestStop();
             setState(State::Idle);
-            m_watchdog.stop();
+            stopWatchdog();
             emit message("任务重置完成。");
+            emit homingFinished();
         }
     }
 }
@@ -394,6 +687,15 @@ void TaskManager::updateFeedback(const MotionFeedback &fb)
     
     // 更新位置，驱动状态机
     onPositionUpdated(fb.position_mm);
+
+    // 下位机程序：以 programActive 标志的下降沿判定程序结束
+    if (m_state == State::DeviceProgram) {
+        if (fb.programActive) {
+            m_programSeenActive = true;
+        } else if (m_programSeenActive) {
+            finishDeviceProgram();
+        }
+    }
 }
 
 /**
@@ -413,7 +715,8 @@ void TaskManager::onWatchdogTick()
     }
 
     if (m_state != State::AutoForward && m_state != State::AutoBackward && 
-        m_state != State::StepExecution && m_state != State::Resetting) {
+        m_state != State::StepExecution && m_state != State::Resetting &&
+        m_state != State::DeviceProgram) {
         return;
     }
     // 如果还没记录开始时间，现在记录
@@ -425,6 +728,15 @@ void TaskManager::onWatchdogTick()
     // 序列任务中，如果是在移动，也需要检查超时 (Motion MoveTo)
     // 这里简单共用 edgeTimeout
     const qint64 elapsed = nowMs() - m_motionStartMs;
+    if (m_state == State::DeviceProgram) {
+        // 下位机程序以下位机为准，影子目标可能错过，只在长时间没有任何运动时判定超时
+        if (elapsed > m_edgeTimeoutMs + m_programMaxWaitMs) {
+            enterFault(QString("下位机程序无响应：已超过%1ms没有运动，当前位置=%2mm")
+                           .arg(elapsed)
+                           .arg(m_position));
+        }
+        return;
+    }
     if (elapsed > m_edgeTimeoutMs) {
         // 超时未到达目标边界
         QString target = "target";
@@ -451,12 +763,25 @@ void TaskManager::setState(State s)
 /**
  * @brief 进入故障状态
  */
+bool TaskManager::abortTask(const QString& reason)
+{
+    if (m_state == State::Idle || m_state == State::Fault) {
+        return false;
+    }
+    enterFault(reason);
+    return true;
+}
+
 void TaskManager::enterFault(const QString& reason)
 {
     LOG_ERR << "========== 进入故障状态 ==========";
     LOG_ERR << "故障原因: " << reason;
+    const bool wasDeviceProgram = (m_state == State::DeviceProgram);
     setState(State::Fault);
-    m_watchdog.stop();
+    if (wasDeviceProgram) {
+        emit requestAbortProgram();
+    }
+    stopWatchdog();
     LOG_INFO << "看门狗定时器已停止";
     emit requestStop(); // 尝试停止硬件
     emit fault(reason);
@@ -474,7 +799,8 @@ void TaskManager::startMovingToMax()
     setState(State::AutoForward);
     m_motionStartMs = nowMs(); // 重置超时计时
     LOG_INFO << "运动开始时间戳: " << m_motionStartMs;
-    emit requestMoveForward(m_speed);
+    m_commandedSpeed = m_useSpeedMap ? scanSpeedAt(m_position, 1) : m_speed;
+    emit requestMoveForward(m_commandedSpeed);
 }
 
 /**
@@ -487,7 +813,8 @@ void TaskManager::startMovingToMin()
     setState(State::AutoBackward);
     m_motionStartMs = nowMs(); // 重置超时计时
     LOG_INFO << "运动开始时间戳: " << m_motionStartMs;
-    emit requestMoveBackward(m_speed);
+    m_commandedSpeed = m_useSpeedMap ? scanSpeedAt(m_position, -1) : m_speed;
+    emit requestMoveBackward(m_commandedSpeed);
 }
 
 /**
@@ -500,6 +827,258 @@ bool TaskManager::reached(double pos, double target) const
     return qAbs(pos - target) <= m_tol;
 }
 
+/**
+ * @brief 按速度表查询扫描速度
+ *
+ * 除当前位置外，还向运动方向预看一个反馈周期的行程，
+ * 保证进入重点区域之前已经减速。
+ */
+double TaskManager::scanSpeedAt(double pos, int direction) const
+{
+    static const double kLookaheadSec = 0.1; // 反馈周期 (10Hz)
+    const double here = m_speedMap.speedAt(pos);
+    const double ahead = pos + direction * qMax(here, m_commandedSpeed) * kLookaheadSec;
+    return qMin(here, m_speedMap.speedAt(ahead));
+}
+
+/**
+ * @brief 往返扫描中按当前位置调整速度，仅在速度变化时下发
+ */
+void TaskManager::applySpeedMap()
+{
+    if (!m_useSpeedMap) return;
+    if (m_state != State::AutoForward && m_state != State::AutoBackward) return;
+
+    const double speed = scanSpeedAt(m_position, m_state == State::AutoForward ? 1 : -1);
+    if (qAbs(speed - m_commandedSpeed) > 1e-3) {
+        m_commandedSpeed = speed;
+        emit requestSetSpeed(speed);
+    }
+}
+
+/**
+ * @brief 记录一个周期完成，并统计周期耗时
+ */
+void TaskManager::finishCycle(bool deviceDriven)
+{
+    m_completedCycles++;
+    const qint64 now = nowMs();
+    const qint64 elapsed = now - m_cycleStartMs;
+    m_cycleStartMs = now;
+
+    LOG_INFO << "完成周期: " << m_completedCycles << " / " << m_targetCycles
+             << ", 耗时: " << elapsed << " ms (" << (deviceDriven ? "下位机执行" : "上位机驱动") << ")";
+    emit cycleTimeMeasured(m_completedCycles, elapsed, deviceDriven);
+    emit progressChanged(m_completedCycles, m_targetCycles);
+}
+
+// --- 下位机程序相关 ---
+
+ScanProgram TaskManager::compileAutoScan(double minPos, double maxPos, double speed, int cycles)
+{
+    ScanProgram program;
+    program.cycles = cycles;
+    program.instructions.append({ProgramInstruction::MoveTo, maxPos, speed});
+    program.instructions.append({ProgramInstruction::MoveTo, minPos, speed});
+    return program;
+}
+
+ScanProgram TaskManager::compileSequence(const QList<TaskStep> &steps, int cycles)
+{
+    ScanProgram program;
+    program.cycles = cycles;
+    for (const TaskStep &step : steps) {
+        switch (step.type) {
+        case StepType::MoveTo:
+            // 与主机驱动保持一致：未指定速度时使用默认 20.0
+            program.instructions.append({ProgramInstruction::MoveTo, step.param1,
+                                         step.param2 > 0 ? step.param2 : 20.0});
+            break;
+        case StepType::Wait:
+            program.instructions.append({ProgramInstruction::Wait, step.param1, 0.0});
+            break;
+        case StepType::SetSpeed:
+            if (step.param1 > 0) {
+                program.instructions.append({ProgramInstruction::SetSpeed, step.param1, 0.0});
+            }
+            break;
+        }
+    }
+    return program;
+}
+
+void TaskManager::startAutoScanOnDevice(double minPos, double maxPos, double speed, int cycles)
+{
+    LOG_INFO << "========== 启动自动扫描任务 (下位机执行) ==========";
+    LOG_INFO << "参数 - 最小位置: " << minPos << " mm, 最大位置: " << maxPos << " mm";
+    LOG_INFO << "参数 - 速度: " << speed << " mm/s, 周期数: " << cycles;
+
+    if (m_state != State::Idle && m_state != State::Fault) {
+        LOG_WARN << "任务启动失败: 当前状态不是Idle或Fault (当前状态: " << (int)m_state << ")";
+        emit message("任务正在运行，请先停止");
+        return;
+    }
+    if (!validateAutoScan(minPos, maxPos, speed)) {
+        return;
+    }
+
+    if (m_useSpeedMap) {
+        LOG_WARN << "下位机执行模式不支持速度表，按恒定速度 " << speed << " mm/s 扫描";
+    }
+
+    m_minPos = minPos;
+    m_maxPos = maxPos;
+    m_speed  = speed;
+    m_sequenceSteps.clear();
+    startDeviceProgram(compileAutoScan(minPos, maxPos, speed, cycles));
+}
+
+void TaskManager::startTaskSequenceOnDevice(const QList<TaskStep> &steps, int cycles)
+{
+    LOG_INFO << "========== 启动任务序列 (下位机执行) ==========";
+    LOG_INFO << "步骤数: " << steps.size() << ", 周期数: " << cycles;
+
+    if (m_state != State::Idle && m_state != State::Fault) {
+        LOG_WARN << "任务启动失败: 当前状态不是Idle或Fault";
+        emit message("任务正在运行，请先停止");
+        return;
+    }
+    if (steps.isEmpty()) {
+        LOG_ERR << "任务启动失败: 步骤列表为空";
+        emit fault("任务序列为空");
+        return;
+    }
+
+    // 程序一次性下发，必须在下发前完成全部目标位置的限位检查
+    const double maxPos = ConfigManager::instance().maxPosition();
+    for (int i = 0; i < steps.size(); ++i) {
+        const TaskStep &step = steps.at(i);
+        if (step.type == StepType::MoveTo && (step.param1 > maxPos || step.param1 < 0.0)) {
+            enterFault(QString("步骤 %1: 目标位置 %2mm 超出行程范围 [0, %3]mm").arg(i).arg(step.param1).arg(maxPos));
+            return;
+        }
+    }
+
+    m_sequenceSteps = steps;
+    startDeviceProgram(compileSequence(steps, cycles));
+}
+
+/**
+ * @brief 下发并启动下位机程序，进入监控状态
+ */
+void TaskManager::startDeviceProgram(const ScanProgram &program)
+{
+    ScanProgram prog = program;
+    prog.tolerance = m_tol;
+
+    // 按 MoveTo 顺序建立影子目标表，用于上位机侧的进度监控
+    m_programTargets.clear();
+    m_programMaxWaitMs = 0;
+    qint64 pendingWaitMs = 0;
+    for (const ProgramInstruction &ins : prog.instructions) {
+        if (ins.op == ProgramInstruction::MoveTo) {
+            m_programTargets.append(ins.param1);
+            pendingWaitMs = 0;
+        } else if (ins.op == ProgramInstruction::Wait) {
+            pendingWaitMs += static_cast<qint64>(ins.param1);
+            m_programMaxWaitMs = qMax(m_programMaxWaitMs, pendingWaitMs);
+        }
+    }
+    m_programTargetIndex = 0;
+    m_programSeenActive = false;
+    m_programMotionPos = m_position;
+    beginProgramTarget(m_position);
+
+    m_targetCycles = prog.cycles;
+    m_completedCycles = 0;
+    m_cycleStartMs = nowMs();
+    emit progressChanged(m_completedCycles, m_targetCycles);
+
+    setState(State::DeviceProgram);
+    m_motionStartMs = nowMs();
+    startWatchdog();
+
+    emit requestUploadProgram(prog);
+    emit requestRunProgram();
+
+    emit message(QString("下位机程序已下发并启动：指令数=%1, 周期=%2")
+                 .arg(prog.instructions.size()).arg(prog.cycles));
+}
+
+/**
+ * @brief 影子跟踪下位机程序进度
+ *
+ * 依次匹配 MoveTo 目标，全部目标到达一轮即视为完成一个周期。
+ * 反馈采样间隔内下位机可能越过目标或在目标处换向，采样点不一定落在容差内，
+ * 因此到位、两次采样之间越过目标、或朝目标运动后明显反向，都视为到达目标。
+ */
+void TaskManager::trackDeviceProgram(double currentPos)
+{
+    // 有运动即喂看门狗
+    if (qAbs(currentPos - m_programMotionPos) > m_tol) {
+        m_programMotionPos = currentPos;
+        m_motionStartMs = nowMs();
+    }
+
+    if (m_programTargets.isEmpty()) return;
+
+    const double target = m_programTargets.at(m_programTargetIndex);
+    const bool crossed = (m_programLastPos - target) * (currentPos - target) < 0.0;
+    bool reversed = false;
+    if (m_programDir > 0) {
+        m_programExtreme = qMax(m_programExtreme, currentPos);
+        reversed = m_programExtreme - currentPos > m_tol;
+    } else if (m_programDir < 0) {
+        m_programExtreme = qMin(m_programExtreme, currentPos);
+        reversed = currentPos - m_programExtreme > m_tol;
+    }
+    m_programLastPos = currentPos;
+
+    if (!reached(currentPos, target) && !crossed && !reversed) return;
+
+    m_programTargetIndex++;
+    if (m_programTargetIndex >= m_programTargets.size()) {
+        m_programTargetIndex = 0;
+        if (m_targetCycles <= 0 || m_completedCycles < m_targetCycles) {
+            finishCycle(true);
+        }
+    }
+    beginProgramTarget(currentPos);
+}
+
+/**
+ * @brief 开始跟踪下一个影子目标，记录朝目标运动的方向
+ */
+void TaskManager::beginProgramTarget(double currentPos)
+{
+    m_programLastPos = currentPos;
+    m_programExtreme = currentPos;
+    m_programDir = 0;
+    if (m_programTargets.isEmpty()) return;
+
+    const double target = m_programTargets.at(m_programTargetIndex);
+    if (!reached(currentPos, target)) {
+        m_programDir = target > currentPos ? 1 : -1;
+    }
+}
+
+/**
+ * @brief 下位机报告程序结束
+ */
+void TaskManager::finishDeviceProgram()
+{
+    LOG_INFO << "下位机程序执行结束，已完成周期: " << m_completedCycles << " / " << m_targetCycles;
+    if (m_targetCycles > 0 && m_completedCycles < m_targetCycles) {
+        // 影子跟踪可能因反馈采样间隔错过最后一个目标，以下位机结果为准
+        m_completedCycles = m_targetCycles;
+        emit progressChanged(m_completedCycles, m_targetCycles);
+    }
+    setState(State::Idle);
+    stopWatchdog();
+    emit message("下位机扫描程序已完成。");
+    emit taskCompleted();
+}
+
 // --- 序列执行相关 ---
 
 void TaskManager::executeNextStep()
@@ -507,14 +1086,13 @@ void TaskManager::executeNextStep()
     m_currentStepIndex++;
     if (m_currentStepIndex >= m_sequenceSteps.size()) {
         // 当前周期完成
-        m_completedCycles++;
-        emit progressChanged(m_completedCycles, m_targetCycles);
+        finishCycle(false);
 
         if (m_targetCycles > 0 && m_completedCycles >= m_targetCycles) {
             // 所有周期完成
             emit requestStop();
             setState(State::Idle);
-            m_watchdog.stop();
+            stopWatchdog();
             emit message("高级任务序列已完成。");
             emit taskCompleted(); // 通知任务完成
             return;
@@ -555,8 +1133,8 @@ void TaskManager::executeStep(const TaskStep &step)
         // 预判：如果已经到位，直接进入下一步，避免原地抖动
         if (reached(m_position, target)) {
              emit message(QString("步骤 %1: 已在目标位置 %2，跳过移动").arg(m_currentStepIndex).arg(target));
-             // 使用 QTimer::singleShot 异步调用下一 步，避免递归过深
-             QTimer::singleShot(0, this, [this](){ executeNextStep(); });
+             // 异步调用下一步，避免递归过深
+             deferNextStep();
              break;
         }
 
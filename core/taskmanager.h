@@ -4,6 +4,8 @@
 #include <QObject>
 #include <QTimer>
 #include "../communication/protocol.h"
+#include "taskclock.h"
+#include "speedmap.h"
 
 /**
  * @brief 自动任务管理器类
@@ -35,7 +37,8 @@ public:
         Stopping,       ///< 正在停止
         Fault,          ///< 故障状态
         StepExecution,  ///< 脚本/配方执行中
-        Resetting       ///< 重置中（回到初始位置）
+        Resetting,      ///< 重置中（回到初始位置）
+        DeviceProgram   ///< 下位机程序执行中（上位机仅监控）
     };
     Q_ENUM(State)
 
@@ -59,8 +62,63 @@ public:
         QString description;
     };
 
+    /**
+     * @brief 任务计划 (由 DetectionTask.task_type/task_config 解析而来)
+     */
+    struct TaskPlan {
+        QString type;                 ///< auto_scan / sequence
+        double minPos = 0.0;          ///< auto_scan: 起点
+        double maxPos = 100.0;        ///< auto_scan: 终点
+        double speed = 20.0;          ///< auto_scan: 扫描速度
+        int cycles = 1;               ///< 循环次数
+        QList<TaskStep> steps;        ///< sequence: 步骤列表
+        bool deviceExecution = false; ///< 是否以下位机程序方式执行
+        bool adaptiveSpeed = false;   ///< auto_scan: 按同一管道上次扫描数据自适应速度
+        double roiSpeed = 5.0;        ///< auto_scan: 重点区域速度
+        QString speedMapFile;         ///< auto_scan: 速度表文件 (优先于自适应推导)
+    };
+
+    /**
+     * @brief 任务执行快照 (用于检查点与崩溃恢复)
+     */
+    struct Snapshot {
+        State state = State::Idle;  ///< 运行状态 (暂停时记录暂停前的状态)
+        int completedCycles = 0;    ///< 已完成周期数
+        int targetCycles = 0;       ///< 目标周期数
+        int stepIndex = -1;         ///< 序列任务当前步骤索引
+        double position = 0.0;      ///< 快照时的位置 (mm)
+    };
+
     explicit TaskManager(QObject* parent = nullptr);
 
+    /**
+     * @brief 解析任务配置 JSON
+     * @param taskType 任务类型 (auto_scan/sequence)
+     * @param configJson 任务配置 JSON
+     * @param plan 输出参数：解析结果
+     * @param error 可选：失败原因
+     * @return true 解析成功
+     */
+    static bool parseTaskPlan(const QString &taskType, const QString &configJson, TaskPlan &plan, QString *error = nullptr);
+
+    /**
+     * @brief 按任务计划启动任务 (自动选择往返扫描/序列、主机驱动/下位机执行)
+     */
+    void startPlan(const TaskPlan &plan);
+
+    /**
+     * @brief 获取当前执行快照
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief 从快照恢复任务
+     * 往返扫描从中断时的周期和方向继续，序列任务从中断的步骤重新执行；
+     * 下位机程序执行的任务以剩余周期数重新下发程序。
+     * @return true 任务已恢复运行
+     */
+    bool resumePlan(const TaskPlan &plan, const Snapshot &snap);
+
     /**
      * @brief 启动高级任务序列 (脚本化控制)
      * @param steps 步骤列表
@@ -78,6 +136,29 @@ public:
      */
     Q_INVOKABLE void startAutoScan(double minPos, double maxPos, double speed, int cycles = 1);
 
+    /**
+     * @brief 以下位机程序方式启动自动往返扫描
+     *
+     * 扫描参数编译为 ScanProgram 整体下发，换向由下位机完成，
+     * 上位机只负责监控进度、超时与中止。参数含义同 startAutoScan。
+     */
+    Q_INVOKABLE void startAutoScanOnDevice(double minPos, double maxPos, double speed, int cycles = 1);
+
+    /**
+     * @brief 以下位机程序方式启动任务序列，参数含义同 startTaskSequence
+     */
+    Q_INVOKABLE void startTaskSequenceOnDevice(const QList<TaskStep> &steps, int cycles = 1);
+
+    /**
+     * @brief 将往返扫描参数编译为下位机程序 (每周期: MoveTo max -> MoveTo min)
+     */
+    static ScanProgram compileAutoScan(double minPos, double maxPos, double speed, int cycles);
+
+    /**
+     * @brief 将任务序列编译为下位机程序
+     */
+    static ScanProgram compileSequence(const QList<TaskStep> &steps, int cycles);
+
     /**
      * @brief 暂停当前任务
      * 发送停止请求，并记录当前状态以便恢复。
@@ -96,12 +177,29 @@ public:
      */
     Q_INVOKABLE void stopAll();
 
+    /**
+     * @brief 安全中止当前任务
+     * 限位/报警/删除任务等非正常停止时调用：进入故障状态并发出 taskFailed，
+     * 由上层据此写入任务结果、清除检查点并结束任务队列。
+     * @param reason 中止原因
+     * @return false 表示当前没有活动任务 (Idle/Fault)
+     */
+    bool abortTask(const QString& reason);
+
     /**
      * @brief 重置任务
      * 只能在暂停状态下调用，重置任务状态并回到初始位置
      */
     Q_INVOKABLE void resetTask();
 
+    /**
+     * @brief 回零 (任务间复位)
+     * 只能在空闲状态下调用，低速移动到指定位置，完成后发出 homingFinished()。
+     * @param position 回零目标位置 (mm)
+     * @param speed 回零速度 (mm/s)
+     */
+    Q_INVOKABLE void home(double position = 0.0, double speed = 20.0);
+
     /**
      * @brief 设置到位判断的容差值
      * @param tol 容差 (mm)，默认 0.2
@@ -117,6 +215,38 @@ public:
     void setEdgeTimeoutMs(int ms);
     int edgeTimeoutMs() const;
 
+    /**
+     * @brief 注入外部时钟 (离线仿真用)
+     *
+     * 设置后所有计时基于该时钟，实时看门狗定时器不再启动，
+     * 需由调用方周期性调用 tick() 推进。传入 nullptr 恢复系统时钟。
+     * 时钟对象的生命周期由调用方管理。
+     */
+    void setClock(TaskClock *clock);
+
+    /**
+     * @brief 外部时钟模式下推进内部定时逻辑 (看门狗/延迟步骤)
+     */
+    void tick();
+
+    /**
+     * @brief 设置往返扫描的速度表 (对之后启动的主机驱动往返扫描生效)
+     * 运行中每帧按当前位置查表，速度变化时发出 requestSetSpeed()。
+     */
+    void setSpeedMap(const SpeedMap &map);
+
+    /**
+     * @brief 清除速度表，恢复恒速扫描
+     */
+    void clearSpeedMap();
+
+    bool hasSpeedMap() const { return m_useSpeedMap; }
+
+    /**
+     * @brief 是否输出逐毫米的位置日志 (离线仿真时关闭)
+     */
+    void setPositionLogging(bool enabled);
+
     State state() const { return m_state; }
     
     /**
@@ -131,6 +261,10 @@ signals:
     void requestMoveForward(double speed);
     void requestMoveBackward(double speed);
     void requestStop();
+    void requestSetSpeed(double speed);
+    void requestUploadProgram(const ScanProgram &program);
+    void requestRunProgram();
+    void requestAbortProgram();
 
     // --- 向上层发送的状态反馈 ---
     
@@ -140,6 +274,15 @@ signals:
     void fault(const QString& reason);
     void taskCompleted(); // 任务完成信号
     void taskFailed(const QString& reason); // 任务失败信号
+    void homingFinished(); // 回零/重置到位信号
+
+    /**
+     * @brief 单个周期耗时统计，用于对比上位机驱动与下位机驱动的周期时间
+     * @param cycle 周期序号 (从 1 开始)
+     * @param elapsedMs 本周期耗时
+     * @param deviceDriven true 表示下位机程序执行
+     */
+    void cycleTimeMeasured(int cycle, qint64 elapsedMs, bool deviceDriven);
 
 public slots:
     /**
@@ -166,11 +309,27 @@ private:
     void setState(State s);
     void enterFault(const QString& reason);
 
+    qint64 nowMs() const;
+    void startWatchdog();
+    void stopWatchdog();
+    void deferNextStep();
+
     void startMovingToMax();
     void startMovingToMin();
 
+    bool validateAutoScan(double minPos, double maxPos, double speed);
+    void finishCycle(bool deviceDriven);
+
+    // --- 下位机程序相关 ---
+    void startDeviceProgram(const ScanProgram &program);
+    void trackDeviceProgram(double currentPos);
+    void beginProgramTarget(double currentPos);
+    void finishDeviceProgram();
+
     // 判断是否到达目标位置 (在容差范围内)
     bool reached(double pos, double target) const;
+    double scanSpeedAt(double pos, int direction) const;
+    void applySpeedMap();
 
     // --- 序列执行相关 ---
     void executeNextStep();
@@ -186,6 +345,11 @@ private:
     double  m_maxPos {0.0};
     double  m_speed  {1.0};
 
+    // 速度表 (自适应扫描)
+    SpeedMap m_speedMap;
+    bool    m_useSpeedMap {false};
+    double  m_commandedSpeed {0.0}; // 最近一次下发的速度
+
     // 通用参数
     int     m_targetCycles {1};   // <=0 infinite
     int     m_completedCycles {0};
@@ -202,6 +366,26 @@ private:
     double  m_tol {0.2};          // 到位容差
     double  m_resetTargetPos {0.0}; // 重置目标位置
     
+    // 下位机程序监控参数：按 MoveTo 目标顺序影子跟踪程序进度
+    QVector<double> m_programTargets;
+    qint64  m_programMaxWaitMs {0};   // 程序中最长的连续 Wait，静止期间不计入超时
+    int     m_programTargetIndex {0};
+    bool    m_programSeenActive {false};
+    double  m_programLastPos {0.0};   // 上一个反馈位置，用于判断采样间隔内越过目标
+    double  m_programExtreme {0.0};   // 朝当前目标运动的最远位置，用于判断换向
+    int     m_programDir {0};         // 朝当前目标的运动方向 (1/-1，0 表示已在目标处)
+    double  m_programMotionPos {0.0}; // 上次喂看门狗时的位置
+
+    qint64  m_cycleStartMs {0};
+
+    // 时钟：nullptr 表示系统时钟 + 实时看门狗
+    TaskClock *m_clock {nullptr};
+    bool    m_watchdogActive {false};
+    bool    m_deferredNextStep {false};
+
+    bool    m_logPositions {true};
+    double  m_lastLoggedPos {-999.0};
+
     // 超时检测相关
     QTimer  m_watchdog;
     qint64  m_motionStartMs {0};
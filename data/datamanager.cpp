@@ -1,18 +1,120 @@
 #include "datamanager.h"
 #include "../utils/logger.h"
 #include "../core/configmanager.h"
+#include "sqliteconfig.h"
 #include <QStandardPaths>
 #include <QDir>
 #include <QUuid>
 #include <QThread>
+#include <QTimer>
+#include <QFileInfo>
+#include <QCoreApplication>
+#include <QRegularExpression>
+#include <limits>
+
+static const int kMotionLogSchemaVersion = 1;
+
+// 历史任务统计每批补算的时间预算 (ms)，两批之间数据库线程处理其他请求
+static const int kBackfillBatchMs = 50;
+
+namespace {
+
+/**
+ * @brief 统计 UI 线程在作用域内的耗时 (其他线程中调用时不计)
+ */
+class UiBlockScope
+{
+public:
+    explicit UiBlockScope(DataManager::BlockingStats &stats)
+        : m_stats(stats)
+        , m_active(QCoreApplication::instance()
+                   && QThread::currentThread() == QCoreApplication::instance()->thread())
+    {
+        if (m_active) m_timer.start();
+    }
+
+    ~UiBlockScope()
+    {
+        if (!m_active) return;
+        const double ms = m_timer.nsecsElapsed() / 1e6;
+        ++m_stats.calls;
+        m_stats.totalMs += ms;
+        m_stats.maxMs = qMax(m_stats.maxMs, ms);
+    }
+
+private:
+    DataManager::BlockingStats &m_stats;
+    bool m_active;
+    QElapsedTimer m_timer;
+};
+
+/**
+ * @brief 检索词转为 FTS5 短语 (引号包围、内部引号加倍)，不会被解析为查询语法
+ */
+QString ftsPhrase(const QString &term)
+{
+    return QString("\"%1\"").arg(QString(term).replace('"', "\"\""));
+}
+
+/**
+ * @brief 检索词转为子串匹配的 LIKE 模式 (反斜杠转义，配合 ESCAPE 子句)
+ */
+QString likePattern(const QString &term)
+{
+    QString escaped = term;
+    escaped.replace('\\', "\\\\").replace('%', "\\%").replace('_', "\\_");
+    return QString("%%1%").arg(escaped);
+}
+
+} // namespace
 
 DataManager::DataManager(QObject *parent) : QObject(parent)
 {
     m_dbPath = "EddyPusher.db"; // 默认路径
+    m_clockBaseUs = QDateTime::currentMSecsSinceEpoch() * 1000;
+    m_monoClock.start();
 }
 
 DataManager::~DataManager()
 {
+    // 等待已提交的异步操作执行完，再在数据库线程中关闭其连接
+    if (m_dbContext) {
+        QMetaObject::invokeMethod(m_dbContext, [this]() {
+            const QString connName = getConnectionName();
+            if (QSqlDatabase::contains(connName)) {
+                QSqlDatabase::database(connName, false).close();
+                QSqlDatabase::removeDatabase(connName);
+            }
+        }, Qt::BlockingQueuedConnection);
+        m_dbThread.quit();
+        m_dbThread.wait();
+        delete m_dbContext;
+        m_dbContext = nullptr;
+    }
+    if (m_uiBlocking.calls > 0) {
+        LOG_INFO << "UI 线程任务数据库调用: " << m_uiBlocking.calls << " 次, 合计 "
+                 << m_uiBlocking.totalMs << " ms, 最长 " << m_uiBlocking.maxMs << " ms";
+    }
+
+    // 先停止写入线程，确保队列中的日志全部落盘
+    if (m_logWriter) {
+        if (m_writerThread.isRunning()) {
+            QMetaObject::invokeMethod(m_logWriter, "stop", Qt::BlockingQueuedConnection);
+            QMetaObject::invokeMethod(m_logWriter, "deleteLater", Qt::BlockingQueuedConnection);
+        } else {
+            delete m_logWriter;
+        }
+        m_logWriter = nullptr;
+    }
+    m_writerThread.quit();
+    m_writerThread.wait();
+
+    const QString readName = readConnectionName();
+    if (QSqlDatabase::contains(readName)) {
+        QSqlDatabase::database(readName, false).close();
+        QSqlDatabase::removeDatabase(readName);
+    }
+
     // 在析构时移除当前线程的数据库连接
     QString connName = getConnectionName();
     if (QSqlDatabase::contains(connName)) {
@@ -25,6 +127,65 @@ QString DataManager::connectionName() const
     return getConnectionName();
 }
 
+QString DataManager::readConnectionName() const
+{
+    return QString("ReadOnly_%1").arg((quint64)QThread::currentThreadId());
+}
+
+bool DataManager::openReadConnection()
+{
+    const QString readName = readConnectionName();
+    QSqlDatabase db;
+    if (QSqlDatabase::contains(readName)) {
+        db = QSqlDatabase::database(readName, false);
+    } else {
+        db = QSqlDatabase::addDatabase("QSQLITE", readName);
+        db.setDatabaseName(m_dbPath);
+        SqliteConfig::prepare(db, SqliteConfig::Role::ReadOnly);
+    }
+    if (!db.isOpen() && !db.open()) {
+        LOG_ERR << "只读数据库连接打开失败：" << db.lastError().text();
+        return false;
+    }
+    SqliteConfig::applyPragmas(db, SqliteConfig::Role::ReadOnly);
+    return true;
+}
+
+bool DataManager::openDbThreadConnection()
+{
+    const QString connName = getConnectionName();
+    QSqlDatabase db;
+    if (QSqlDatabase::contains(connName)) {
+        db = QSqlDatabase::database(connName, false);
+    } else {
+        db = QSqlDatabase::addDatabase("QSQLITE", connName);
+        db.setDatabaseName(m_dbPath);
+        SqliteConfig::prepare(db, SqliteConfig::Role::Primary);
+    }
+    if (db.isOpen()) return true;
+    if (!db.open()) {
+        LOG_ERR << "数据库线程连接打开失败：" << db.lastError().text();
+        return false;
+    }
+    SqliteConfig::applyPragmas(db, SqliteConfig::Role::Primary);
+    return true;
+}
+
+/**
+ * @brief 当前时间 (微秒，UTC)
+ * 以初始化时的系统时间为基准，叠加单调时钟的增量，
+ * 保证同一毫秒内的多帧数据时间戳仍然有序。
+ */
+qint64 DataManager::nowUs() const
+{
+    return m_clockBaseUs + m_monoClock.nsecsElapsed() / 1000;
+}
+
+MotionLogWriter::Stats DataManager::motionLogStats() const
+{
+    return m_logWriter ? m_logWriter->stats() : MotionLogWriter::Stats();
+}
+
 /**
  * @brief 获取线程特定的数据库连接名称
  * 
@@ -37,6 +198,29 @@ QString DataManager::getConnectionName() const
     return QString("Connection_%1").arg((quint64)QThread::currentThreadId());
 }
 
+bool DataManager::openReadOnly()
+{
+    const QString connName = getConnectionName();
+    m_dbPath = ConfigManager::instance().dataStoragePath() + "/EddyPusher.db";
+    if (!QFileInfo::exists(m_dbPath)) {
+        LOG_ERR << "数据库不存在：" << m_dbPath;
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::contains(connName)
+        ? QSqlDatabase::database(connName, false)
+        : QSqlDatabase::addDatabase("QSQLITE", connName);
+    db.setDatabaseName(m_dbPath);
+    SqliteConfig::prepare(db, SqliteConfig::Role::ReadOnly);
+    if (!db.open()) {
+        LOG_ERR << "数据库只读打开失败：" << db.lastError().text();
+        return false;
+    }
+    SqliteConfig::applyPragmas(db, SqliteConfig::Role::ReadOnly);
+    LOG_INFO << "数据库已只读打开: " << m_dbPath;
+    return true;
+}
+
 /**
  * @brief 初始化数据库
  * 
@@ -63,6 +247,7 @@ bool DataManager::initDatabase()
         LOG_INFO << "创建新的数据库连接";
         db = QSqlDatabase::addDatabase("QSQLITE", connName);
         db.setDatabaseName(m_dbPath);
+        SqliteConfig::prepare(db, SqliteConfig::Role::Primary);
     }
 
     if (!db.open()) {
@@ -70,6 +255,8 @@ bool DataManager::initDatabase()
         return false;
     }
     LOG_INFO << "数据库打开成功";
+    SqliteConfig::applyPragmas(db, SqliteConfig::Role::Primary);
+    SqliteConfig::ensureIncrementalVacuum(db);
 
     QSqlQuery query(db);
     
@@ -96,6 +283,8 @@ bool DataManager::initDatabase()
     bool hasTaskConfig = false;
     bool hasExecutionResult = false;
     bool hasCompletionTime = false;
+    bool hasSampleFile = false;
+    bool hasOrigin = false;
     
     if (query.exec("PRAGMA table_info(DetectionTask)")) {
         while (query.next()) {
@@ -105,6 +294,8 @@ bool DataManager::initDatabase()
             else if (fieldName == "task_config") hasTaskConfig = true;
             else if (fieldName == "execution_result") hasExecutionResult = true;
             else if (fieldName == "completion_time") hasCompletionTime = true;
+            else if (fieldName == "sample_file") hasSampleFile = true;
+            else if (fieldName == "origin") hasOrigin = true;
         }
     }
 
@@ -139,111 +330,355 @@ bool DataManager::initDatabase()
             LOG_ERR << "新增完成时间列失败：" << alterQuery.lastError().text();
         }
     }
+    if (!hasSampleFile) {
+        QSqlQuery alterQuery(db);
+        if (!alterQuery.exec("ALTER TABLE DetectionTask ADD COLUMN sample_file TEXT")) {  // 列式采样文件 (相对数据目录)
+            LOG_ERR << "新增采样文件列失败：" << alterQuery.lastError().text();
+        }
+    }
+    if (!hasOrigin) {
+        QSqlQuery alterQuery(db);
+        if (!alterQuery.exec("ALTER TABLE DetectionTask ADD COLUMN origin TEXT")) {  // 导入任务的来源 (工位/原任务ID)
+            LOG_ERR << "新增任务来源列失败：" << alterQuery.lastError().text();
+        }
+    }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_task_origin ON DetectionTask(origin)")) {
+        LOG_ERR << "创建任务来源索引失败：" << query.lastError().text();
+    }
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_task_start ON DetectionTask(start_time)")) {
+        LOG_ERR << "创建任务时间索引失败：" << query.lastError().text();
+    }
+
+    // 任务全文索引：管道编号/操作员/结果信息的子串检索
+    m_hasTaskSearch = ensureTaskSearch(db);
+
+    // 表2: 运动日志表 - 存储高频的运动状态数据 (按版本迁移)
+    LOG_INFO << "创建/检查 MotionLog 表";
+    success = migrateMotionLog(db) && success;
+
+    // 表3: 降采样金字塔 - 按 100 ms / 1 s 时间桶统计位置、速度，供长时间曲线绘制
+    if (!query.exec("CREATE TABLE IF NOT EXISTS MotionRollup ("
+                    "task_id INTEGER NOT NULL, "
+                    "level INTEGER NOT NULL, "
+                    "bucket INTEGER NOT NULL, "     // t / 桶宽
+                    "n INTEGER, "
+                    "pos_min REAL, pos_max REAL, pos_sum REAL, "
+                    "spd_min REAL, spd_max REAL, spd_sum REAL, "
+                    "PRIMARY KEY (task_id, level, bucket)) WITHOUT ROWID")) {
+        LOG_ERR << "创建 MotionRollup 表失败：" << query.lastError().text();
+    }
+
+    // 表4: 任务统计 - 写入线程随批量提交增量更新 (Welford 速度均值/方差)，任务列表直接读取
+    if (!query.exec("CREATE TABLE IF NOT EXISTS TaskStats ("
+                    "task_id INTEGER PRIMARY KEY, "
+                    "t_first INTEGER, t_last INTEGER, samples INTEGER, "
+                    "distance REAL, max_speed REAL, "
+                    "speed_mean REAL, speed_m2 REAL, speed_std REAL, "
+                    "reversals INTEGER, faults INTEGER, "
+                    "last_pos REAL, anchor_pos REAL, direction INTEGER, last_status INTEGER)")) {
+        LOG_ERR << "创建 TaskStats 表失败：" << query.lastError().text();
+    }
+
+    // 任务列表视图：任务元数据 + 统计，供 UI 模型使用
+    if (!query.exec("DROP VIEW IF EXISTS TaskListView")
+        || !query.exec("CREATE VIEW TaskListView AS SELECT d.*, "
+                       "s.samples AS sample_count, "
+                       "round((s.t_last - s.t_first) / 1e6, 1) AS duration_s, "
+                       "round(s.distance, 1) AS distance_mm, "
+                       "round(s.max_speed, 1) AS max_speed, "
+                       "round(s.speed_mean, 1) AS mean_speed, "
+                       "round(s.speed_std, 2) AS speed_std, "
+                       "s.reversals AS reversals, "
+                       "s.faults AS faults "
+                       "FROM DetectionTask d LEFT JOIN TaskStats s ON s.task_id = d.id")) {
+        LOG_ERR << "创建 TaskListView 视图失败：" << query.lastError().text();
+    }
 
     if (!query.exec("UPDATE DetectionTask SET status = 'stop' "
                     "WHERE (status IS NULL OR status = '') "
-                    "AND id IN (SELECT DISTINCT task_id FROM MotionLog WHERE task_id IS NOT NULL)")) {
+                    "AND (id IN (SELECT DISTINCT task_id FROM MotionLog WHERE task_id > 0) "
+                    "OR sample_file IS NOT NULL)")) {
         LOG_ERR << "修正任务状态失败：" << query.lastError().text();
     }
     if (!query.exec("UPDATE DetectionTask SET status = 'create' "
                     "WHERE (status IS NULL OR status = '') "
-                    "AND id NOT IN (SELECT DISTINCT task_id FROM MotionLog WHERE task_id IS NOT NULL)")) {
+                    "AND id NOT IN (SELECT DISTINCT task_id FROM MotionLog WHERE task_id > 0) "
+                    "AND sample_file IS NULL")) {
         LOG_ERR << "修正任务状态失败：" << query.lastError().text();
     }
 
-    // 表2: 运动日志表 - 存储高频的运动状态数据
-    // 注意：在实际高频写入场景中，可能需要考虑分表或定期归档
-    LOG_INFO << "创建/检查 MotionLog 表";
-    success = query.exec("CREATE TABLE IF NOT EXISTS MotionLog ("
-                         "id INTEGER PRIMARY KEY AUTOINCREMENT, "
-                         "task_id INTEGER, "
-                         "timestamp DATETIME, "
-                         "position REAL, "
-                         "speed REAL, "
-                         "status INTEGER)");
-                         
-    if (!success) {
-        LOG_ERR << "创建日志失败：" << query.lastError().text();
-    } else {
-        LOG_INFO << "MotionLog 表就绪";
+    // 只读连接：供 UI 模型与导出使用，WAL 模式下读取不阻塞写入
+    if (success) {
+        openReadConnection();
     }
 
-    // 初始化完成后，执行一次数据清理 (自动维护策略)
-    LOG_INFO << "执行数据清理 (保留最近30天数据)";
-    cleanupOldData(30);
+    // 启动运动日志写入线程 (独立连接，批量事务写入)
+    if (success && !m_logWriter) {
+        m_logWriter = new MotionLogWriter(m_dbPath);
+        if (ConfigManager::instance().motionLogEngine() == "columnar") {
+            m_logWriter->setEngine(MotionLogWriter::Engine::Columnar, dataDir);
+        }
+        m_logWriter->moveToThread(&m_writerThread);
+        m_lastDroppedRows = 0;
+        connect(m_logWriter, &MotionLogWriter::statsUpdated, this, [this](const MotionLogWriter::Stats &stats){
+            // 积压或丢弃说明写入跟不上采集速率
+            if (stats.backlog > 1000 || stats.rowsDropped > m_lastDroppedRows) {
+                LOG_WARN << "运动日志写入积压: " << stats.backlog << " 行, 累计丢弃 " << stats.rowsDropped
+                         << " 行, 写入速率 " << stats.insertRate << " 行/秒, 最近提交耗时 " << stats.lastCommitMs << " ms";
+                m_lastDroppedRows = stats.rowsDropped;
+            }
+        });
+        connect(m_logWriter, &MotionLogWriter::samplesAppended, this, [this](int taskId, qint64 samples){
+            notifyTaskChange(TaskChange::SamplesAppended, {taskId}, samples);
+        });
+        connect(m_logWriter, &MotionLogWriter::sampleFileRegistered, this, [this](int taskId){
+            notifyTaskChange(TaskChange::Updated, {taskId});
+        });
+        connect(m_logWriter, &MotionLogWriter::retentionFinished, this, [this](const RetentionJob::Progress &progress){
+            if (progress.freelistPages > 0) {
+                LOG_INFO << "数据清理后仍有 " << progress.freelistPages << " 个空闲页 (下次清理时继续回收)";
+            }
+            // 归档登记了 sample_file 的任务需刷新，已删除的任务从界面移除
+            if (!progress.archivedTaskIds.isEmpty()) {
+                notifyTaskChange(TaskChange::Updated, progress.archivedTaskIds);
+            }
+            if (!progress.deletedTaskIds.isEmpty()) {
+                notifyTaskChange(TaskChange::Deleted, progress.deletedTaskIds);
+            }
+        });
+        m_writerThread.setObjectName("MotionLogWriter");
+        m_writerThread.start();
+        QMetaObject::invokeMethod(m_logWriter, "start", Qt::QueuedConnection);
+    }
+
+    // 启动数据库线程 (任务增删改查的异步接口在此执行)
+    if (success && !m_dbContext) {
+        m_dbContext = new QObject();
+        m_dbContext->moveToThread(&m_dbThread);
+        m_dbThread.setObjectName("DataManagerDb");
+        m_dbThread.start();
+    }
+
+    // 历史任务的统计在数据库线程中分批补算，每批完成后通知界面刷新对应行
+    if (success) {
+        runOnDbThread([this]() { return backfillTaskStats(); });
+    }
+
+    // 数据清理在写入线程中分步执行，不阻塞启动；之后每 6 小时执行一次
+    if (m_logWriter) {
+        const int logDays = ConfigManager::instance().motionLogRetentionDays();
+        LOG_INFO << "提交数据清理 (MotionLog 保留最近" << logDays << "天数据)";
+        cleanupOldData(logDays);
+
+        QTimer *retentionTimer = new QTimer(this);
+        retentionTimer->setInterval(6 * 60 * 60 * 1000);
+        connect(retentionTimer, &QTimer::timeout, this, [this]() {
+            cleanupOldData(ConfigManager::instance().motionLogRetentionDays());
+        });
+        retentionTimer->start();
+    }
 
     LOG_INFO << "数据库初始化完成";
     return success;
 }
 
 /**
- * @brief 自动清理旧数据
- * 删除 MotionLog 和 DetectionTask 表中超过指定天数的数据，
- * 防止数据库文件无限增长。
+ * @brief MotionLog 表结构迁移 (版本号记录在 PRAGMA user_version)
+ *
+ * v0: id 自增主键 + DATETIME 文本时间戳，无索引，按任务/时间查询均为全表扫描。
+ * v1: WITHOUT ROWID 表，主键 (task_id, t) 使同一任务的数据按时间聚簇存放；
+ *     t 为 int64 微秒时间戳 (UTC)，另建 t 索引供按时间清理；
+ *     无任务的数据 task_id 记为 0。
+ *     MotionLogView 视图把 t 转回本地时间文本，供界面显示与导出。
  */
-void DataManager::cleanupOldData(int daysToKeep)
+bool DataManager::migrateMotionLog(QSqlDatabase &db)
 {
-    QString connName = getConnectionName();
-    QSqlDatabase db = QSqlDatabase::database(connName);
-    if (!db.isOpen()) return;
+    QSqlQuery query(db);
+    int version = 0;
+    if (query.exec("PRAGMA user_version") && query.next()) {
+        version = query.value(0).toInt();
+    }
+    if (version >= kMotionLogSchemaVersion) {
+        LOG_INFO << "MotionLog 表就绪 (schema v" << version << ")";
+        return true;
+    }
+
+    bool hasLegacyTable = false;
+    if (query.exec("PRAGMA table_info(MotionLog)")) {
+        while (query.next()) {
+            if (query.value("name").toString() == "id") hasLegacyTable = true;
+        }
+    }
+
+    LOG_INFO << "MotionLog 表迁移: v" << version << " -> v" << kMotionLogSchemaVersion
+             << (hasLegacyTable ? " (转换已有数据)" : "");
+
+    db.transaction();
+    auto fail = [&db, &query](const char *step) {
+        LOG_ERR << "MotionLog 迁移失败 (" << step << "): " << query.lastError().text();
+        db.rollback();
+        return false;
+    };
+
+    if (!query.exec("CREATE TABLE MotionLog_v1 ("
+                    "task_id INTEGER NOT NULL, "
+                    "t INTEGER NOT NULL, "       // 微秒时间戳 (UTC)
+                    "position REAL, "
+                    "speed REAL, "
+                    "status INTEGER, "
+                    "PRIMARY KEY (task_id, t)) WITHOUT ROWID")) {
+        return fail("create");
+    }
+
+    if (hasLegacyTable) {
+        // 旧时间戳为本地时间文本，精度到毫秒；同一毫秒内的多条记录用 id 区分微秒位，保持写入顺序
+        if (!query.exec("INSERT OR IGNORE INTO MotionLog_v1 (task_id, t, position, speed, status) "
+                        "SELECT COALESCE(task_id, 0), "
+                        "CAST(round((julianday(timestamp, 'utc') - 2440587.5) * 86400000.0) AS INTEGER) * 1000 + (id % 1000), "
+                        "position, speed, status FROM MotionLog WHERE timestamp IS NOT NULL")) {
+            return fail("copy");
+        }
+        LOG_INFO << "MotionLog 迁移数据: " << query.numRowsAffected() << " 行";
+        if (!query.exec("DROP TABLE MotionLog")) {
+            return fail("drop");
+        }
+    }
+
+    if (!query.exec("ALTER TABLE MotionLog_v1 RENAME TO MotionLog")
+        || !query.exec("CREATE INDEX IF NOT EXISTS idx_motionlog_t ON MotionLog(t)")
+        || !query.exec("DROP VIEW IF EXISTS MotionLogView")
+        || !query.exec("CREATE VIEW MotionLogView AS SELECT task_id, "
+                       "strftime('%Y-%m-%d %H:%M:%f', t / 1000000.0, 'unixepoch', 'localtime') AS timestamp, "
+                       "position, speed, status, t FROM MotionLog")) {
+        return fail("index/view");
+    }
+
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(kMotionLogSchemaVersion))) {
+        return fail("version");
+    }
+    if (!db.commit()) {
+        LOG_ERR << "MotionLog 迁移提交失败: " << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    LOG_INFO << "MotionLog 表就绪 (schema v" << kMotionLogSchemaVersion << ")";
+    return true;
+}
+
+/**
+ * @brief 任务全文索引 (FTS5，trigram 分词)
+ *
+ * rowid 即任务ID；message 取自 execution_result 的 $.message。
+ * 触发器随 DetectionTask 的增删改同步，批量创建/删除、归档导入、数据清理都无需额外处理。
+ */
+bool DataManager::ensureTaskSearch(QSqlDatabase &db)
+{
+    static const QString kMessage =
+        "CASE WHEN json_valid(new.execution_result) THEN json_extract(new.execution_result, '$.message') END";
 
     QSqlQuery query(db);
-    
-    // 计算截止时间点
-    QDateTime cutoffTime = QDateTime::currentDateTime().addDays(-daysToKeep);
-    
-    // 1. 清理运动日志 (MotionLog)
-    query.prepare("DELETE FROM MotionLog WHERE timestamp < :cutoff");
-    query.bindValue(":cutoff", cutoffTime);
-    if (query.exec()) {
-        int deleted = query.numRowsAffected();
-        if (deleted > 0) {
-            LOG_INFO << "自动清理: 已删除" << deleted << "条过期的运动日志 (超过" << daysToKeep << "天)";
+    const bool exists = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'TaskSearch'")
+                        && query.next();
+    if (!exists && !query.exec("CREATE VIRTUAL TABLE TaskSearch USING fts5("
+                               "tube_id, operator_name, message, tokenize = 'trigram')")) {
+        LOG_WARN << "SQLite 不支持 FTS5 trigram，任务检索使用 LIKE 扫描：" << query.lastError().text();
+        return false;
+    }
+
+    const QStringList triggers = {
+        QString("CREATE TRIGGER IF NOT EXISTS TaskSearch_ai AFTER INSERT ON DetectionTask BEGIN "
+                "INSERT INTO TaskSearch (rowid, tube_id, operator_name, message) "
+                "VALUES (new.id, new.tube_id, new.operator_name, %1); END").arg(kMessage),
+        QString("CREATE TRIGGER IF NOT EXISTS TaskSearch_au AFTER UPDATE OF tube_id, operator_name, execution_result "
+                "ON DetectionTask BEGIN "
+                "UPDATE TaskSearch SET tube_id = new.tube_id, operator_name = new.operator_name, message = %1 "
+                "WHERE rowid = new.id; END").arg(kMessage),
+        QString("CREATE TRIGGER IF NOT EXISTS TaskSearch_ad AFTER DELETE ON DetectionTask BEGIN "
+                "DELETE FROM TaskSearch WHERE rowid = old.id; END")
+    };
+    for (const QString &sql : triggers) {
+        if (!query.exec(sql)) {
+            LOG_ERR << "创建 TaskSearch 触发器失败：" << query.lastError().text();
+            return false;
         }
-    } else {
-        LOG_ERR << "清理 MotionLog 失败:" << query.lastError().text();
     }
 
-    // 2. 清理任务记录 (DetectionTask)
-    query.prepare("DELETE FROM DetectionTask WHERE start_time < :cutoff");
-    query.bindValue(":cutoff", cutoffTime);
-    if (query.exec()) {
-        int deleted = query.numRowsAffected();
-        if (deleted > 0) {
-            LOG_INFO << "自动清理: 已删除" << deleted << "条过期的任务记录";
+    if (!exists) {
+        QElapsedTimer timer;
+        timer.start();
+        QString fill = "INSERT INTO TaskSearch (rowid, tube_id, operator_name, message) "
+                       "SELECT id, tube_id, operator_name, " + QString(kMessage).replace("new.", "") +
+                       " FROM DetectionTask";
+        if (!query.exec(fill)) {
+            LOG_ERR << "填充 TaskSearch 失败：" << query.lastError().text();
+            return false;
         }
-    } else {
-        LOG_ERR << "清理 DetectionTask 失败:" << query.lastError().text();
+        LOG_INFO << "建立任务全文索引: " << query.numRowsAffected() << " 个任务, 耗时 " << timer.elapsed() << " ms";
     }
-    
-    // 3. 执行 VACUUM 释放磁盘空间 (可选，操作较重，建议在空闲时执行)
-    // query.exec("VACUUM");
+    return true;
+}
+
+/**
+ * @brief 自动清理旧数据
+ *
+ * 清理由日志写入线程中的 RetentionJob 分步执行，本函数只提交策略并立即返回：
+ * 过期任务日志先归档为压缩采样文件再删除，各表按 ConfigManager 中的保留天数清理，
+ * 最后通过 incremental_vacuum 逐步归还空闲页。进度见 motionLogStats().retention。
+ */
+void DataManager::cleanupOldData(int daysToKeep)
+{
+    if (!m_logWriter || !m_writerThread.isRunning()) {
+        LOG_WARN << "日志写入线程未运行，跳过数据清理";
+        return;
+    }
+
+    auto &cfg = ConfigManager::instance();
+    RetentionJob::Policy policy;
+    policy.dataDir = cfg.dataStoragePath();
+    policy.motionLogDays = daysToKeep;
+    policy.taskDays = cfg.taskRetentionDays();
+    policy.archiveDays = cfg.archiveRetentionDays();
+    m_logWriter->setRetentionPolicy(policy);
+    QMetaObject::invokeMethod(m_logWriter, "startRetention", Qt::QueuedConnection);
 }
 
 /**
  * @brief 记录单条运动数据
  * 
  * 将当前的时间戳、位置、速度和状态写入 MotionLog 表。
+ * 只能由同一个线程调用 (写入队列为单生产者)。
  */
 void DataManager::logMotionData(const MotionFeedback &fb, int taskId)
 {
-    // 注意：实际生产中如果数据频率很高（例如 > 100Hz），
-    // 建议使用事务 (Transaction) 进行批量插入，或者先写入内存队列，由单独线程批量刷入数据库。
-    // 这里演示简单的单条插入模式。
-    
+    if (taskId > 0) m_lastLoggedTaskId.store(taskId, std::memory_order_relaxed);
+
+    // 正常情况下放入无锁队列，由写入线程批量提交，调用方不等待磁盘 I/O
+    if (m_logWriter && m_logWriter->isRunning()) {
+        MotionLogWriter::Record record;
+        record.timestampUs = nowUs();
+        record.position = fb.position_mm;
+        record.speed = fb.speed_mm_s;
+        record.status = static_cast<int>(fb.status);
+        record.taskId = taskId;
+        m_logWriter->enqueue(record);
+        return;
+    }
+
+    // 写入线程未就绪时退回单条插入
     QString connName = getConnectionName();
     QSqlDatabase db = QSqlDatabase::database(connName);
     
     if (!db.isOpen()) return;
 
     QSqlQuery query(db);
-    query.prepare("INSERT INTO MotionLog (timestamp, position, speed, status, task_id) "
-                  "VALUES (:time, :pos, :spd, :stat, :tid)");
-    query.bindValue(":time", QDateTime::currentDateTime());
+    query.prepare("INSERT OR IGNORE INTO MotionLog (task_id, t, position, speed, status) "
+                  "VALUES (:tid, :t, :pos, :spd, :stat)");
+    query.bindValue(":tid", taskId == -1 ? 0 : taskId);
+    query.bindValue(":t", nowUs());
     query.bindValue(":pos", fb.position_mm);
     query.bindValue(":spd", fb.speed_mm_s);
     query.bindValue(":stat", static_cast<int>(fb.status));
-    query.bindValue(":tid", taskId == -1 ? QVariant() : taskId);
     
     if (!query.exec()) {
         // 记录错误，但避免日志泛滥
@@ -258,6 +693,7 @@ void DataManager::logMotionData(const MotionFeedback &fb, int taskId)
  */
 int DataManager::createDetectionTask(const QString &operatorName, const QString &tubeId)
 {
+    UiBlockScope block(m_uiBlocking);
     LOG_INFO << "========== 创建检测任务 ==========";
     LOG_INFO << "操作员: " << operatorName << ", 管号: " << tubeId;
     
@@ -275,6 +711,7 @@ int DataManager::createDetectionTask(const QString &operatorName, const QString
     if (query.exec()) {
         int taskId = query.lastInsertId().toInt();
         LOG_INFO << "任务创建成功，ID: " << taskId;
+        notifyTaskChange(TaskChange::Inserted, {taskId});
         return taskId;
     }
     LOG_ERR << "任务创建失败: " << query.lastError().text();
@@ -283,6 +720,7 @@ int DataManager::createDetectionTask(const QString &operatorName, const QString
 
 bool DataManager::updateDetectionTaskStatus(int taskId, const QString &status)
 {
+    UiBlockScope block(m_uiBlocking);
     if (taskId <= 0) return false;
 
     LOG_INFO << "更新任务状态 - ID: " << taskId << ", 新状态: " << status;
@@ -300,6 +738,7 @@ bool DataManager::updateDetectionTaskStatus(int taskId, const QString &status)
         return false;
     }
     LOG_INFO << "任务状态更新成功";
+    notifyTaskChange(TaskChange::Updated, {taskId});
     return true;
 }
 
@@ -307,29 +746,358 @@ bool DataManager::deleteDetectionTask(int taskId)
 {
     if (taskId <= 0) return false;
 
-    QString connName = getConnectionName();
-    QSqlDatabase db = QSqlDatabase::database(connName);
-    if (!db.isOpen()) return false;
+    // 与批量删除同一路径：单个事务，提交后再删除采样文件
+    const BulkResult result = deleteDetectionTasks({taskId});
+    return result.ok && result.taskIds.contains(taskId);
+}
+
+/**
+ * @brief 通知写入线程关闭并丢弃即将删除的任务
+ * 写完队列中已有的记录后关闭采样文件、丢弃统计与降采样状态，
+ * 避免删除后写入线程重新写回 TaskStats/MotionRollup 或继续写已删除的文件。
+ */
+void DataManager::forgetTasksInWriter(const QList<int> &taskIds)
+{
+    if (!m_logWriter || !m_logWriter->isRunning()) return;
+
+    MotionLogWriter *writer = m_logWriter;
+    QMetaObject::invokeMethod(writer, [writer, taskIds]() {
+        writer->forgetTasks(taskIds);
+    }, Qt::BlockingQueuedConnection);
+}
+
+DataManager::BulkResult DataManager::deleteDetectionTasks(const QList<int> &taskIds)
+{
+    UiBlockScope block(m_uiBlocking);
+    BulkResult result;
+    if (taskIds.isEmpty()) {
+        result.ok = true;
+        return result;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) {
+        result.error = "数据库未打开";
+        return result;
+    }
+
+    forgetTasksInWriter(taskIds);
 
     QSqlQuery query(db);
-    query.prepare("DELETE FROM MotionLog WHERE task_id = :tid");
-    query.bindValue(":tid", taskId);
-    if (!query.exec()) {
-        LOG_ERR << "删除 MotionLog 失败:" << query.lastError().text();
-        return false;
+    if (!query.exec("CREATE TEMP TABLE IF NOT EXISTS BatchTaskIds (id INTEGER PRIMARY KEY)")) {
+        result.error = query.lastError().text();
+        return result;
     }
 
-    query.prepare("DELETE FROM DetectionTask WHERE id = :tid");
-    query.bindValue(":tid", taskId);
+    QStringList sampleFiles;
+    auto fail = [&](const QString &what) {
+        result.error = what + ": " + query.lastError().text();
+        LOG_ERR << "批量删除任务失败 - " << result.error;
+        db.rollback();
+        return result;
+    };
+
+    if (!db.transaction()) {
+        result.error = db.lastError().text();
+        return result;
+    }
+
+    if (!query.exec("DELETE FROM temp.BatchTaskIds")) return fail("清空临时表");
+    query.prepare("INSERT OR IGNORE INTO temp.BatchTaskIds (id) VALUES (:tid)");
+    for (int taskId : taskIds) {
+        query.bindValue(":tid", taskId);
+        if (!query.exec()) return fail("写入临时表");
+    }
+
+    if (!query.exec("SELECT d.id, d.sample_file FROM DetectionTask d JOIN temp.BatchTaskIds b ON b.id = d.id")) {
+        return fail("查询任务");
+    }
+    while (query.next()) {
+        result.taskIds.append(query.value(0).toInt());
+        if (!query.value(1).isNull()) sampleFiles.append(query.value(1).toString());
+    }
+
+    if (!query.exec("DELETE FROM MotionLog WHERE task_id IN (SELECT id FROM temp.BatchTaskIds)")) {
+        return fail("删除 MotionLog");
+    }
+    const int logRows = query.numRowsAffected();
+    if (!query.exec("DELETE FROM MotionRollup WHERE task_id IN (SELECT id FROM temp.BatchTaskIds)")) {
+        return fail("删除 MotionRollup");
+    }
+    if (!query.exec("DELETE FROM TaskStats WHERE task_id IN (SELECT id FROM temp.BatchTaskIds)")) {
+        return fail("删除 TaskStats");
+    }
+    if (!query.exec("DELETE FROM DetectionTask WHERE id IN (SELECT id FROM temp.BatchTaskIds)")) {
+        return fail("删除 DetectionTask");
+    }
+    query.exec("DELETE FROM temp.BatchTaskIds");
+
+    if (!db.commit()) {
+        result.error = db.lastError().text();
+        LOG_ERR << "批量删除任务提交失败: " << result.error;
+        db.rollback();
+        result.taskIds.clear();
+        return result;
+    }
+
+    // 事务提交后再删除采样文件，失败回滚时文件仍然完整
+    for (const QString &file : sampleFiles) {
+        removeSampleFile(file);
+    }
+
+    LOG_INFO << "批量删除任务 " << result.taskIds.size() << " 个, 运动日志 " << logRows << " 行";
+    if (!result.taskIds.isEmpty()) notifyTaskChange(TaskChange::Deleted, result.taskIds);
+    result.ok = true;
+    return result;
+}
+
+DataManager::BulkResult DataManager::createDetectionTasks(const QVector<WorkOrderImport::Item> &items)
+{
+    UiBlockScope block(m_uiBlocking);
+    BulkResult result;
+    result.time = QDateTime::currentDateTime();
+    if (items.isEmpty()) {
+        result.ok = true;
+        return result;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) {
+        result.error = "数据库未打开";
+        return result;
+    }
+    if (!db.transaction()) {
+        result.error = db.lastError().text();
+        return result;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO DetectionTask (start_time, operator_name, tube_id, status, task_type, task_config) "
+                  "VALUES (:time, :op, :tube, :status, :type, :config)");
+    result.taskIds.reserve(items.size());
+    for (const WorkOrderImport::Item &item : items) {
+        const bool configured = !item.taskConfig.isEmpty();
+        query.bindValue(":time", result.time);
+        query.bindValue(":op", item.operatorName);
+        query.bindValue(":tube", item.tubeId);
+        query.bindValue(":status", configured ? "configured" : "create");
+        query.bindValue(":type", item.taskType.isEmpty() ? QString("manual") : item.taskType);
+        query.bindValue(":config", configured ? QVariant(item.taskConfig) : QVariant());
+        if (!query.exec()) {
+            result.error = QString("管道 %1: %2").arg(item.tubeId, query.lastError().text());
+            result.taskIds.clear();
+            LOG_ERR << "批量创建任务失败 - " << result.error;
+            db.rollback();
+            return result;
+        }
+        result.taskIds.append(query.lastInsertId().toInt());
+    }
+
+    if (!db.commit()) {
+        result.error = db.lastError().text();
+        result.taskIds.clear();
+        LOG_ERR << "批量创建任务提交失败: " << result.error;
+        db.rollback();
+        return result;
+    }
+
+    LOG_INFO << "按工单创建任务 " << result.taskIds.size() << " 个";
+    notifyTaskChange(TaskChange::Inserted, result.taskIds);
+    result.ok = true;
+    return result;
+}
+
+DataManager::TaskPage DataManager::searchTasks(const TaskQuery &q)
+{
+    UiBlockScope block(m_uiBlocking);
+    TaskPage page;
+    QElapsedTimer timer;
+    timer.start();
+
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) {
+        page.error = "数据库未打开";
+        return page;
+    }
+
+    // 条件与参数分开拼接，检索词一律绑定，不进入 SQL 文本
+    QStringList where;
+    QVariantList binds;
+    QStringList ftsTerms;
+
+    const QStringList terms = q.text.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+    for (const QString &term : terms) {
+        if (m_hasTaskSearch && term.size() >= 3) {
+            ftsTerms << ftsPhrase(term);
+            continue;
+        }
+        // trigram 无法索引 3 个字符以下的词：直接在任务表上子串匹配 (与索引相同的字段，结果只匹配 $.message)
+        where << "(v.tube_id LIKE ? ESCAPE '\\' OR v.operator_name LIKE ? ESCAPE '\\' "
+                 "OR (CASE WHEN json_valid(v.execution_result) "
+                 "THEN json_extract(v.execution_result, '$.message') END) LIKE ? ESCAPE '\\')";
+        const QString pattern = likePattern(term);
+        binds << pattern << pattern << pattern;
+    }
+
+    const QString tube = q.tubeId.trimmed();
+    if (!tube.isEmpty()) {
+        if (m_hasTaskSearch && tube.size() >= 3) {
+            ftsTerms << "tube_id : " + ftsPhrase(tube);
+        } else {
+            where << "v.tube_id LIKE ? ESCAPE '\\'";
+            binds << likePattern(tube);
+        }
+    }
+    if (!ftsTerms.isEmpty()) {
+        where << "v.id IN (SELECT rowid FROM TaskSearch WHERE TaskSearch MATCH ?)";
+        binds << ftsTerms.join(' ');
+    }
+    if (!q.operatorName.isEmpty()) {
+        where << "v.operator_name = ?";
+        binds << q.operatorName;
+    }
+    if (!q.status.isEmpty()) {
+        where << "v.status = ?";
+        binds << q.status;
+    }
+    // start_time 为 ISO 文本，按日期前缀比较 (兼容 'T' 与空格两种分隔)
+    if (q.fromDate.isValid()) {
+        where << "v.start_time >= ?";
+        binds << q.fromDate.toString("yyyy-MM-dd");
+    }
+    if (q.toDate.isValid()) {
+        where << "v.start_time < ?";
+        binds << q.toDate.addDays(1).toString("yyyy-MM-dd");
+    }
+    if (q.beforeId > 0) {
+        where << "v.id < ?";
+        binds << q.beforeId;
+    }
+
+    const int limit = qMax(1, q.limit);
+    QString sql = "SELECT v.* FROM TaskListView v";
+    if (!where.isEmpty()) sql += " WHERE " + where.join(" AND ");
+    sql += " ORDER BY v.id DESC LIMIT ?";
+    binds << limit + 1;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        page.error = query.lastError().text();
+        LOG_ERR << "任务检索失败: " << page.error;
+        return page;
+    }
+    for (const QVariant &value : std::as_const(binds)) query.addBindValue(value);
     if (!query.exec()) {
-        LOG_ERR << "删除 DetectionTask 失败:" << query.lastError().text();
-        return false;
+        page.error = query.lastError().text();
+        LOG_ERR << "任务检索失败: " << page.error;
+        return page;
     }
 
-    return true;
+    page.rows.reserve(limit);
+    while (query.next()) {
+        if (page.rows.size() == limit) {
+            page.hasMore = true;
+            break;
+        }
+        page.rows.append(query.record());
+    }
+    page.elapsedMs = timer.nsecsElapsed() / 1e6;
+    page.ok = true;
+    return page;
+}
+
+QVector<QSqlRecord> DataManager::taskRows(const QVector<int> &taskIds)
+{
+    UiBlockScope block(m_uiBlocking);
+    QVector<QSqlRecord> rows;
+    if (taskIds.isEmpty()) return rows;
+
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) return rows;
+
+    // 按主键分批查询 (SQLite 对绑定参数个数有上限)
+    constexpr int kBatch = 500;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    for (int first = 0; first < taskIds.size(); first += kBatch) {
+        const int count = qMin(kBatch, int(taskIds.size()) - first);
+        QStringList holders;
+        for (int i = 0; i < count; ++i) holders << "?";
+        query.prepare(QString("SELECT * FROM TaskListView WHERE id IN (%1)").arg(holders.join(',')));
+        for (int i = 0; i < count; ++i) query.addBindValue(taskIds[first + i]);
+        if (!query.exec()) {
+            LOG_WARN << "读取任务行失败: " << query.lastError().text();
+            break;
+        }
+        while (query.next()) rows.append(query.record());
+        query.finish();
+    }
+    std::sort(rows.begin(), rows.end(), [](const QSqlRecord &a, const QSqlRecord &b) {
+        return a.value("id").toInt() > b.value("id").toInt();
+    });
+    return rows;
 }
+
+void DataManager::notifyTaskChange(TaskChange::Kind kind, const QVector<int> &taskIds, qint64 samples)
+{
+    TaskChange change;
+    change.kind = kind;
+    change.taskIds = taskIds;
+    change.samples = samples;
+    emit taskChanged(change);
+}
+
+TaskArchive::Result DataManager::exportTaskArchive(const QList<int> &taskIds, const QString &path)
+{
+    UiBlockScope block(m_uiBlocking);
+    TaskArchive::Result result;
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) {
+        result.error = "数据库未打开";
+        return result;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    // 数据库位于数据目录下；可能在数据库线程中调用，不读取 ConfigManager
+    result = TaskArchive::exportTasks(db, QFileInfo(m_dbPath).dir().absolutePath(), taskIds, path);
+    if (!result.ok) {
+        LOG_ERR << "导出任务归档失败: " << result.error;
+        return result;
+    }
+    LOG_INFO << "导出任务归档 " << path << ": " << result.taskIds.size() << " 个任务, " << result.samples
+             << " 个采样, " << result.bytes / 1024 << " KB, 耗时 " << timer.elapsed() << " ms";
+    return result;
+}
+
+TaskArchive::Result DataManager::importTaskArchive(const QString &path)
+{
+    UiBlockScope block(m_uiBlocking);
+    TaskArchive::Result result;
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) {
+        result.error = "数据库未打开";
+        return result;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    result = TaskArchive::importTasks(db, QFileInfo(m_dbPath).dir().absolutePath(), path);
+    // 每个任务单独提交，失败时之前导入的任务也已生效
+    if (!result.taskIds.isEmpty()) notifyTaskChange(TaskChange::Inserted, result.taskIds);
+    if (!result.ok) {
+        LOG_ERR << "导入任务归档失败: " << result.error << " (已导入 " << result.taskIds.size() << " 个任务)";
+        return result;
+    }
+    LOG_INFO << "导入任务归档 " << path << ": " << result.taskIds.size() << " 个任务, 跳过已存在 "
+             << result.skipped << " 个, " << result.samples << " 个采样, 耗时 " << timer.elapsed() << " ms";
+    return result;
+}
+
 bool DataManager::updateTaskConfig(int taskId, const QString &taskType, const QString &taskConfig)
 {
+    UiBlockScope block(m_uiBlocking);
     if (taskId <= 0) return false;
 
     QString connName = getConnectionName();
@@ -346,11 +1114,13 @@ bool DataManager::updateTaskConfig(int taskId, const QString &taskType, const QS
         LOG_ERR << "更新任务配置失败:" << query.lastError().text();
         return false;
     }
+    notifyTaskChange(TaskChange::Updated, {taskId});
     return true;
 }
 
 bool DataManager::getTaskConfig(int taskId, QString &taskType, QString &taskConfig)
 {
+    UiBlockScope block(m_uiBlocking);
     if (taskId <= 0) return false;
 
     QString connName = getConnectionName();
@@ -369,8 +1139,373 @@ bool DataManager::getTaskConfig(int taskId, QString &taskType, QString &taskConf
     return false;
 }
 
+QVector<double> DataManager::previousScanPositions(int taskId)
+{
+    QVector<double> positions;
+    if (taskId <= 0) return positions;
+
+    QString connName = getConnectionName();
+    QSqlDatabase db = QSqlDatabase::database(connName);
+    if (!db.isOpen()) return positions;
+
+    QSqlQuery query(db);
+    query.prepare("SELECT d.id FROM DetectionTask d"
+                  " WHERE d.tube_id = (SELECT tube_id FROM DetectionTask WHERE id = :tid)"
+                  "   AND d.id <> :tid2"
+                  "   AND (d.sample_file IS NOT NULL"
+                  "        OR EXISTS (SELECT 1 FROM MotionLog m WHERE m.task_id = d.id))"
+                  " ORDER BY d.id DESC LIMIT 1");
+    query.bindValue(":tid", taskId);
+    query.bindValue(":tid2", taskId);
+
+    if (!query.exec()) {
+        LOG_ERR << "查询历史扫描数据失败: " << query.lastError().text();
+        return positions;
+    }
+    if (!query.next()) return positions;
+
+    SampleStore::Columns samples;
+    QString error;
+    if (!readTaskSamples(query.value(0).toInt(), samples, &error)) {
+        LOG_ERR << "读取历史扫描数据失败: " << error;
+        return positions;
+    }
+    return samples.position;
+}
+
+/**
+ * @brief 读取任务的全部运动采样
+ *
+ * 登记了列式采样文件的任务通过 mmap 按列读取；否则从 MotionLog 表按时间顺序查询。
+ */
+bool DataManager::readTaskSamples(int taskId, SampleStore::Columns &out, QString *error)
+{
+    return readTaskSampleRange(taskId, std::numeric_limits<qint64>::min(),
+                               std::numeric_limits<qint64>::max(), out, error);
+}
+
+bool DataManager::readTaskSampleRange(int taskId, qint64 tFromUs, qint64 tToUs,
+                                      SampleStore::Columns &out, QString *error)
+{
+    out.clear();
+    if (taskId <= 0) return false;
+
+    QString connName = getConnectionName();
+    QSqlDatabase db = QSqlDatabase::database(connName);
+    if (!db.isOpen()) {
+        if (error) *error = "数据库未打开";
+        return false;
+    }
+
+    QSqlQuery query(db);
+    query.prepare("SELECT sample_file FROM DetectionTask WHERE id = :tid");
+    query.bindValue(":tid", taskId);
+    QString sampleFile;
+    if (query.exec() && query.next()) {
+        sampleFile = query.value(0).toString();
+    }
+
+    if (!sampleFile.isEmpty()) {
+        SampleStore::Reader reader;
+        // 数据库位于数据目录下；可能在数据库线程中调用，不读取 ConfigManager
+        const QString path = QFileInfo(m_dbPath).dir().filePath(sampleFile);
+        if (!reader.open(path, error)) return false;
+        if (!reader.readRange(tFromUs, tToUs, out) && error) {
+            *error = "部分数据块损坏，已跳过";
+        }
+        return true;
+    }
+
+    // 主键 (task_id, t) 范围扫描
+    query.prepare("SELECT t, position, speed, status FROM MotionLog "
+                  "WHERE task_id = :tid AND t BETWEEN :from AND :to ORDER BY t");
+    query.bindValue(":tid", taskId);
+    query.bindValue(":from", tFromUs);
+    query.bindValue(":to", tToUs);
+    query.setForwardOnly(true);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        SampleStore::Sample sample;
+        sample.t = query.value(0).toLongLong();
+        sample.position = query.value(1).toDouble();
+        sample.speed = query.value(2).toDouble();
+        sample.status = quint8(query.value(3).toInt());
+        out.append(sample);
+    }
+    return true;
+}
+
+/**
+ * @brief 查询任务的曲线数据 (降采样)
+ *
+ * 按窗口时长 / 像素宽度选择金字塔层级：每像素对应的时长不足 100 ms 时读取原始采样，
+ * 否则读取对应层级的 min/max/avg。useLttb 时先选出不超过 kLttbMaxInput 个点的最细来源，
+ * 再用 LTTB 降到 pixelWidth 个点。
+ * 没有降采样数据的历史任务 (金字塔引入之前的数据) 在第一次查询时补建。
+ */
+MotionRollup::Series DataManager::querySeries(int taskId, qint64 tFromUs, qint64 tToUs,
+                                              int pixelWidth, bool useLttb)
+{
+    static const qint64 kLttbMaxInput = 200000;
+
+    MotionRollup::Series series;
+    if (taskId <= 0 || pixelWidth <= 0) return series;
+
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) return series;
+
+    ensureRollups(db, taskId);
+
+    QSqlQuery query(db);
+    if (tFromUs <= 0 || tToUs <= tFromUs) {
+        // 未指定窗口：取任务全程 (1 s 层级的首尾桶)
+        query.prepare("SELECT MIN(bucket), MAX(bucket) FROM MotionRollup WHERE task_id = :tid AND level = 1");
+        query.bindValue(":tid", taskId);
+        if (!query.exec() || !query.next() || query.value(0).isNull()) return series;
+        tFromUs = query.value(0).toLongLong() * MotionRollup::kBucketUs[1];
+        tToUs = (query.value(1).toLongLong() + 1) * MotionRollup::kBucketUs[1] - 1;
+    }
+
+    int level = MotionRollup::chooseLevel(tToUs - tFromUs, pixelWidth);
+    if (useLttb) {
+        // 原始点数由 1 s 层级的计数估算
+        query.prepare("SELECT SUM(n) FROM MotionRollup WHERE task_id = :tid AND level = 1 "
+                      "AND bucket BETWEEN :from AND :to");
+        query.bindValue(":tid", taskId);
+        query.bindValue(":from", tFromUs / MotionRollup::kBucketUs[1]);
+        query.bindValue(":to", tToUs / MotionRollup::kBucketUs[1]);
+        const qint64 rawCount = (query.exec() && query.next()) ? query.value(0).toLongLong() : 0;
+
+        level = MotionRollup::kLevelCount - 1;
+        if (rawCount <= kLttbMaxInput) {
+            level = -1;
+        } else {
+            for (int l = 0; l < MotionRollup::kLevelCount; ++l) {
+                if ((tToUs - tFromUs) / MotionRollup::kBucketUs[l] <= kLttbMaxInput) {
+                    level = l;
+                    break;
+                }
+            }
+        }
+    }
+
+    if (level < 0) {
+        SampleStore::Columns samples;
+        readTaskSampleRange(taskId, tFromUs, tToUs, samples);
+        series.reserve(samples.size());
+        for (int i = 0; i < samples.size(); ++i) {
+            series.appendPoint(samples.t[i], samples.position[i], samples.speed[i]);
+        }
+    } else {
+        query.finish();
+        query.setForwardOnly(true);
+        query.prepare("SELECT bucket, n, pos_min, pos_max, pos_sum, spd_min, spd_max, spd_sum FROM MotionRollup "
+                      "WHERE task_id = :tid AND level = :level AND bucket BETWEEN :from AND :to ORDER BY bucket");
+        query.bindValue(":tid", taskId);
+        query.bindValue(":level", level);
+        query.bindValue(":from", tFromUs / MotionRollup::kBucketUs[level]);
+        query.bindValue(":to", tToUs / MotionRollup::kBucketUs[level]);
+        if (query.exec()) {
+            while (query.next()) {
+                MotionRollup::Bucket b;
+                b.bucket = query.value(0).toLongLong();
+                b.n = query.value(1).toInt();
+                b.posMin = query.value(2).toDouble();
+                b.posMax = query.value(3).toDouble();
+                b.posSum = query.value(4).toDouble();
+                b.spdMin = query.value(5).toDouble();
+                b.spdMax = query.value(6).toDouble();
+                b.spdSum = query.value(7).toDouble();
+                series.appendBucket(b.bucket * MotionRollup::kBucketUs[level], b);
+            }
+        } else {
+            LOG_ERR << "查询降采样数据失败: " << query.lastError().text();
+        }
+    }
+    series.level = level;
+
+    if (useLttb && series.size() > pixelWidth) {
+        series = MotionRollup::pick(series, MotionRollup::lttb(series.t, series.posAvg, pixelWidth));
+        series.lttb = true;
+    }
+    return series;
+}
+
+bool DataManager::taskStats(int taskId, TaskStats &out)
+{
+    if (taskId <= 0) return false;
+
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) return false;
+
+    if (TaskStats::load(db, taskId, out)) return true;
+    // 正在记录的任务由写入线程维护，不在此补算
+    if (taskId == m_lastLoggedTaskId.load(std::memory_order_relaxed)) return false;
+    return computeTaskStats(db, taskId, out);
+}
+
+QFuture<TaskStats> DataManager::taskStatsAsync(int taskId)
+{
+    UiBlockScope block(m_uiBlocking);
+    if (m_logWriter && m_logWriter->isRunning()) {
+        auto promise = std::make_shared<QPromise<TaskStats>>();
+        QFuture<TaskStats> future = promise->future();
+        promise->start();
+        MotionLogWriter *writer = m_logWriter;
+        QMetaObject::invokeMethod(writer, [writer, promise, taskId]() {
+            promise->addResult(writer->flushTaskStats(taskId));
+            promise->finish();
+        }, Qt::QueuedConnection);
+        return future;
+    }
+
+    return runOnDbThread([this, taskId]() {
+        TaskStats stats;
+        taskStats(taskId, stats);
+        stats.taskId = taskId;
+        return stats;
+    });
+}
+
+bool DataManager::computeTaskStats(QSqlDatabase &db, int taskId, TaskStats &out)
+{
+    SampleStore::Columns samples;
+    if (!readTaskSamples(taskId, samples) || samples.isEmpty()) return false;
+
+    out = TaskStats();
+    out.taskId = taskId;
+    for (int i = 0; i < samples.size(); ++i) {
+        out.add(samples.t[i], samples.position[i], samples.speed[i], samples.status[i]);
+    }
+
+    QString error;
+    if (!out.save(db, &error)) {
+        LOG_WARN << "保存任务 " << taskId << " 统计失败: " << error;
+    }
+    return true;
+}
+
+int DataManager::backfillTaskStats()
+{
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) return 0;
+
+    QSqlQuery query(db);
+    if (!query.exec("SELECT d.id FROM DetectionTask d "
+                    "WHERE NOT EXISTS (SELECT 1 FROM TaskStats s WHERE s.task_id = d.id) "
+                    "AND (d.sample_file IS NOT NULL "
+                    "     OR EXISTS (SELECT 1 FROM MotionLog m WHERE m.task_id = d.id))")) {
+        LOG_WARN << "查询缺少统计的任务失败: " << query.lastError().text();
+        return 0;
+    }
+    QVector<int> taskIds;
+    while (query.next()) taskIds.append(query.value(0).toInt());
+    query.finish();
+    if (taskIds.isEmpty()) return 0;
+
+    LOG_INFO << "补算历史任务统计: " << taskIds.size() << " 个任务 (分批执行)";
+    backfillTaskStatsBatch(taskIds);
+    return taskIds.size();
+}
+
+int DataManager::backfillTaskStatsBatch(QVector<int> taskIds)
+{
+    QSqlDatabase db = QSqlDatabase::database(getConnectionName());
+    if (!db.isOpen()) return 0;
+
+    // 每批至少一个任务，超过时间预算即让出数据库线程
+    QElapsedTimer timer;
+    timer.start();
+    QVector<int> computed;
+    TaskStats stats;
+    QSqlQuery exists(db);
+    exists.prepare("SELECT 1 FROM TaskStats WHERE task_id = :tid");
+    int next = 0;
+    while (next < taskIds.size() && (next == 0 || timer.elapsed() < kBackfillBatchMs)) {
+        const int taskId = taskIds.at(next++);
+        // 排队期间任务被恢复执行：统计由写入线程维护，不能覆盖
+        if (taskId == m_lastLoggedTaskId.load(std::memory_order_relaxed)) continue;
+        exists.bindValue(":tid", taskId);
+        if (exists.exec() && exists.next()) continue;
+        exists.finish();
+        if (computeTaskStats(db, taskId, stats)) computed.append(taskId);
+    }
+    if (!computed.isEmpty()) notifyTaskChange(TaskChange::Updated, computed);
+
+    taskIds.remove(0, next);
+    if (taskIds.isEmpty()) {
+        LOG_INFO << "历史任务统计补算完成";
+    } else {
+        // 重新排队，之前已提交的增删改查先执行
+        runOnDbThread([this, taskIds]() { return backfillTaskStatsBatch(taskIds); });
+    }
+    return computed.size();
+}
+
+/**
+ * @brief 为没有降采样数据的任务补建金字塔
+ * 正在记录的任务由写入线程维护，这里跳过，避免重复累加。
+ */
+void DataManager::ensureRollups(QSqlDatabase &db, int taskId)
+{
+    if (taskId == m_lastLoggedTaskId.load(std::memory_order_relaxed)) return;
+
+    QSqlQuery query(db);
+    query.prepare("SELECT 1 FROM MotionRollup WHERE task_id = :tid LIMIT 1");
+    query.bindValue(":tid", taskId);
+    if (!query.exec() || query.next()) return;
+
+    SampleStore::Columns samples;
+    if (!readTaskSamples(taskId, samples) || samples.isEmpty()) return;
+
+    QVector<MotionRollup::Bucket> buckets;
+    MotionRollup::Accumulator acc;
+    for (int i = 0; i < samples.size(); ++i) {
+        acc.add(taskId, samples.t[i], samples.position[i], samples.speed[i], buckets);
+    }
+    acc.closeAll(buckets);
+
+    db.transaction();
+    query.prepare("INSERT OR REPLACE INTO MotionRollup (task_id, level, bucket, n, pos_min, pos_max, pos_sum, "
+                  "spd_min, spd_max, spd_sum) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    for (const MotionRollup::Bucket &b : std::as_const(buckets)) {
+        query.bindValue(0, b.taskId);
+        query.bindValue(1, b.level);
+        query.bindValue(2, b.bucket);
+        query.bindValue(3, b.n);
+        query.bindValue(4, b.posMin);
+        query.bindValue(5, b.posMax);
+        query.bindValue(6, b.posSum);
+        query.bindValue(7, b.spdMin);
+        query.bindValue(8, b.spdMax);
+        query.bindValue(9, b.spdSum);
+        if (!query.exec()) {
+            LOG_ERR << "补建降采样数据失败: " << query.lastError().text();
+            db.rollback();
+            return;
+        }
+    }
+    db.commit();
+    LOG_INFO << "任务 " << taskId << " 补建降采样数据: " << samples.size() << " 个样本 -> "
+             << buckets.size() << " 个时间桶";
+}
+
+void DataManager::removeSampleFile(const QString &sampleFile)
+{
+    if (sampleFile.isEmpty()) return;
+    // 数据库位于数据目录下；可能在数据库线程中调用，不读取 ConfigManager
+    const QString path = QFileInfo(m_dbPath).dir().filePath(sampleFile);
+    if (QFile::exists(path) && !QFile::remove(path)) {
+        LOG_WARN << "删除采样文件失败: " << path;
+    }
+}
+
 bool DataManager::updateTaskExecutionResult(int taskId, const QString &executionResult)
 {
+    UiBlockScope block(m_uiBlocking);
     if (taskId <= 0) return false;
 
     QString connName = getConnectionName();
@@ -387,11 +1522,13 @@ bool DataManager::updateTaskExecutionResult(int taskId, const QString &execution
         LOG_ERR << "更新任务执行结果失败:" << query.lastError().text();
         return false;
     }
+    notifyTaskChange(TaskChange::Updated, {taskId});
     return true;
 }
 
 QString DataManager::getTaskExecutionResult(int taskId)
 {
+    UiBlockScope block(m_uiBlocking);
     if (taskId <= 0) return QString();
 
     QString connName = getConnectionName();
@@ -406,4 +1543,120 @@ QString DataManager::getTaskExecutionResult(int taskId)
         return query.value("execution_result").toString();
     }
     return QString();
-}
\ No newline at end of file
+}
+
+// ---- 异步任务接口 ----
+
+QFuture<int> DataManager::createDetectionTaskAsync(const QString &operatorName, const QString &tubeId)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, operatorName, tubeId]() {
+        return createDetectionTask(operatorName, tubeId);
+    });
+}
+
+QFuture<bool> DataManager::deleteDetectionTaskAsync(int taskId)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId]() {
+        return deleteDetectionTask(taskId);
+    });
+}
+
+QFuture<DataManager::BulkResult> DataManager::deleteDetectionTasksAsync(const QList<int> &taskIds)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskIds]() {
+        return deleteDetectionTasks(taskIds);
+    });
+}
+
+QFuture<DataManager::BulkResult> DataManager::createDetectionTasksAsync(const QVector<WorkOrderImport::Item> &items)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, items]() {
+        return createDetectionTasks(items);
+    });
+}
+
+QFuture<bool> DataManager::updateDetectionTaskStatusAsync(int taskId, const QString &status)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId, status]() {
+        return updateDetectionTaskStatus(taskId, status);
+    });
+}
+
+QFuture<bool> DataManager::updateTaskConfigAsync(int taskId, const QString &taskType, const QString &taskConfig)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId, taskType, taskConfig]() {
+        return updateTaskConfig(taskId, taskType, taskConfig);
+    });
+}
+
+QFuture<DataManager::TaskConfigResult> DataManager::getTaskConfigAsync(int taskId)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId]() {
+        TaskConfigResult result;
+        result.ok = getTaskConfig(taskId, result.taskType, result.taskConfig);
+        return result;
+    });
+}
+
+QFuture<bool> DataManager::updateTaskExecutionResultAsync(int taskId, const QString &executionResult)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId, executionResult]() {
+        return updateTaskExecutionResult(taskId, executionResult);
+    });
+}
+
+QFuture<QString> DataManager::getTaskExecutionResultAsync(int taskId)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId]() {
+        return getTaskExecutionResult(taskId);
+    });
+}
+
+QFuture<TaskArchive::Result> DataManager::exportTaskArchiveAsync(const QList<int> &taskIds, const QString &path)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskIds, path]() {
+        return exportTaskArchive(taskIds, path);
+    });
+}
+
+QFuture<TaskArchive::Result> DataManager::importTaskArchiveAsync(const QString &path)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, path]() {
+        return importTaskArchive(path);
+    });
+}
+
+QFuture<DataManager::TaskPage> DataManager::searchTasksAsync(const TaskQuery &query)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, query]() {
+        return searchTasks(query);
+    });
+}
+
+QFuture<QVector<QSqlRecord>> DataManager::taskRowsAsync(const QVector<int> &taskIds)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskIds]() {
+        return taskRows(taskIds);
+    });
+}
+
+QFuture<QVector<double>> DataManager::previousScanPositionsAsync(int taskId)
+{
+    UiBlockScope block(m_uiBlocking);
+    return runOnDbThread([this, taskId]() {
+        return previousScanPositions(taskId);
+    });
+}
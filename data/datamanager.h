@@ -2,11 +2,26 @@
 #define DATAMANAGER_H
 
 #include <QObject>
+#include <QVector>
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QPromise>
+#include <atomic>
+#include <memory>
+#include <type_traits>
 #include "../communication/protocol.h"
+#include "motionlogwriter.h"
+#include "samplestore.h"
+#include "motionrollup.h"
+#include "workorderimport.h"
+#include "taskstats.h"
+#include "taskarchive.h"
+#include <QThread>
 
 /**
  * @brief 数据管理器类
@@ -21,6 +36,9 @@
  * 线程安全说明：
  * SQLite 的连接通常是线程绑定的。本类提供了 getConnectionName() 方法
  * 确保每个线程使用独立的数据库连接实例，以支持多线程并发访问（如果需要）。
+ *
+ * 任务增删改查另提供 *Async 版本：调用在独立的数据库线程中按提交顺序执行，
+ * 返回 QFuture，UI 线程通过 QFuture::then(this, ...) 接收结果，不等待磁盘 I/O。
  */
 class DataManager : public QObject
 {
@@ -29,6 +47,76 @@ public:
     explicit DataManager(QObject *parent = nullptr);
     ~DataManager();
 
+    /**
+     * @brief 任务配置 (getTaskConfigAsync 的结果)
+     */
+    struct TaskConfigResult {
+        bool ok = false;
+        QString taskType;
+        QString taskConfig;
+    };
+
+    /**
+     * @brief 批量操作结果
+     */
+    struct BulkResult {
+        bool ok = false;
+        QVector<int> taskIds;       ///< 实际删除/新建的任务ID (新建时与输入条目一一对应)
+        QDateTime time;             ///< 新建任务的创建时间
+        QString error;
+    };
+
+    /**
+     * @brief 任务检索条件 (searchTasks)
+     */
+    struct TaskQuery {
+        QString text;               ///< 全文检索：管道编号/操作员/结果信息的子串，空格分隔的多个词须同时匹配
+        QString tubeId;             ///< 管道编号子串
+        QString operatorName;       ///< 操作员 (完全匹配)
+        QString status;             ///< 任务状态 (完全匹配)
+        QDate fromDate;             ///< 创建日期下限 (含)，无效表示不限
+        QDate toDate;               ///< 创建日期上限 (含)
+        int beforeId = 0;           ///< 分页：只返回ID小于此值的任务，0 表示第一页
+        int limit = 200;            ///< 每页行数
+    };
+
+    /**
+     * @brief 任务检索结果 (一页)
+     */
+    struct TaskPage {
+        bool ok = false;
+        QVector<QSqlRecord> rows;   ///< TaskListView 的行，按任务ID倒序
+        bool hasMore = false;       ///< 还有下一页 (beforeId 取最后一行的ID)
+        double elapsedMs = 0.0;
+        QString error;
+    };
+
+    /**
+     * @brief 任务数据变更 (行级)
+     * 写操作提交后发出，界面按任务ID增量更新，不再整表重新查询。
+     */
+    struct TaskChange {
+        enum Kind {
+            Inserted,           ///< 新建任务 (含工单导入、归档导入)
+            Updated,            ///< 任务记录 (状态/配置/结果) 或统计变化
+            Deleted,            ///< 任务已删除
+            SamplesAppended     ///< 任务写入了新的运动采样 (统计随之变化)
+        };
+        Kind kind = Updated;
+        QVector<int> taskIds;
+        qint64 samples = 0;     ///< SamplesAppended: 任务累计采样数
+    };
+
+    /**
+     * @brief UI 线程在任务增删改查上的阻塞统计
+     * 同步接口计入整个 SQL 执行时间，异步接口只计入提交时间。
+     */
+    struct BlockingStats {
+        quint64 calls = 0;
+        double totalMs = 0.0;
+        double maxMs = 0.0;
+    };
+
     /**
      * @brief 初始化数据库
      * 
@@ -38,11 +126,63 @@ public:
      */
     bool initDatabase();
 
+    /**
+     * @brief 以只读方式打开已有数据库 (离线仿真等只查询的场景)
+     *
+     * 不建表、不迁移，也不启动写入线程、数据库线程、统计补算和数据清理，
+     * 不会修改数据库。之后只能调用只读的查询接口 (如 getTaskConfig)。
+     * @return true 打开成功, false 数据库不存在或无法打开
+     */
+    bool openReadOnly();
+
     /**
      * @brief 获取当前线程的数据库连接名称
      */
     QString connectionName() const;
 
+    /**
+     * @brief 获取当前线程的只读连接名称 (UI 模型、导出使用)
+     */
+    QString readConnectionName() const;
+
+    /**
+     * @brief 数据库文件路径 (导出等工作线程自行建立连接时使用)
+     */
+    QString databasePath() const { return m_dbPath; }
+
+    /**
+     * @brief 运动日志后台写入统计 (写入速率、提交耗时、积压行数)
+     */
+    MotionLogWriter::Stats motionLogStats() const;
+
+    /**
+     * @brief UI 线程阻塞统计
+     */
+    BlockingStats uiBlockingStats() const { return m_uiBlocking; }
+
+    // ---- 异步任务接口 (在数据库线程中执行，结果通过 QFuture 返回) ----
+
+    QFuture<int> createDetectionTaskAsync(const QString &operatorName, const QString &tubeId);
+    QFuture<bool> deleteDetectionTaskAsync(int taskId);
+    QFuture<BulkResult> deleteDetectionTasksAsync(const QList<int> &taskIds);
+    QFuture<BulkResult> createDetectionTasksAsync(const QVector<WorkOrderImport::Item> &items);
+    QFuture<bool> updateDetectionTaskStatusAsync(int taskId, const QString &status);
+    QFuture<bool> updateTaskConfigAsync(int taskId, const QString &taskType, const QString &taskConfig);
+    QFuture<TaskConfigResult> getTaskConfigAsync(int taskId);
+    QFuture<bool> updateTaskExecutionResultAsync(int taskId, const QString &executionResult);
+    QFuture<QString> getTaskExecutionResultAsync(int taskId);
+    QFuture<TaskArchive::Result> exportTaskArchiveAsync(const QList<int> &taskIds, const QString &path);
+    QFuture<TaskArchive::Result> importTaskArchiveAsync(const QString &path);
+    QFuture<TaskPage> searchTasksAsync(const TaskQuery &query);
+    QFuture<QVector<QSqlRecord>> taskRowsAsync(const QVector<int> &taskIds);
+    QFuture<QVector<double>> previousScanPositionsAsync(int taskId);
+
+signals:
+    /**
+     * @brief 任务数据变更 (可能在数据库线程中发出，界面对象的连接为排队连接)
+     */
+    void taskChanged(const DataManager::TaskChange &change);
+
 public slots:
     /**
      * @brief 记录运动日志
@@ -66,6 +206,42 @@ public slots:
      */
     bool deleteDetectionTask(int taskId);
 
+    /**
+     * @brief 批量删除检测任务 (单个事务)
+     * 任务ID写入临时表，MotionLog/MotionRollup/DetectionTask 各执行一次联表删除。
+     */
+    BulkResult deleteDetectionTasks(const QList<int> &taskIds);
+
+    /**
+     * @brief 按工单批量创建检测任务 (单个事务)
+     * 带任务配置的条目直接置为 configured 状态。
+     */
+    BulkResult createDetectionTasks(const QVector<WorkOrderImport::Item> &items);
+
+    /**
+     * @brief 检索任务 (参数化查询，按任务ID倒序分页)
+     * 3 个字符以上的检索词走 TaskSearch 全文索引 (FTS5 trigram)，更短的词按 LIKE 扫描。
+     */
+    TaskPage searchTasks(const TaskQuery &query);
+
+    /**
+     * @brief 读取指定任务的 TaskListView 行 (按任务ID倒序)，收到 taskChanged 后增量刷新用
+     * 已删除的任务不返回。
+     */
+    QVector<QSqlRecord> taskRows(const QVector<int> &taskIds);
+
+    /**
+     * @brief 将任务导出为归档文件 (.epa，见 TaskArchive)
+     * 已归档为采样文件的任务直接拷贝压缩数据块，MotionLog 中的任务按块编码后写入。
+     */
+    TaskArchive::Result exportTaskArchive(const QList<int> &taskIds, const QString &path);
+
+    /**
+     * @brief 导入归档文件中的任务
+     * 任务重新分配ID，来源记录在 origin 列；已导入过的任务跳过。
+     */
+    TaskArchive::Result importTaskArchive(const QString &path);
+
     /**
      * @brief 更新任务状态
      * @param taskId 任务ID
@@ -105,8 +281,51 @@ public slots:
     QString getTaskExecutionResult(int taskId);
 
     /**
-     * @brief 自动清理旧数据
-     * @param daysToKeep 保留最近多少天的数据 (默认30天)
+     * @brief 获取同一管道上一次扫描的位置样本
+     * 查找与 taskId 管道编号相同、且有运动日志的最近一个其他任务。
+     * @param taskId 当前任务ID
+     * @return 位置样本 (mm)，无历史数据时为空
+     */
+    QVector<double> previousScanPositions(int taskId);
+
+    /**
+     * @brief 读取任务的全部运动采样 (按时间排序)
+     * 自动区分列式采样文件与 MotionLog 表两种存储。
+     * @return false 读取失败 (error 给出原因)
+     */
+    bool readTaskSamples(int taskId, SampleStore::Columns &out, QString *error = nullptr);
+
+    /**
+     * @brief 读取任务在 [tFromUs, tToUs] 内的运动采样
+     */
+    bool readTaskSampleRange(int taskId, qint64 tFromUs, qint64 tToUs,
+                             SampleStore::Columns &out, QString *error = nullptr);
+
+    /**
+     * @brief 查询曲线数据 (按窗口与像素宽度自动选择降采样层级)
+     * @param tFromUs/tToUs 时间窗口 (微秒)，都为 0 表示任务全程
+     * @param pixelWidth 绘图区域像素宽度
+     * @param useLttb 使用 LTTB 降采样 (保形) 代替 min/max 桶
+     */
+    MotionRollup::Series querySeries(int taskId, qint64 tFromUs, qint64 tToUs,
+                                     int pixelWidth, bool useLttb = false);
+
+    /**
+     * @brief 读取任务统计 (TaskStats 表)
+     * 历史任务没有统计行时，从运动采样计算一次并保存 (正在记录的任务除外)。
+     */
+    bool taskStats(int taskId, TaskStats &out);
+
+    /**
+     * @brief 获取任务的最终统计
+     * 写入线程运行时，先写完队列中已采集的数据再返回，保证包含任务结束前的全部采样。
+     */
+    QFuture<TaskStats> taskStatsAsync(int taskId);
+
+    /**
+     * @brief 提交一轮过期数据清理 (在日志写入线程中分步执行，立即返回)
+     * 过期的任务运动日志先归档为压缩采样文件，归档文件按归档保留期删除。
+     * @param daysToKeep MotionLog 表保留最近多少天的数据 (默认30天)
      */
     void cleanupOldData(int daysToKeep = 30);
 
@@ -117,7 +336,107 @@ private:
      */
     QString getConnectionName() const;
 
+    /**
+     * @brief 打开当前线程的只读连接
+     */
+    bool openReadConnection();
+
+    /**
+     * @brief 打开数据库线程的连接 (在数据库线程中调用，已打开时直接返回)
+     */
+    bool openDbThreadConnection();
+
+    /**
+     * @brief 将操作投递到数据库线程执行
+     * 数据库线程未启动时在调用线程中同步执行。
+     */
+    template <typename Fn>
+    QFuture<std::invoke_result_t<Fn &>> runOnDbThread(Fn fn);
+
+    /**
+     * @brief MotionLog 表结构迁移
+     */
+    bool migrateMotionLog(QSqlDatabase &db);
+
+    /**
+     * @brief 创建任务全文索引 TaskSearch 及同步触发器，新建时从 DetectionTask 填充
+     * @return false SQLite 不支持 FTS5 trigram (检索退化为 LIKE 扫描)
+     */
+    bool ensureTaskSearch(QSqlDatabase &db);
+
+    qint64 nowUs() const;
+
+    /**
+     * @brief 发出 taskChanged
+     */
+    void notifyTaskChange(TaskChange::Kind kind, const QVector<int> &taskIds, qint64 samples = 0);
+
+    /**
+     * @brief 删除任务登记的采样文件 (相对数据目录)
+     */
+    void removeSampleFile(const QString &sampleFile);
+
+    /**
+     * @brief 为历史任务补建降采样金字塔
+     */
+    void ensureRollups(QSqlDatabase &db, int taskId);
+
+    /**
+     * @brief 由运动采样计算任务统计并保存
+     */
+    bool computeTaskStats(QSqlDatabase &db, int taskId, TaskStats &out);
+
+    void forgetTasksInWriter(const QList<int> &taskIds);
+
+    /**
+     * @brief 查出缺少统计行的历史任务并开始分批补算 (数据库线程中执行)
+     * @return 待补算的任务数
+     */
+    int backfillTaskStats();
+
+    /**
+     * @brief 补算一批任务的统计，其余任务重新排队到数据库线程 (两批之间可执行异步增删改查)
+     * @return 本批补算的任务数
+     */
+    int backfillTaskStatsBatch(QVector<int> taskIds);
+
     QString m_dbPath; ///< 数据库文件路径
+    qint64 m_clockBaseUs = 0;        ///< 时间戳基准 (微秒)
+    QElapsedTimer m_monoClock;       ///< 单调时钟，叠加到基准上
+    std::atomic<int> m_lastLoggedTaskId {-1}; ///< 最近写入日志的任务 (其金字塔由写入线程维护；UI 线程写、数据库线程读)
+    bool m_hasTaskSearch = false;    ///< TaskSearch 全文索引可用
+
+    QThread m_writerThread;                ///< 运动日志写入线程
+    MotionLogWriter *m_logWriter = nullptr; ///< 运动日志写入器 (运行于 m_writerThread)
+    quint64 m_lastDroppedRows = 0;          ///< 上次告警时写入器的累计丢弃行数
+
+    QThread m_dbThread;                    ///< 任务增删改查线程 (异步接口)
+    QObject *m_dbContext = nullptr;        ///< 运行于 m_dbThread，作为投递目标
+    BlockingStats m_uiBlocking;            ///< 仅在 UI 线程中更新
 };
 
+template <typename Fn>
+QFuture<std::invoke_result_t<Fn &>> DataManager::runOnDbThread(Fn fn)
+{
+    using Result = std::invoke_result_t<Fn &>;
+    auto promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    if (!m_dbContext) {
+        promise->addResult(fn());
+        promise->finish();
+        return future;
+    }
+
+    QMetaObject::invokeMethod(m_dbContext, [this, promise, fn = std::move(fn)]() mutable {
+        openDbThreadConnection();
+        promise->addResult(fn());
+        promise->finish();
+    }, Qt::QueuedConnection);
+    return future;
+}
+
+Q_DECLARE_METATYPE(DataManager::TaskChange)
+
 #endif // DATAMANAGER_H
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include "gorillacodec.h"
+#include <bit>
+#include <cstring>
+
+namespace {
+
+/**
+ * @brief 按位写入 (高位在前)
+ */
+class BitWriter
+{
+public:
+    explicit BitWriter(int reserveBytes) { m_buffer.reserve(reserveBytes); }
+
+    void write(quint64 value, int bits)
+    {
+        while (bits > 0) {
+            const int take = qMin(64 - m_accBits, bits);
+            const quint64 part = (value >> (bits - take)) & mask(take);
+            m_acc = (take == 64 ? 0 : (m_acc << take)) | part;
+            m_accBits += take;
+            bits -= take;
+            if (m_accBits == 64) {
+                emitBytes(8);
+                m_acc = 0;
+                m_accBits = 0;
+            }
+        }
+    }
+
+    QByteArray finish()
+    {
+        if (m_accBits > 0) {
+            m_acc <<= (64 - m_accBits);
+            emitBytes((m_accBits + 7) / 8);
+            m_acc = 0;
+            m_accBits = 0;
+        }
+        return m_buffer;
+    }
+
+private:
+    static quint64 mask(int bits) { return bits >= 64 ? ~quint64(0) : ((quint64(1) << bits) - 1); }
+
+    void emitBytes(int n)
+    {
+        char bytes[8];
+        for (int i = 0; i < n; ++i) {
+            bytes[i] = char(m_acc >> (56 - 8 * i));
+        }
+        m_buffer.append(bytes, n);
+    }
+
+    QByteArray m_buffer;
+    quint64 m_acc = 0;
+    int m_accBits = 0;
+};
+
+/**
+ * @brief 按位读取 (高位在前)，越界后 ok() 返回 false
+ */
+class BitReader
+{
+public:
+    BitReader(const uchar *data, qint64 size) : m_data(data), m_size(size) {}
+
+    quint64 read(int bits)
+    {
+        quint64 value = 0;
+        while (bits > 0) {
+            if (m_bytePos >= m_size) {
+                m_ok = false;
+                return 0;
+            }
+            const int avail = 8 - m_bitOffset;
+            const int take = qMin(avail, bits);
+            const quint64 part = (m_data[m_bytePos] >> (avail - take)) & ((1u << take) - 1);
+            value = (value << take) | part;
+            bits -= take;
+            m_bitOffset += take;
+            if (m_bitOffset == 8) {
+                m_bitOffset = 0;
+                ++m_bytePos;
+            }
+        }
+        return value;
+    }
+
+    bool readBit() { return read(1) != 0; }
+    bool ok() const { return m_ok; }
+
+private:
+    const uchar *m_data;
+    qint64 m_size;
+    qint64 m_bytePos = 0;
+    int m_bitOffset = 0;
+    bool m_ok = true;
+};
+
+quint64 zigzag(qint64 v) { return (quint64(v) << 1) ^ quint64(v >> 63); }
+qint64 unzigzag(quint64 z) { return qint64(z >> 1) ^ -qint64(z & 1); }
+
+quint64 doubleBits(double v)
+{
+    quint64 bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(quint64 bits)
+{
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+// delta-of-delta 分档: 前缀位数、前缀值、数据位数
+struct DodBucket { int prefixBits; quint64 prefix; int valueBits; };
+constexpr DodBucket kDodBuckets[] = {
+    {2, 0b10, 8},
+    {3, 0b110, 14},
+    {4, 0b1110, 20},
+    {4, 0b1111, 64},
+};
+
+void encodeTimestamps(BitWriter &w, const qint64 *t, int count)
+{
+    w.write(quint64(t[0]), 64);
+    if (count < 2) return;
+
+    qint64 prevDelta = t[1] - t[0];
+    w.write(quint64(prevDelta), 64);
+
+    for (int i = 2; i < count; ++i) {
+        const qint64 delta = t[i] - t[i - 1];
+        const quint64 zz = zigzag(delta - prevDelta);
+        prevDelta = delta;
+
+        if (zz == 0) {
+            w.write(0, 1);
+            continue;
+        }
+        for (const DodBucket &b : kDodBuckets) {
+            if (b.valueBits == 64 || zz < (quint64(1) << b.valueBits)) {
+                w.write(b.prefix, b.prefixBits);
+                w.write(zz, b.valueBits);
+                break;
+            }
+        }
+    }
+}
+
+bool decodeTimestamps(BitReader &r, qint64 *t, int count)
+{
+    t[0] = qint64(r.read(64));
+    if (count < 2) return r.ok();
+
+    qint64 prevDelta = qint64(r.read(64));
+    t[1] = t[0] + prevDelta;
+
+    for (int i = 2; i < count && r.ok(); ++i) {
+        qint64 dod = 0;
+        if (r.readBit()) {
+            // 依次读取前缀中的 1，确定分档
+            int ones = 1;
+            while (ones < 4 && r.readBit()) ++ones;
+            const DodBucket &b = kDodBuckets[ones - 1];
+            dod = unzigzag(r.read(b.valueBits));
+        }
+        prevDelta += dod;
+        t[i] = t[i - 1] + prevDelta;
+    }
+    return r.ok();
+}
+
+void encodeValues(BitWriter &w, const double *v, int count)
+{
+    quint64 prev = doubleBits(v[0]);
+    w.write(prev, 64);
+
+    int prevLead = -1;
+    int prevTrail = 0;
+    for (int i = 1; i < count; ++i) {
+        const quint64 cur = doubleBits(v[i]);
+        const quint64 x = cur ^ prev;
+        prev = cur;
+
+        if (x == 0) {
+            w.write(0, 1);
+            continue;
+        }
+        w.write(1, 1);
+
+        const int lead = qMin(std::countl_zero(x), 31);
+        const int trail = std::countr_zero(x);
+        if (prevLead >= 0 && lead >= prevLead && trail >= prevTrail) {
+            // 有效位落在上一个窗口内，复用窗口
+            w.write(0, 1);
+            w.write(x >> prevTrail, 64 - prevLead - prevTrail);
+        } else {
+            const int len = 64 - lead - trail;
+            w.write(1, 1);
+            w.write(quint64(lead), 5);
+            w.write(quint64(len - 1), 6);
+            w.write(x >> trail, len);
+            prevLead = lead;
+            prevTrail = trail;
+        }
+    }
+}
+
+bool decodeValues(BitReader &r, double *v, int count)
+{
+    quint64 prev = r.read(64);
+    v[0] = bitsDouble(prev);
+
+    int prevLead = 0;
+    int prevTrail = 0;
+    for (int i = 1; i < count && r.ok(); ++i) {
+        if (r.readBit()) {
+            if (r.readBit()) {
+                prevLead = int(r.read(5));
+                const int len = int(r.read(6)) + 1;
+                prevTrail = 64 - prevLead - len;
+                if (prevTrail < 0) return false;
+            }
+            const int len = 64 - prevLead - prevTrail;
+            prev ^= r.read(len) << prevTrail;
+        }
+        v[i] = bitsDouble(prev);
+    }
+    return r.ok();
+}
+
+void encodeStatus(BitWriter &w, const quint8 *s, int count)
+{
+    w.write(s[0], 8);
+    for (int i = 1; i < count; ++i) {
+        if (s[i] == s[i - 1]) {
+            w.write(0, 1);
+        } else {
+            w.write(1, 1);
+            w.write(s[i], 8);
+        }
+    }
+}
+
+bool decodeStatus(BitReader &r, quint8 *s, int count)
+{
+    s[0] = quint8(r.read(8));
+    for (int i = 1; i < count && r.ok(); ++i) {
+        s[i] = r.readBit() ? quint8(r.read(8)) : s[i - 1];
+    }
+    return r.ok();
+}
+
+} // namespace
+
+QByteArray GorillaCodec::encode(const qint64 *t, const double *position, const double *speed,
+                                const quint8 *status, int count)
+{
+    if (count <= 0) return QByteArray();
+
+    // 平稳数据通常压到 2~4 字节/样本，按 1/4 原始大小预留
+    BitWriter w(count * kRawSampleBytes / 4 + 32);
+    encodeTimestamps(w, t, count);
+    encodeValues(w, position, count);
+    encodeValues(w, speed, count);
+    encodeStatus(w, status, count);
+    return w.finish();
+}
+
+bool GorillaCodec::decode(const uchar *data, qint64 size, int count,
+                          qint64 *t, double *position, double *speed, quint8 *status)
+{
+    if (count <= 0) return true;
+
+    BitReader r(data, size);
+    return decodeTimestamps(r, t, count)
+        && decodeValues(r, position, count)
+        && decodeValues(r, speed, count)
+        && decodeStatus(r, status, count);
+}
@@ -0,0 +1,40 @@
+#ifndef GORILLACODEC_H
+#define GORILLACODEC_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief 运动采样流压缩编码 (Gorilla 风格)
+ *
+ * 推杆的位置/速度变化平滑、采样间隔近似恒定，适合按以下方式编码：
+ * - 时间戳: 首值 + 首个增量原样存放，其后存增量的增量 (delta-of-delta)，
+ *           按 zigzag 后的大小分 0/8/14/20/64 位几档变长编码；
+ * - 位置/速度: 与前一值按位异或，只存有效位 (前导零/尾随零窗口可复用)；
+ * - 状态: 与前一值相同记 1 位，否则 1 位标志 + 8 位新值。
+ *
+ * 四列依次写入同一个位流，解码时需要给出样本数。
+ */
+class GorillaCodec
+{
+public:
+    /**
+     * @brief 编码一组采样
+     */
+    static QByteArray encode(const qint64 *t, const double *position, const double *speed,
+                             const quint8 *status, int count);
+
+    /**
+     * @brief 解码一组采样，输出数组需预先分配 count 个元素
+     * @return false 数据不完整或损坏
+     */
+    static bool decode(const uchar *data, qint64 size, int count,
+                       qint64 *t, double *position, double *speed, quint8 *status);
+
+    /**
+     * @brief 未压缩时每个样本占用的字节数 (t + position + speed + status)
+     */
+    static constexpr int kRawSampleBytes = 8 + 8 + 8 + 1;
+};
+
+#endif // GORILLACODEC_H
@@ -0,0 +1,297 @@
+#include "motionlogexporter.h"
+#include "samplestore.h"
+#include "sqliteconfig.h"
+#include "../utils/logger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QThread>
+#include <QtConcurrent>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief 带缓冲的 CSV 输出 (时间文本按秒缓存，避免逐行格式化日期)
+ */
+class CsvSink
+{
+public:
+    static constexpr int kBufferBytes = 1 << 20;
+
+    explicit CsvSink(QFile &file) : m_file(file)
+    {
+        m_buffer.reserve(kBufferBytes + 256);
+        m_buffer.append("\xEF\xBB\xBF"); // BOM，防止 Excel 中文乱码
+        m_buffer.append("task_id,timestamp,position,speed,status\n");
+    }
+
+    bool append(const QByteArray &taskId, qint64 tUs, double position, double speed, int status)
+    {
+        const qint64 ms = tUs / 1000;
+        const qint64 sec = ms / 1000;
+        if (sec != m_lastSec) {
+            m_lastSec = sec;
+            m_secText = QDateTime::fromSecsSinceEpoch(sec).toString("yyyy-MM-dd HH:mm:ss").toUtf8();
+        }
+        const int milli = int(ms % 1000);
+
+        m_buffer.append(taskId).append(',').append(m_secText).append('.');
+        if (milli < 100) m_buffer.append('0');
+        if (milli < 10) m_buffer.append('0');
+        m_buffer.append(QByteArray::number(milli)).append(',');
+        m_buffer.append(QByteArray::number(position, 'f', 3)).append(',');
+        m_buffer.append(QByteArray::number(speed, 'f', 3)).append(',');
+        m_buffer.append(QByteArray::number(status)).append('\n');
+
+        return m_buffer.size() < kBufferBytes || flush();
+    }
+
+    bool flush()
+    {
+        if (m_buffer.isEmpty()) return true;
+        const bool ok = m_file.write(m_buffer) == m_buffer.size();
+        m_buffer.clear();
+        return ok;
+    }
+
+private:
+    QFile &m_file;
+    QByteArray m_buffer;
+    qint64 m_lastSec = std::numeric_limits<qint64>::min();
+    QByteArray m_secText;
+};
+
+} // namespace
+
+MotionLogExporter::MotionLogExporter(QObject *parent)
+    : QObject(parent)
+{
+    m_progressTimer.setInterval(200);
+    connect(&m_progressTimer, &QTimer::timeout, this, &MotionLogExporter::emitProgress);
+    connect(&m_watcher, &QFutureWatcher<TaskResult>::resultReadyAt, this, &MotionLogExporter::onTaskFinished);
+    connect(&m_watcher, &QFutureWatcher<TaskResult>::finished, this, &MotionLogExporter::onAllFinished);
+}
+
+MotionLogExporter::~MotionLogExporter()
+{
+    m_cancel.store(true);
+    m_watcher.cancel();
+    m_watcher.waitForFinished();
+    m_pool.waitForDone();
+}
+
+bool MotionLogExporter::start(const Options &options)
+{
+    if (m_running) return false;
+
+    m_options = options;
+    m_result = Result();
+    m_tasksDone = 0;
+    m_rowsTotal = 0;
+    m_rowsDone.store(0);
+    m_cancel.store(false);
+    m_running = true;
+    m_elapsed.start();
+    m_pool.setMaxThreadCount(qBound(1, options.maxThreads, QThread::idealThreadCount()));
+
+    LOG_INFO << "开始导出 " << options.taskIds.size() << " 个任务的运动日志到 " << options.outputDir;
+
+    // 先在线程池中估算总行数，再并行导出各任务
+    QtConcurrent::run(&m_pool, [this]() { return estimateRows(); }).then(this, [this](qint64 total) {
+        m_rowsTotal = total;
+        if (m_cancel.load()) {
+            m_result.canceled = true;
+            onAllFinished();
+            return;
+        }
+        m_watcher.setFuture(QtConcurrent::mapped(&m_pool, m_options.taskIds, [this](const int &taskId) {
+            return exportTask(taskId);
+        }));
+        m_progressTimer.start();
+        emitProgress();
+    });
+    return true;
+}
+
+void MotionLogExporter::cancel()
+{
+    if (!m_running) return;
+    m_cancel.store(true);
+    m_watcher.cancel();
+}
+
+/**
+ * @brief 由 TaskStats 估算总行数 (只用于进度显示)
+ */
+qint64 MotionLogExporter::estimateRows()
+{
+    const QString connName = QString("ExportEstimate_%1").arg((quint64)QThread::currentThreadId());
+    qint64 total = 0;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connName);
+        db.setDatabaseName(m_options.dbPath);
+        SqliteConfig::prepare(db, SqliteConfig::Role::ReadOnly);
+        if (db.open()) {
+            QStringList ids;
+            ids.reserve(m_options.taskIds.size());
+            for (int taskId : std::as_const(m_options.taskIds)) ids << QString::number(taskId);
+
+            QSqlQuery query(db);
+            if (query.exec(QString("SELECT SUM(samples) FROM TaskStats WHERE task_id IN (%1)").arg(ids.join(',')))
+                && query.next()) {
+                total = query.value(0).toLongLong();
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connName);
+    return total;
+}
+
+/**
+ * @brief 导出单个任务 (工作线程中执行，使用独立的只读连接)
+ */
+MotionLogExporter::TaskResult MotionLogExporter::exportTask(int taskId)
+{
+    TaskResult result;
+    result.taskId = taskId;
+    if (m_cancel.load()) {
+        result.error = "已取消";
+        return result;
+    }
+
+    const QString connName = QString("Export_%1_%2").arg(taskId).arg((quint64)QThread::currentThreadId());
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connName);
+        db.setDatabaseName(m_options.dbPath);
+        SqliteConfig::prepare(db, SqliteConfig::Role::ReadOnly);
+        if (!db.open()) {
+            result.error = "打开数据库失败: " + db.lastError().text();
+        } else {
+            SqliteConfig::applyPragmas(db, SqliteConfig::Role::ReadOnly);
+        }
+
+        QFile file(QDir(m_options.outputDir).filePath(QString("task_%1.csv").arg(taskId)));
+        if (result.error.isEmpty() && !file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            result.error = "无法写入文件: " + file.errorString();
+        }
+
+        if (result.error.isEmpty()) {
+            CsvSink sink(file);
+            const QByteArray taskText = QByteArray::number(taskId);
+            bool writeOk = true;
+
+            QSqlQuery query(db);
+            query.prepare("SELECT sample_file FROM DetectionTask WHERE id = :tid");
+            query.bindValue(":tid", taskId);
+            QString sampleFile;
+            if (query.exec() && query.next()) sampleFile = query.value(0).toString();
+            query.finish();
+
+            if (!sampleFile.isEmpty()) {
+                // 列式采样文件：逐块解码
+                SampleStore::Reader reader;
+                const QString path = QFileInfo(m_options.dbPath).dir().filePath(sampleFile);
+                QString error;
+                if (!reader.open(path, &error)) {
+                    result.error = error;
+                } else {
+                    SampleStore::Columns samples;
+                    for (const SampleStore::ChunkInfo &chunk : reader.chunks()) {
+                        if (m_cancel.load() || !writeOk) break;
+                        samples.clear();
+                        if (!reader.readChunk(chunk, samples)) {
+                            result.error = "读取采样文件失败: " + path;
+                            break;
+                        }
+                        for (int i = 0; i < samples.size() && writeOk; ++i) {
+                            writeOk = sink.append(taskText, samples.t[i], samples.position[i],
+                                                  samples.speed[i], samples.status[i]);
+                        }
+                        result.rows += samples.size();
+                        m_rowsDone.fetch_add(samples.size(), std::memory_order_relaxed);
+                    }
+                }
+            } else {
+                // MotionLog：按主键分段读取，每段从上一段的最后时间之后开始
+                query.setForwardOnly(true);
+                query.prepare("SELECT t, position, speed, status FROM MotionLog "
+                              "WHERE task_id = :tid AND t > :after ORDER BY t LIMIT :limit");
+                qint64 after = std::numeric_limits<qint64>::min();
+                while (!m_cancel.load() && writeOk) {
+                    query.bindValue(":tid", taskId);
+                    query.bindValue(":after", after);
+                    query.bindValue(":limit", m_options.chunkRows);
+                    if (!query.exec()) {
+                        result.error = "读取运动日志失败: " + query.lastError().text();
+                        break;
+                    }
+                    int n = 0;
+                    while (query.next() && writeOk) {
+                        after = query.value(0).toLongLong();
+                        writeOk = sink.append(taskText, after, query.value(1).toDouble(),
+                                              query.value(2).toDouble(), query.value(3).toInt());
+                        ++n;
+                    }
+                    query.finish();
+                    result.rows += n;
+                    m_rowsDone.fetch_add(n, std::memory_order_relaxed);
+                    if (n < m_options.chunkRows) break;
+                }
+            }
+
+            if (result.error.isEmpty() && !(writeOk && sink.flush())) {
+                result.error = "写入文件失败: " + file.errorString();
+            }
+            file.close();
+
+            if (result.error.isEmpty() && m_cancel.load()) {
+                result.error = "已取消";
+            } else if (result.error.isEmpty() && result.rows == 0) {
+                result.error = "没有运动日志数据";
+            }
+            if (!result.error.isEmpty()) {
+                file.remove();
+            }
+        }
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connName);
+    return result;
+}
+
+void MotionLogExporter::onTaskFinished(int index)
+{
+    const TaskResult r = m_watcher.resultAt(index);
+    ++m_tasksDone;
+    if (r.error.isEmpty()) {
+        m_result.files++;
+        m_result.rows += r.rows;
+    } else if (!m_cancel.load()) {
+        m_result.failed << QString("任务 %1: %2").arg(r.taskId).arg(r.error);
+    }
+}
+
+void MotionLogExporter::onAllFinished()
+{
+    m_progressTimer.stop();
+    emitProgress();
+
+    m_result.canceled = m_cancel.load();
+    m_result.elapsedMs = m_elapsed.elapsed();
+    m_running = false;
+    LOG_INFO << "运动日志导出" << (m_result.canceled ? "已取消" : "完成") << ": " << m_result.files << " 个文件, "
+             << m_result.rows << " 行, 耗时 " << m_result.elapsedMs << " ms";
+    emit finished(m_result);
+}
+
+void MotionLogExporter::emitProgress()
+{
+    emit progress(m_rowsDone.load(std::memory_order_relaxed), m_rowsTotal,
+                  m_tasksDone, m_options.taskIds.size());
+}
@@ -0,0 +1,100 @@
+#ifndef MOTIONLOGEXPORTER_H
+#define MOTIONLOGEXPORTER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QStringList>
+#include <QThreadPool>
+#include <QTimer>
+#include <atomic>
+
+/**
+ * @brief 运动日志流式导出
+ *
+ * 每个任务导出为一个 CSV 文件，各任务在线程池中并行导出 (QtConcurrent::mapped)：
+ *   - 每个工作线程使用自己的只读连接，按 (task_id, t) 主键分段读取 (每段 chunkRows 行)，
+ *     列式采样文件则按数据块读取，内存占用与任务大小无关；
+ *   - 输出先格式化到缓冲区，满 1 MB 再写文件；
+ *   - 进度由原子计数器汇总，UI 线程定时读取，不逐行跨线程发信号；
+ *   - cancel() 后未开始的任务不再执行，进行中的任务在下一段读取前停止并删除未完成的文件。
+ *
+ * 对象本身在 UI 线程中使用，信号也在 UI 线程发出。
+ */
+class MotionLogExporter : public QObject
+{
+    Q_OBJECT
+public:
+    struct Options {
+        QString dbPath;             ///< 数据库文件 (采样文件相对其所在目录)
+        QString outputDir;          ///< 输出目录，文件名为 task_<id>.csv
+        QList<int> taskIds;
+        int chunkRows = 20000;      ///< 每段读取的行数
+        int maxThreads = 4;         ///< 并行导出的任务数上限
+    };
+
+    struct Result {
+        int files = 0;              ///< 成功导出的文件数
+        qint64 rows = 0;
+        QStringList failed;         ///< 失败任务及原因
+        bool canceled = false;
+        qint64 elapsedMs = 0;
+    };
+
+    explicit MotionLogExporter(QObject *parent = nullptr);
+    ~MotionLogExporter();
+
+    /**
+     * @brief 开始导出 (立即返回)
+     * @return false 已有导出在进行
+     */
+    bool start(const Options &options);
+
+    /**
+     * @brief 取消导出 (结果通过 finished 返回，canceled = true)
+     */
+    void cancel();
+
+    bool isRunning() const { return m_running; }
+
+signals:
+    /**
+     * @brief 导出进度 (约每 200 ms 一次)
+     * @param rowsTotal 预计总行数 (来自 TaskStats，未知时为 0)
+     */
+    void progress(qint64 rowsDone, qint64 rowsTotal, int tasksDone, int tasksTotal);
+
+    void finished(const MotionLogExporter::Result &result);
+
+private:
+    /**
+     * @brief 单个任务的导出结果 (工作线程返回)
+     */
+    struct TaskResult {
+        int taskId = 0;
+        qint64 rows = 0;
+        QString error;              ///< 为空表示成功
+    };
+
+    TaskResult exportTask(int taskId);
+    qint64 estimateRows();
+    void onTaskFinished(int index);
+    void onAllFinished();
+    void emitProgress();
+
+    Options m_options;
+    QThreadPool m_pool;
+    QFutureWatcher<TaskResult> m_watcher;
+    QTimer m_progressTimer;
+    QElapsedTimer m_elapsed;
+    bool m_running = false;
+    Result m_result;
+    int m_tasksDone = 0;
+    qint64 m_rowsTotal = 0;
+    std::atomic<qint64> m_rowsDone {0};
+    std::atomic<bool> m_cancel {false};
+};
+
+Q_DECLARE_METATYPE(MotionLogExporter::Result)
+
+#endif // MOTIONLOGEXPORTER_H
@@ -0,0 +1,549 @@
+#include "motionlogwriter.h"
+#include "../utils/logger.h"
+#include "sqliteconfig.h"
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QDir>
+#include <QVariant>
+
+MotionLogWriter::MotionLogWriter(const QString &dbPath, int queueCapacity, QObject *parent)
+    : QObject(parent)
+    , m_queue(queueCapacity)
+    , m_dbPath(dbPath)
+    , m_connName(QString("MotionLogWriter_%1").arg(reinterpret_cast<quintptr>(this)))
+    , m_retention(m_connName)
+{
+}
+
+MotionLogWriter::~MotionLogWriter()
+{
+    if (m_running.load()) {
+        LOG_WARN << "MotionLogWriter 未调用 stop() 即被销毁，可能丢失未提交的记录";
+    }
+}
+
+void MotionLogWriter::setBatchPolicy(int batchSize, int flushIntervalMs)
+{
+    m_batchSize = qMax(1, batchSize);
+    m_flushIntervalMs = qMax(1, flushIntervalMs);
+}
+
+void MotionLogWriter::setEngine(Engine engine, const QString &dataDir)
+{
+    m_engine = engine;
+    m_dataDir = dataDir;
+}
+
+void MotionLogWriter::setRetentionPolicy(const RetentionJob::Policy &policy)
+{
+    QMutexLocker locker(&m_statsMutex);
+    m_retentionPolicy = policy;
+}
+
+void MotionLogWriter::startRetention()
+{
+    if (!m_running.load()) return;
+    RetentionJob::Policy policy;
+    {
+        QMutexLocker locker(&m_statsMutex);
+        policy = m_retentionPolicy;
+    }
+    m_retention.setActiveTask(m_taskStats.taskId);
+    m_retention.start(policy);
+}
+
+bool MotionLogWriter::enqueue(const Record &record)
+{
+    if (!m_queue.tryPush(record)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+MotionLogWriter::Stats MotionLogWriter::stats() const
+{
+    QMutexLocker locker(&m_statsMutex);
+    Stats s = m_stats;
+    s.rowsDropped = m_dropped.load(std::memory_order_relaxed);
+    s.backlog = m_queue.sizeApprox() + m_pending;
+    return s;
+}
+
+void MotionLogWriter::start()
+{
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connName);
+    db.setDatabaseName(m_dbPath);
+    SqliteConfig::prepare(db, SqliteConfig::Role::Writer);
+    if (!db.open()) {
+        LOG_ERR << "日志写入线程打开数据库失败: " << db.lastError().text();
+        return;
+    }
+    SqliteConfig::applyPragmas(db, SqliteConfig::Role::Writer);
+
+    m_insert = std::make_unique<QSqlQuery>(db);
+    if (!m_insert->prepare("INSERT INTO MotionLog (task_id, t, position, speed, status) "
+                           "VALUES (?, ?, ?, ?, ?)")) {
+        LOG_ERR << "日志写入语句预编译失败: " << m_insert->lastError().text();
+        m_insert.reset();
+        return;
+    }
+
+    // 降采样金字塔：同一个桶可能分多次写入 (例如程序重启)，用 upsert 合并
+    m_rollupUpsert = std::make_unique<QSqlQuery>(db);
+    if (!m_rollupUpsert->prepare("INSERT INTO MotionRollup (task_id, level, bucket, n, pos_min, pos_max, pos_sum, "
+                                 "spd_min, spd_max, spd_sum) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?) "
+                                 "ON CONFLICT(task_id, level, bucket) DO UPDATE SET "
+                                 "n = n + excluded.n, "
+                                 "pos_min = min(pos_min, excluded.pos_min), pos_max = max(pos_max, excluded.pos_max), "
+                                 "pos_sum = pos_sum + excluded.pos_sum, "
+                                 "spd_min = min(spd_min, excluded.spd_min), spd_max = max(spd_max, excluded.spd_max), "
+                                 "spd_sum = spd_sum + excluded.spd_sum")) {
+        LOG_WARN << "降采样写入语句预编译失败，不维护 MotionRollup: " << m_rollupUpsert->lastError().text();
+        m_rollupUpsert.reset();
+    }
+    m_rollupTimer.start();
+
+    m_timer = new QTimer(this);
+    m_timer->setInterval(20);
+    connect(m_timer, &QTimer::timeout, this, &MotionLogWriter::drain);
+    m_timer->start();
+
+    m_rateTimer.start();
+    m_checkpointTimer.start();
+    m_running.store(true, std::memory_order_release);
+    LOG_INFO << "运动日志写入线程已启动: 批量=" << m_batchSize << " 行, 最长 " << m_flushIntervalMs << " ms 提交一次"
+             << (m_engine == Engine::Columnar ? ", 任务数据写入列式采样文件" : "");
+}
+
+void MotionLogWriter::stop()
+{
+    if (!m_running.load()) return;
+
+    if (m_timer) m_timer->stop();
+    drain();
+    if (m_inTransaction) commitBatch();
+    closeSampleFile();
+
+    // 未满的桶也写入，重启后同一桶的数据通过 upsert 合并
+    m_rollup.closeAll(m_closedBuckets);
+    if (!m_closedBuckets.isEmpty() || m_taskStatsDirty || !m_finishedTaskStats.isEmpty()) {
+        QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+        db.transaction();
+        writeRollups();
+        writeTaskStats();
+        db.commit();
+    }
+    emitSamplesAppended();
+    m_running.store(false, std::memory_order_release);
+
+    // 退出前把 WAL 全部合并回主库并截断
+    checkpoint("TRUNCATE");
+
+    m_insert.reset();
+    m_rollupUpsert.reset();
+    {
+        QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(m_connName);
+
+    const Stats s = stats();
+    LOG_INFO << "运动日志写入线程已停止: 共写入 " << s.rowsWritten << " 行, 丢弃 " << s.rowsDropped
+             << " 行, 提交 " << s.commits << " 次, 平均提交耗时 " << s.avgCommitMs << " ms";
+}
+
+/**
+ * @brief 取出队列中的记录并写入当前事务
+ */
+void MotionLogWriter::drain()
+{
+    if (!m_insert) return;
+
+    Record record;
+    while (m_queue.tryPop(record)) {
+        // 时间戳严格递增，避免同一微秒的两帧主键冲突
+        const qint64 t = qMax(record.timestampUs, m_lastTimestampUs + 1);
+        m_lastTimestampUs = t;
+
+        if (m_engine == Engine::Columnar && record.taskId > 0) {
+            if (appendSample(record, t)) {
+                accumulateRecord(record, t);
+            }
+            continue;
+        }
+
+        if (!m_inTransaction) {
+            QSqlDatabase::database(m_connName, false).transaction();
+            m_inTransaction = true;
+            m_batchTimer.start();
+        }
+
+        m_insert->bindValue(0, record.taskId == -1 ? 0 : record.taskId);
+        m_insert->bindValue(1, t);
+        m_insert->bindValue(2, record.position);
+        m_insert->bindValue(3, record.speed);
+        m_insert->bindValue(4, record.status);
+        if (!m_insert->exec()) {
+            LOG_WARN << "写入运动日志失败: " << m_insert->lastError().text();
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        accumulateRecord(record, t);
+
+        if (++m_pending >= m_batchSize) {
+            commitBatch();
+        }
+    }
+
+    if (m_inTransaction && m_batchTimer.elapsed() >= m_flushIntervalMs) {
+        commitBatch();
+    }
+
+    // 列式引擎下没有 MotionLog 事务可搭车，攒够一批或每秒单独提交一次
+    const bool rollupsDue = !m_closedBuckets.isEmpty()
+        && (m_closedBuckets.size() >= 64 || m_rollupTimer.elapsed() >= 1000);
+    const bool statsDue = (m_taskStatsDirty || !m_finishedTaskStats.isEmpty())
+        && m_rollupTimer.elapsed() >= 1000;
+    if (!m_inTransaction && (rollupsDue || statsDue)) {
+        QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+        db.transaction();
+        writeRollups();
+        writeTaskStats();
+        if (!db.commit()) {
+            LOG_WARN << "降采样数据提交失败: " << db.lastError().text();
+            db.rollback();
+        }
+    }
+
+    if (m_sampleWriter.isOpen() && m_sampleFlushTimer.elapsed() >= m_sampleFlushIntervalMs) {
+        m_sampleWriter.flush();
+        m_sampleFlushTimer.restart();
+    }
+
+    // 过期清理与检查点只在队列已清空、没有未提交事务时执行，不占用写入路径
+    if (!m_inTransaction && m_queue.sizeApprox() == 0) {
+        if (m_retention.isRunning()) {
+            stepRetention();
+        } else if (m_checkpointTimer.elapsed() >= m_checkpointIntervalMs) {
+            checkpoint("PASSIVE");
+        }
+    }
+
+    updateRate();
+}
+
+/**
+ * @brief 已写入的记录计入降采样金字塔和任务统计 (写入失败、被丢弃的记录不计入)
+ */
+void MotionLogWriter::accumulateRecord(const Record &record, qint64 t)
+{
+    if (record.taskId <= 0) return;
+    if (m_rollupUpsert) {
+        m_rollup.add(record.taskId, t, record.position, record.speed, m_closedBuckets);
+    }
+    accumulateTaskStats(record, t);
+}
+
+/**
+ * @brief 写入列式采样文件，任务切换时关闭旧文件、打开新文件
+ * @return false 写入失败，记录按丢弃统计
+ */
+bool MotionLogWriter::appendSample(const Record &record, qint64 t)
+{
+    if (record.taskId != m_sampleTaskId && !openSampleFile(record.taskId)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    SampleStore::Sample sample;
+    sample.t = t;
+    sample.position = record.position;
+    sample.speed = record.speed;
+    sample.status = quint8(record.status);
+    if (!m_sampleWriter.append(sample)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    QMutexLocker locker(&m_statsMutex);
+    m_stats.samplesWritten++;
+    return true;
+}
+
+bool MotionLogWriter::openSampleFile(int taskId)
+{
+    closeSampleFile();
+
+    const QString path = SampleStore::fileForTask(m_dataDir, taskId);
+    QString error;
+    if (!m_sampleWriter.open(path, &error)) {
+        LOG_ERR << "打开采样文件失败: " << path << " " << error;
+        return false;
+    }
+    m_sampleTaskId = taskId;
+    m_sampleFlushTimer.start();
+
+    // 在任务表中登记文件 (相对数据目录)，读取端据此定位
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    query.prepare("UPDATE DetectionTask SET sample_file = :file WHERE id = :tid");
+    query.bindValue(":file", QDir(m_dataDir).relativeFilePath(path));
+    query.bindValue(":tid", taskId);
+    if (!query.exec()) {
+        LOG_WARN << "登记采样文件失败: " << query.lastError().text();
+    } else {
+        emit sampleFileRegistered(taskId);
+    }
+
+    LOG_INFO << "任务 " << taskId << " 采样写入文件: " << path
+             << " (已有 " << m_sampleWriter.sampleCount() << " 个样本)";
+    return true;
+}
+
+void MotionLogWriter::closeSampleFile()
+{
+    if (m_sampleWriter.isOpen()) {
+        const qint64 samples = m_sampleWriter.sampleCount();
+        if (m_sampleWriter.close()) {
+            LOG_INFO << "任务 " << m_sampleTaskId << " 采样文件已关闭: " << samples << " 个样本, 压缩比 "
+                     << QString::number(m_sampleWriter.compressionRatio(), 'f', 1) << ":1";
+        } else {
+            LOG_ERR << "关闭采样文件失败: " << m_sampleWriter.path();
+        }
+    }
+    m_sampleTaskId = -1;
+}
+
+/**
+ * @brief 执行 WAL 检查点
+ * @param mode PASSIVE (不等待读者) 或 TRUNCATE (退出时)
+ */
+void MotionLogWriter::checkpoint(const char *mode)
+{
+    m_checkpointTimer.restart();
+
+    QElapsedTimer timer;
+    timer.start();
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    if (!query.exec(QString("PRAGMA wal_checkpoint(%1)").arg(QLatin1String(mode)))) {
+        LOG_WARN << "WAL 检查点失败: " << query.lastError().text();
+        return;
+    }
+    const double elapsedMs = timer.nsecsElapsed() / 1e6;
+
+    // 返回 (busy, WAL 总页数, 已写回页数)
+    int walPages = 0;
+    int checkpointedPages = 0;
+    if (query.next()) {
+        walPages = query.value(1).toInt();
+        checkpointedPages = query.value(2).toInt();
+    }
+
+    QMutexLocker locker(&m_statsMutex);
+    m_stats.checkpoints++;
+    m_stats.lastCheckpointMs = elapsedMs;
+    m_stats.walPages = walPages;
+    if (walPages > 0 && checkpointedPages < walPages) {
+        // 有读者持有旧快照，未能全部写回，下次再试
+        LOG_INFO << "WAL 检查点部分完成: " << checkpointedPages << "/" << walPages << " 页";
+    }
+}
+
+/**
+ * @brief 执行一步过期清理，并更新进度统计
+ */
+void MotionLogWriter::stepRetention()
+{
+    m_retention.setActiveTask(m_taskStats.taskId);
+    const bool more = m_retention.step();
+    const RetentionJob::Progress progress = m_retention.progress();
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.retention = progress;
+    }
+    if (!more) {
+        // 删除大量数据后 WAL 较大，立即合并一次
+        checkpoint("PASSIVE");
+        emit retentionFinished(progress);
+    }
+}
+
+/**
+ * @brief 写入已结束的时间桶 (调用方负责事务)
+ * 写入出错时未写入的桶保留到下次提交。
+ */
+void MotionLogWriter::writeRollups()
+{
+    m_rollupTimer.restart();
+    if (!m_rollupUpsert) {
+        m_closedBuckets.clear();
+        return;
+    }
+    int written = 0;
+    for (const MotionRollup::Bucket &b : std::as_const(m_closedBuckets)) {
+        m_rollupUpsert->bindValue(0, b.taskId);
+        m_rollupUpsert->bindValue(1, b.level);
+        m_rollupUpsert->bindValue(2, b.bucket);
+        m_rollupUpsert->bindValue(3, b.n);
+        m_rollupUpsert->bindValue(4, b.posMin);
+        m_rollupUpsert->bindValue(5, b.posMax);
+        m_rollupUpsert->bindValue(6, b.posSum);
+        m_rollupUpsert->bindValue(7, b.spdMin);
+        m_rollupUpsert->bindValue(8, b.spdMax);
+        m_rollupUpsert->bindValue(9, b.spdSum);
+        if (!m_rollupUpsert->exec()) {
+            LOG_WARN << "写入降采样数据失败: " << m_rollupUpsert->lastError().text();
+            break;
+        }
+        ++written;
+    }
+    m_closedBuckets.remove(0, written);
+}
+
+/**
+ * @brief 累加任务统计；任务切换时从数据库载入新任务已有的统计 (任务恢复后继续累加)
+ */
+void MotionLogWriter::accumulateTaskStats(const Record &record, qint64 t)
+{
+    if (record.taskId != m_taskStats.taskId) {
+        if (m_taskStatsDirty) {
+            m_finishedTaskStats.append(m_taskStats);
+        }
+        QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+        if (!TaskStats::load(db, record.taskId, m_taskStats)) {
+            m_taskStats = TaskStats();
+            m_taskStats.taskId = record.taskId;
+        }
+        m_taskStatsDirty = false;
+    }
+    m_taskStats.add(t, record.position, record.speed, record.status);
+    m_taskStatsDirty = true;
+}
+
+/**
+ * @brief 写入任务统计 (调用方负责事务)
+ */
+void MotionLogWriter::writeTaskStats()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+    QString error;
+    for (const TaskStats &stats : m_finishedTaskStats) {
+        if (!stats.save(db, &error)) {
+            LOG_WARN << "写入任务统计失败: " << error;
+        }
+        m_appendedTasks.insert(stats.taskId, stats.samples);
+    }
+    m_finishedTaskStats.clear();
+
+    if (m_taskStatsDirty) {
+        if (!m_taskStats.save(db, &error)) {
+            LOG_WARN << "写入任务统计失败: " << error;
+        }
+        m_appendedTasks.insert(m_taskStats.taskId, m_taskStats.samples);
+        m_taskStatsDirty = false;
+    }
+}
+
+TaskStats MotionLogWriter::flushTaskStats(int taskId)
+{
+    drain();
+    if (m_inTransaction) {
+        commitBatch();
+    } else if (m_taskStatsDirty || !m_finishedTaskStats.isEmpty()) {
+        QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+        db.transaction();
+        writeTaskStats();
+        if (!db.commit()) {
+            LOG_WARN << "任务统计提交失败: " << db.lastError().text();
+            db.rollback();
+        }
+    }
+
+    if (m_taskStats.taskId == taskId) return m_taskStats;
+    TaskStats stats;
+    QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+    TaskStats::load(db, taskId, stats);
+    stats.taskId = taskId;
+    return stats;
+}
+
+void MotionLogWriter::forgetTasks(const QList<int> &taskIds)
+{
+    drain();
+    if (m_inTransaction) {
+        commitBatch();
+    }
+
+    if (m_sampleWriter.isOpen() && taskIds.contains(m_sampleTaskId)) {
+        closeSampleFile();
+    }
+    if (taskIds.contains(m_taskStats.taskId)) {
+        m_taskStats = TaskStats();
+        m_taskStatsDirty = false;
+    }
+    m_finishedTaskStats.removeIf([&](const TaskStats &stats) { return taskIds.contains(stats.taskId); });
+    m_closedBuckets.removeIf([&](const MotionRollup::Bucket &b) { return taskIds.contains(b.taskId); });
+    for (int taskId : taskIds) {
+        m_rollup.discardTask(taskId);
+        m_appendedTasks.remove(taskId);
+    }
+}
+
+void MotionLogWriter::commitBatch()
+{
+    writeRollups();
+    writeTaskStats();
+
+    QElapsedTimer timer;
+    timer.start();
+    QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+    const bool committed = db.commit();
+    if (!committed) {
+        LOG_ERR << "运动日志批量提交失败: " << db.lastError().text() << ", 丢弃 " << m_pending << " 行";
+        db.rollback();
+        // 回滚的行不计入写入数，按丢弃统计
+        m_dropped.fetch_add(m_pending, std::memory_order_relaxed);
+    }
+    const double commitMs = timer.nsecsElapsed() / 1e6;
+
+    {
+        QMutexLocker locker(&m_statsMutex);
+        if (committed) m_stats.rowsWritten += m_pending;
+        m_stats.commits++;
+        m_stats.lastCommitMs = commitMs;
+        m_stats.maxCommitMs = qMax(m_stats.maxCommitMs, commitMs);
+        m_totalCommitMs += commitMs;
+        m_stats.avgCommitMs = m_totalCommitMs / m_stats.commits;
+    }
+
+    if (committed) m_rateRows += m_pending;
+    m_pending = 0;
+    m_inTransaction = false;
+}
+
+/**
+ * @brief 每秒更新一次写入速率并发出统计
+ */
+void MotionLogWriter::updateRate()
+{
+    const qint64 elapsed = m_rateTimer.elapsed();
+    if (elapsed < 1000) return;
+
+    {
+        QMutexLocker locker(&m_statsMutex);
+        m_stats.insertRate = m_rateRows * 1000.0 / elapsed;
+    }
+    m_rateRows = 0;
+    m_rateTimer.restart();
+
+    emit statsUpdated(stats());
+    emitSamplesAppended();
+}
+
+void MotionLogWriter::emitSamplesAppended()
+{
+    for (auto it = m_appendedTasks.cbegin(); it != m_appendedTasks.cend(); ++it) {
+        emit samplesAppended(it.key(), it.value());
+    }
+    m_appendedTasks.clear();
+}
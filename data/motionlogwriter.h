@@ -0,0 +1,235 @@
+#ifndef MOTIONLOGWRITER_H
+#define MOTIONLOGWRITER_H
+
+#include <QObject>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSqlQuery>
+#include <QTimer>
+#include <memory>
+#include "../utils/spscqueue.h"
+#include "samplestore.h"
+#include "motionrollup.h"
+#include "retentionjob.h"
+#include "taskstats.h"
+
+/**
+ * @brief 运动日志后台写入器
+ *
+ * 运行在独立的数据库线程中，持有自己的数据库连接。
+ * 生产者 (主线程) 通过 enqueue() 将记录放入无锁队列后立即返回；
+ * 写入线程定时取出记录，复用同一条预编译 INSERT 语句，
+ * 在一个事务中批量写入，达到批量大小或时间上限时提交。
+ * 数据库的 WAL 自动检查点已关闭，由本线程在队列空闲时执行 PASSIVE 检查点。
+ *
+ * 列式引擎 (Engine::Columnar) 下，关联任务的记录改写入该任务的采样文件
+ * (见 SampleStore)，文件路径登记到 DetectionTask.sample_file；无任务的记录仍写入 MotionLog。
+ *
+ * 两种引擎下都会同时增量维护 MotionRollup 降采样金字塔 (见 MotionRollup)
+ * 和 TaskStats 任务统计 (见 TaskStats)，随批量提交一起写入。
+ *
+ * 过期数据清理 (RetentionJob) 也在本线程执行：队列为空且没有未提交事务时每个周期只执行一步，
+ * 清理期间日志写入不受影响。
+ *
+ * 使用方式 (由 DataManager 管理)：
+ *   writer->moveToThread(&thread);
+ *   QMetaObject::invokeMethod(writer, "start", Qt::QueuedConnection);
+ *   writer->enqueue(record);
+ */
+class MotionLogWriter : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief 存储引擎
+     */
+    enum class Engine {
+        Sqlite,     ///< 全部写入 MotionLog 表
+        Columnar    ///< 任务数据写入列式采样文件
+    };
+
+    /**
+     * @brief 单条运动日志记录 (时间戳在采集时确定，而非写入时)
+     */
+    struct Record {
+        qint64 timestampUs = 0;   ///< 微秒时间戳 (UTC)
+        double position = 0.0;
+        double speed = 0.0;
+        int status = 0;
+        int taskId = -1;
+    };
+
+    /**
+     * @brief 写入统计
+     */
+    struct Stats {
+        quint64 rowsWritten = 0;    ///< 累计写入行数
+        quint64 rowsDropped = 0;    ///< 队列满或批量提交失败丢弃的行数
+        quint64 commits = 0;        ///< 累计提交次数
+        double insertRate = 0.0;    ///< 最近一秒写入速率 (行/秒)
+        double lastCommitMs = 0.0;  ///< 最近一次提交耗时
+        double maxCommitMs = 0.0;   ///< 最大提交耗时
+        double avgCommitMs = 0.0;   ///< 平均提交耗时
+        int backlog = 0;            ///< 队列中 + 未提交的行数
+        quint64 checkpoints = 0;    ///< WAL 检查点次数
+        double lastCheckpointMs = 0.0; ///< 最近一次检查点耗时
+        int walPages = 0;           ///< 最近一次检查点时 WAL 中的页数
+        quint64 samplesWritten = 0; ///< 写入列式采样文件的样本数
+        RetentionJob::Progress retention; ///< 过期数据清理进度
+    };
+
+    /**
+     * @param dbPath 数据库文件路径
+     * @param queueCapacity 队列容量 (行)
+     */
+    explicit MotionLogWriter(const QString &dbPath, int queueCapacity = 65536, QObject *parent = nullptr);
+    ~MotionLogWriter();
+
+    /**
+     * @brief 入队一条记录 (仅由一个生产者线程调用，无锁、不阻塞)
+     * @return false 队列已满，记录被丢弃
+     */
+    bool enqueue(const Record &record);
+
+    /**
+     * @brief 获取统计快照 (任意线程)
+     */
+    Stats stats() const;
+
+    /**
+     * @brief 批量提交参数 (需在 start() 之前设置)
+     * @param batchSize 累计多少行提交一次
+     * @param flushIntervalMs 事务最长持续时间
+     */
+    void setBatchPolicy(int batchSize, int flushIntervalMs);
+
+    /**
+     * @brief 选择存储引擎 (需在 start() 之前设置)
+     * @param dataDir 数据目录，采样文件存放在其 samples/ 子目录，数据库中记录相对路径
+     */
+    void setEngine(Engine engine, const QString &dataDir);
+
+    /**
+     * @brief 设置数据保留策略 (任意线程，下次 startRetention() 时生效)
+     */
+    void setRetentionPolicy(const RetentionJob::Policy &policy);
+
+    /**
+     * @brief 写完队列中已有的记录并提交，返回任务的最新统计
+     * 仅在写入线程中调用 (DataManager 通过 invokeMethod 投递)。
+     */
+    TaskStats flushTaskStats(int taskId);
+
+    /**
+     * @brief 任务即将被删除：写完队列中已有的记录，关闭其采样文件并丢弃其统计与降采样状态
+     * 之后不会再为这些任务写入 TaskStats/MotionRollup。仅在写入线程中调用。
+     */
+    void forgetTasks(const QList<int> &taskIds);
+
+    /**
+     * @brief 写入线程是否已就绪
+     */
+    bool isRunning() const { return m_running.load(std::memory_order_acquire); }
+
+public slots:
+    /**
+     * @brief 在写入线程中打开连接并开始定时写入
+     */
+    void start();
+
+    /**
+     * @brief 写完队列中剩余的记录、提交并关闭连接
+     */
+    void stop();
+
+    /**
+     * @brief 按当前策略开始一轮过期数据清理 (在写入线程中分步执行)
+     */
+    void startRetention();
+
+signals:
+    /**
+     * @brief 每秒发出一次统计
+     */
+    void statsUpdated(const MotionLogWriter::Stats &stats);
+
+    /**
+     * @brief 一轮过期数据清理结束
+     */
+    void retentionFinished(const RetentionJob::Progress &progress);
+
+    /**
+     * @brief 任务有新采样写入 (随统计每秒最多一次)
+     * @param samples 该任务累计采样数
+     */
+    void samplesAppended(int taskId, qint64 samples);
+
+    /**
+     * @brief 任务的列式采样文件已登记到 DetectionTask.sample_file
+     */
+    void sampleFileRegistered(int taskId);
+
+private slots:
+    void drain();
+
+private:
+    void commitBatch();
+    void checkpoint(const char *mode);
+    void updateRate();
+    void emitSamplesAppended();
+    bool appendSample(const Record &record, qint64 t);
+    void accumulateRecord(const Record &record, qint64 t);
+    bool openSampleFile(int taskId);
+    void closeSampleFile();
+    void writeRollups();
+    void accumulateTaskStats(const Record &record, qint64 t);
+    void writeTaskStats();
+    void stepRetention();
+
+    SpscQueue<Record> m_queue;
+    QString m_dbPath;
+    QString m_connName;
+    std::unique_ptr<QSqlQuery> m_insert;
+    std::unique_ptr<QSqlQuery> m_rollupUpsert;
+    QTimer *m_timer = nullptr;
+    std::atomic<bool> m_running {false};
+
+    int m_batchSize = 256;
+    int m_flushIntervalMs = 200;
+    std::atomic<int> m_pending {0}; ///< 当前事务中未提交的行数
+    bool m_inTransaction = false;
+    QElapsedTimer m_batchTimer;
+    qint64 m_lastTimestampUs = 0;   ///< 保证 (task_id, t) 主键唯一、时间严格递增
+
+    Engine m_engine = Engine::Sqlite;
+    QString m_dataDir;
+    SampleStore::Writer m_sampleWriter;
+    int m_sampleTaskId = -1;             ///< 当前打开的采样文件所属任务
+    int m_sampleFlushIntervalMs = 5000;  ///< 未满的块最长驻留内存时间
+    QElapsedTimer m_sampleFlushTimer;
+
+    MotionRollup::Accumulator m_rollup;
+    QVector<MotionRollup::Bucket> m_closedBuckets;  ///< 已结束、待写入的时间桶
+    QElapsedTimer m_rollupTimer;
+
+    TaskStats m_taskStats;                      ///< 当前任务的累加状态
+    bool m_taskStatsDirty = false;
+    QVector<TaskStats> m_finishedTaskStats;     ///< 任务切换后待写入的上一任务统计
+    QHash<int, qint64> m_appendedTasks;         ///< 上次通知后有新采样写入的任务 -> 累计采样数
+
+    RetentionJob m_retention;
+    RetentionJob::Policy m_retentionPolicy;     ///< 受 m_statsMutex 保护
+
+    int m_checkpointIntervalMs = 10000; ///< 空闲检查点最小间隔
+    QElapsedTimer m_checkpointTimer;
+
+    std::atomic<quint64> m_dropped {0};
+    mutable QMutex m_statsMutex;
+    Stats m_stats;
+    double m_totalCommitMs = 0.0;
+    quint64 m_rateRows = 0;
+    QElapsedTimer m_rateTimer;
+};
+
+#endif // MOTIONLOGWRITER_H
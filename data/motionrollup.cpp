@@ -0,0 +1,175 @@
+#include "motionrollup.h"
+#include <QtMath>
+
+void MotionRollup::Bucket::add(double position, double speed)
+{
+    if (n == 0) {
+        posMin = posMax = position;
+        spdMin = spdMax = speed;
+    } else {
+        posMin = qMin(posMin, position);
+        posMax = qMax(posMax, position);
+        spdMin = qMin(spdMin, speed);
+        spdMax = qMax(spdMax, speed);
+    }
+    posSum += position;
+    spdSum += speed;
+    ++n;
+}
+
+void MotionRollup::Accumulator::add(int taskId, qint64 t, double position, double speed,
+                                    QVector<Bucket> &closed)
+{
+    for (int level = 0; level < kLevelCount; ++level) {
+        const qint64 bucket = t / kBucketUs[level];
+        Bucket &open = m_open[level];
+        if (m_active[level] && (open.taskId != taskId || open.bucket != bucket)) {
+            closed.append(open);
+            m_active[level] = false;
+        }
+        if (!m_active[level]) {
+            open = Bucket();
+            open.taskId = taskId;
+            open.level = level;
+            open.bucket = bucket;
+            m_active[level] = true;
+        }
+        open.add(position, speed);
+    }
+}
+
+void MotionRollup::Accumulator::closeAll(QVector<Bucket> &closed)
+{
+    for (int level = 0; level < kLevelCount; ++level) {
+        if (m_active[level]) {
+            closed.append(m_open[level]);
+            m_active[level] = false;
+        }
+    }
+}
+
+void MotionRollup::Accumulator::discardTask(int taskId)
+{
+    for (int level = 0; level < kLevelCount; ++level) {
+        if (m_active[level] && m_open[level].taskId == taskId) {
+            m_active[level] = false;
+        }
+    }
+}
+
+void MotionRollup::Series::reserve(int n)
+{
+    t.reserve(n);
+    posMin.reserve(n);
+    posMax.reserve(n);
+    posAvg.reserve(n);
+    spdMin.reserve(n);
+    spdMax.reserve(n);
+    spdAvg.reserve(n);
+}
+
+void MotionRollup::Series::appendPoint(qint64 time, double position, double speed)
+{
+    t.append(time);
+    posMin.append(position);
+    posMax.append(position);
+    posAvg.append(position);
+    spdMin.append(speed);
+    spdMax.append(speed);
+    spdAvg.append(speed);
+}
+
+void MotionRollup::Series::appendBucket(qint64 time, const Bucket &b)
+{
+    t.append(time);
+    posMin.append(b.posMin);
+    posMax.append(b.posMax);
+    posAvg.append(b.n > 0 ? b.posSum / b.n : 0.0);
+    spdMin.append(b.spdMin);
+    spdMax.append(b.spdMax);
+    spdAvg.append(b.n > 0 ? b.spdSum / b.n : 0.0);
+}
+
+int MotionRollup::chooseLevel(qint64 windowUs, int pixelWidth)
+{
+    const qint64 usPerPixel = windowUs / qMax(1, pixelWidth);
+    int chosen = -1;
+    for (int level = 0; level < kLevelCount; ++level) {
+        if (kBucketUs[level] <= usPerPixel) chosen = level;
+    }
+    return chosen;
+}
+
+/**
+ * @brief LTTB 降采样
+ * 首尾两点固定保留；中间按等宽分桶，每桶选出与"上一选中点、下一桶均值"
+ * 构成三角形面积最大的点。
+ */
+QVector<int> MotionRollup::lttb(const QVector<qint64> &t, const QVector<double> &y, int threshold)
+{
+    const int n = qMin(t.size(), y.size());
+    QVector<int> picked;
+    if (threshold >= n || threshold < 3) {
+        picked.reserve(n);
+        for (int i = 0; i < n; ++i) picked.append(i);
+        return picked;
+    }
+
+    picked.reserve(threshold);
+    picked.append(0);
+
+    const double every = double(n - 2) / double(threshold - 2);
+    const double t0 = double(t[0]); // 以首点为原点，避免微秒时间戳相乘丢失精度
+    int a = 0;
+    for (int i = 0; i < threshold - 2; ++i) {
+        // 下一桶均值
+        const int nextStart = int(std::floor((i + 1) * every)) + 1;
+        const int nextEnd = qMin(int(std::floor((i + 2) * every)) + 1, n);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (int j = nextStart; j < nextEnd; ++j) {
+            avgX += double(t[j]) - t0;
+            avgY += y[j];
+        }
+        const int nextCount = qMax(1, nextEnd - nextStart);
+        avgX /= nextCount;
+        avgY /= nextCount;
+
+        // 当前桶中面积最大的点
+        const int start = int(std::floor(i * every)) + 1;
+        const int end = int(std::floor((i + 1) * every)) + 1;
+        const double ax = double(t[a]) - t0;
+        const double ay = y[a];
+        double maxArea = -1.0;
+        int maxIndex = start;
+        for (int j = start; j < end; ++j) {
+            const double area = qAbs((ax - avgX) * (y[j] - ay) - (ax - (double(t[j]) - t0)) * (avgY - ay));
+            if (area > maxArea) {
+                maxArea = area;
+                maxIndex = j;
+            }
+        }
+        picked.append(maxIndex);
+        a = maxIndex;
+    }
+
+    picked.append(n - 1);
+    return picked;
+}
+
+MotionRollup::Series MotionRollup::pick(const Series &src, const QVector<int> &indices)
+{
+    Series out;
+    out.level = src.level;
+    out.reserve(indices.size());
+    for (int i : indices) {
+        out.t.append(src.t[i]);
+        out.posMin.append(src.posMin[i]);
+        out.posMax.append(src.posMax[i]);
+        out.posAvg.append(src.posAvg[i]);
+        out.spdMin.append(src.spdMin[i]);
+        out.spdMax.append(src.spdMax[i]);
+        out.spdAvg.append(src.spdAvg[i]);
+    }
+    return out;
+}
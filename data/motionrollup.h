@@ -0,0 +1,101 @@
+#ifndef MOTIONROLLUP_H
+#define MOTIONROLLUP_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief 运动数据降采样金字塔
+ *
+ * 按固定时间桶 (100 ms / 1 s) 统计每个任务位置、速度的 min/max/sum/n，
+ * 写入 MotionRollup 表 (task_id, level, bucket) 聚簇存放。
+ * 绘制长时间扫描曲线时按时间窗口和像素宽度选择合适的层级，
+ * 读取的点数只与像素宽度有关，与扫描时长无关。
+ *
+ * 另提供 LTTB (Largest-Triangle-Three-Buckets) 降采样，保留曲线形状。
+ */
+class MotionRollup
+{
+public:
+    static constexpr int kLevelCount = 2;
+    static constexpr qint64 kBucketUs[kLevelCount] = { 100000, 1000000 }; ///< 各层桶宽 (微秒)
+
+    /**
+     * @brief 一个时间桶的统计
+     */
+    struct Bucket {
+        int taskId = 0;
+        int level = 0;
+        qint64 bucket = 0;      ///< 桶编号 = t / kBucketUs[level]
+        int n = 0;
+        double posMin = 0.0;
+        double posMax = 0.0;
+        double posSum = 0.0;
+        double spdMin = 0.0;
+        double spdMax = 0.0;
+        double spdSum = 0.0;
+
+        void add(double position, double speed);
+    };
+
+    /**
+     * @brief 增量累加器 (写入线程中逐条喂入，桶结束时产出)
+     */
+    class Accumulator
+    {
+    public:
+        /**
+         * @brief 累加一个采样；任务切换或跨桶时，已结束的桶追加到 closed
+         */
+        void add(int taskId, qint64 t, double position, double speed, QVector<Bucket> &closed);
+
+        /**
+         * @brief 结束所有未完成的桶 (停止写入时调用)
+         */
+        void closeAll(QVector<Bucket> &closed);
+
+        /**
+         * @brief 丢弃任务未完成的桶 (任务被删除时调用)
+         */
+        void discardTask(int taskId);
+
+    private:
+        Bucket m_open[kLevelCount];
+        bool m_active[kLevelCount] = {};
+    };
+
+    /**
+     * @brief 曲线数据 (每个点对应一个桶或一个原始采样)
+     */
+    struct Series {
+        int level = -1;             ///< -1 原始采样；0.. 金字塔层级；LTTB 时为其输入来源
+        bool lttb = false;
+        QVector<qint64> t;          ///< 桶起始时间或采样时间 (微秒)
+        QVector<double> posMin, posMax, posAvg;
+        QVector<double> spdMin, spdMax, spdAvg;
+
+        int size() const { return t.size(); }
+        void reserve(int n);
+        void appendPoint(qint64 time, double position, double speed);
+        void appendBucket(qint64 time, const Bucket &b);
+    };
+
+    /**
+     * @brief 为时间窗口和像素宽度选择层级
+     * 取桶宽不超过"每像素时长"的最粗层级；窗口很短时返回 -1 (直接读原始采样)。
+     */
+    static int chooseLevel(qint64 windowUs, int pixelWidth);
+
+    /**
+     * @brief LTTB 降采样 (以位置为纵轴)
+     * @return 选中点在输入中的下标 (递增，包含首尾)
+     */
+    static QVector<int> lttb(const QVector<qint64> &t, const QVector<double> &y, int threshold);
+
+    /**
+     * @brief 按下标抽取曲线点
+     */
+    static Series pick(const Series &src, const QVector<int> &indices);
+};
+
+#endif // MOTIONROLLUP_H
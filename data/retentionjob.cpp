@@ -0,0 +1,386 @@
+#include "retentionjob.h"
+#include "samplestore.h"
+#include "sqliteconfig.h"
+#include "../utils/logger.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStringList>
+#include <QVariant>
+
+QString RetentionJob::Progress::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Phase::Idle: return "空闲";
+    case Phase::ArchiveTasks: return "归档过期任务";
+    case Phase::DeleteLogs: return "删除过期日志";
+    case Phase::RemoveArchives: return "删除过期归档";
+    case Phase::DeleteTasks: return "删除过期任务";
+    case Phase::DeleteRollups: return "删除降采样数据";
+    case Phase::Vacuum: return "回收空闲页";
+    }
+    return QString();
+}
+
+RetentionJob::RetentionJob(const QString &connName)
+    : m_connName(connName)
+{
+}
+
+void RetentionJob::start(const Policy &policy)
+{
+    m_policy = policy;
+    m_policy.archiveDays = qMax(m_policy.archiveDays, m_policy.taskDays);
+
+    const QDateTime now = QDateTime::currentDateTime();
+    m_logCutoffUs = now.addDays(-m_policy.motionLogDays).toMSecsSinceEpoch() * 1000;
+    m_taskCutoff = now.addDays(-m_policy.taskDays);
+    m_archiveCutoff = now.addDays(-m_policy.archiveDays);
+    m_failedTasks.clear();
+    m_archiveQueue.clear();
+
+    m_progress = Progress();
+    m_progress.running = true;
+    m_progress.startedAtMs = now.toMSecsSinceEpoch();
+    m_progress.phase = Phase::ArchiveTasks;
+
+    // 待归档任务一次查出 (一般只有几个)，之后逐个处理
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    // 正在运行的任务还会写入新的日志，归档后这些日志不再被读取，留到任务结束后再归档
+    query.prepare(QString("SELECT DISTINCT m.task_id FROM MotionLog m "
+                          "JOIN DetectionTask d ON d.id = m.task_id "
+                          "WHERE m.t < :cutoff AND d.sample_file IS NULL%1")
+                      .arg(excludeRunningTasks()));
+    query.bindValue(":cutoff", m_logCutoffUs);
+    if (query.exec()) {
+        while (query.next()) m_archiveQueue.append(query.value(0).toInt());
+    } else {
+        LOG_ERR << "查询过期运动日志失败: " << query.lastError().text();
+    }
+
+    LOG_INFO << "数据保留任务开始: 日志保留 " << m_policy.motionLogDays << " 天, 任务保留 "
+             << m_policy.taskDays << " 天, 归档保留 " << m_policy.archiveDays << " 天, 待归档任务 "
+             << m_archiveQueue.size() << " 个";
+}
+
+bool RetentionJob::step()
+{
+    if (!m_progress.running) return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    bool more = false;
+    switch (m_progress.phase) {
+    case Phase::ArchiveTasks: more = stepArchiveTasks(); break;
+    case Phase::DeleteLogs: more = stepDeleteLogs(); break;
+    case Phase::RemoveArchives: more = stepRemoveArchives(); break;
+    case Phase::DeleteTasks: more = stepDeleteTasks(); break;
+    case Phase::DeleteRollups: more = stepDeleteRollups(); break;
+    case Phase::Vacuum: more = stepVacuum(); break;
+    case Phase::Idle: break;
+    }
+    if (!more) nextPhase();
+
+    const double ms = timer.nsecsElapsed() / 1e6;
+    m_progress.steps++;
+    m_progress.busyMs += ms;
+    m_progress.maxStepMs = qMax(m_progress.maxStepMs, ms);
+
+    if (!m_progress.running) {
+        m_progress.finishedAtMs = QDateTime::currentMSecsSinceEpoch();
+        LOG_INFO << "数据保留任务完成: 归档 " << m_progress.tasksArchived << " 个任务, 删除日志 "
+                 << m_progress.logRowsDeleted << " 行, 删除任务 " << m_progress.tasksDeleted
+                 << " 个, 删除文件 " << m_progress.filesRemoved << " 个, 回收 " << m_progress.pagesFreed
+                 << " 页; 共 " << m_progress.steps << " 步, 累计 " << m_progress.busyMs
+                 << " ms, 单步最长 " << m_progress.maxStepMs << " ms";
+    }
+    return m_progress.running;
+}
+
+void RetentionJob::nextPhase()
+{
+    switch (m_progress.phase) {
+    case Phase::ArchiveTasks: m_progress.phase = Phase::RemoveArchives; break;
+    case Phase::RemoveArchives: m_progress.phase = Phase::DeleteTasks; break;
+    case Phase::DeleteTasks: m_progress.phase = Phase::DeleteLogs; break;
+    case Phase::DeleteLogs: m_progress.phase = Phase::DeleteRollups; break;
+    case Phase::DeleteRollups: m_progress.phase = Phase::Vacuum; break;
+    case Phase::Vacuum:
+    case Phase::Idle:
+        m_progress.phase = Phase::Idle;
+        m_progress.running = false;
+        break;
+    }
+}
+
+/**
+ * @brief 每步归档一个任务
+ */
+bool RetentionJob::stepArchiveTasks()
+{
+    if (m_archiveQueue.isEmpty()) return false;
+    const int taskId = m_archiveQueue.takeFirst();
+    if (isTaskRunning(taskId)) {
+        // 开始本轮清理后任务被恢复执行
+        LOG_INFO << "任务 " << taskId << " 正在运行，本轮不归档";
+        m_failedTasks.insert(taskId);
+    } else if (archiveTask(taskId)) {
+        m_progress.tasksArchived++;
+        m_progress.archivedTaskIds.append(taskId);
+    } else {
+        m_failedTasks.insert(taskId);
+    }
+    return !m_archiveQueue.isEmpty();
+}
+
+/**
+ * @brief 任务是否正在运行 (写入线程正在记录，或状态为 running)
+ */
+bool RetentionJob::isTaskRunning(int taskId)
+{
+    if (taskId == m_activeTaskId) return true;
+
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    query.prepare("SELECT status FROM DetectionTask WHERE id = :tid");
+    query.bindValue(":tid", taskId);
+    return query.exec() && query.next() && query.value(0).toString() == "running";
+}
+
+/**
+ * @brief 排除正在运行任务的 SQL 条件 (DetectionTask 别名为 d)
+ */
+QString RetentionJob::excludeRunningTasks() const
+{
+    QString condition = " AND (d.status IS NULL OR d.status <> 'running')";
+    if (m_activeTaskId > 0) condition += QString(" AND d.id <> %1").arg(m_activeTaskId);
+    return condition;
+}
+
+/**
+ * @brief 将任务在 MotionLog 中的全部数据写入压缩采样文件并登记
+ * 表中的行留给 DeleteLogs 阶段按块删除 (已归档任务的过期行)。
+ * 只处理 sample_file 为空的任务：已存在的同名文件是之前登记失败的残留，重新生成而不是追加。
+ */
+bool RetentionJob::archiveTask(int taskId)
+{
+    const QString path = SampleStore::fileForTask(m_policy.dataDir, taskId);
+    if (QFile::exists(path)) {
+        LOG_WARN << "归档任务 " << taskId << ": 删除未登记的采样文件后重新归档 " << path;
+        if (!QFile::remove(path)) {
+            LOG_ERR << "归档任务 " << taskId << " 失败: 无法删除 " << path;
+            return false;
+        }
+    }
+
+    SampleStore::Writer writer;
+    QString error;
+    if (!writer.open(path, &error)) {
+        LOG_ERR << "归档任务 " << taskId << " 失败: " << error;
+        return false;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT t, position, speed, status FROM MotionLog WHERE task_id = :tid ORDER BY t");
+    query.bindValue(":tid", taskId);
+    if (!query.exec()) {
+        LOG_ERR << "归档任务 " << taskId << " 读取失败: " << query.lastError().text();
+        writer.close();
+        return false;
+    }
+    bool ok = true;
+    while (ok && query.next()) {
+        SampleStore::Sample sample;
+        sample.t = query.value(0).toLongLong();
+        sample.position = query.value(1).toDouble();
+        sample.speed = query.value(2).toDouble();
+        sample.status = quint8(query.value(3).toInt());
+        ok = writer.append(sample);
+    }
+    query.finish();
+    const qint64 archived = writer.sampleCount();
+    ok = writer.close() && ok;
+    if (!ok) {
+        LOG_ERR << "归档任务 " << taskId << " 写入采样文件失败，保留数据库中的记录";
+        return false;
+    }
+
+    query.prepare("UPDATE DetectionTask SET sample_file = :file WHERE id = :tid");
+    query.bindValue(":file", QDir(m_policy.dataDir).relativeFilePath(path));
+    query.bindValue(":tid", taskId);
+    if (!query.exec()) {
+        LOG_ERR << "归档任务 " << taskId << " 登记失败: " << query.lastError().text();
+        return false;
+    }
+
+    LOG_INFO << "已归档任务 " << taskId << ": " << archived << " 条运动日志, 压缩比 "
+             << QString::number(writer.compressionRatio(), 'f', 1) << ":1";
+    return true;
+}
+
+/**
+ * @brief 按块删除过期日志：无任务关联、任务已删除、或任务已归档
+ */
+bool RetentionJob::stepDeleteLogs()
+{
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    query.prepare("DELETE FROM MotionLog WHERE (task_id, t) IN ("
+                  "SELECT m.task_id, m.t FROM MotionLog m "
+                  "LEFT JOIN DetectionTask d ON d.id = m.task_id "
+                  "WHERE m.t < :cutoff AND (d.id IS NULL OR d.sample_file IS NOT NULL) "
+                  "LIMIT :limit)");
+    query.bindValue(":cutoff", m_logCutoffUs);
+    query.bindValue(":limit", m_policy.chunkRows);
+    if (!query.exec()) {
+        LOG_ERR << "清理 MotionLog 失败: " << query.lastError().text();
+        return false;
+    }
+    const int deleted = query.numRowsAffected();
+    m_progress.logRowsDeleted += quint64(qMax(0, deleted));
+    return deleted >= m_policy.chunkRows;
+}
+
+/**
+ * @brief 删除超过归档保留期的任务 (含采样文件)
+ */
+bool RetentionJob::stepRemoveArchives()
+{
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    query.prepare(QString("SELECT d.id, d.sample_file FROM DetectionTask d "
+                          "WHERE d.start_time < :cutoff%1 LIMIT :limit").arg(excludeRunningTasks()));
+    query.bindValue(":cutoff", m_archiveCutoff);
+    query.bindValue(":limit", 50);
+    if (!query.exec()) {
+        LOG_ERR << "查询过期归档失败: " << query.lastError().text();
+        return false;
+    }
+
+    QVector<int> taskIds;
+    QStringList ids;
+    QStringList files;
+    while (query.next()) {
+        taskIds.append(query.value(0).toInt());
+        ids << QString::number(taskIds.last());
+        files << query.value(1).toString();
+    }
+    if (ids.isEmpty()) return false;
+
+    // 任务记录删除成功后才删除文件，避免记录指向已不存在的文件
+    if (!query.exec(QString("DELETE FROM DetectionTask WHERE id IN (%1)").arg(ids.join(",")))) {
+        LOG_ERR << "删除过期归档任务失败: " << query.lastError().text();
+        return false;
+    }
+    m_progress.tasksDeleted += quint64(qMax(0, query.numRowsAffected()));
+    m_progress.deletedTaskIds += taskIds;
+    for (const QString &file : std::as_const(files)) removeSampleFile(file);
+    return ids.size() >= 50;
+}
+
+/**
+ * @brief 删除超过保留期、未归档的任务记录 (归档失败的任务保留)
+ */
+bool RetentionJob::stepDeleteTasks()
+{
+    QString exclude;
+    if (!m_failedTasks.isEmpty()) {
+        QStringList ids;
+        for (int id : std::as_const(m_failedTasks)) ids << QString::number(id);
+        exclude = QString(" AND d.id NOT IN (%1)").arg(ids.join(","));
+    }
+    exclude += excludeRunningTasks();
+
+    // 先查出本块的任务ID (界面据此移除对应行)，再按ID删除
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    query.prepare(QString("SELECT d.id FROM DetectionTask d WHERE d.start_time < :cutoff "
+                          "AND d.sample_file IS NULL%1 LIMIT :limit").arg(exclude));
+    query.bindValue(":cutoff", m_taskCutoff);
+    query.bindValue(":limit", m_policy.chunkRows);
+    if (!query.exec()) {
+        LOG_ERR << "查询过期任务失败: " << query.lastError().text();
+        return false;
+    }
+    QVector<int> taskIds;
+    QStringList ids;
+    while (query.next()) {
+        taskIds.append(query.value(0).toInt());
+        ids << QString::number(taskIds.last());
+    }
+    if (ids.isEmpty()) return false;
+
+    if (!query.exec(QString("DELETE FROM DetectionTask WHERE id IN (%1)").arg(ids.join(",")))) {
+        LOG_ERR << "清理 DetectionTask 失败: " << query.lastError().text();
+        return false;
+    }
+    m_progress.tasksDeleted += quint64(qMax(0, query.numRowsAffected()));
+    m_progress.deletedTaskIds += taskIds;
+    return ids.size() >= m_policy.chunkRows;
+}
+
+bool RetentionJob::stepDeleteRollups()
+{
+    QSqlQuery query(QSqlDatabase::database(m_connName, false));
+    query.prepare("DELETE FROM MotionRollup WHERE (task_id, level, bucket) IN ("
+                  "SELECT r.task_id, r.level, r.bucket FROM MotionRollup r "
+                  "LEFT JOIN DetectionTask d ON d.id = r.task_id WHERE d.id IS NULL LIMIT :limit)");
+    query.bindValue(":limit", m_policy.chunkRows);
+    if (!query.exec()) {
+        LOG_ERR << "清理 MotionRollup 失败: " << query.lastError().text();
+        return false;
+    }
+    const int deleted = query.numRowsAffected();
+    m_progress.rollupRowsDeleted += quint64(qMax(0, deleted));
+    if (deleted >= m_policy.chunkRows) return true;
+
+    // 任务统计每个任务只有一行，一次删完
+    if (!query.exec("DELETE FROM TaskStats WHERE task_id NOT IN (SELECT id FROM DetectionTask)")) {
+        LOG_WARN << "清理 TaskStats 失败: " << query.lastError().text();
+    }
+    return false;
+}
+
+/**
+ * @brief 分批归还空闲页 (需 auto_vacuum=INCREMENTAL)
+ * 已有数据的库首次执行时先 VACUUM 一次切换为增量回收 (VACUUM 同时归还全部空闲页)。
+ */
+bool RetentionJob::stepVacuum()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+    if (!SqliteConfig::convertToIncrementalVacuum(db)) return false;
+
+    QSqlQuery query(db);
+    auto freelist = [&query]() {
+        return (query.exec("PRAGMA freelist_count") && query.next()) ? query.value(0).toInt() : 0;
+    };
+
+    const int before = freelist();
+    if (before <= 0) {
+        m_progress.freelistPages = 0;
+        return false;
+    }
+    if (!query.exec(QString("PRAGMA incremental_vacuum(%1)").arg(m_policy.vacuumPages))) {
+        LOG_WARN << "incremental_vacuum 失败: " << query.lastError().text();
+        return false;
+    }
+    query.finish();
+    const int after = freelist();
+    m_progress.freelistPages = after;
+    if (after >= before) return false;  // 未启用增量回收 (auto_vacuum 不是 INCREMENTAL)
+    m_progress.pagesFreed += quint64(before - after);
+    return after > 0;
+}
+
+void RetentionJob::removeSampleFile(const QString &sampleFile)
+{
+    if (sampleFile.isEmpty()) return;
+    const QString path = QDir(m_policy.dataDir).filePath(sampleFile);
+    if (!QFile::exists(path)) return;
+    if (QFile::remove(path)) {
+        m_progress.filesRemoved++;
+    } else {
+        LOG_WARN << "删除采样文件失败: " << path;
+    }
+}
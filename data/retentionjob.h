@@ -0,0 +1,125 @@
+#ifndef RETENTIONJOB_H
+#define RETENTIONJOB_H
+
+#include <QDateTime>
+#include <QList>
+#include <QMetaType>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 数据保留 (过期清理) 任务
+ *
+ * 由日志写入线程在空闲时逐步执行：每次 step() 只处理有限的行数/任务数，
+ * 两次 step() 之间写入线程照常处理日志队列，不会长时间占用数据库写锁。
+ *
+ * 执行阶段依次为：
+ *   1. ArchiveTasks   - 含过期日志的任务归档为压缩采样文件 (每步一个任务)
+ *   2. RemoveArchives - 删除超过归档保留期的采样文件及其任务记录
+ *   3. DeleteTasks    - 删除超过保留期、未归档的任务记录
+ *   4. DeleteLogs     - 删除已归档、无任务关联或任务已删除的过期日志
+ *   5. DeleteRollups  - 删除已删除任务的降采样数据与任务统计
+ *   6. Vacuum         - PRAGMA incremental_vacuum 分批归还空闲页
+ *                       (旧库首次执行时先 VACUUM 切换为 auto_vacuum=INCREMENTAL)
+ */
+class RetentionJob
+{
+public:
+    /**
+     * @brief 各表的保留策略
+     */
+    struct Policy {
+        QString dataDir;            ///< 采样文件所在的数据目录
+        int motionLogDays = 30;     ///< MotionLog 表保留天数
+        int taskDays = 30;          ///< 未归档任务 (DetectionTask) 保留天数
+        int archiveDays = 365;      ///< 已归档任务 (采样文件) 保留天数
+        int chunkRows = 2000;       ///< 每步最多删除的行数
+        int vacuumPages = 512;      ///< 每步最多归还的空闲页数
+    };
+
+    enum class Phase {
+        Idle,
+        ArchiveTasks,
+        RemoveArchives,
+        DeleteTasks,
+        DeleteLogs,
+        DeleteRollups,
+        Vacuum
+    };
+
+    /**
+     * @brief 进度统计
+     */
+    struct Progress {
+        Phase phase = Phase::Idle;
+        bool running = false;
+        int steps = 0;                  ///< 已执行的步数
+        quint64 tasksArchived = 0;
+        quint64 logRowsDeleted = 0;     ///< MotionLog 删除行数 (含归档后删除)
+        quint64 tasksDeleted = 0;
+        quint64 filesRemoved = 0;
+        QVector<int> archivedTaskIds;   ///< 本轮归档 (登记了 sample_file) 的任务
+        QVector<int> deletedTaskIds;    ///< 本轮删除的任务
+        quint64 rollupRowsDeleted = 0;
+        quint64 pagesFreed = 0;         ///< incremental_vacuum 归还的页数
+        int freelistPages = 0;          ///< 当前空闲页数
+        double busyMs = 0.0;            ///< 各步耗时合计
+        double maxStepMs = 0.0;         ///< 单步最长耗时
+        qint64 startedAtMs = 0;
+        qint64 finishedAtMs = 0;
+
+        static QString phaseName(Phase phase);
+    };
+
+    explicit RetentionJob(const QString &connName);
+
+    /**
+     * @brief 按策略开始一轮清理 (正在执行时重新开始)
+     */
+    void start(const Policy &policy);
+
+    bool isRunning() const { return m_progress.running; }
+
+    /**
+     * @brief 设置写入线程正在记录的任务 (每步之前由写入线程更新)
+     * 该任务以及状态为 running 的任务不归档、不删除。
+     */
+    void setActiveTask(int taskId) { m_activeTaskId = taskId; }
+
+    /**
+     * @brief 执行一步 (调用方负责在两步之间让出线程)
+     * @return true 本轮尚未结束
+     */
+    bool step();
+
+    const Progress &progress() const { return m_progress; }
+
+private:
+    bool stepArchiveTasks();
+    bool stepDeleteLogs();
+    bool stepRemoveArchives();
+    bool stepDeleteTasks();
+    bool stepDeleteRollups();
+    bool stepVacuum();
+
+    bool archiveTask(int taskId);
+    bool isTaskRunning(int taskId);
+    QString excludeRunningTasks() const;
+    void removeSampleFile(const QString &sampleFile);
+    void nextPhase();
+
+    QString m_connName;
+    Policy m_policy;
+    Progress m_progress;
+    qint64 m_logCutoffUs = 0;
+    QDateTime m_taskCutoff;
+    QDateTime m_archiveCutoff;
+    QList<int> m_archiveQueue;  ///< 待归档的任务 (进入 ArchiveTasks 阶段时一次查出)
+    QSet<int> m_failedTasks;    ///< 本轮归档失败或因正在运行而跳过的任务，保留其数据，下轮再试
+    int m_activeTaskId = -1;    ///< 写入线程正在记录的任务
+};
+
+Q_DECLARE_METATYPE(RetentionJob::Progress)
+
+#endif // RETENTIONJOB_H
@@ -0,0 +1,526 @@
+#include "samplestore.h"
+#include "gorillacodec.h"
+#include "../utils/logger.h"
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+// 文件按小端存放，列数据直接 memcpy，不做逐元素字节序转换
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "SampleStore 仅支持小端平台");
+
+namespace {
+
+constexpr quint32 kFileMagic = 0x53535045;   // "EPSS"
+constexpr quint32 kChunkMagic = 0x4B4E4843;  // "CHNK"
+constexpr quint32 kFooterMagic = 0x46535045; // "EPSF"
+constexpr quint32 kVersion = 2;
+
+constexpr qint64 kFileHeaderSize = 16;
+constexpr qint64 kChunkHeaderSizeV1 = 24;
+constexpr qint64 kChunkHeaderSize = 32;
+constexpr qint64 kIndexEntrySize = 32;
+constexpr qint64 kTrailerSize = 16;
+
+qint64 align8(qint64 n) { return (n + 7) & ~qint64(7); }
+
+qint64 chunkHeaderSize(quint32 version)
+{
+    return version >= 2 ? kChunkHeaderSize : kChunkHeaderSizeV1;
+}
+
+template <typename T>
+T readLE(const uchar *p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template <typename T>
+void putLE(QByteArray &buf, T v)
+{
+    buf.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+void setError(QString *error, const QString &msg)
+{
+    if (error) *error = msg;
+}
+
+/**
+ * @brief 解析 offset 处的块头
+ * @return 整块占用的字节数 (含块头与对齐填充)，块头无效或块不完整时返回 -1
+ */
+qint64 readChunkHeader(const uchar *data, qint64 size, qint64 offset, quint32 version,
+                       SampleStore::ChunkInfo &c)
+{
+    const qint64 headerSize = chunkHeaderSize(version);
+    if (offset < kFileHeaderSize || offset + headerSize > size) return -1;
+
+    const uchar *p = data + offset;
+    if (readLE<quint32>(p) != kChunkMagic) return -1;
+
+    c.offset = quint64(offset);
+    c.count = readLE<quint32>(p + 4);
+    c.tMin = readLE<qint64>(p + 8);
+    c.tMax = readLE<qint64>(p + 16);
+    if (version >= 2) {
+        c.payloadBytes = readLE<quint32>(p + 24);
+        c.codec = SampleStore::Codec(readLE<quint32>(p + 28));
+    } else {
+        c.payloadBytes = c.count * GorillaCodec::kRawSampleBytes;
+        c.codec = SampleStore::Codec::Raw;
+    }
+
+    if (c.count == 0) return -1;
+    if (c.codec == SampleStore::Codec::Raw && c.payloadBytes != c.count * quint32(GorillaCodec::kRawSampleBytes)) return -1;
+    if (c.codec != SampleStore::Codec::Raw && c.codec != SampleStore::Codec::Gorilla) return -1;
+
+    const qint64 bytes = headerSize + align8(c.payloadBytes);
+    return offset + bytes <= size ? bytes : -1;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Columns
+// ---------------------------------------------------------------------------
+
+void SampleStore::Columns::clear()
+{
+    t.clear();
+    position.clear();
+    speed.clear();
+    status.clear();
+}
+
+void SampleStore::Columns::reserve(int n)
+{
+    t.reserve(n);
+    position.reserve(n);
+    speed.reserve(n);
+    status.reserve(n);
+}
+
+void SampleStore::Columns::append(const Sample &s)
+{
+    t.append(s.t);
+    position.append(s.position);
+    speed.append(s.speed);
+    status.append(s.status);
+}
+
+// ---------------------------------------------------------------------------
+// 索引解析
+// ---------------------------------------------------------------------------
+
+bool SampleStore::parseIndex(const uchar *data, qint64 size, QVector<ChunkInfo> &index,
+                             quint32 *version, qint64 *validEnd, QString *error)
+{
+    index.clear();
+    if (validEnd) *validEnd = kFileHeaderSize;
+
+    if (size < kFileHeaderSize || readLE<quint32>(data) != kFileMagic) {
+        setError(error, "不是采样文件");
+        return false;
+    }
+    const quint32 fileVersion = readLE<quint32>(data + 4);
+    if (fileVersion < 1 || fileVersion > kVersion) {
+        setError(error, QString("不支持的采样文件版本: %1").arg(fileVersion));
+        return false;
+    }
+    if (version) *version = fileVersion;
+
+    // 1. 完整文件：读取文件尾的块索引，再校验各块头
+    if (size >= kFileHeaderSize + kTrailerSize
+        && readLE<quint32>(data + size - 4) == kFooterMagic) {
+        const quint64 indexOffset = readLE<quint64>(data + size - kTrailerSize);
+        const quint32 chunkCount = readLE<quint32>(data + size - 8);
+        if (indexOffset >= quint64(kFileHeaderSize)
+            && indexOffset + quint64(chunkCount) * kIndexEntrySize == quint64(size - kTrailerSize)) {
+            index.reserve(chunkCount);
+            bool valid = true;
+            for (quint32 i = 0; i < chunkCount; ++i) {
+                const uchar *p = data + indexOffset + i * kIndexEntrySize;
+                ChunkInfo c;
+                const qint64 bytes = readChunkHeader(data, qint64(indexOffset), qint64(readLE<quint64>(p)),
+                                                     fileVersion, c);
+                if (bytes < 0) {
+                    valid = false;
+                    break;
+                }
+                index.append(c);
+            }
+            if (valid) {
+                if (validEnd) *validEnd = qint64(indexOffset);
+                return true;
+            }
+            index.clear();
+        }
+    }
+
+    // 2. 文件尾缺失 (异常退出)：按块头顺序扫描，丢弃最后不完整的块
+    qint64 offset = kFileHeaderSize;
+    ChunkInfo c;
+    qint64 bytes = 0;
+    while ((bytes = readChunkHeader(data, size, offset, fileVersion, c)) > 0) {
+        index.append(c);
+        offset += bytes;
+    }
+    if (validEnd) *validEnd = offset;
+    if (offset < size) {
+        LOG_WARN << "采样文件未正常关闭，已恢复 " << index.size() << " 个数据块，丢弃 "
+                 << (size - offset) << " 字节";
+    }
+    return true;
+}
+
+QString SampleStore::fileForTask(const QString &dataDir, int taskId)
+{
+    return QDir(dataDir).filePath(QString("samples/task_%1.eps").arg(taskId));
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+SampleStore::Writer::Writer(int chunkSamples, Codec codec)
+    : m_chunkSamples(qMax(16, chunkSamples))
+    , m_codec(codec)
+{
+    m_chunk.reserve(m_chunkSamples);
+}
+
+SampleStore::Writer::~Writer()
+{
+    if (isOpen()) close();
+}
+
+bool SampleStore::Writer::open(const QString &path, QString *error)
+{
+    if (isOpen()) close();
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    m_index.clear();
+    m_chunk.clear();
+    m_written = 0;
+    m_storedBytes = 0;
+
+    if (!m_file.open(QIODevice::ReadWrite)) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+
+    if (m_file.size() == 0) {
+        QByteArray header;
+        putLE<quint32>(header, kFileMagic);
+        putLE<quint32>(header, kVersion);
+        putLE<quint64>(header, 0);
+        if (m_file.write(header) != header.size()) {
+            setError(error, m_file.errorString());
+            m_file.close();
+            return false;
+        }
+        return true;
+    }
+
+    // 已有文件：恢复索引，截掉旧的索引和文件尾后继续追加
+    qint64 validEnd = 0;
+    quint32 version = 0;
+    uchar *data = m_file.map(0, m_file.size());
+    if (!data) {
+        setError(error, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    const bool ok = parseIndex(data, m_file.size(), m_index, &version, &validEnd, error);
+    m_file.unmap(data);
+    if (!ok) {
+        m_file.close();
+        return false;
+    }
+    if (version != kVersion) {
+        // 旧版本块头格式不同，不能混写
+        setError(error, QString("采样文件版本 %1 不支持追加写入").arg(version));
+        m_file.close();
+        m_index.clear();
+        return false;
+    }
+
+    for (const ChunkInfo &c : std::as_const(m_index)) {
+        m_written += c.count;
+        m_storedBytes += c.payloadBytes;
+    }
+    if (!m_file.resize(validEnd) || !m_file.seek(validEnd)) {
+        setError(error, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool SampleStore::Writer::append(const Sample &sample)
+{
+    if (!isOpen()) return false;
+    m_chunk.append(sample);
+    if (m_chunk.size() >= m_chunkSamples) {
+        return writeChunk();
+    }
+    return true;
+}
+
+bool SampleStore::Writer::flush()
+{
+    if (!isOpen()) return false;
+    if (!m_chunk.isEmpty() && !writeChunk()) return false;
+    return m_file.flush();
+}
+
+bool SampleStore::Writer::writeChunk()
+{
+    const quint32 count = quint32(m_chunk.size());
+
+    ChunkInfo info;
+    info.count = count;
+    info.tMin = *std::min_element(m_chunk.t.cbegin(), m_chunk.t.cend());
+    info.tMax = *std::max_element(m_chunk.t.cbegin(), m_chunk.t.cend());
+    info.codec = m_codec;
+
+    QByteArray payload;
+    if (m_codec == Codec::Gorilla) {
+        payload = GorillaCodec::encode(m_chunk.t.constData(), m_chunk.position.constData(),
+                                       m_chunk.speed.constData(), m_chunk.status.constData(), int(count));
+    } else {
+        payload.reserve(int(count * GorillaCodec::kRawSampleBytes));
+        payload.append(reinterpret_cast<const char *>(m_chunk.t.constData()), count * sizeof(qint64));
+        payload.append(reinterpret_cast<const char *>(m_chunk.position.constData()), count * sizeof(double));
+        payload.append(reinterpret_cast<const char *>(m_chunk.speed.constData()), count * sizeof(double));
+        payload.append(reinterpret_cast<const char *>(m_chunk.status.constData()), count);
+    }
+    info.payloadBytes = quint32(payload.size());
+
+    if (!writeEncodedChunk(info, reinterpret_cast<const uchar *>(payload.constData()))) return false;
+    m_chunk.clear();
+    return true;
+}
+
+bool SampleStore::Writer::appendChunk(const ChunkInfo &chunk, const uchar *payload)
+{
+    if (!isOpen() || chunk.count == 0) return false;
+    if (chunk.codec != Codec::Raw && chunk.codec != Codec::Gorilla) return false;
+    if (chunk.codec == Codec::Raw && chunk.payloadBytes != chunk.count * quint32(GorillaCodec::kRawSampleBytes)) {
+        return false;
+    }
+    // 先写出未满的当前块，保证块按时间顺序排列
+    if (!m_chunk.isEmpty() && !writeChunk()) return false;
+    return writeEncodedChunk(chunk, payload);
+}
+
+bool SampleStore::Writer::writeEncodedChunk(ChunkInfo info, const uchar *payload)
+{
+    info.offset = quint64(m_file.pos());
+
+    QByteArray buf;
+    buf.reserve(int(kChunkHeaderSize + align8(info.payloadBytes)));
+    putLE<quint32>(buf, kChunkMagic);
+    putLE<quint32>(buf, info.count);
+    putLE<qint64>(buf, info.tMin);
+    putLE<qint64>(buf, info.tMax);
+    putLE<quint32>(buf, info.payloadBytes);
+    putLE<quint32>(buf, quint32(info.codec));
+    buf.append(reinterpret_cast<const char *>(payload), info.payloadBytes);
+    buf.append(int(align8(info.payloadBytes) - info.payloadBytes), '\0');
+
+    if (m_file.write(buf) != buf.size()) {
+        LOG_ERR << "写入采样文件失败: " << m_file.fileName() << " " << m_file.errorString();
+        return false;
+    }
+
+    m_index.append(info);
+    m_written += info.count;
+    m_storedBytes += info.payloadBytes;
+    return true;
+}
+
+double SampleStore::Writer::compressionRatio() const
+{
+    if (m_storedBytes <= 0) return 0.0;
+    return double(m_written) * GorillaCodec::kRawSampleBytes / double(m_storedBytes);
+}
+
+bool SampleStore::Writer::close()
+{
+    if (!isOpen()) return true;
+
+    bool ok = m_chunk.isEmpty() || writeChunk();
+
+    QByteArray footer;
+    footer.reserve(int(m_index.size() * kIndexEntrySize + kTrailerSize));
+    const quint64 indexOffset = quint64(m_file.pos());
+    for (const ChunkInfo &c : std::as_const(m_index)) {
+        putLE<quint64>(footer, c.offset);
+        putLE<quint32>(footer, c.count);
+        putLE<quint32>(footer, 0);
+        putLE<qint64>(footer, c.tMin);
+        putLE<qint64>(footer, c.tMax);
+    }
+    putLE<quint64>(footer, indexOffset);
+    putLE<quint32>(footer, quint32(m_index.size()));
+    putLE<quint32>(footer, kFooterMagic);
+
+    if (m_file.write(footer) != footer.size()) {
+        LOG_ERR << "写入采样文件索引失败: " << m_file.fileName() << " " << m_file.errorString();
+        ok = false;
+    }
+    m_file.close();
+    m_index.clear();
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+SampleStore::Reader::~Reader()
+{
+    close();
+}
+
+bool SampleStore::Reader::open(const QString &path, QString *error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_file.map(0, m_size);
+    if (!m_data) {
+        setError(error, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    if (!parseIndex(m_data, m_size, m_index, &m_version, nullptr, error)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SampleStore::Reader::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_index.clear();
+}
+
+qint64 SampleStore::Reader::sampleCount() const
+{
+    qint64 n = 0;
+    for (const ChunkInfo &c : m_index) n += c.count;
+    return n;
+}
+
+qint64 SampleStore::Reader::payloadBytes() const
+{
+    qint64 n = 0;
+    for (const ChunkInfo &c : m_index) n += c.payloadBytes;
+    return n;
+}
+
+const uchar *SampleStore::Reader::payload(const ChunkInfo &chunk) const
+{
+    return m_data ? m_data + chunk.offset + chunkHeaderSize(m_version) : nullptr;
+}
+
+/**
+ * @brief 读取一个完整数据块 (追加到 out)
+ */
+bool SampleStore::Reader::readChunk(const ChunkInfo &chunk, Columns &out) const
+{
+    if (decodeChunk(chunk, payload(chunk), out)) return true;
+    LOG_ERR << "采样数据块解码失败: " << m_file.fileName() << " @" << chunk.offset;
+    return false;
+}
+
+bool SampleStore::decodeChunk(const ChunkInfo &chunk, const uchar *payload, Columns &out)
+{
+    if (!payload) return false;
+    const int count = int(chunk.count);
+
+    const int at = out.size();
+    out.t.resize(at + count);
+    out.position.resize(at + count);
+    out.speed.resize(at + count);
+    out.status.resize(at + count);
+
+    if (chunk.codec == Codec::Gorilla) {
+        if (GorillaCodec::decode(payload, chunk.payloadBytes, count, out.t.data() + at,
+                                 out.position.data() + at, out.speed.data() + at, out.status.data() + at)) {
+            return true;
+        }
+        out.t.resize(at);
+        out.position.resize(at);
+        out.speed.resize(at);
+        out.status.resize(at);
+        return false;
+    }
+
+    const uchar *tCol = payload;
+    const uchar *posCol = tCol + count * sizeof(qint64);
+    const uchar *spdCol = posCol + count * sizeof(double);
+    const uchar *stCol = spdCol + count * sizeof(double);
+    std::memcpy(out.t.data() + at, tCol, count * sizeof(qint64));
+    std::memcpy(out.position.data() + at, posCol, count * sizeof(double));
+    std::memcpy(out.speed.data() + at, spdCol, count * sizeof(double));
+    std::memcpy(out.status.data() + at, stCol, count);
+    return true;
+}
+
+bool SampleStore::Reader::readAll(Columns &out) const
+{
+    if (!m_data) return false;
+    out.reserve(out.size() + int(sampleCount()));
+    bool ok = true;
+    for (const ChunkInfo &c : m_index) {
+        ok = readChunk(c, out) && ok;
+    }
+    return ok;
+}
+
+bool SampleStore::Reader::readRange(qint64 tFrom, qint64 tTo, Columns &out) const
+{
+    if (!m_data) return false;
+    bool ok = true;
+    Columns chunk;
+    for (const ChunkInfo &c : m_index) {
+        if (c.tMax < tFrom || c.tMin > tTo) continue;
+        if (c.tMin >= tFrom && c.tMax <= tTo) {
+            ok = readChunk(c, out) && ok;
+            continue;
+        }
+        // 边界块：整块解出后取区间内的连续部分 (块内时间戳递增)
+        chunk.clear();
+        if (!readChunk(c, chunk)) {
+            ok = false;
+            continue;
+        }
+        const auto lo = std::lower_bound(chunk.t.cbegin(), chunk.t.cend(), tFrom);
+        const auto hi = std::upper_bound(lo, chunk.t.cend(), tTo);
+        const int first = int(lo - chunk.t.cbegin());
+        const int n = int(hi - lo);
+        out.t.append(chunk.t.mid(first, n));
+        out.position.append(chunk.position.mid(first, n));
+        out.speed.append(chunk.speed.mid(first, n));
+        out.status.append(chunk.status.mid(first, n));
+    }
+    return ok;
+}
@@ -0,0 +1,208 @@
+#ifndef SAMPLESTORE_H
+#define SAMPLESTORE_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief 按任务存储的列式采样文件
+ *
+ * 每个任务的运动采样追加写入一个独立文件，SQLite 中只保留任务元数据和文件路径。
+ * 文件按块 (chunk) 组织，块内按列存放 (默认 Gorilla 压缩)，读取时通过 mmap 访问，无需逐行查询。
+ *
+ * 文件格式 (小端，version 2)：
+ *   文件头 16 字节:  magic "EPSS" | version u32 | reserved u64
+ *   数据块 (重复):   magic "CHNK" | count u32 | tMin i64 | tMax i64 | payloadBytes u32 | codec u32
+ *                    payload | 填充到 8 字节对齐
+ *                    codec = Raw:     t[count] i64 | position[count] f64 | speed[count] f64 | status[count] u8
+ *                    codec = Gorilla: GorillaCodec 位流 (见 gorillacodec.h)
+ *   块索引:          每块 32 字节 {offset u64, count u32, reserved u32, tMin i64, tMax i64}
+ *   文件尾 16 字节:  indexOffset u64 | chunkCount u32 | magic "EPSF"
+ *
+ * version 1 的块头没有 payloadBytes/codec 两个字段 (24 字节)，负载固定为 Raw，仍可读取。
+ *
+ * 块索引和文件尾只在关闭时写入。程序异常退出导致文件尾缺失时，
+ * 读取端按块头顺序扫描重建索引，最后一个不完整的块被丢弃。
+ */
+class SampleStore
+{
+public:
+    /**
+     * @brief 块负载编码
+     */
+    enum class Codec : quint32 {
+        Raw = 0,        ///< 按列原样存放，可直接 memcpy
+        Gorilla = 1     ///< 差分/异或压缩
+    };
+
+    /**
+     * @brief 单个采样点
+     */
+    struct Sample {
+        qint64 t = 0;           ///< 微秒时间戳 (UTC)
+        double position = 0.0;
+        double speed = 0.0;
+        quint8 status = 0;
+    };
+
+    /**
+     * @brief 按列存放的采样数据
+     */
+    struct Columns {
+        QVector<qint64> t;
+        QVector<double> position;
+        QVector<double> speed;
+        QVector<quint8> status;
+
+        int size() const { return t.size(); }
+        bool isEmpty() const { return t.isEmpty(); }
+        void clear();
+        void reserve(int n);
+        void append(const Sample &s);
+    };
+
+    /**
+     * @brief 块索引项
+     */
+    struct ChunkInfo {
+        quint64 offset = 0;     ///< 块头在文件中的偏移
+        quint32 count = 0;
+        qint64 tMin = 0;
+        qint64 tMax = 0;
+        quint32 payloadBytes = 0;
+        Codec codec = Codec::Raw;
+    };
+
+    /**
+     * @brief 追加写入器 (单线程使用)
+     */
+    class Writer
+    {
+    public:
+        explicit Writer(int chunkSamples = 4096, Codec codec = Codec::Gorilla);
+        ~Writer();
+
+        /**
+         * @brief 打开文件；文件已存在时截掉索引/文件尾，继续追加
+         */
+        bool open(const QString &path, QString *error = nullptr);
+
+        /**
+         * @brief 追加一个采样点，块写满时自动落盘
+         */
+        bool append(const Sample &sample);
+
+        /**
+         * @brief 将未满的当前块写入文件 (不写索引)
+         */
+        bool flush();
+
+        /**
+         * @brief 追加一个已编码的数据块 (负载原样写入，不重新编码)
+         * 用于归档导入等块拷贝场景；当前未满的块先落盘。
+         */
+        bool appendChunk(const ChunkInfo &chunk, const uchar *payload);
+
+        /**
+         * @brief 写入剩余数据、块索引和文件尾并关闭
+         */
+        bool close();
+
+        bool isOpen() const { return m_file.isOpen(); }
+        QString path() const { return m_file.fileName(); }
+        qint64 sampleCount() const { return m_written + m_chunk.size(); }
+
+        /**
+         * @brief 已落盘数据的压缩比 (原始列字节数 / 实际负载字节数)
+         */
+        double compressionRatio() const;
+
+    private:
+        bool writeChunk();
+        bool writeEncodedChunk(ChunkInfo info, const uchar *payload);
+
+        QFile m_file;
+        QVector<ChunkInfo> m_index;
+        Columns m_chunk;
+        int m_chunkSamples;
+        Codec m_codec;
+        qint64 m_written = 0;
+        qint64 m_storedBytes = 0;   ///< 已写入的负载字节数
+    };
+
+    /**
+     * @brief 只读访问 (mmap)
+     */
+    class Reader
+    {
+    public:
+        Reader() = default;
+        ~Reader();
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        bool open(const QString &path, QString *error = nullptr);
+        void close();
+
+        bool isOpen() const { return m_data != nullptr; }
+        const QVector<ChunkInfo> &chunks() const { return m_index; }
+        qint64 sampleCount() const;
+
+        /**
+         * @brief 负载字节数合计 (不含块头/索引)
+         */
+        qint64 payloadBytes() const;
+
+        /**
+         * @brief 读取全部采样 (追加到 out)
+         * @return false 有数据块解码失败 (已跳过)
+         */
+        bool readAll(Columns &out) const;
+
+        /**
+         * @brief 读取 [tFrom, tTo] 区间内的采样，借助块索引跳过无关块
+         */
+        bool readRange(qint64 tFrom, qint64 tTo, Columns &out) const;
+
+        /**
+         * @brief 解码单个数据块，追加到 out (顺序遍历 chunks() 时使用，不查找索引)
+         */
+        bool readChunk(const ChunkInfo &chunk, Columns &out) const;
+
+        /**
+         * @brief 数据块负载的起始地址 (映射内存，关闭前有效)
+         */
+        const uchar *payload(const ChunkInfo &chunk) const;
+
+    private:
+
+        QFile m_file;
+        quint32 m_version = 0;
+        const uchar *m_data = nullptr;
+        qint64 m_size = 0;
+        QVector<ChunkInfo> m_index;
+    };
+
+    /**
+     * @brief 解码一个数据块的负载 (追加到 out)
+     * @return false 负载损坏，out 不变
+     */
+    static bool decodeChunk(const ChunkInfo &chunk, const uchar *payload, Columns &out);
+
+    /**
+     * @brief 任务采样文件的默认路径 (<dir>/samples/task_<id>.eps)
+     */
+    static QString fileForTask(const QString &dataDir, int taskId);
+
+    /**
+     * @brief 解析文件中的块索引
+     * 优先读取文件尾的索引；文件尾缺失或损坏时按块头扫描恢复。
+     * @param version 输出：文件版本
+     * @param validEnd 输出：最后一个完整块的结束偏移 (追加写入从此处继续)
+     */
+    static bool parseIndex(const uchar *data, qint64 size, QVector<ChunkInfo> &index,
+                           quint32 *version, qint64 *validEnd, QString *error);
+};
+
+#endif // SAMPLESTORE_H
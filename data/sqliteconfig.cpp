@@ -0,0 +1,99 @@
+#include "sqliteconfig.h"
+#include "../utils/logger.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QElapsedTimer>
+
+namespace SqliteConfig {
+
+void prepare(QSqlDatabase &db, Role role)
+{
+    if (role == Role::ReadOnly) {
+        db.setConnectOptions("QSQLITE_OPEN_READONLY;QSQLITE_BUSY_TIMEOUT=5000");
+    } else {
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+    }
+}
+
+void applyPragmas(QSqlDatabase &db, Role role)
+{
+    QSqlQuery query(db);
+
+    auto exec = [&query](const QString &sql) {
+        if (!query.exec(sql)) {
+            LOG_WARN << "设置数据库参数失败: " << sql << " - " << query.lastError().text();
+        }
+    };
+
+    if (role == Role::Primary) {
+        // WAL 模式写入数据库文件头，只需由主连接设置一次
+        exec("PRAGMA journal_mode=WAL");
+        if (query.next()) {
+            LOG_INFO << "数据库日志模式: " << query.value(0).toString();
+        }
+        // 检查点后将 WAL 文件截断到 64MB 以内
+        exec("PRAGMA journal_size_limit=67108864");
+    }
+
+    // WAL 模式下 NORMAL 只在检查点时同步，掉电最多丢失最近一次提交，不会损坏数据库
+    exec("PRAGMA synchronous=NORMAL");
+    exec("PRAGMA temp_store=MEMORY");
+    exec("PRAGMA mmap_size=268435456");   // 256MB 内存映射读取
+
+    if (role == Role::Writer) {
+        exec("PRAGMA cache_size=-32768"); // 32MB
+    } else {
+        exec("PRAGMA cache_size=-16384"); // 16MB
+    }
+
+    // 自动检查点会在提交路径上执行，统一关闭，由写入线程在空闲时执行
+    if (role != Role::ReadOnly) {
+        exec("PRAGMA wal_autocheckpoint=0");
+    } else {
+        exec("PRAGMA query_only=1");
+    }
+}
+
+void ensureIncrementalVacuum(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA auto_vacuum") || !query.next()) return;
+    if (query.value(0).toInt() == 2) return; // 已是 INCREMENTAL
+
+    // 新库 (尚无表) 设置即生效；已有表的库留给数据保留任务在写入线程中切换
+    int tableCount = 0;
+    if (query.exec("SELECT COUNT(*) FROM sqlite_master") && query.next()) {
+        tableCount = query.value(0).toInt();
+    }
+    if (tableCount > 0) {
+        LOG_INFO << "数据库尚未启用增量回收，将在后台数据清理时切换";
+        return;
+    }
+    if (!query.exec("PRAGMA auto_vacuum=INCREMENTAL")) {
+        LOG_WARN << "设置 auto_vacuum 失败: " << query.lastError().text();
+    }
+}
+
+bool convertToIncrementalVacuum(QSqlDatabase &db)
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA auto_vacuum") || !query.next()) return false;
+    if (query.value(0).toInt() == 2) return true;
+
+    if (!query.exec("PRAGMA auto_vacuum=INCREMENTAL")) {
+        LOG_WARN << "设置 auto_vacuum 失败: " << query.lastError().text();
+        return false;
+    }
+
+    LOG_INFO << "数据库切换为增量回收模式 (一次性 VACUUM)...";
+    QElapsedTimer timer;
+    timer.start();
+    if (!query.exec("VACUUM")) {
+        LOG_WARN << "VACUUM 失败: " << query.lastError().text();
+        return false;
+    }
+    LOG_INFO << "VACUUM 完成，耗时 " << timer.elapsed() << " ms";
+    return true;
+}
+
+} // namespace SqliteConfig
@@ -0,0 +1,49 @@
+#ifndef SQLITECONFIG_H
+#define SQLITECONFIG_H
+
+#include <QSqlDatabase>
+
+/**
+ * @brief SQLite 连接参数配置
+ *
+ * 数据库使用 WAL 日志模式：读连接与写连接互不阻塞。
+ * 各类连接在打开前后统一通过这里设置参数，保证行为一致。
+ */
+namespace SqliteConfig {
+
+/**
+ * @brief 连接角色
+ */
+enum class Role {
+    Primary,   ///< 主线程连接：建表、迁移、任务元数据读写
+    Writer,    ///< 日志写入线程连接：高频批量写入，负责 WAL 检查点
+    ReadOnly   ///< 只读连接：UI 模型与导出
+};
+
+/**
+ * @brief 打开前设置连接选项 (只读连接需在 open() 之前调用)
+ */
+void prepare(QSqlDatabase &db, Role role);
+
+/**
+ * @brief 打开后设置 PRAGMA
+ */
+void applyPragmas(QSqlDatabase &db, Role role);
+
+/**
+ * @brief 启用 auto_vacuum=INCREMENTAL (主连接，建表前调用)
+ * 只对新库 (尚无表) 立即生效；已有数据的库需要一次 VACUUM 才能切换，
+ * 不在启动路径上执行，由数据保留任务调用 convertToIncrementalVacuum()。
+ */
+void ensureIncrementalVacuum(QSqlDatabase &db);
+
+/**
+ * @brief 已有数据的库切换为 auto_vacuum=INCREMENTAL (一次性 VACUUM，耗时与库大小成正比)
+ * 在写入线程中、没有未提交事务时调用。
+ * @return true 已是或已切换为 INCREMENTAL
+ */
+bool convertToIncrementalVacuum(QSqlDatabase &db);
+
+} // namespace SqliteConfig
+
+#endif // SQLITECONFIG_H
@@ -0,0 +1,561 @@
+#include "taskarchive.h"
+#include "gorillacodec.h"
+#include "taskstats.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QSysInfo>
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+static_assert(Q_BYTE_ORDER == Q_LITTLE_ENDIAN, "TaskArchive 仅支持小端平台");
+
+namespace {
+
+constexpr quint32 fourcc(const char (&s)[5])
+{
+    return quint32(quint8(s[0])) | quint32(quint8(s[1])) << 8 | quint32(quint8(s[2])) << 16
+           | quint32(quint8(s[3])) << 24;
+}
+
+constexpr quint32 kFileMagic = fourcc("EPAR");
+constexpr quint32 kBlockHead = fourcc("HEAD");
+constexpr quint32 kBlockTask = fourcc("TASK");
+constexpr quint32 kBlockSamples = fourcc("SAMP");
+constexpr quint32 kBlockEnd = fourcc("END ");
+constexpr quint32 kVersion = 1;
+
+constexpr qint64 kFileHeaderSize = 16;
+constexpr qint64 kBlockHeaderSize = 16;
+constexpr qint64 kSampleHeadSize = 24;     ///< SAMP 块负载前的 count/codec/tMin/tMax
+constexpr qint64 kEndPayloadSize = 16;
+
+template <typename T>
+T readLE(const uchar *p)
+{
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+template <typename T>
+void putLE(QByteArray &buf, T v)
+{
+    buf.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+void setError(QString *error, const QString &msg)
+{
+    if (error) *error = msg;
+}
+
+const std::array<quint32, 256> &crcTable()
+{
+    static const std::array<quint32, 256> table = [] {
+        std::array<quint32, 256> t {};
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    return table;
+}
+
+} // namespace
+
+quint32 TaskArchive::crc32(const uchar *data, qint64 size, quint32 crc)
+{
+    const std::array<quint32, 256> &table = crcTable();
+    crc = ~crc;
+    for (qint64 i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+QString TaskArchive::localStation()
+{
+    const QString host = QSysInfo::machineHostName();
+    return host.isEmpty() ? QString("station") : host;
+}
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+TaskArchive::Writer::~Writer()
+{
+    if (m_file.isOpen()) m_file.close();
+}
+
+bool TaskArchive::Writer::open(const QString &path, const QString &station, QString *error)
+{
+    m_tasks = 0;
+    m_samples = 0;
+    m_failed = false;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+
+    QByteArray header;
+    putLE<quint32>(header, kFileMagic);
+    putLE<quint32>(header, kVersion);
+    putLE<quint64>(header, 0);
+
+    QJsonObject info;
+    info["station"] = station;
+    info["created"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    const QByteArray json = QJsonDocument(info).toJson(QJsonDocument::Compact);
+
+    if (m_file.write(header) != header.size()
+        || !writeBlock(kBlockHead, json, nullptr, 0)) {
+        setError(error, m_file.errorString());
+        m_file.close();
+        return false;
+    }
+    return true;
+}
+
+bool TaskArchive::Writer::writeBlock(quint32 type, const QByteArray &head, const uchar *payload, quint32 payloadBytes)
+{
+    if (m_failed || !m_file.isOpen()) return false;
+
+    const quint32 bytes = quint32(head.size()) + payloadBytes;
+    quint32 crc = TaskArchive::crc32(reinterpret_cast<const uchar *>(head.constData()), head.size());
+    if (payloadBytes > 0) crc = TaskArchive::crc32(payload, payloadBytes, crc);
+
+    QByteArray blockHeader;
+    putLE<quint32>(blockHeader, type);
+    putLE<quint32>(blockHeader, bytes);
+    putLE<quint32>(blockHeader, crc);
+    putLE<quint32>(blockHeader, 0);
+
+    if (m_file.write(blockHeader) != blockHeader.size()
+        || m_file.write(head) != head.size()
+        || (payloadBytes > 0
+            && m_file.write(reinterpret_cast<const char *>(payload), payloadBytes) != qint64(payloadBytes))) {
+        m_failed = true;
+        return false;
+    }
+    return true;
+}
+
+bool TaskArchive::Writer::beginTask(const QJsonObject &meta)
+{
+    if (!writeBlock(kBlockTask, QJsonDocument(meta).toJson(QJsonDocument::Compact), nullptr, 0)) return false;
+    ++m_tasks;
+    return true;
+}
+
+bool TaskArchive::Writer::appendChunk(const SampleStore::ChunkInfo &chunk, const uchar *payload)
+{
+    if (m_tasks == 0 || !payload || chunk.count == 0) return false;
+
+    QByteArray head;
+    putLE<quint32>(head, chunk.count);
+    putLE<quint32>(head, quint32(chunk.codec));
+    putLE<qint64>(head, chunk.tMin);
+    putLE<qint64>(head, chunk.tMax);
+    if (!writeBlock(kBlockSamples, head, payload, chunk.payloadBytes)) return false;
+    m_samples += chunk.count;
+    return true;
+}
+
+bool TaskArchive::Writer::appendSamples(const SampleStore::Columns &samples)
+{
+    for (int at = 0; at < samples.size(); at += kChunkSamples) {
+        const int count = qMin(kChunkSamples, samples.size() - at);
+        const qint64 *t = samples.t.constData() + at;
+
+        SampleStore::ChunkInfo chunk;
+        chunk.count = quint32(count);
+        chunk.tMin = *std::min_element(t, t + count);
+        chunk.tMax = *std::max_element(t, t + count);
+        chunk.codec = SampleStore::Codec::Gorilla;
+
+        const QByteArray payload = GorillaCodec::encode(t, samples.position.constData() + at,
+                                                        samples.speed.constData() + at,
+                                                        samples.status.constData() + at, count);
+        chunk.payloadBytes = quint32(payload.size());
+        if (!appendChunk(chunk, reinterpret_cast<const uchar *>(payload.constData()))) return false;
+    }
+    return true;
+}
+
+bool TaskArchive::Writer::close(QString *error)
+{
+    if (!m_file.isOpen()) return !m_failed;
+
+    QByteArray end;
+    putLE<quint32>(end, quint32(m_tasks));
+    putLE<quint32>(end, 0);
+    putLE<quint64>(end, quint64(m_samples));
+    const bool ok = writeBlock(kBlockEnd, end, nullptr, 0) && m_file.flush();
+    if (!ok) setError(error, "写入归档文件失败: " + m_file.errorString());
+    m_file.close();
+    return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+TaskArchive::Reader::~Reader()
+{
+    close();
+}
+
+void TaskArchive::Reader::close()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+        m_data = nullptr;
+    }
+    if (m_file.isOpen()) m_file.close();
+    m_size = 0;
+    m_header = QJsonObject();
+    m_tasks.clear();
+}
+
+const uchar *TaskArchive::Reader::payload(const SampleStore::ChunkInfo &chunk) const
+{
+    return m_data ? m_data + chunk.offset : nullptr;
+}
+
+bool TaskArchive::Reader::open(const QString &path, QString *error)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+    m_size = m_file.size();
+    m_data = m_size > 0 ? m_file.map(0, m_size) : nullptr;
+    if (!m_data || m_size < kFileHeaderSize || readLE<quint32>(m_data) != kFileMagic) {
+        setError(error, "不是任务归档文件");
+        close();
+        return false;
+    }
+    const quint32 version = readLE<quint32>(m_data + 4);
+    if (version != kVersion) {
+        setError(error, QString("不支持的归档版本: %1").arg(version));
+        close();
+        return false;
+    }
+
+    auto fail = [&](const QString &msg) {
+        setError(error, msg);
+        close();
+        return false;
+    };
+
+    qint64 offset = kFileHeaderSize;
+    int blockNo = 0;
+    bool sawEnd = false;
+    qint64 totalSamples = 0;
+    while (offset + kBlockHeaderSize <= m_size) {
+        const uchar *p = m_data + offset;
+        const quint32 type = readLE<quint32>(p);
+        const quint32 bytes = readLE<quint32>(p + 4);
+        const quint32 crc = readLE<quint32>(p + 8);
+        const qint64 payloadOffset = offset + kBlockHeaderSize;
+        ++blockNo;
+
+        if (payloadOffset + bytes > m_size) {
+            return fail(QString("归档文件不完整 (第 %1 个数据块被截断)").arg(blockNo));
+        }
+        const uchar *data = m_data + payloadOffset;
+        if (crc32(data, bytes) != crc) {
+            return fail(QString("第 %1 个数据块校验失败 (偏移 %2)").arg(blockNo).arg(offset));
+        }
+
+        if (type == kBlockHead) {
+            m_header = QJsonDocument::fromJson(QByteArray::fromRawData(reinterpret_cast<const char *>(data), bytes)).object();
+        } else if (type == kBlockTask) {
+            const QJsonDocument doc = QJsonDocument::fromJson(
+                QByteArray::fromRawData(reinterpret_cast<const char *>(data), bytes));
+            if (!doc.isObject()) return fail(QString("第 %1 个数据块的任务元数据无效").arg(blockNo));
+            Task task;
+            task.meta = doc.object();
+            m_tasks.append(task);
+        } else if (type == kBlockSamples) {
+            if (m_tasks.isEmpty() || bytes < kSampleHeadSize) {
+                return fail(QString("第 %1 个数据块的采样数据无效").arg(blockNo));
+            }
+            SampleStore::ChunkInfo chunk;
+            chunk.offset = quint64(payloadOffset + kSampleHeadSize);
+            chunk.count = readLE<quint32>(data);
+            chunk.codec = SampleStore::Codec(readLE<quint32>(data + 4));
+            chunk.tMin = readLE<qint64>(data + 8);
+            chunk.tMax = readLE<qint64>(data + 16);
+            chunk.payloadBytes = bytes - quint32(kSampleHeadSize);
+            const bool raw = chunk.codec == SampleStore::Codec::Raw;
+            if (chunk.count == 0 || (!raw && chunk.codec != SampleStore::Codec::Gorilla)
+                || (raw && chunk.payloadBytes != chunk.count * quint32(GorillaCodec::kRawSampleBytes))) {
+                return fail(QString("第 %1 个数据块的采样数据无效").arg(blockNo));
+            }
+            Task &task = m_tasks.last();
+            task.chunks.append(chunk);
+            task.samples += chunk.count;
+            totalSamples += chunk.count;
+        } else if (type == kBlockEnd) {
+            if (bytes < kEndPayloadSize || readLE<quint32>(data) != quint32(m_tasks.size())
+                || readLE<quint64>(data + 8) != quint64(totalSamples)) {
+                return fail("归档文件的结束块与内容不符");
+            }
+            sawEnd = true;
+            break;
+        }
+        // 其他类型：新版本增加的块，跳过
+        offset = payloadOffset + bytes;
+    }
+
+    if (!sawEnd) return fail("归档文件不完整 (缺少结束块)");
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// 数据库导出/导入
+// ---------------------------------------------------------------------------
+
+TaskArchive::Result TaskArchive::exportTasks(QSqlDatabase &db, const QString &dataDir,
+                                             const QList<int> &taskIds, const QString &path)
+{
+    Result result;
+    const QString station = localStation();
+
+    Writer writer;
+    if (!writer.open(path, station, &result.error)) return result;
+
+    auto fail = [&](const QString &msg) {
+        result.error = msg;
+        result.taskIds.clear();
+        writer.close();
+        QFile::remove(path);
+        return result;
+    };
+
+    QSqlQuery query(db);
+    QSqlQuery logQuery(db);
+    logQuery.setForwardOnly(true);
+    SampleStore::Columns samples;
+    samples.reserve(Writer::kChunkSamples);
+
+    for (int taskId : taskIds) {
+        query.prepare("SELECT * FROM DetectionTask WHERE id = :tid");
+        query.bindValue(":tid", taskId);
+        if (!query.exec()) return fail("查询任务失败: " + query.lastError().text());
+        if (!query.next()) {
+            ++result.skipped;
+            continue;
+        }
+
+        // 元数据按列名整体带走，目标库导入两边都有的列
+        const QSqlRecord record = query.record();
+        QJsonObject meta;
+        QString sampleFile;
+        for (int i = 0; i < record.count(); ++i) {
+            const QString name = record.fieldName(i);
+            const QVariant value = query.value(i);
+            if (name == "sample_file") {
+                sampleFile = value.toString();
+            } else if (name != "id" && !value.isNull()) {
+                meta.insert(name, QJsonValue::fromVariant(value));
+            }
+        }
+        query.finish();
+        if (meta.value("origin").toString().isEmpty()) {
+            meta.insert("origin", QString("%1/%2").arg(station).arg(taskId));
+        }
+
+        if (!writer.beginTask(meta)) return fail("写入归档文件失败: " + writer.errorString());
+
+        if (!sampleFile.isEmpty()) {
+            // 采样文件：数据块原样拷贝
+            SampleStore::Reader reader;
+            QString error;
+            if (!reader.open(QDir(dataDir).filePath(sampleFile), &error)) {
+                return fail(QString("任务 %1 的采样文件无法读取: %2").arg(taskId).arg(error));
+            }
+            for (const SampleStore::ChunkInfo &chunk : reader.chunks()) {
+                if (!writer.appendChunk(chunk, reader.payload(chunk))) {
+                    return fail("写入归档文件失败: " + writer.errorString());
+                }
+            }
+        } else {
+            // MotionLog：按主键顺序读出，每 kChunkSamples 行编码一块
+            logQuery.prepare("SELECT t, position, speed, status FROM MotionLog WHERE task_id = :tid ORDER BY t");
+            logQuery.bindValue(":tid", taskId);
+            if (!logQuery.exec()) {
+                return fail(QString("任务 %1 的运动日志读取失败: %2").arg(taskId).arg(logQuery.lastError().text()));
+            }
+            samples.clear();
+            bool ok = true;
+            while (ok && logQuery.next()) {
+                SampleStore::Sample sample;
+                sample.t = logQuery.value(0).toLongLong();
+                sample.position = logQuery.value(1).toDouble();
+                sample.speed = logQuery.value(2).toDouble();
+                sample.status = quint8(logQuery.value(3).toInt());
+                samples.append(sample);
+                if (samples.size() >= Writer::kChunkSamples) {
+                    ok = writer.appendSamples(samples);
+                    samples.clear();
+                }
+            }
+            logQuery.finish();
+            if (!ok || !writer.appendSamples(samples)) {
+                return fail("写入归档文件失败: " + writer.errorString());
+            }
+        }
+        result.taskIds.append(taskId);
+    }
+
+    if (!writer.close(&result.error)) {
+        result.taskIds.clear();
+        QFile::remove(path);
+        return result;
+    }
+    result.samples = writer.sampleCount();
+    result.bytes = QFileInfo(path).size();
+    result.ok = true;
+    return result;
+}
+
+TaskArchive::Result TaskArchive::importTasks(QSqlDatabase &db, const QString &dataDir, const QString &path)
+{
+    Result result;
+    Reader reader;
+    if (!reader.open(path, &result.error)) return result;
+    result.bytes = reader.size();
+
+    // 只导入目标库中存在的列；id 重新分配，采样文件重新登记
+    QSqlQuery query(db);
+    QStringList columns;
+    if (query.exec("PRAGMA table_info(DetectionTask)")) {
+        while (query.next()) columns << query.value("name").toString();
+    }
+    if (!columns.contains("origin")) {
+        result.error = "数据库缺少 origin 列，请先用新版程序打开一次该数据库";
+        return result;
+    }
+    columns.removeAll("id");
+    columns.removeAll("sample_file");
+
+    SampleStore::Columns decoded;
+    for (const Task &task : reader.tasks()) {
+        const QString origin = task.meta.value("origin").toString();
+        if (!origin.isEmpty()) {
+            query.prepare("SELECT 1 FROM DetectionTask WHERE origin = :origin LIMIT 1");
+            query.bindValue(":origin", origin);
+            if (query.exec() && query.next()) {
+                ++result.skipped;
+                continue;
+            }
+        }
+
+        QStringList names;
+        QStringList holders;
+        QVariantList values;
+        for (const QString &column : std::as_const(columns)) {
+            if (!task.meta.contains(column)) continue;
+            QVariant value = task.meta.value(column).toVariant();
+            // 导出时仍在执行的任务，在本工位上视为已结束
+            if (column == "status" && value.toString() == "running") value = QString("stop");
+            names << column;
+            holders << "?";
+            values << value;
+        }
+        if (names.isEmpty()) {
+            ++result.skipped;
+            continue;
+        }
+
+        if (!db.transaction()) {
+            result.error = db.lastError().text();
+            return result;
+        }
+
+        QString error;
+        QString samplePath;
+        int taskId = -1;
+        bool ok = query.prepare(QString("INSERT INTO DetectionTask (%1) VALUES (%2)")
+                                    .arg(names.join(", "), holders.join(", ")));
+        if (ok) {
+            for (const QVariant &value : std::as_const(values)) query.addBindValue(value);
+            ok = query.exec();
+        }
+        if (ok) {
+            taskId = query.lastInsertId().toInt();
+        } else {
+            error = query.lastError().text();
+        }
+
+        if (ok && !task.chunks.isEmpty()) {
+            // 数据块原样写入新的采样文件，同时解码一遍用于校验和计算统计
+            samplePath = SampleStore::fileForTask(dataDir, taskId);
+            QFile::remove(samplePath); // AUTOINCREMENT 不复用ID，同名文件只可能是残留
+            SampleStore::Writer sampleWriter;
+            TaskStats stats;
+            stats.taskId = taskId;
+            ok = sampleWriter.open(samplePath, &error);
+            for (const SampleStore::ChunkInfo &chunk : task.chunks) {
+                if (!ok) break;
+                const uchar *payload = reader.payload(chunk);
+                decoded.clear();
+                if (!SampleStore::decodeChunk(chunk, payload, decoded)) {
+                    error = "采样数据解码失败";
+                    ok = false;
+                    break;
+                }
+                for (int i = 0; i < decoded.size(); ++i) {
+                    stats.add(decoded.t[i], decoded.position[i], decoded.speed[i], decoded.status[i]);
+                }
+                if (!sampleWriter.appendChunk(chunk, payload)) {
+                    error = "写入采样文件失败";
+                    ok = false;
+                }
+            }
+            ok = sampleWriter.close() && ok;
+
+            if (ok) {
+                query.prepare("UPDATE DetectionTask SET sample_file = :file WHERE id = :tid");
+                query.bindValue(":file", QDir(dataDir).relativeFilePath(samplePath));
+                query.bindValue(":tid", taskId);
+                ok = query.exec();
+                if (!ok) error = query.lastError().text();
+            }
+            if (ok) ok = stats.save(db, &error);
+        }
+
+        if (ok && !db.commit()) {
+            error = db.lastError().text();
+            ok = false;
+        }
+        if (!ok) {
+            db.rollback();
+            if (!samplePath.isEmpty()) QFile::remove(samplePath);
+            result.error = QString("导入任务 %1 失败: %2").arg(origin, error);
+            return result;
+        }
+
+        result.taskIds.append(taskId);
+        result.samples += task.samples;
+    }
+
+    result.ok = true;
+    return result;
+}
@@ -0,0 +1,157 @@
+#ifndef TASKARCHIVE_H
+#define TASKARCHIVE_H
+
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include "samplestore.h"
+
+/**
+ * @brief 任务归档文件 (.epa)，用于在工位之间迁移检测任务
+ *
+ * 一个文件包含一个或多个任务的元数据、配置/结果 JSON 和压缩采样列，按块组织，每块带 CRC32 校验。
+ * 采样块与 SampleStore 的数据块负载相同，已归档为采样文件的任务导出/导入时只做块拷贝，不重新编码。
+ *
+ * 文件格式 (小端，version 1)：
+ *   文件头 16 字节:  magic "EPAR" | version u32 | reserved u64
+ *   数据块 (重复):   type u32 | payloadBytes u32 | crc32 u32 | reserved u32 | payload
+ *     type = "HEAD": JSON {station, created}                      (第一个块)
+ *            "TASK": JSON 任务元数据 (DetectionTask 各列，不含 id/sample_file)，
+ *                    其后紧跟该任务的 SAMP 块
+ *            "SAMP": count u32 | codec u32 | tMin i64 | tMax i64 | 负载 (SampleStore::Codec)
+ *            "END ": taskCount u32 | reserved u32 | sampleCount u64 (最后一个块，缺失说明文件不完整)
+ *   crc32 为负载的 CRC-32 (IEEE 802.3)，未知类型的块跳过。
+ *
+ * 任务的来源记录在 origin 列 ("<工位>/<原任务ID>")：导入时分配新的任务ID，
+ * 已导入过的 origin 跳过，同一归档重复导入不会产生重复任务。
+ */
+class TaskArchive
+{
+public:
+    /**
+     * @brief 导出/导入结果
+     */
+    struct Result {
+        bool ok = false;
+        QVector<int> taskIds;       ///< 导出的任务ID / 导入后新分配的任务ID
+        int skipped = 0;            ///< 跳过的任务 (不存在或已导入过)
+        qint64 samples = 0;
+        qint64 bytes = 0;           ///< 归档文件大小
+        QString error;
+    };
+
+    /**
+     * @brief 归档中的一个任务 (采样块负载指向映射内存)
+     */
+    struct Task {
+        QJsonObject meta;
+        QVector<SampleStore::ChunkInfo> chunks;  ///< offset 为负载在归档文件中的偏移
+        qint64 samples = 0;
+    };
+
+    /**
+     * @brief 顺序写入器
+     */
+    class Writer
+    {
+    public:
+        static constexpr int kChunkSamples = 4096;
+
+        Writer() = default;
+        ~Writer();
+
+        bool open(const QString &path, const QString &station, QString *error = nullptr);
+
+        /**
+         * @brief 开始一个任务，之后追加的采样都属于该任务
+         */
+        bool beginTask(const QJsonObject &meta);
+
+        /**
+         * @brief 追加采样 (按 kChunkSamples 分块 Gorilla 编码)
+         */
+        bool appendSamples(const SampleStore::Columns &samples);
+
+        /**
+         * @brief 追加一个已编码的采样块 (原样写入)
+         */
+        bool appendChunk(const SampleStore::ChunkInfo &chunk, const uchar *payload);
+
+        /**
+         * @brief 写入结束块并关闭
+         */
+        bool close(QString *error = nullptr);
+
+        int taskCount() const { return m_tasks; }
+        qint64 sampleCount() const { return m_samples; }
+        QString errorString() const { return m_file.errorString(); }
+
+    private:
+        bool writeBlock(quint32 type, const QByteArray &head, const uchar *payload, quint32 payloadBytes);
+
+        QFile m_file;
+        int m_tasks = 0;
+        qint64 m_samples = 0;
+        bool m_failed = false;
+    };
+
+    /**
+     * @brief 只读访问 (mmap)；open() 时校验全部数据块，损坏或不完整的文件整体拒绝
+     */
+    class Reader
+    {
+    public:
+        Reader() = default;
+        ~Reader();
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        bool open(const QString &path, QString *error = nullptr);
+        void close();
+
+        QString station() const { return m_header.value("station").toString(); }
+        QString created() const { return m_header.value("created").toString(); }
+        const QVector<Task> &tasks() const { return m_tasks; }
+        qint64 size() const { return m_size; }
+
+        /**
+         * @brief 采样块负载的起始地址 (关闭前有效)
+         */
+        const uchar *payload(const SampleStore::ChunkInfo &chunk) const;
+
+    private:
+        QFile m_file;
+        const uchar *m_data = nullptr;
+        qint64 m_size = 0;
+        QJsonObject m_header;
+        QVector<Task> m_tasks;
+    };
+
+    /**
+     * @brief 将任务导出为归档文件
+     * @param dataDir 数据目录 (采样文件路径相对于此)
+     */
+    static Result exportTasks(QSqlDatabase &db, const QString &dataDir,
+                              const QList<int> &taskIds, const QString &path);
+
+    /**
+     * @brief 导入归档文件中的任务
+     * 每个任务一个事务：新建任务行、写入采样文件、计算统计；失败的任务回滚并删除其采样文件。
+     */
+    static Result importTasks(QSqlDatabase &db, const QString &dataDir, const QString &path);
+
+    /**
+     * @brief 本工位标识 (主机名)，用于生成 origin
+     */
+    static QString localStation();
+
+    /**
+     * @brief CRC-32 (IEEE 802.3)
+     */
+    static quint32 crc32(const uchar *data, qint64 size, quint32 crc = 0);
+};
+
+#endif // TASKARCHIVE_H
@@ -0,0 +1,125 @@
+#include "taskstats.h"
+#include "../communication/protocol.h"
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtMath>
+
+void TaskStats::add(qint64 tUs, double position, double speed, int status)
+{
+    const double absSpeed = qAbs(speed);
+
+    if (samples == 0) {
+        tFirstUs = tUs;
+        lastPosition = position;
+        anchorPosition = position;
+    } else {
+        distanceMm += qAbs(position - lastPosition);
+    }
+    tLastUs = tUs;
+    ++samples;
+
+    // Welford: 均值与偏差平方和
+    const double delta = absSpeed - speedMean;
+    speedMean += delta / samples;
+    speedM2 += delta * (absSpeed - speedMean);
+    maxSpeed = qMax(maxSpeed, absSpeed);
+
+    // 位置离开死区后才确定方向，方向翻转记一次换向
+    const double moved = position - anchorPosition;
+    if (qAbs(moved) >= kReversalDeadbandMm) {
+        const int dir = moved > 0 ? 1 : -1;
+        if (direction != 0 && dir != direction) ++reversals;
+        direction = dir;
+        anchorPosition = position;
+    }
+    lastPosition = position;
+
+    const int errorStatus = static_cast<int>(DeviceStatus::Error);
+    if (status == errorStatus && lastStatus != errorStatus) ++faults;
+    lastStatus = status;
+}
+
+double TaskStats::speedStdDev() const
+{
+    return qSqrt(speedVariance());
+}
+
+QJsonObject TaskStats::toJson() const
+{
+    QJsonObject obj;
+    obj["samples"] = samples;
+    obj["durationSec"] = durationSec();
+    obj["distanceMm"] = distanceMm;
+    obj["maxSpeed"] = maxSpeed;
+    obj["meanSpeed"] = speedMean;
+    obj["speedStdDev"] = speedStdDev();
+    obj["reversals"] = reversals;
+    obj["faults"] = faults;
+    return obj;
+}
+
+QString TaskStats::summary() const
+{
+    if (!isValid()) return QString();
+    return QString("%1 s | %2 mm | %3 mm/s | 换向 %4 | 故障 %5")
+        .arg(durationSec(), 0, 'f', 1)
+        .arg(distanceMm, 0, 'f', 0)
+        .arg(maxSpeed, 0, 'f', 1)
+        .arg(reversals)
+        .arg(faults);
+}
+
+bool TaskStats::load(QSqlDatabase &db, int taskId, TaskStats &out)
+{
+    QSqlQuery query(db);
+    query.prepare("SELECT t_first, t_last, samples, distance, max_speed, speed_mean, speed_m2, "
+                  "reversals, faults, last_pos, anchor_pos, direction, last_status "
+                  "FROM TaskStats WHERE task_id = :tid");
+    query.bindValue(":tid", taskId);
+    if (!query.exec() || !query.next()) return false;
+
+    out = TaskStats();
+    out.taskId = taskId;
+    out.tFirstUs = query.value(0).toLongLong();
+    out.tLastUs = query.value(1).toLongLong();
+    out.samples = query.value(2).toLongLong();
+    out.distanceMm = query.value(3).toDouble();
+    out.maxSpeed = query.value(4).toDouble();
+    out.speedMean = query.value(5).toDouble();
+    out.speedM2 = query.value(6).toDouble();
+    out.reversals = query.value(7).toInt();
+    out.faults = query.value(8).toInt();
+    out.lastPosition = query.value(9).toDouble();
+    out.anchorPosition = query.value(10).toDouble();
+    out.direction = query.value(11).toInt();
+    out.lastStatus = query.value(12).toInt();
+    return true;
+}
+
+bool TaskStats::save(QSqlDatabase &db, QString *error) const
+{
+    QSqlQuery query(db);
+    query.prepare("INSERT OR REPLACE INTO TaskStats (task_id, t_first, t_last, samples, distance, max_speed, "
+                  "speed_mean, speed_m2, speed_std, reversals, faults, last_pos, anchor_pos, direction, last_status) "
+                  "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)");
+    query.addBindValue(taskId);
+    query.addBindValue(tFirstUs);
+    query.addBindValue(tLastUs);
+    query.addBindValue(samples);
+    query.addBindValue(distanceMm);
+    query.addBindValue(maxSpeed);
+    query.addBindValue(speedMean);
+    query.addBindValue(speedM2);
+    query.addBindValue(speedStdDev());
+    query.addBindValue(reversals);
+    query.addBindValue(faults);
+    query.addBindValue(lastPosition);
+    query.addBindValue(anchorPosition);
+    query.addBindValue(direction);
+    query.addBindValue(lastStatus);
+    if (!query.exec()) {
+        if (error) *error = query.lastError().text();
+        return false;
+    }
+    return true;
+}
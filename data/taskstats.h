@@ -0,0 +1,69 @@
+#ifndef TASKSTATS_H
+#define TASKSTATS_H
+
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief 单个任务的扫描统计 (TaskStats 表一行)
+ *
+ * 由日志写入线程逐条累加、随批量提交一起写入，任务列表直接读取，无需扫描 MotionLog。
+ * 速度均值/方差使用 Welford 算法在线更新，数值稳定且可从数据库中的状态继续累加。
+ */
+struct TaskStats
+{
+    static constexpr double kReversalDeadbandMm = 0.5; ///< 换向判定的位置死区，滤除抖动
+
+    int taskId = 0;
+    qint64 tFirstUs = 0;        ///< 首个采样时间 (微秒)
+    qint64 tLastUs = 0;         ///< 最后一个采样时间
+    qint64 samples = 0;
+    double distanceMm = 0.0;    ///< 累计行程 (位置变化绝对值之和)
+    double maxSpeed = 0.0;      ///< 最大速度 (绝对值)
+    double speedMean = 0.0;     ///< 速度绝对值均值 (Welford)
+    double speedM2 = 0.0;       ///< 速度绝对值的偏差平方和 (Welford)
+    int reversals = 0;          ///< 换向次数
+    int faults = 0;             ///< 进入故障状态的次数
+
+    // 续算所需的状态
+    double lastPosition = 0.0;
+    double anchorPosition = 0.0; ///< 上次确定运动方向时的位置
+    int direction = 0;           ///< 当前运动方向 (-1/0/1)
+    int lastStatus = -1;
+
+    bool isValid() const { return samples > 0; }
+
+    /**
+     * @brief 累加一个采样 (时间需递增)
+     */
+    void add(qint64 tUs, double position, double speed, int status);
+
+    double durationSec() const { return samples > 1 ? (tLastUs - tFirstUs) / 1e6 : 0.0; }
+    double speedVariance() const { return samples > 1 ? speedM2 / (samples - 1) : 0.0; }
+    double speedStdDev() const;
+
+    /**
+     * @brief 写入任务结果 JSON 的统计字段
+     */
+    QJsonObject toJson() const;
+
+    /**
+     * @brief 列表中显示的简要文本
+     */
+    QString summary() const;
+
+    /**
+     * @brief 读取任务的统计行
+     * @return false 不存在或读取失败
+     */
+    static bool load(QSqlDatabase &db, int taskId, TaskStats &out);
+
+    /**
+     * @brief 写入 (覆盖) 任务的统计行
+     */
+    bool save(QSqlDatabase &db, QString *error = nullptr) const;
+};
+
+#endif // TASKSTATS_H
@@ -0,0 +1,234 @@
+#include "workorderimport.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+namespace {
+
+/**
+ * @brief 表头别名 -> 规范列名
+ */
+QString canonicalColumn(const QString &header)
+{
+    static const QHash<QString, QString> aliases = {
+        { "tube_id", "tube_id" }, { "tubeid", "tube_id" }, { "tube", "tube_id" }, { "管道编号", "tube_id" },
+        { "operator", "operator" }, { "operator_name", "operator" }, { "操作员", "operator" },
+        { "task_type", "task_type" }, { "tasktype", "task_type" }, { "type", "task_type" }, { "任务类型", "task_type" },
+        { "task_config", "task_config" }, { "taskconfig", "task_config" }, { "config", "task_config" }, { "任务配置", "task_config" }
+    };
+    return aliases.value(header.trimmed().toLower());
+}
+
+QString jsonString(const QJsonObject &obj, const char *key, const char *altKey)
+{
+    QJsonValue value = obj.value(QLatin1String(key));
+    if (value.isUndefined()) value = obj.value(QLatin1String(altKey));
+    return value.toString().trimmed();
+}
+
+} // namespace
+
+bool WorkOrderImport::parseFile(const QString &path, const QString &defaultOperator,
+                                QVector<Item> &items, QStringList *warnings, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = QString("无法打开工单文件: %1").arg(file.errorString());
+        return false;
+    }
+    const QByteArray data = file.readAll();
+
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix == "json") {
+        return parseJson(data, defaultOperator, items, warnings, error);
+    }
+    if (suffix == "csv" || suffix == "txt") {
+        return parseCsv(data, defaultOperator, items, warnings, error);
+    }
+    if (error) *error = QString("不支持的工单格式: %1").arg(suffix);
+    return false;
+}
+
+bool WorkOrderImport::parseCsv(const QByteArray &data, const QString &defaultOperator,
+                               QVector<Item> &items, QStringList *warnings, QString *error)
+{
+    QString text = QString::fromUtf8(data);
+    if (text.startsWith(QChar(0xFEFF))) text.remove(0, 1);
+
+    QVector<int> lines;
+    const QVector<QStringList> records = splitCsv(text, lines);
+    if (records.isEmpty()) {
+        if (error) *error = "工单文件为空";
+        return false;
+    }
+
+    // 表头：记录各规范列所在位置
+    QHash<QString, int> columns;
+    const QStringList &header = records.first();
+    for (int i = 0; i < header.size(); ++i) {
+        const QString name = canonicalColumn(header[i]);
+        if (!name.isEmpty() && !columns.contains(name)) columns.insert(name, i);
+    }
+    if (!columns.contains("tube_id")) {
+        if (error) *error = "工单表头缺少 tube_id 列";
+        return false;
+    }
+
+    auto field = [&columns](const QStringList &record, const char *name) {
+        const int col = columns.value(QLatin1String(name), -1);
+        return (col >= 0 && col < record.size()) ? record[col].trimmed() : QString();
+    };
+
+    items.reserve(items.size() + records.size() - 1);
+    for (int r = 1; r < records.size(); ++r) {
+        const QStringList &record = records[r];
+        if (record.size() == 1 && record.first().trimmed().isEmpty()) continue; // 空行
+
+        Item item;
+        item.line = lines[r];
+        item.tubeId = field(record, "tube_id");
+        item.operatorName = field(record, "operator");
+        item.taskType = field(record, "task_type");
+        item.taskConfig = field(record, "task_config");
+
+        QString reason;
+        if (!finishItem(item, defaultOperator, &reason)) {
+            if (warnings) warnings->append(QString("第 %1 行: %2").arg(item.line).arg(reason));
+            continue;
+        }
+        items.append(item);
+    }
+    return true;
+}
+
+bool WorkOrderImport::parseJson(const QByteArray &data, const QString &defaultOperator,
+                                QVector<Item> &items, QStringList *warnings, QString *error)
+{
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &parseError);
+    if (doc.isNull()) {
+        if (error) *error = QString("工单 JSON 格式错误: %1").arg(parseError.errorString());
+        return false;
+    }
+
+    QJsonArray tasks;
+    QString fileOperator = defaultOperator;
+    if (doc.isArray()) {
+        tasks = doc.array();
+    } else {
+        const QJsonObject root = doc.object();
+        tasks = root.value("tasks").toArray();
+        const QString op = jsonString(root, "operator", "operator_name");
+        if (!op.isEmpty()) fileOperator = op;
+    }
+
+    items.reserve(items.size() + tasks.size());
+    for (int i = 0; i < tasks.size(); ++i) {
+        const QJsonObject obj = tasks[i].toObject();
+
+        Item item;
+        item.line = i + 1;
+        item.tubeId = jsonString(obj, "tube_id", "tubeId");
+        item.operatorName = jsonString(obj, "operator", "operator_name");
+        item.taskType = jsonString(obj, "task_type", "taskType");
+
+        QJsonValue config = obj.value("task_config");
+        if (config.isUndefined()) config = obj.value("taskConfig");
+        if (config.isObject()) {
+            item.taskConfig = QString::fromUtf8(QJsonDocument(config.toObject()).toJson(QJsonDocument::Compact));
+        } else {
+            item.taskConfig = config.toString().trimmed();
+        }
+
+        QString reason;
+        if (!finishItem(item, fileOperator, &reason)) {
+            if (warnings) warnings->append(QString("第 %1 项: %2").arg(item.line).arg(reason));
+            continue;
+        }
+        items.append(item);
+    }
+    return true;
+}
+
+QVector<QStringList> WorkOrderImport::splitCsv(const QString &text, QVector<int> &lines)
+{
+    QVector<QStringList> records;
+    QStringList record;
+    QString field;
+    bool quoted = false;
+    bool fieldStarted = false;
+    int line = 1;
+    int recordLine = 1;
+
+    auto endRecord = [&]() {
+        record.append(field);
+        records.append(record);
+        lines.append(recordLine);
+        record.clear();
+        field.clear();
+        fieldStarted = false;
+    };
+
+    for (int i = 0; i < text.size(); ++i) {
+        const QChar c = text[i];
+        if (quoted) {
+            if (c == '"') {
+                if (i + 1 < text.size() && text[i + 1] == '"') {
+                    field.append('"');
+                    ++i;
+                } else {
+                    quoted = false;
+                }
+            } else {
+                if (c == '\n') ++line;
+                field.append(c);
+            }
+            continue;
+        }
+
+        if (c == '"' && !fieldStarted) {
+            quoted = true;
+            fieldStarted = true;
+        } else if (c == ',') {
+            record.append(field);
+            field.clear();
+            fieldStarted = false;
+        } else if (c == '\n' || c == '\r') {
+            if (c == '\r' && i + 1 < text.size() && text[i + 1] == '\n') ++i;
+            endRecord();
+            ++line;
+            recordLine = line;
+        } else {
+            field.append(c);
+            fieldStarted = true;
+        }
+    }
+    if (fieldStarted || !field.isEmpty() || !record.isEmpty()) {
+        endRecord();
+    }
+    return records;
+}
+
+bool WorkOrderImport::finishItem(Item &item, const QString &defaultOperator, QString *reason)
+{
+    if (item.tubeId.isEmpty()) {
+        if (reason) *reason = "缺少管道编号";
+        return false;
+    }
+    if (item.operatorName.isEmpty()) item.operatorName = defaultOperator;
+    if (!item.taskConfig.isEmpty() && item.taskType.isEmpty()) {
+        if (reason) *reason = QString("管道 %1 给出了任务配置但缺少任务类型").arg(item.tubeId);
+        return false;
+    }
+    if (!item.taskConfig.isEmpty()) {
+        QJsonParseError parseError;
+        if (QJsonDocument::fromJson(item.taskConfig.toUtf8(), &parseError).isNull()) {
+            if (reason) *reason = QString("管道 %1 的任务配置不是有效的 JSON").arg(item.tubeId);
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef WORKORDERIMPORT_H
+#define WORKORDERIMPORT_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief 检测工单 (批量任务) 解析
+ *
+ * 支持两种格式，每个条目对应一根传热管的检测任务：
+ *
+ * CSV (首行为表头，列顺序任意，UTF-8，可带 BOM)：
+ *   tube_id,operator,task_type,task_config
+ *   H01-R12C07,张三,auto_scan,"{""minPos"":0,""maxPos"":1200,...}"
+ *
+ * JSON (数组，或带 tasks 数组的对象；对象级 operator 作为默认操作员)：
+ *   { "operator": "张三",
+ *     "tasks": [ { "tube_id": "H01-R12C07", "task_type": "auto_scan", "task_config": { ... } } ] }
+ *
+ * tube_id 必填；operator 缺省时使用调用方给出的默认操作员；
+ * 给出 task_config 时必须同时给出 task_type。无效条目跳过并记录原因。
+ */
+class WorkOrderImport
+{
+public:
+    /**
+     * @brief 工单中的一个任务
+     */
+    struct Item {
+        int line = 0;               ///< 源文件中的行号 (CSV) 或序号 (JSON)，用于提示
+        QString tubeId;
+        QString operatorName;
+        QString taskType;           ///< 为空表示只登记任务，稍后再配置
+        QString taskConfig;         ///< 任务配置 JSON (紧凑格式)
+    };
+
+    /**
+     * @brief 按扩展名解析工单文件 (.csv / .json)
+     * @param warnings 输出：被跳过的条目及原因
+     * @return false 文件无法读取或格式错误 (error 给出原因)
+     */
+    static bool parseFile(const QString &path, const QString &defaultOperator,
+                          QVector<Item> &items, QStringList *warnings = nullptr,
+                          QString *error = nullptr);
+
+    static bool parseCsv(const QByteArray &data, const QString &defaultOperator,
+                         QVector<Item> &items, QStringList *warnings = nullptr,
+                         QString *error = nullptr);
+
+    static bool parseJson(const QByteArray &data, const QString &defaultOperator,
+                          QVector<Item> &items, QStringList *warnings = nullptr,
+                          QString *error = nullptr);
+
+private:
+    /**
+     * @brief 拆分 CSV 记录 (支持引号、转义引号和引号内换行)
+     * @param lines 输出：每条记录起始的行号
+     */
+    static QVector<QStringList> splitCsv(const QString &text, QVector<int> &lines);
+
+    /**
+     * @brief 检查条目并补全默认值，无效时返回 false 并给出原因
+     */
+    static bool finishItem(Item &item, const QString &defaultOperator, QString *reason);
+};
+
+#endif // WORKORDERIMPORT_H
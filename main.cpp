@@ -7,6 +7,62 @@
 #include "ui/logindialog.h"
 #include "core/configmanager.h"
 #include "utils/logger.h"
+#include "core/dryrunsimulator.h"
+#include "data/datamanager.h"
+#include "data/motionlogexporter.h"
+#include <QCoreApplication>
+#include <QStringList>
+#include <QTextStream>
+
+/**
+ * @brief 命令行离线仿真模式
+ *
+ * 用法: <程序> --dry-run <任务ID>[,<任务ID>...]
+ * 不创建任何窗口，以只读方式读取 DetectionTask 中保存的配置并输出预估结果。
+ * @return 进程退出码 (全部任务预估成功返回 0)
+ */
+static int runDryRun(int argc, char *argv[], int argIndex)
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    if (argIndex + 1 >= argc) {
+        out << "用法: --dry-run <任务ID>[,<任务ID>...]\n";
+        return 2;
+    }
+
+    // 只读打开：仿真不能修改数据库 (不迁移、不启动写入线程和数据清理)
+    DataManager dataManager;
+    if (!dataManager.openReadOnly()) {
+        out << "数据库打开失败\n";
+        return 1;
+    }
+
+    int failures = 0;
+    const QStringList ids = QString::fromLocal8Bit(argv[argIndex + 1]).split(',', Qt::SkipEmptyParts);
+    for (const QString &idText : ids) {
+        bool okId = false;
+        const int taskId = idText.trimmed().toInt(&okId);
+        QString taskType, taskConfig;
+        if (!okId || !dataManager.getTaskConfig(taskId, taskType, taskConfig)) {
+            out << "任务 " << idText << ": 无法获取任务配置\n";
+            ++failures;
+            continue;
+        }
+
+        const DryRunSimulator::Report report = DryRunSimulator().runConfig(taskType, taskConfig);
+        out << "任务 " << taskId << " (" << taskType << "): ";
+        if (report.ok) {
+            out << "耗时 " << report.durationMs << " ms, 行程 " << QString::number(report.distanceMm, 'f', 1)
+                << " mm, 换向 " << report.reversals << " 次 (仿真用时 " << report.wallMs << " ms)\n";
+        } else {
+            out << "预估失败: " << report.message << "\n";
+            ++failures;
+        }
+    }
+    out.flush();
+    return failures == 0 ? 0 : 1;
+}
 
 /**
  * @brief 应用程序入口点
@@ -15,6 +71,13 @@
  */
 int main(int argc, char *argv[])
 {
+    // 离线仿真模式：无界面，直接输出预估结果后退出
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--dry-run") == 0) {
+            return runDryRun(argc, argv, i);
+        }
+    }
+
     // 创建 Qt 应用程序实例
     // argc 和 argv 是命令行参数
     QApplication a(argc, argv);
@@ -26,6 +89,11 @@ int main(int argc, char *argv[])
     // 在 Qt 的信号槽机制中，如果参数是自定义类型且跨线程传递，必须注册
     qRegisterMetaType<MotionFeedback>("MotionFeedback");
     qRegisterMetaType<ControlCommand>("ControlCommand");
+    qRegisterMetaType<ScanProgram>("ScanProgram");
+    qRegisterMetaType<MotionLogWriter::Stats>("MotionLogWriter::Stats");
+    qRegisterMetaType<RetentionJob::Progress>("RetentionJob::Progress");
+    qRegisterMetaType<MotionLogExporter::Result>("MotionLogExporter::Result");
+    qRegisterMetaType<DataManager::TaskChange>("DataManager::TaskChange");
 
     // 设置应用程序元数据
     a.setApplicationName("蒸发器涡流探头推拔器控制系统");
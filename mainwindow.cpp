@@ -1,6 +1,7 @@
 #include "mainwindow.h"
 #include "ui/taskconfigdialog.h"
 #include "ui/taskconfigwidget.h"
+#include "core/dryrunsimulator.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
@@ -16,6 +17,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QFileDialog>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -43,37 +45,69 @@ MainWindow::MainWindow(QWidget *parent)
     m_controller->init(); // 初始化控制器串口等
     
     // 5. 初始化数据库模型（日志）
-    // 获取 DataManager 初始化的数据库连接
-    QSqlDatabase db = QSqlDatabase::database(m_controller->dataManager()->connectionName());
+    // 使用只读连接：浏览与导出不会阻塞日志写入线程
+    QSqlDatabase db = QSqlDatabase::database(m_controller->dataManager()->readConnectionName());
     
-    m_logModel = new QSqlTableModel(this, db);
-    m_logModel->setTable("MotionLog");
-    m_logModel->setSort(0, Qt::DescendingOrder); // 按时间倒序
-    m_logModel->setEditStrategy(QSqlTableModel::OnManualSubmit);
-      
     m_taskModel = new QSqlTableModel(this, db);
-    m_taskModel->setTable("DetectionTask");
+    m_taskModel->setTable("TaskListView"); // 任务元数据 + 扫描统计
     m_taskModel->setSort(0, Qt::DescendingOrder); // 最新任务在前
     m_taskModel->setEditStrategy(QSqlTableModel::OnManualSubmit);
     
-    // 将模型设置给 LogWidget
-    m_logWidget->setModels(m_taskModel, m_logModel);
-
     m_taskModel->select();
+
+    // 将模型设置给 LogWidget (运动详情由 LogWidget 按页读取)
+    m_logWidget->setModels(m_taskModel);
+    m_logWidget->setDataManager(m_controller->dataManager());
+
     m_taskSetupWidget->loadHistory(m_taskModel);
+    // 此后任务列表和日志视图只按 DataManager::taskChanged 增量更新，不再定时整表重新查询
     
-    // 定时刷新日志视图
-    QTimer *viewTimer = new QTimer(this);
-    connect(viewTimer, &QTimer::timeout, this, &MainWindow::updateLogView);
-    viewTimer->start(1000);
+    // 6. 检查是否有异常中断的任务 (窗口显示后再询问)
+    QTimer::singleShot(0, this, &MainWindow::checkPendingCheckpoint);
 }
 
-MainWindow::~MainWindow()
+void MainWindow::checkPendingCheckpoint()
 {
-    if (m_logModel) {
-        delete m_logModel;
-        m_logModel = nullptr;
+    TaskCheckpoint::Record record;
+    if (!m_controller->pendingCheckpoint(record)) return;
+    
+    QString progress = QString("已完成周期: %1").arg(record.snapshot.completedCycles);
+    if (record.snapshot.targetCycles > 0) {
+        progress += QString("/%1").arg(record.snapshot.targetCycles);
+    }
+    if (record.snapshot.stepIndex >= 0) {
+        progress += QString("，中断于第 %1 步").arg(record.snapshot.stepIndex + 1);
+    }
+    
+    const auto reply = QMessageBox::question(
+        this,
+        "恢复任务",
+        QString("检测到任务 %1 在上次运行中异常中断 (%2)。\n%3\n中断位置: %4 mm\n\n是否在连接设备后从中断处继续？")
+            .arg(record.taskId)
+            .arg(record.savedAt.toString("yyyy-MM-dd HH:mm:ss"))
+            .arg(progress)
+            .arg(record.snapshot.position, 0, 'f', 1),
+        QMessageBox::Yes | QMessageBox::No,
+        QMessageBox::Yes
+    );
+    
+    if (reply == QMessageBox::Yes) {
+        m_resumeOnConnect = true;
+        if (m_isConnected) {
+            m_resumeOnConnect = false;
+            m_controller->resumeFromCheckpoint().then(this, [this](QString error) {
+                if (!error.isEmpty()) QMessageBox::warning(this, "错误", error);
+            });
+        }
+    } else {
+        // 列表在状态写入完成后由 taskRecordChanged 刷新
+        m_controller->updateTaskStatus(record.taskId, "stopped");
+        m_controller->discardCheckpoint();
     }
+}
+
+MainWindow::~MainWindow()
+{
     if (m_taskModel) {
         delete m_taskModel;
         m_taskModel = nullptr;
@@ -222,7 +256,8 @@ void MainWindow::initUI()
     dashLayout->setContentsMargins(30, 30, 30, 30);
     dashLayout->setSpacing(20);
     m_connWidget = new ConnectionWidget(this);
-    m_statusWidget = new StatusWidget(this);
+    m_telemetry = new TelemetryHistory(this);
+    m_statusWidget = new StatusWidget(m_telemetry, this);
     dashLayout->addWidget(m_connWidget);
     dashLayout->addWidget(m_statusWidget);
     dashLayout->addStretch();
@@ -242,7 +277,7 @@ void MainWindow::initUI()
     QVBoxLayout *manualLayout = new QVBoxLayout(pageManual);
     manualLayout->setContentsMargins(30, 30, 30, 30);
     manualLayout->setSpacing(20);
-    m_statusManual = new StatusWidget(this); 
+    m_statusManual = new StatusWidget(m_telemetry, this);
     m_manualWidget = new ManualControlWidget(this);
     manualLayout->addWidget(m_statusManual);
     manualLayout->addWidget(m_manualWidget);
@@ -254,7 +289,7 @@ void MainWindow::initUI()
     QVBoxLayout *autoLayout = new QVBoxLayout(pageAuto);
     autoLayout->setContentsMargins(30, 30, 30, 30);
     autoLayout->setSpacing(20);
-    m_statusAuto = new StatusWidget(this);
+    m_statusAuto = new StatusWidget(m_telemetry, this);
     m_autoTaskWidget = new AutoTaskWidget(this);
     autoLayout->addWidget(m_statusAuto);
     autoLayout->addWidget(m_autoTaskWidget);
@@ -353,32 +388,49 @@ void MainWindow::initLogic()
         m_controller->startNewTask(op, tube);
     });
     connect(m_taskSetupWidget, &TaskSetupWidget::configTaskClicked, this, [this](int taskId){
-        // 打开任务配置对话框
-        TaskConfigWidget configDialog(taskId, this);
-        
-        // 加载现有配置
-        QString taskType, taskConfig;
-        if (m_controller->dataManager()->getTaskConfig(taskId, taskType, taskConfig)) {
-            configDialog.setTaskConfig(taskType, taskConfig);
-        }
-        
-        if (configDialog.exec() == QDialog::Accepted) {
+        // 读取现有配置 (数据库线程)，完成后打开任务配置对话框
+        m_controller->dataManager()->getTaskConfigAsync(taskId).then(this, [this, taskId](DataManager::TaskConfigResult current){
+            TaskConfigWidget configDialog(taskId, this);
+            if (current.ok) {
+                configDialog.setTaskConfig(current.taskType, current.taskConfig);
+            }
+
+            if (configDialog.exec() != QDialog::Accepted) {
+                return;
+            }
+
             // 保存配置
-            QString newTaskType = configDialog.getTaskType();
-            QString newTaskConfig = configDialog.getTaskConfig();
-            
-            if (m_controller->dataManager()->updateTaskConfig(taskId, newTaskType, newTaskConfig)) {
-                // 更新任务状态为已配置
+            const QString newTaskType = configDialog.getTaskType();
+            const QString newTaskConfig = configDialog.getTaskConfig();
+            m_controller->dataManager()->updateTaskConfigAsync(taskId, newTaskType, newTaskConfig)
+                .then(this, [this, taskId, newTaskType, newTaskConfig](bool ok){
+                if (!ok) {
+                    QMessageBox::warning(this, "错误", "保存任务配置失败");
+                    return;
+                }
+
+                // 更新任务状态为已配置 (写入完成后由 taskRecordChanged 刷新列表)
                 m_controller->updateTaskStatus(taskId, "configured");
-                QMessageBox::information(this, "提示", "任务配置已保存");
-                
-                // 刷新任务列表
-                if (m_taskModel) m_taskModel->select();
-                m_taskSetupWidget->loadHistory(m_taskModel);
-            } else {
-                QMessageBox::warning(this, "错误", "保存任务配置失败");
-            }
-        }
+
+                // 离线仿真预估执行时间 (速度表所需的历史数据在后台读取)
+                TaskManager::TaskPlan plan;
+                TaskManager::parseTaskPlan(newTaskType, newTaskConfig, plan);
+                m_controller->prepareSpeedMap(taskId, plan)
+                    .then(this, [this, newTaskType, newTaskConfig](DeviceController::SpeedMapResult speedMap){
+                    DryRunSimulator::Options options;
+                    options.useSpeedMap = speedMap.ok;
+                    options.speedMap = speedMap.map;
+                    DryRunSimulator::Report report = DryRunSimulator(options).runConfig(newTaskType, newTaskConfig);
+                    QString info = "任务配置已保存";
+                    if (report.ok) {
+                        info += "\n\n" + report.summary();
+                    } else if (!report.message.isEmpty()) {
+                        info += "\n\n预估失败: " + report.message;
+                    }
+                    QMessageBox::information(this, "提示", info);
+                });
+            });
+        });
     });
     connect(m_taskSetupWidget, &TaskSetupWidget::executeTaskClicked, this, [this](int taskId){
         // 检查设备连接状态
@@ -387,30 +439,44 @@ void MainWindow::initLogic()
             return;
         }
         
-        // 执行任务
-        QString taskType, taskConfig;
-        if (!m_controller->dataManager()->getTaskConfig(taskId, taskType, taskConfig)) {
-            QMessageBox::warning(this, "错误", "无法获取任务配置");
+        // 执行任务 (后台读取配置，完成后激活任务并启动)
+        m_controller->executeTask(taskId).then(this, [this, taskId](QString error) {
+            if (!error.isEmpty()) {
+                QMessageBox::warning(this, "错误", error);
+                return;
+            }
+
+            // 更新UI中的任务状态显示
+            m_taskSetupWidget->updateTaskStatusInTable(taskId, "running");
+        });
+    });
+    connect(m_taskSetupWidget, &TaskSetupWidget::batchExecuteTasksClicked, this, [this](const QList<int> &taskIds){
+        // 检查设备连接状态
+        if (!m_isConnected) {
+            QMessageBox::warning(this, "提示", "请连接设备后重试");
             return;
         }
         
-        // 激活任务并更新状态为运行中
-        m_controller->activateTask(taskId);
-        m_controller->updateTaskStatus(taskId, "running");
-        
-        // 更新UI中的任务状态显示
-        m_taskSetupWidget->updateTaskStatusInTable(taskId, "running");
+        const auto reply = QMessageBox::question(
+            this,
+            "批量执行",
+            QString("将按列表顺序连续执行选中的 %1 个任务。\n任务之间是否先回零？").arg(taskIds.size()),
+            QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel,
+            QMessageBox::Yes
+        );
+        if (reply == QMessageBox::Cancel) return;
         
-        // 根据任务类型执行相应的操作
-        if (taskType == "auto_scan") {
-            executeAutoScanTask(taskConfig);
-        } else if (taskType == "sequence") {
-            executeSequenceTask(taskConfig);
+        QString error;
+        if (!m_controller->startTaskQueue(taskIds, reply == QMessageBox::Yes, &error)) {
+            QMessageBox::warning(this, "错误", error);
         }
     });
     connect(m_taskSetupWidget, &TaskSetupWidget::stopTaskClicked, this, [this](int taskId){
         // 停止任务执行
         if (m_controller->currentTaskId() == taskId) {
+            // 手动停止同时结束批量执行队列
+            m_controller->stopTaskQueue();
+            
             // 停止TaskManager中的任务
             TaskManager *tm = m_controller->taskManager();
             if (tm) {
@@ -430,7 +496,7 @@ void MainWindow::initLogic()
             
             QJsonDocument doc(result);
             QString resultJson = doc.toJson(QJsonDocument::Compact);
-            m_controller->dataManager()->updateTaskExecutionResult(taskId, resultJson);
+            m_controller->dataManager()->updateTaskExecutionResultAsync(taskId, resultJson);
             
             // 清除当前任务ID
             m_controller->endCurrentTask();
@@ -443,13 +509,14 @@ void MainWindow::initLogic()
     });
     connect(m_taskSetupWidget, &TaskSetupWidget::viewResultClicked, this, [this](int taskId){
         // 查看任务结果
-        QString result = m_controller->dataManager()->getTaskExecutionResult(taskId);
-        if (result.isEmpty()) {
-            QMessageBox::information(this, "提示", "该任务暂无执行结果");
-        } else {
-            // 这里可以创建一个结果查看对话框
-            QMessageBox::information(this, "任务执行结果", result);
-        }
+        m_controller->dataManager()->getTaskExecutionResultAsync(taskId).then(this, [this](QString result){
+            if (result.isEmpty()) {
+                QMessageBox::information(this, "提示", "该任务暂无执行结果");
+            } else {
+                // 这里可以创建一个结果查看对话框
+                QMessageBox::information(this, "任务执行结果", result);
+            }
+        });
     });
     connect(m_taskSetupWidget, &TaskSetupWidget::deleteTaskClicked, this, [this](int taskId){
         const auto reply = QMessageBox::question(
@@ -462,35 +529,24 @@ void MainWindow::initLogic()
         if (reply != QMessageBox::Yes) {
             return;
         }
-        if (m_controller->deleteTask(taskId)) {
-            if (m_taskModel) m_taskModel->select();
-            m_taskSetupWidget->loadHistory(m_taskModel);
-        }
+        // 删除成功后由 taskChanged 移除对应行
+        m_controller->deleteTask(taskId);
     });
     connect(m_taskSetupWidget, &TaskSetupWidget::batchDeleteTasksClicked, this, [this](const QList<int> &taskIds){
-        // 批量删除任务
-        int successCount = 0;
-        int failCount = 0;
-        
-        for (int taskId : taskIds) {
-            if (m_controller->deleteTask(taskId)) {
-                successCount++;
+        // 批量删除任务 (单个事务，对应行由 taskChanged 移除)
+        const int requested = taskIds.size();
+        m_controller->deleteTasks(taskIds).then(this, [this, requested](DataManager::BulkResult result){
+            // 显示删除结果
+            if (!result.ok) {
+                QMessageBox::warning(this, "删除失败", QString("批量删除任务失败: %1").arg(result.error));
+            } else if (result.taskIds.size() == requested) {
+                QMessageBox::information(this, "删除完成", QString("成功删除 %1 个任务").arg(result.taskIds.size()));
             } else {
-                failCount++;
+                QMessageBox::warning(this, "删除完成", QString("成功删除 %1 个任务，失败 %2 个").arg(result.taskIds.size()).arg(requested - result.taskIds.size()));
             }
-        }
-        
-        // 刷新任务列表
-        if (m_taskModel) m_taskModel->select();
-        m_taskSetupWidget->loadHistory(m_taskModel);
-        
-        // 显示删除结果
-        if (failCount == 0) {
-            QMessageBox::information(this, "删除完成", QString("成功删除 %1 个任务").arg(successCount));
-        } else {
-            QMessageBox::warning(this, "删除完成", QString("成功删除 %1 个任务，失败 %2 个").arg(successCount).arg(failCount));
-        }
+        });
     });
+    connect(m_taskSetupWidget, &TaskSetupWidget::importTasksClicked, this, &MainWindow::onImportTasksClicked);
 
     // --- 3. 手动控制事件 ---
     connect(m_manualWidget, &ManualControlWidget::moveForwardClicked, this, &MainWindow::onForwardPressed);
@@ -520,38 +576,60 @@ void MainWindow::initLogic()
         m_connWidget->setConnectedState(connected);
         
         if (!connected) {
-             if (m_statusWidget) m_statusWidget->setDisconnected();
-             if (m_statusManual) m_statusManual->setDisconnected();
-             if (m_statusAuto) m_statusAuto->setDisconnected();
+             m_telemetry->setDisconnected();
         }
 
         // 重新计算控制权限：只要已连接就可以控制
         m_manualWidget->setControlsEnabled(m_isConnected);
         m_autoTaskWidget->setEnabled(m_isConnected);
+        
+        // 恢复异常中断的任务
+        if (connected && m_resumeOnConnect) {
+            m_resumeOnConnect = false;
+            m_controller->resumeFromCheckpoint().then(this, [this](QString error) {
+                if (!error.isEmpty()) QMessageBox::warning(this, "错误", error);
+            });
+        }
     });
     
     // 任务状态变化
     connect(m_controller, &DeviceController::taskStateChanged, this, [this](int taskId){
         // 更新任务页状态 (仅刷新按钮)
-        // 注意：这里不再负责添加行，添加行由 taskCreated 负责
+        // 注意：这里不负责添加行，添加行由 taskChanged (Inserted) 负责
+        // 状态写入数据库后由 taskChanged 刷新对应行
         m_taskSetupWidget->updateTaskState(taskId);
         
-        // 如果任务完成或失败，需要刷新数据库模型以显示最新状态
-        if (taskId != -1) {
-            if (m_taskModel) m_taskModel->select();
-            m_taskSetupWidget->loadHistory(m_taskModel);
-        }
-        
         // 控制权限只依赖连接状态，不依赖任务状态
         // 这样任务完成后用户仍然可以进行手动控制或开始新任务
     });
     
-    // 任务创建通知
+    // 批量执行结束通知
+    connect(m_controller, &DeviceController::queueFinished, this, [this](const DeviceController::QueueStats &stats){
+        QString text = QString("完成 %1/%2 个任务，失败 %3 个\n总耗时: %4 s\n吞吐量: %5 管/小时\n任务间空闲: 共 %6 s，最大 %7 s")
+                           .arg(stats.completed).arg(stats.total).arg(stats.failed)
+                           .arg(stats.elapsedMs / 1000.0, 0, 'f', 1)
+                           .arg(stats.tubesPerHour, 0, 'f', 1)
+                           .arg(stats.idleMs / 1000.0, 0, 'f', 1)
+                           .arg(stats.maxIdleGapMs / 1000.0, 0, 'f', 1);
+        QMessageBox::information(this, "批量执行结束", text);
+    });
+    
+    // 任务数据变更：删除直接移除行，其余按任务ID读取 TaskListView 中的对应行
+    connect(m_controller->dataManager(), &DataManager::taskChanged, this, [this](const DataManager::TaskChange &change){
+        if (change.kind == DataManager::TaskChange::Deleted) {
+            m_taskSetupWidget->removeTasks(QList<int>(change.taskIds.begin(), change.taskIds.end()));
+            return;
+        }
+        const bool insertMissing = change.kind == DataManager::TaskChange::Inserted;
+        m_controller->dataManager()->taskRowsAsync(change.taskIds).then(this, [this, insertMissing](QVector<QSqlRecord> rows){
+            m_taskSetupWidget->applyTaskRows(rows, insertMissing);
+        });
+    });
+
+    // 任务创建通知 (列表行由 taskChanged 插入)
     connect(m_controller, &DeviceController::taskCreated, this, [this](int taskId, QString op, QString tube){
-        if (m_taskModel) m_taskModel->select();
         if (m_taskSetupWidget) {
-            m_taskSetupWidget->loadHistory(m_taskModel);
-            m_taskSetupWidget->updateTaskState(taskId);
+            m_taskSetupWidget->updateTaskState(taskId, op, tube);
         }
     });
 
@@ -576,6 +654,66 @@ void MainWindow::initLogic()
     onUserChanged(UserManager::instance().currentUser());
 }
 
+/**
+ * @brief 从 CSV/JSON 工单批量创建任务
+ * 解析与参数校验在 UI 线程完成，插入在数据库线程中以单个事务执行。
+ */
+void MainWindow::onImportTasksClicked()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "导入检测工单", QString(),
+                                                      "检测工单 (*.csv *.json);;所有文件 (*)");
+    if (path.isEmpty()) return;
+
+    QString defaultOperator = m_taskSetupWidget->operatorName();
+    if (defaultOperator.isEmpty()) defaultOperator = UserManager::instance().currentUser().username;
+
+    QVector<WorkOrderImport::Item> items;
+    QStringList warnings;
+    QString error;
+    if (!WorkOrderImport::parseFile(path, defaultOperator, items, &warnings, &error)) {
+        QMessageBox::warning(this, "导入失败", error);
+        return;
+    }
+
+    // 带配置的条目先按执行时的规则校验，避免导入后才发现无法执行
+    QVector<WorkOrderImport::Item> valid;
+    valid.reserve(items.size());
+    for (const WorkOrderImport::Item &item : items) {
+        if (!item.taskConfig.isEmpty()) {
+            TaskManager::TaskPlan plan;
+            QString planError;
+            if (!TaskManager::parseTaskPlan(item.taskType, item.taskConfig, plan, &planError)) {
+                warnings.append(QString("第 %1 行: 管道 %2 配置无效 (%3)").arg(item.line).arg(item.tubeId, planError));
+                continue;
+            }
+        }
+        valid.append(item);
+    }
+
+    if (valid.isEmpty()) {
+        QMessageBox::warning(this, "导入失败", "工单中没有可导入的任务\n\n" + warnings.mid(0, 10).join("\n"));
+        return;
+    }
+
+    QString question = QString("将创建 %1 个任务").arg(valid.size());
+    if (!warnings.isEmpty()) {
+        question += QString("，跳过 %1 条：\n\n%2").arg(warnings.size()).arg(warnings.mid(0, 10).join("\n"));
+        if (warnings.size() > 10) question += "\n...";
+    }
+    question += "\n\n是否继续？";
+    if (QMessageBox::question(this, "导入检测工单", question) != QMessageBox::Yes) return;
+
+    // 新任务行由 taskChanged 插入
+    m_controller->dataManager()->createDetectionTasksAsync(valid).then(this, [this](DataManager::BulkResult result){
+        if (!result.ok) {
+            QMessageBox::warning(this, "导入失败", QString("批量创建任务失败: %1").arg(result.error));
+            return;
+        }
+
+        QMessageBox::information(this, "导入完成", QString("已创建 %1 个任务").arg(result.taskIds.size()));
+    });
+}
+
 void MainWindow::onLoginLogoutClicked()
 {
     if (UserManager::instance().currentUser().role != UserManager::Guest) {
@@ -700,72 +838,6 @@ void MainWindow::onSliderValueChanged(int val)
 
 void MainWindow::updateStatusDisplay(MotionFeedback fb)
 {
-    // 同步更新所有页面的状态监控组件
-    if (m_statusWidget) m_statusWidget->updateStatus(fb);
-    if (m_statusManual) m_statusManual->updateStatus(fb);
-    if (m_statusAuto) m_statusAuto->updateStatus(fb);
-}
-
-void MainWindow::updateLogView()
-{
-    m_logWidget->refresh();
-}
-void MainWindow::executeAutoScanTask(const QString &configJson)
-{
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(configJson.toUtf8(), &error);
-    if (error.error != QJsonParseError::NoError) {
-        QMessageBox::warning(this, "错误", "任务配置格式错误");
-        return;
-    }
-    
-    QJsonObject config = doc.object();
-    double minPos = config["minPos"].toDouble(0.0);
-    double maxPos = config["maxPos"].toDouble(100.0);
-    double speed = config["speed"].toDouble(20.0);
-    int cycles = config["cycles"].toInt(5);
-    
-    // 执行自动扫描
-    TaskManager *tm = m_controller->taskManager();
-    if (tm) {
-        tm->startAutoScan(minPos, maxPos, speed, cycles);
-    }
+    // 只写入共享的遥测数据，由当前可见页面的状态监控绘制
+    m_telemetry->append(fb);
 }
-
-void MainWindow::executeSequenceTask(const QString &configJson)
-{
-    QJsonParseError error;
-    QJsonDocument doc = QJsonDocument::fromJson(configJson.toUtf8(), &error);
-    if (error.error != QJsonParseError::NoError) {
-        QMessageBox::warning(this, "错误", "任务配置格式错误");
-        return;
-    }
-    
-    QJsonObject config = doc.object();
-    int cycles = config["cycles"].toInt(1);
-    QJsonArray stepsArray = config["steps"].toArray();
-    
-    QList<TaskManager::TaskStep> steps;
-    for (const QJsonValue &stepValue : stepsArray) {
-        QJsonObject stepObj = stepValue.toObject();
-        TaskManager::TaskStep step;
-        step.type = static_cast<TaskManager::StepType>(stepObj["type"].toInt());
-        step.param1 = stepObj["param1"].toDouble();
-        step.param2 = stepObj["param2"].toDouble();
-        
-        // 生成描述
-        if (step.type == TaskManager::StepType::MoveTo) {
-            step.description = QString("MoveTo %1mm @ %2%").arg(step.param1).arg(step.param2);
-        } else if (step.type == TaskManager::StepType::Wait) {
-            step.description = QString("Wait %1ms").arg(step.param1);
-        }
-        
-        steps.append(step);
-    }
-    
-    // 执行脚本序列
-    TaskManager *tm = m_controller->taskManager();
-    if (tm) {
-        tm->startTaskSequence(steps, cycles);
-    }
-}
\ No newline at end of file
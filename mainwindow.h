@@ -55,6 +55,9 @@ private slots:
     void onSettingsClicked();
     void onLoginLogoutClicked();
 
+    // 批量导入检测工单
+    void onImportTasksClicked();
+
     void onForwardPressed();
     void onBackwardPressed();
     void onStopClicked();
@@ -66,12 +69,6 @@ private slots:
      */
     void updateStatusDisplay(MotionFeedback fb);
 
-    /**
-     * @brief 定时刷新日志视图
-     * 为了性能考虑，不是每次插入数据都刷新，而是定时刷新
-     */
-    void updateLogView();
-
     // 用户权限变更
     void onUserChanged(const UserManager::User &user);
 
@@ -105,16 +102,11 @@ private:
      * @brief 检查并强制登录
      */
     void checkLogin();
-    
-    /**
-     * @brief 执行自动扫描任务
-     */
-    void executeAutoScanTask(const QString &configJson);
-    
+
     /**
-     * @brief 执行脚本序列任务
+     * @brief 检查上次异常退出遗留的任务检查点，询问是否恢复
      */
-    void executeSequenceTask(const QString &configJson);
+    void checkPendingCheckpoint();
     
     QIcon createIcon(const QString &text, const QColor &bg, const QColor &fg); // 新增图标生成辅助函数
 
@@ -130,6 +122,7 @@ private:
     QStackedWidget *m_mainStack;   ///< 右侧内容区域
 
     ConnectionWidget *m_connWidget;
+    TelemetryHistory *m_telemetry;     ///< 各页面状态监控共享的遥测数据
     StatusWidget *m_statusWidget;      ///< 概览页的状态监控
     
     TaskSetupWidget *m_taskSetupWidget;///< 任务配置页
@@ -141,12 +134,12 @@ private:
     LogWidget *m_logWidget;
 
     // --- 数据模型 ---
-    QSqlTableModel *m_logModel;
     QSqlTableModel *m_taskModel;
 
     // --- 核心逻辑 ---
     DeviceController *m_controller;
     bool m_isConnected = false;
+    bool m_resumeOnConnect = false; ///< 连接设备后恢复检查点任务
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,177 @@
+/**
+ * @brief 任务归档命令行工具
+ *
+ * 在没有界面的分析工位上导出/导入/检查任务归档 (.epa，格式见 data/taskarchive.h)：
+ *   eparchive info   <archive>                    列出归档中的任务 (同时校验全部数据块)
+ *   eparchive export <db> <archive> [taskId ...]  导出任务，不指定ID时导出全部任务
+ *   eparchive import <db> <archive>               导入任务 (新分配ID，已导入过的跳过)
+ *
+ * <db> 为工位的 EddyPusher.db，采样文件按其所在目录解析。
+ */
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTextStream>
+#include "../data/sqliteconfig.h"
+#include "../data/taskarchive.h"
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+int usage()
+{
+    err() << "用法:\n"
+          << "  eparchive info   <archive>\n"
+          << "  eparchive export <db> <archive> [taskId ...]\n"
+          << "  eparchive import <db> <archive>\n";
+    return 2;
+}
+
+bool openDatabase(const QString &path, QSqlDatabase &db)
+{
+    if (!QFileInfo::exists(path)) {
+        err() << "数据库不存在: " << path << "\n";
+        return false;
+    }
+    db = QSqlDatabase::addDatabase("QSQLITE", "eparchive");
+    db.setDatabaseName(path);
+    SqliteConfig::prepare(db, SqliteConfig::Role::Primary);
+    if (!db.open()) {
+        err() << "数据库打开失败: " << db.lastError().text() << "\n";
+        return false;
+    }
+    SqliteConfig::applyPragmas(db, SqliteConfig::Role::Primary);
+    return true;
+}
+
+void printResult(const TaskArchive::Result &result, const char *verb, qint64 elapsedMs)
+{
+    const double mb = result.bytes / 1048576.0;
+    out() << verb << " " << result.taskIds.size() << " 个任务, " << result.samples << " 个采样, "
+          << QString::number(mb, 'f', 1) << " MB, 耗时 " << elapsedMs << " ms";
+    if (elapsedMs > 0) out() << " (" << QString::number(mb * 1000.0 / elapsedMs, 'f', 1) << " MB/s)";
+    if (result.skipped > 0) out() << ", 跳过 " << result.skipped << " 个";
+    out() << "\n";
+}
+
+int runInfo(const QString &archivePath)
+{
+    TaskArchive::Reader reader;
+    QString error;
+    if (!reader.open(archivePath, &error)) {
+        err() << "归档无效: " << error << "\n";
+        return 1;
+    }
+
+    out() << "工位: " << reader.station() << "  创建时间: " << reader.created()
+          << "  大小: " << reader.size() << " 字节\n";
+    qint64 samples = 0;
+    for (const TaskArchive::Task &task : reader.tasks()) {
+        out() << QString("  %1  管号 %2  %3  %4  采样 %5\n")
+                     .arg(task.meta.value("origin").toString(), -24)
+                     .arg(task.meta.value("tube_id").toString(), -12)
+                     .arg(task.meta.value("start_time").toString(), -24)
+                     .arg(task.meta.value("status").toString(), -10)
+                     .arg(task.samples);
+        samples += task.samples;
+    }
+    out() << reader.tasks().size() << " 个任务, " << samples << " 个采样, 校验通过\n";
+    return 0;
+}
+
+int runExport(const QString &dbPath, const QString &archivePath, const QStringList &idArgs)
+{
+    QSqlDatabase db;
+    if (!openDatabase(dbPath, db)) return 1;
+
+    QList<int> taskIds;
+    for (const QString &arg : idArgs) {
+        bool ok = false;
+        const int id = arg.toInt(&ok);
+        if (!ok || id <= 0) {
+            err() << "无效的任务ID: " << arg << "\n";
+            return 2;
+        }
+        taskIds.append(id);
+    }
+    if (taskIds.isEmpty()) {
+        QSqlQuery query(db);
+        if (!query.exec("SELECT id FROM DetectionTask ORDER BY id")) {
+            err() << "查询任务失败: " << query.lastError().text() << "\n";
+            return 1;
+        }
+        while (query.next()) taskIds.append(query.value(0).toInt());
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const TaskArchive::Result result =
+        TaskArchive::exportTasks(db, QFileInfo(dbPath).absolutePath(), taskIds, archivePath);
+    if (!result.ok) {
+        err() << "导出失败: " << result.error << "\n";
+        return 1;
+    }
+    printResult(result, "导出", timer.elapsed());
+    return 0;
+}
+
+int runImport(const QString &dbPath, const QString &archivePath)
+{
+    QSqlDatabase db;
+    if (!openDatabase(dbPath, db)) return 1;
+
+    QElapsedTimer timer;
+    timer.start();
+    const TaskArchive::Result result =
+        TaskArchive::importTasks(db, QFileInfo(dbPath).absolutePath(), archivePath);
+    if (!result.ok) {
+        err() << "导入失败: " << result.error << " (已导入 " << result.taskIds.size() << " 个任务)\n";
+        return 1;
+    }
+    printResult(result, "导入", timer.elapsed());
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+    if (args.isEmpty()) return usage();
+
+    const QString command = args.first();
+    int rc = 0;
+    if (command == "info" && args.size() == 2) {
+        rc = runInfo(args[1]);
+    } else if (command == "export" && args.size() >= 3) {
+        rc = runExport(args[1], args[2], args.mid(3));
+    } else if (command == "import" && args.size() == 3) {
+        rc = runImport(args[1], args[2]);
+    } else {
+        return usage();
+    }
+
+    out().flush();
+    err().flush();
+    if (QSqlDatabase::contains("eparchive")) {
+        QSqlDatabase::database("eparchive", false).close();
+        QSqlDatabase::removeDatabase("eparchive");
+    }
+    return rc;
+}
@@ -352,6 +352,11 @@ void AutoTaskWidget::updateState(TaskManager::State state)
              m_btnResetTask->setText("重置任务");
              m_btnResetTask->setEnabled(true);  // 只有暂停时才能重置
              m_isPaused = true;
+        } else if (state == TaskManager::State::DeviceProgram) {
+             // 下位机程序执行中：不支持暂停/重置，只能停止
+             m_btnPauseTask->setEnabled(false);
+             m_btnResetTask->setEnabled(false);
+             m_isPaused = false;
         } else if (state == TaskManager::State::Resetting) {
              // 重置中：禁用所有操作
              m_btnPauseTask->setEnabled(false);
@@ -387,6 +392,9 @@ void AutoTaskWidget::updateState(TaskManager::State state)
         m_btnStartTask->setText("自动扫描运行中...");
     } else if (state == TaskManager::State::StepExecution) {
         m_btnRunSeq->setText("脚本正在执行...");
+    } else if (state == TaskManager::State::DeviceProgram) {
+        m_btnStartTask->setText("下位机程序执行中...");
+        m_btnRunSeq->setText("下位机程序执行中...");
     } else if (state == TaskManager::State::Resetting) {
         m_btnStartTask->setText("重置中，请稍候...");
         m_btnRunSeq->setText("重置中，请稍候...");
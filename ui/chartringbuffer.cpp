@@ -0,0 +1,73 @@
+#include "chartringbuffer.h"
+
+ChartRingBuffer::ChartRingBuffer(int capacity)
+{
+    setCapacity(capacity);
+}
+
+void ChartRingBuffer::setCapacity(int capacity)
+{
+    capacity = qMax(0, capacity);
+    m_t.fill(0.0, capacity);
+    m_position.fill(0.0, capacity);
+    m_speed.fill(0.0, capacity);
+    clear();
+}
+
+void ChartRingBuffer::clear()
+{
+    m_head = 0;
+    m_size = 0;
+    ++m_generation;
+}
+
+void ChartRingBuffer::append(double t, double position, double speed)
+{
+    const int cap = capacity();
+    if (cap == 0) return;
+
+    m_t[m_head] = t;
+    m_position[m_head] = position;
+    m_speed[m_head] = speed;
+    m_head = (m_head + 1) % cap;
+    if (m_size < cap) ++m_size;
+    ++m_generation;
+}
+
+double ChartRingBuffer::lastTime() const
+{
+    return m_size > 0 ? m_t[indexOf(m_size - 1)] : 0.0;
+}
+
+int ChartRingBuffer::indexOf(int i) const
+{
+    const int cap = capacity();
+    return (m_head - m_size + i + cap) % cap;
+}
+
+void ChartRingBuffer::points(double fromT, QList<QPointF> &position, QList<QPointF> &speed) const
+{
+    position.clear();
+    speed.clear();
+    if (m_size == 0) return;
+
+    // 时间递增，二分查找窗口起点
+    int lo = 0;
+    int hi = m_size;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (m_t[indexOf(mid)] < fromT) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    position.reserve(m_size - lo);
+    speed.reserve(m_size - lo);
+    for (int i = lo; i < m_size; ++i) {
+        const int k = indexOf(i);
+        position.append(QPointF(m_t[k], m_position[k]));
+        speed.append(QPointF(m_t[k], m_speed[k]));
+    }
+}
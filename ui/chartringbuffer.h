@@ -0,0 +1,57 @@
+#ifndef CHARTRINGBUFFER_H
+#define CHARTRINGBUFFER_H
+
+#include <QList>
+#include <QPointF>
+#include <QVector>
+
+/**
+ * @brief 实时曲线的定长环形缓冲 (时间, 位置, 速度)
+ *
+ * 容量在 setCapacity() 时一次性分配，写满后覆盖最旧的点，长时间运行内存占用不变。
+ * 曲线按显示帧率从缓冲中取出时间窗口内的点，用 QXYSeries::replace() 整体替换。
+ */
+class ChartRingBuffer
+{
+public:
+    explicit ChartRingBuffer(int capacity = 0);
+
+    /**
+     * @brief 重新分配容量 (清空已有数据)
+     */
+    void setCapacity(int capacity);
+
+    int capacity() const { return m_t.size(); }
+    int size() const { return m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    void clear();
+
+    void append(double t, double position, double speed);
+
+    /**
+     * @brief 内容版本号，每次追加或清空时递增；视图据此跳过内容未变的刷新
+     */
+    quint64 generation() const { return m_generation; }
+
+    /**
+     * @brief 最新一个点的时间 (缓冲为空时为 0)
+     */
+    double lastTime() const;
+
+    /**
+     * @brief 取出时间 >= fromT 的点 (按时间递增，复用输出列表的容量)
+     */
+    void points(double fromT, QList<QPointF> &position, QList<QPointF> &speed) const;
+
+private:
+    int indexOf(int i) const;   ///< 第 i 旧的点在数组中的下标
+
+    QVector<double> m_t;
+    QVector<double> m_position;
+    QVector<double> m_speed;
+    int m_head = 0;             ///< 下一个写入位置
+    int m_size = 0;
+    quint64 m_generation = 0;
+};
+
+#endif // CHARTRINGBUFFER_H
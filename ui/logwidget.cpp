@@ -14,6 +14,13 @@
 #include <QTableWidgetItem>
 #include <QCheckBox>
 #include <QDebug>
+#include <QDateTime>
+#include <QProgressDialog>
+#include <QHash>
+#include "../data/datamanager.h"
+#include "../data/motionlogexporter.h"
+
+static const int kQueryPageSize = 200;
 
 LogWidget::LogWidget(QWidget *parent) : QGroupBox("数据日志 (SQLite)", parent)
 {
@@ -38,8 +45,9 @@ LogWidget::LogWidget(QWidget *parent) : QGroupBox("数据日志 (SQLite)", paren
     m_dateEnd->setDisplayFormat("yyyy-MM-dd");
     
     m_editTubeId = new QLineEdit();
-    m_editTubeId->setPlaceholderText("管号过滤 (可选)");
-    m_editTubeId->setFixedWidth(150);
+    m_editTubeId->setPlaceholderText("管号/操作员/结果 (可选)");
+    m_editTubeId->setToolTip("按子串检索管道编号、操作员和结果信息，多个词用空格分隔");
+    m_editTubeId->setFixedWidth(180);
     
     m_btnQuery = new QPushButton("查询任务");
     m_btnQuery->setCursor(Qt::PointingHandCursor);
@@ -53,17 +61,28 @@ LogWidget::LogWidget(QWidget *parent) : QGroupBox("数据日志 (SQLite)", paren
     m_btnExport->setCursor(Qt::PointingHandCursor);
     m_btnExport->setObjectName("btnConnect"); // 复用样式
     m_btnExport->setEnabled(false); // 初始禁用，选中任务后启用
+
+    m_btnArchiveExport = new QPushButton("导出归档");
+    m_btnArchiveExport->setCursor(Qt::PointingHandCursor);
+    m_btnArchiveExport->setToolTip("将选中任务 (含采样数据) 导出为归档文件，可在其他工位导入");
+    m_btnArchiveExport->setEnabled(false);
+
+    m_btnArchiveImport = new QPushButton("导入归档");
+    m_btnArchiveImport->setCursor(Qt::PointingHandCursor);
+    m_btnArchiveImport->setToolTip("导入其他工位导出的任务归档，已导入过的任务自动跳过");
     
     filterLayout->addWidget(new QLabel("开始日期\nStart:"));
     filterLayout->addWidget(m_dateStart);
     filterLayout->addWidget(new QLabel("结束日期\nEnd:"));
     filterLayout->addWidget(m_dateEnd);
-    filterLayout->addWidget(new QLabel("管号\nTube ID:"));
+    filterLayout->addWidget(new QLabel("检索\nSearch:"));
     filterLayout->addWidget(m_editTubeId);
     filterLayout->addWidget(m_btnQuery);
     filterLayout->addStretch();
     filterLayout->addWidget(m_btnSelectAll);
     filterLayout->addWidget(m_btnExport);
+    filterLayout->addWidget(m_btnArchiveExport);
+    filterLayout->addWidget(m_btnArchiveImport);
     
     mainLayout->addLayout(filterLayout);
 
@@ -81,6 +100,11 @@ LogWidget::LogWidget(QWidget *parent) : QGroupBox("数据日志 (SQLite)", paren
     m_taskTable->setAlternatingRowColors(true);
     m_taskTable->horizontalHeader()->setStretchLastSection(true);
     topLayout->addWidget(m_taskTable);
+
+    m_btnMore = new QPushButton("加载更多");
+    m_btnMore->setCursor(Qt::PointingHandCursor);
+    m_btnMore->setVisible(false);
+    topLayout->addWidget(m_btnMore, 0, Qt::AlignHCenter);
     
     splitter->addWidget(topWidget);
 
@@ -107,48 +131,59 @@ LogWidget::LogWidget(QWidget *parent) : QGroupBox("数据日志 (SQLite)", paren
     // 连接信号
     connect(m_taskTable, &QTableWidget::cellClicked, this, &LogWidget::onTaskSelected);
     connect(m_btnQuery, &QPushButton::clicked, this, &LogWidget::onQueryClicked);
+    connect(m_editTubeId, &QLineEdit::returnPressed, this, &LogWidget::onQueryClicked);
+    connect(m_btnMore, &QPushButton::clicked, this, &LogWidget::onMoreClicked);
     connect(m_btnExport, &QPushButton::clicked, this, &LogWidget::onExportClicked);
     connect(m_btnSelectAll, &QPushButton::clicked, this, &LogWidget::onSelectAllClicked);
+    connect(m_btnArchiveExport, &QPushButton::clicked, this, &LogWidget::onArchiveExportClicked);
+    connect(m_btnArchiveImport, &QPushButton::clicked, this, &LogWidget::onArchiveImportClicked);
 }
 
-void LogWidget::setModels(QSqlTableModel *taskModel, QSqlTableModel *logModel)
+void LogWidget::setModels(QSqlTableModel *taskModel)
 {
     m_taskModel = taskModel;
-    m_logModel = logModel;
-
-    // 设置日志视图模型
-    m_logView->setModel(m_logModel);
-    
-    // 初始设置过滤器为空，不显示任何运动详情，避免一启动就刷屏
-    m_logModel->setFilter("1=0"); 
     
     // 更新任务表格
     updateTaskTable();
 }
 
-void LogWidget::refresh()
+void LogWidget::setDataManager(DataManager *dataManager)
 {
-    if (m_taskModel) m_taskModel->select();
-    
-    // 保存当前复选框状态
-    QSet<int> selectedTaskIds = getSelectedTaskIds();
-    
-    // 更新任务表格
-    updateTaskTable();
-    
-    // 恢复复选框状态
-    restoreCheckboxStates(selectedTaskIds);
-    
-    // logModel 不需要在这里全局刷新，它依赖于 filter
-    if (m_logModel) {
-        m_logModel->select();
-        // 自动拉取更多数据 (解决默认只显示256行的问题)
-        while(m_logModel->canFetchMore()) {
-            m_logModel->fetchMore();
-        }
+    if (m_dataManager) disconnect(m_dataManager, nullptr, this, nullptr);
+    m_dataManager = dataManager;
+    if (!m_dataManager) return;
+    connect(m_dataManager, &DataManager::taskChanged, this, &LogWidget::onTaskChanged);
+
+    // 运动详情按页在后台读取，初始不显示任何任务
+    if (!m_logModel) {
+        m_logModel = new MotionLogModel(m_dataManager->databasePath(), this);
+        m_logView->setModel(m_logModel);
     }
 }
 
+/**
+ * @brief 按任务变更增量刷新
+ * 删除的任务直接移除行；新建/更新的任务按ID读取对应行后替换或插入 (检索结果中不插入新任务)；
+ * 日志视图只在当前显示的任务写入新采样时读取新增部分。
+ */
+void LogWidget::onTaskChanged(const DataManager::TaskChange &change)
+{
+    if (change.kind == DataManager::TaskChange::Deleted) {
+        removeTaskRows(QSet<int>(change.taskIds.begin(), change.taskIds.end()));
+        return;
+    }
+
+    if (change.kind == DataManager::TaskChange::SamplesAppended && m_logModel
+        && change.taskIds.contains(m_logModel->taskId())) {
+        m_logModel->refresh();
+    }
+
+    const bool insertMissing = change.kind == DataManager::TaskChange::Inserted && !m_queryActive;
+    m_dataManager->taskRowsAsync(change.taskIds).then(this, [this, insertMissing](const QVector<QSqlRecord> &rows) {
+        applyTaskRows(rows, insertMissing);
+    });
+}
+
 void LogWidget::onTaskSelected(int row, int column)
 {
     if (row < 0 || !m_taskModel || !m_logModel) return;
@@ -164,14 +199,8 @@ void LogWidget::onTaskSelected(int row, int column)
     
     int taskId = idItem->text().toInt();
 
-    // 过滤日志表显示当前点击任务的详情
-    m_logModel->setFilter(QString("task_id = %1").arg(taskId));
-    m_logModel->select();
-    
-    // 自动拉取更多数据
-    while(m_logModel->canFetchMore()) {
-        m_logModel->fetchMore();
-    }
+    // 显示当前点击任务的详情 (只读取可见的页)
+    m_logModel->setTask(taskId);
 }
 
 void LogWidget::onCheckboxStateChanged()
@@ -201,30 +230,61 @@ void LogWidget::onCheckboxStateChanged()
 
 void LogWidget::onQueryClicked()
 {
-    if (!m_taskModel) return;
-
-    QString filter = QString("start_time BETWEEN '%1 00:00:00' AND '%2 23:59:59'")
-                         .arg(m_dateStart->date().toString("yyyy-MM-dd"))
-                         .arg(m_dateEnd->date().toString("yyyy-MM-dd"));
+    if (!m_dataManager) return;
 
-    QString tubeId = m_editTubeId->text().trimmed();
-    if (!tubeId.isEmpty()) {
-        filter += QString(" AND tube_id LIKE '%%1%'").arg(tubeId);
-    }
-
-    m_taskModel->setFilter(filter);
-    m_taskModel->select();
-    
-    // 更新任务表格
-    updateTaskTable();
+    m_queryActive = true;
+    runQuery(false);
     
     // 清空日志视图
-    m_logModel->setFilter("1=0");
-    m_logModel->select();
-    
-    updateExportButtonState();
+    if (m_logModel) m_logModel->setTask(0);
+}
+
+void LogWidget::onMoreClicked()
+{
+    if (m_queryActive && m_queryNextBeforeId > 0) runQuery(true);
+}
+
+/**
+ * @brief 按筛选条件检索任务 (数据库线程中执行参数化查询，按任务ID倒序分页)
+ * 不再修改共享的 m_taskModel 过滤条件，任务配置页的列表不受影响。
+ */
+void LogWidget::runQuery(bool nextPage)
+{
+    if (!m_dataManager) return;
+
+    DataManager::TaskQuery query;
+    query.text = m_editTubeId->text().trimmed();
+    query.fromDate = m_dateStart->date();
+    query.toDate = m_dateEnd->date();
+    query.beforeId = nextPage ? m_queryNextBeforeId : 0;
+    query.limit = kQueryPageSize;
+
+    const QSet<int> selectedTaskIds = getSelectedTaskIds();
+    const int serial = ++m_querySerial;
+    m_btnMore->setEnabled(false);
+
+    m_dataManager->searchTasksAsync(query).then(this, [this, serial, nextPage, selectedTaskIds](const DataManager::TaskPage &page) {
+        if (serial != m_querySerial) return; // 已有更新的查询
+        m_btnMore->setEnabled(true);
+        if (!page.ok) {
+            QMessageBox::warning(this, "查询失败", page.error);
+            return;
+        }
+
+        fillTaskTable(page.rows, nextPage);
+        restoreCheckboxStates(selectedTaskIds);
+
+        if (!page.rows.isEmpty()) m_queryNextBeforeId = page.rows.last().value("id").toInt();
+        m_btnMore->setVisible(page.hasMore);
+        m_btnMore->setToolTip(QString("已显示 %1 个任务 (本页查询 %2 ms)")
+                                  .arg(m_taskTable->rowCount()).arg(page.elapsedMs, 0, 'f', 1));
+    });
 }
 
+/**
+ * @brief 导出选中任务的运动日志
+ * 每个任务一个 CSV 文件，由 MotionLogExporter 在线程池中并行流式导出，界面不等待。
+ */
 void LogWidget::onExportClicked()
 {
     QSet<int> selectedTaskIds = getSelectedTaskIds();
@@ -232,75 +292,123 @@ void LogWidget::onExportClicked()
         QMessageBox::warning(this, "导出失败", "请先选择要导出的任务。");
         return;
     }
-
-    QString fileName = QFileDialog::getSaveFileName(this, "导出任务详情", "", "CSV Files (*.csv)");
-    if (fileName.isEmpty()) return;
-
-    QFile file(fileName);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::critical(this, "导出失败", "无法打开文件进行写入：" + file.errorString());
+    if (!m_dataManager) return;
+    if (m_exporter && m_exporter->isRunning()) {
+        QMessageBox::information(this, "导出", "已有导出正在进行。");
         return;
     }
 
-    QTextStream out(&file);
-    // 写入 BOM 防止 Excel 中文乱码
-    out << QString::fromUtf8("\xEF\xBB\xBF"); 
+    const QString dir = QFileDialog::getExistingDirectory(this, "选择导出目录");
+    if (dir.isEmpty()) return;
+
+    QList<int> taskIds = selectedTaskIds.values();
+    std::sort(taskIds.begin(), taskIds.end());
+
+    if (!m_exporter) {
+        m_exporter = new MotionLogExporter(this);
+        m_exportProgress = new QProgressDialog(this);
+        m_exportProgress->setWindowTitle("导出运动日志");
+        m_exportProgress->setCancelButtonText("取消");
+        m_exportProgress->setMinimumDuration(300);
+        m_exportProgress->setAutoClose(false);
+        m_exportProgress->setAutoReset(false);
+        m_exportProgress->reset();
+
+        connect(m_exportProgress, &QProgressDialog::canceled, m_exporter, &MotionLogExporter::cancel);
+        connect(m_exporter, &MotionLogExporter::progress, this,
+                [this](qint64 rowsDone, qint64 rowsTotal, int tasksDone, int tasksTotal) {
+            // 有行数估计时按行显示，否则按任务数显示
+            if (rowsTotal > 0) {
+                m_exportProgress->setMaximum(1000);
+                m_exportProgress->setValue(int(qMin<qint64>(999, rowsDone * 1000 / rowsTotal)));
+            } else {
+                m_exportProgress->setMaximum(qMax(1, tasksTotal));
+                m_exportProgress->setValue(qMin(tasksDone, tasksTotal - 1));
+            }
+            m_exportProgress->setLabelText(QString("已导出 %1 / %2 个任务，%3 行")
+                                               .arg(tasksDone).arg(tasksTotal).arg(rowsDone));
+        });
+        connect(m_exporter, &MotionLogExporter::finished, this, [this](const MotionLogExporter::Result &result) {
+            m_exportProgress->reset();
+            m_exportProgress->hide();
+            updateExportButtonState();
+
+            if (result.canceled) {
+                QMessageBox::information(this, "导出已取消",
+                                         QString("已完成 %1 个任务的导出，其余已取消。").arg(result.files));
+                return;
+            }
+            if (result.files == 0) {
+                QMessageBox::warning(this, "导出失败", result.failed.isEmpty() ? "选中的任务没有运动日志数据。"
+                                                                                : "读取运动日志失败：\n" + result.failed.join("\n"));
+                return;
+            }
 
-    // 构建任务ID列表的过滤条件
-    QStringList taskIdList;
-    for (int taskId : selectedTaskIds) {
-        taskIdList << QString::number(taskId);
-    }
-    QString filter = QString("task_id IN (%1)").arg(taskIdList.join(","));
-    
-    // 临时设置过滤器来获取所有选中任务的日志
-    QString originalFilter = m_logModel->filter();
-    m_logModel->setFilter(filter);
-    m_logModel->select();
-    
-    // 确保拉取所有数据
-    while (m_logModel->canFetchMore()) {
-        m_logModel->fetchMore();
+            QString message = QString("已成功导出 %1 个任务的 %2 条运动记录 (耗时 %3 s)。")
+                                  .arg(result.files).arg(result.rows).arg(result.elapsedMs / 1000.0, 0, 'f', 1);
+            if (!result.failed.isEmpty()) {
+                message += "\n\n以下任务导出失败：\n" + result.failed.join("\n");
+            }
+            QMessageBox::information(this, "导出成功", message);
+        });
     }
 
-    if (m_logModel->rowCount() == 0) {
-        QMessageBox::warning(this, "导出失败", "选中的任务没有运动日志数据。");
-        file.close();
-        m_logModel->setFilter(originalFilter);
-        m_logModel->select();
-        return;
-    }
+    MotionLogExporter::Options options;
+    options.dbPath = m_dataManager->databasePath();
+    options.outputDir = dir;
+    options.taskIds = taskIds;
 
-    // 1. 写入表头
-    QStringList headers;
-    for (int i = 0; i < m_logModel->columnCount(); ++i) {
-        headers << m_logModel->headerData(i, Qt::Horizontal).toString();
-    }
-    out << headers.join(",") << "\n";
-
-    // 2. 写入数据
-    int rows = m_logModel->rowCount();
-    for (int i = 0; i < rows; ++i) {
-        QStringList rowData;
-        for (int j = 0; j < m_logModel->columnCount(); ++j) {
-            QString data = m_logModel->index(i, j).data().toString();
-            // 处理包含逗号的字段
-            if (data.contains(",")) {
-                data = "\"" + data + "\"";
-            }
-            rowData << data;
+    m_exportProgress->setLabelText("正在准备导出...");
+    m_exportProgress->setValue(0);
+    m_exportProgress->show();
+    m_btnExport->setEnabled(false);
+    m_exporter->start(options);
+}
+
+void LogWidget::onArchiveExportClicked()
+{
+    QList<int> taskIds = getSelectedTaskIds().values();
+    if (taskIds.isEmpty() || !m_dataManager) return;
+    std::sort(taskIds.begin(), taskIds.end());
+
+    const QString path = QFileDialog::getSaveFileName(
+        this, "导出任务归档", QString("tasks_%1.epa").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmm")),
+        "Task Archive (*.epa)");
+    if (path.isEmpty()) return;
+
+    m_btnArchiveExport->setEnabled(false);
+    m_dataManager->exportTaskArchiveAsync(taskIds, path).then(this, [this, path](const TaskArchive::Result &result) {
+        updateExportButtonState();
+        if (!result.ok) {
+            QMessageBox::critical(this, "导出失败", result.error);
+            return;
         }
-        out << rowData.join(",") << "\n";
-    }
+        QString message = QString("已导出 %1 个任务、%2 个采样到\n%3\n(%4 MB)")
+                              .arg(result.taskIds.size()).arg(result.samples).arg(path)
+                              .arg(result.bytes / 1048576.0, 0, 'f', 1);
+        if (result.skipped > 0) message += QString("\n\n%1 个任务已不存在，未导出。").arg(result.skipped);
+        QMessageBox::information(this, "导出成功", message);
+    });
+}
 
-    file.close();
-    
-    // 恢复原来的过滤器
-    m_logModel->setFilter(originalFilter);
-    m_logModel->select();
-    
-    QMessageBox::information(this, "导出成功", 
-        QString("已成功导出 %1 个任务的 %2 条运动记录。").arg(selectedTaskIds.size()).arg(rows));
+void LogWidget::onArchiveImportClicked()
+{
+    if (!m_dataManager) return;
+    const QString path = QFileDialog::getOpenFileName(this, "导入任务归档", "", "Task Archive (*.epa)");
+    if (path.isEmpty()) return;
+
+    m_btnArchiveImport->setEnabled(false);
+    m_dataManager->importTaskArchiveAsync(path).then(this, [this](const TaskArchive::Result &result) {
+        m_btnArchiveImport->setEnabled(true);
+        // 导入的任务行由 taskChanged 插入
+        if (!result.ok) {
+            QMessageBox::critical(this, "导入失败",
+                                  QString("%1\n\n失败前已导入 %2 个任务。").arg(result.error).arg(result.taskIds.size()));
+            return;
+        }
+        QMessageBox::information(this, "导入成功", QString("已导入 %1 个任务 (%2 个采样)，跳过已存在的任务 %3 个。")
+                                                      .arg(result.taskIds.size()).arg(result.samples).arg(result.skipped));
+    });
 }
 
 void LogWidget::onSelectAllClicked()
@@ -329,48 +437,111 @@ void LogWidget::onSelectAllClicked()
 void LogWidget::updateTaskTable()
 {
     if (!m_taskModel) return;
-    
-    // 清空表格
-    m_taskTable->clear();
-    m_taskTable->setRowCount(0);
-    
-    // 设置表头
-    QStringList headers;
-    headers << "选择";
-    for (int i = 0; i < m_taskModel->columnCount(); ++i) {
-        headers << m_taskModel->headerData(i, Qt::Horizontal).toString();
+
+    QVector<QSqlRecord> rows;
+    rows.reserve(m_taskModel->rowCount());
+    for (int row = 0; row < m_taskModel->rowCount(); ++row) {
+        rows.append(m_taskModel->record(row));
+    }
+    fillTaskTable(rows, false);
+    m_btnMore->setVisible(false);
+}
+
+void LogWidget::fillTaskTable(const QVector<QSqlRecord> &rows, bool append)
+{
+    if (!append) {
+        // 清空表格
+        m_taskTable->clear();
+        m_taskTable->setRowCount(0);
+        
+        // 设置表头 (TaskListView 的列名)
+        const QSqlRecord columns = m_taskModel ? m_taskModel->record() : rows.value(0);
+        QStringList headers;
+        headers << "选择";
+        for (int i = 0; i < columns.count(); ++i) {
+            headers << columns.fieldName(i);
+        }
+        m_taskTable->setColumnCount(headers.size());
+        m_taskTable->setHorizontalHeaderLabels(headers);
     }
-    m_taskTable->setColumnCount(headers.size());
-    m_taskTable->setHorizontalHeaderLabels(headers);
     
     // 复制数据
-    for (int row = 0; row < m_taskModel->rowCount(); ++row) {
+    m_taskTable->setUpdatesEnabled(false);
+    for (const QSqlRecord &record : rows) {
+        const int row = m_taskTable->rowCount();
         m_taskTable->insertRow(row);
         
-        // 第0列：复选框
-        QCheckBox *checkbox = new QCheckBox();
-        // 从第二列获取任务ID（假设第一列是ID）
-        QModelIndex idIndex = m_taskModel->index(row, 0);
-        int taskId = m_taskModel->data(idIndex).toInt();
-        checkbox->setProperty("taskId", taskId);
-        connect(checkbox, &QCheckBox::checkStateChanged, this, &LogWidget::onCheckboxStateChanged);
-        m_taskTable->setCellWidget(row, 0, checkbox);
-        
-        // 其他列：从原模型复制数据
-        for (int col = 0; col < m_taskModel->columnCount(); ++col) {
-            QModelIndex sourceIndex = m_taskModel->index(row, col);
-            QTableWidgetItem *item = new QTableWidgetItem(m_taskModel->data(sourceIndex).toString());
-            item->setFlags(item->flags() & ~Qt::ItemIsEditable); // 设置为只读
-            m_taskTable->setItem(row, col + 1, item); // +1 因为第0列是复选框
-        }
+        setTaskRow(row, record);
     }
+    m_taskTable->setUpdatesEnabled(true);
     
     // 调整列宽
     m_taskTable->resizeColumnToContents(0); // 复选框列
     m_taskTable->horizontalHeader()->setStretchLastSection(true);
     
     // 启用全选按钮
-    m_btnSelectAll->setEnabled(m_taskModel->rowCount() > 0);
+    m_btnSelectAll->setEnabled(m_taskTable->rowCount() > 0);
+}
+
+void LogWidget::setTaskRow(int row, const QSqlRecord &record)
+{
+    // 第0列：复选框 (已有的行保留勾选状态)
+    if (!m_taskTable->cellWidget(row, 0)) {
+        QCheckBox *checkbox = new QCheckBox();
+        checkbox->setProperty("taskId", record.value("id").toInt());
+        connect(checkbox, &QCheckBox::checkStateChanged, this, &LogWidget::onCheckboxStateChanged);
+        m_taskTable->setCellWidget(row, 0, checkbox);
+    }
+    
+    // 其他列 (+1 因为第0列是复选框)，内容不变的单元格不触发重绘
+    for (int col = 0; col < record.count(); ++col) {
+        const QString text = record.value(col).toString();
+        QTableWidgetItem *item = m_taskTable->item(row, col + 1);
+        if (!item) {
+            item = new QTableWidgetItem(text);
+            item->setFlags(item->flags() & ~Qt::ItemIsEditable); // 设置为只读
+            m_taskTable->setItem(row, col + 1, item);
+        } else if (item->text() != text) {
+            item->setText(text);
+        }
+    }
+}
+
+void LogWidget::applyTaskRows(const QVector<QSqlRecord> &rows, bool insertMissing)
+{
+    if (rows.isEmpty() || m_taskTable->columnCount() == 0) return;
+
+    QHash<int, int> rowOf;
+    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
+        if (QTableWidgetItem *idItem = m_taskTable->item(i, 1)) rowOf.insert(idItem->text().toInt(), i);
+    }
+
+    // rows 按任务ID倒序，新任务从最小的开始插到最前面
+    int inserted = 0;
+    m_taskTable->setUpdatesEnabled(false);
+    for (auto it = rows.crbegin(); it != rows.crend(); ++it) {
+        const int row = rowOf.value(it->value("id").toInt(), -1);
+        if (row >= 0) {
+            setTaskRow(row + inserted, *it);
+        } else if (insertMissing) {
+            m_taskTable->insertRow(0);
+            setTaskRow(0, *it);
+            ++inserted;
+        }
+    }
+    m_taskTable->setUpdatesEnabled(true);
+    m_btnSelectAll->setEnabled(m_taskTable->rowCount() > 0);
+}
+
+void LogWidget::removeTaskRows(const QSet<int> &taskIds)
+{
+    for (int i = m_taskTable->rowCount() - 1; i >= 0; --i) {
+        QTableWidgetItem *idItem = m_taskTable->item(i, 1);
+        if (idItem && taskIds.contains(idItem->text().toInt())) m_taskTable->removeRow(i);
+    }
+    if (m_logModel && taskIds.contains(m_logModel->taskId())) m_logModel->setTask(0);
+    m_btnSelectAll->setEnabled(m_taskTable->rowCount() > 0);
+    updateExportButtonState();
 }
 
 void LogWidget::updateExportButtonState()
@@ -383,7 +554,8 @@ void LogWidget::updateExportButtonState()
             break;
         }
     }
-    m_btnExport->setEnabled(hasSelected);
+    m_btnExport->setEnabled(hasSelected && !(m_exporter && m_exporter->isRunning()));
+    m_btnArchiveExport->setEnabled(hasSelected);
 }
 
 void LogWidget::restoreCheckboxStates(const QSet<int> &selectedTaskIds)
@@ -10,6 +10,12 @@
 #include <QPushButton>
 #include <QCheckBox>
 #include <QSet>
+#include <QSqlRecord>
+#include "../data/datamanager.h"
+#include "motionlogmodel.h"
+
+class MotionLogExporter;
+class QProgressDialog;
 
 class LogWidget : public QGroupBox
 {
@@ -17,11 +23,12 @@ class LogWidget : public QGroupBox
 public:
     explicit LogWidget(QWidget *parent = nullptr);
     
-    // 设置数据模型
-    void setModels(QSqlTableModel *taskModel, QSqlTableModel *logModel);
-    
-    // 刷新数据
-    void refresh();
+    // 设置任务列表数据模型
+    void setModels(QSqlTableModel *taskModel);
+
+    // 设置数据源 (导出时按任务流式读取，支持 MotionLog 表与列式采样文件)
+    // 创建分页的运动详情模型，并订阅任务变更，列表和日志视图只按变更增量刷新
+    void setDataManager(DataManager *dataManager);
 
 private slots:
     // 当在任务列表中选择某行时触发
@@ -33,14 +40,29 @@ private slots:
     // 查询按钮点击
     void onQueryClicked();
     
+    // 加载下一页查询结果
+    void onMoreClicked();
+    
     // 导出按钮点击
     void onExportClicked();
     
     // 全选/取消全选
     void onSelectAllClicked();
 
+    // 任务归档 (.epa) 导出/导入，用于工位之间迁移数据
+    void onArchiveExportClicked();
+    void onArchiveImportClicked();
+
+    // 任务数据变更 (DataManager::taskChanged)
+    void onTaskChanged(const DataManager::TaskChange &change);
+
 private:
     void updateTaskTable();
+    void fillTaskTable(const QVector<QSqlRecord> &rows, bool append);
+    void setTaskRow(int row, const QSqlRecord &record);
+    void applyTaskRows(const QVector<QSqlRecord> &rows, bool insertMissing);
+    void removeTaskRows(const QSet<int> &taskIds);
+    void runQuery(bool nextPage);
     void updateExportButtonState();
     void restoreCheckboxStates(const QSet<int> &selectedTaskIds);
     QSet<int> getSelectedTaskIds() const;
@@ -50,7 +72,8 @@ private:
     QTableView *m_logView;  // 详细日志视图
     
     QSqlTableModel *m_taskModel;
-    QSqlTableModel *m_logModel;
+    MotionLogModel *m_logModel = nullptr;
+    DataManager *m_dataManager = nullptr;
     
     // 筛选控件
     QDateEdit *m_dateStart;
@@ -59,6 +82,18 @@ private:
     QPushButton *m_btnQuery;
     QPushButton *m_btnExport;
     QPushButton *m_btnSelectAll;
+    QPushButton *m_btnMore;
+    QPushButton *m_btnArchiveExport;
+    QPushButton *m_btnArchiveImport;
+
+    // 检索状态 (查询后列表来自 DataManager::searchTasks 的分页结果)
+    bool m_queryActive = false;
+    int m_queryNextBeforeId = 0;
+    int m_querySerial = 0;
+
+    // 后台导出
+    MotionLogExporter *m_exporter = nullptr;
+    QProgressDialog *m_exportProgress = nullptr;
 };
 
 #endif // LOGWIDGET_H
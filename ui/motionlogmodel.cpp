@@ -0,0 +1,414 @@
+#include "motionlogmodel.h"
+#include "../data/sqliteconfig.h"
+#include "../data/taskstats.h"
+#include "../utils/logger.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QtConcurrent>
+#include <algorithm>
+
+MotionLogModel::MotionLogModel(const QString &dbPath, QObject *parent)
+    : QAbstractTableModel(parent)
+    , m_dbPath(dbPath)
+    , m_connName(QString("MotionLogModel_%1").arg(quintptr(this)))
+    , m_pages(kMaxPages)
+{
+    // 只用一个常驻线程，只读连接在其中打开后一直复用
+    m_pool.setMaxThreadCount(1);
+    m_pool.setExpiryTimeout(-1);
+}
+
+MotionLogModel::~MotionLogModel()
+{
+    m_pool.clear();
+    const QString connName = m_connName;
+    QtConcurrent::run(&m_pool, [connName]() {
+        {
+            QSqlDatabase db = QSqlDatabase::database(connName, false);
+            if (db.isValid()) db.close();
+        }
+        QSqlDatabase::removeDatabase(connName);
+    });
+    m_pool.waitForDone();
+}
+
+int MotionLogModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : int(m_source.count);
+}
+
+int MotionLogModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant MotionLogModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= m_source.count) return QVariant();
+
+    // 视图第 0 行是最新的采样
+    const qint64 ordinal = m_source.count - 1 - index.row();
+    const int page = int(ordinal / kPageRows);
+    const SampleStore::Columns *samples = m_pages.object(page);
+    if (!samples) {
+        requestPage(page);
+        return QVariant();
+    }
+    const int i = int(ordinal % kPageRows);
+    if (i >= samples->size()) return QVariant();
+
+    switch (index.column()) {
+    case ColTaskId:
+        return m_taskId;
+    case ColTimestamp:
+        return QDateTime::fromMSecsSinceEpoch(samples->t[i] / 1000).toString("yyyy-MM-dd HH:mm:ss.zzz");
+    case ColPosition:
+        return samples->position[i];
+    case ColSpeed:
+        return samples->speed[i];
+    case ColStatus:
+        return int(samples->status[i]);
+    case ColT:
+        return samples->t[i];
+    default:
+        return QVariant();
+    }
+}
+
+QVariant MotionLogModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+    // 与 MotionLogView 的列名一致
+    static const char *labels[ColumnCount] = {"task_id", "timestamp", "position", "speed", "status", "t"};
+    return (section >= 0 && section < ColumnCount) ? QString(labels[section]) : QVariant();
+}
+
+void MotionLogModel::setTask(int taskId)
+{
+    beginResetModel();
+    ++m_generation;
+    m_taskId = taskId;
+    m_source = Source();
+    m_source.taskId = taskId;
+    m_after.clear();
+    m_pages.clear();
+    m_wanted.clear();
+    m_loading = false;
+    m_sourcePending = false;
+    m_refreshAgain = false;
+    endResetModel();
+
+    if (taskId <= 0) return;
+
+    m_sourcePending = true;
+    const int generation = m_generation;
+    QtConcurrent::run(&m_pool, [this, taskId]() {
+        return openSource(taskId);
+    }).then(this, [this, generation](const Source &source) {
+        if (generation != m_generation) return;
+        m_sourcePending = false;
+        applySource(source);
+    });
+}
+
+void MotionLogModel::refresh()
+{
+    if (m_taskId <= 0) return;
+    if (m_sourcePending) {
+        m_refreshAgain = true;
+        return;
+    }
+
+    m_sourcePending = true;
+    const int generation = m_generation;
+    const Source previous = m_source;
+    QtConcurrent::run(&m_pool, [this, previous]() {
+        return refreshSource(previous);
+    }).then(this, [this, generation](const Source &source) {
+        if (generation != m_generation) return;
+        m_sourcePending = false;
+        applySource(source);
+    });
+}
+
+/**
+ * @brief 行数增加时在顶部插入行 (页号按时间正序，已缓存的完整页不受影响)
+ */
+void MotionLogModel::applySource(const Source &source)
+{
+    const qint64 added = source.count - m_source.count;
+    if (added > 0) {
+        // 原来的最后一页不完整，作废后重新读取 (其后一页的起点也随之失效)
+        if (m_source.count % kPageRows) {
+            const int last = int(m_source.count / kPageRows);
+            m_pages.remove(last);
+            m_after.remove(last + 1);
+        }
+        beginInsertRows(QModelIndex(), 0, int(added) - 1);
+        m_source = source;
+        endInsertRows();
+    } else {
+        m_source.tLast = source.tLast;
+    }
+
+    if (m_refreshAgain) {
+        m_refreshAgain = false;
+        refresh();
+    }
+}
+
+void MotionLogModel::requestPage(int page) const
+{
+    // 当前页最后取，相邻页作为预取排在前面
+    for (int p : {page - 1, page + 1, page}) {
+        if (p < 0 || qint64(p) * kPageRows >= m_source.count || m_pages.contains(p)) continue;
+        m_wanted.removeOne(p);
+        m_wanted.append(p);
+    }
+    while (m_wanted.size() > kMaxPendingPages) m_wanted.removeFirst();
+
+    if (!m_fetchQueued && !m_loading) {
+        m_fetchQueued = true;
+        QMetaObject::invokeMethod(const_cast<MotionLogModel *>(this), &MotionLogModel::fetchNext, Qt::QueuedConnection);
+    }
+}
+
+void MotionLogModel::fetchNext()
+{
+    m_fetchQueued = false;
+    if (m_loading) return;
+
+    int page = -1;
+    while (!m_wanted.isEmpty() && page < 0) {
+        const int p = m_wanted.takeLast();
+        if (!m_pages.contains(p) && qint64(p) * kPageRows < m_source.count) page = p;
+    }
+    if (page < 0) return;
+
+    m_loading = true;
+    const int generation = m_generation;
+    const Source source = m_source;
+    const QMap<int, qint64> after = m_after;
+    QtConcurrent::run(&m_pool, [this, source, page, after]() {
+        return loadPage(source, page, after);
+    }).then(this, [this, generation, page, count = source.count](SampleStore::Columns samples) {
+        if (generation != m_generation) return;
+        m_loading = false;
+        onPageLoaded(page, count, std::move(samples));
+        fetchNext();
+    });
+}
+
+void MotionLogModel::onPageLoaded(int page, qint64 count, SampleStore::Columns samples)
+{
+    const qint64 first = qint64(page) * kPageRows;
+    const int expected = int(qMin<qint64>(kPageRows, m_source.count - first));
+    if (count != m_source.count && samples.size() < expected) {
+        // 读取期间又有新采样，末页不完整，重新读取
+        m_wanted.append(page);
+        return;
+    }
+    if (samples.isEmpty()) return;
+
+    const int size = samples.size();
+    m_after[page] = samples.t.first() - 1;
+    // 不完整的末页之后还会追加采样，只有完整页才能作为下一页的起点
+    if (size == kPageRows) m_after[page + 1] = samples.t.last();
+    m_pages.insert(page, new SampleStore::Columns(std::move(samples)));
+
+    emit dataChanged(index(viewRow(first + size - 1), 0), index(viewRow(first), ColumnCount - 1));
+}
+
+QSqlDatabase MotionLogModel::connection() const
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connName, false);
+    if (!db.isValid()) {
+        db = QSqlDatabase::addDatabase("QSQLITE", m_connName);
+        db.setDatabaseName(m_dbPath);
+        SqliteConfig::prepare(db, SqliteConfig::Role::ReadOnly);
+    }
+    if (!db.isOpen()) {
+        if (db.open()) {
+            SqliteConfig::applyPragmas(db, SqliteConfig::Role::ReadOnly);
+        } else {
+            LOG_WARN << "运动日志浏览连接打开失败: " << db.lastError().text();
+        }
+    }
+    return db;
+}
+
+/**
+ * @brief 确定任务的数据来源和行数
+ * MotionLog 只做一次主键查找得到最后时间；TaskStats 的最后采样时间与之一致时直接使用其采样数，
+ * 否则 (统计缺失或落后) 才按主键范围计数。
+ */
+MotionLogModel::Source MotionLogModel::openSource(int taskId) const
+{
+    Source source;
+    source.taskId = taskId;
+
+    QSqlDatabase db = connection();
+    if (!db.isOpen()) return source;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT sample_file FROM DetectionTask WHERE id = :tid");
+    query.bindValue(":tid", taskId);
+    QString sampleFile;
+    if (query.exec() && query.next()) sampleFile = query.value(0).toString();
+    query.finish();
+
+    if (!sampleFile.isEmpty()) {
+        source.sampleFile = QFileInfo(m_dbPath).dir().filePath(sampleFile);
+        SampleStore::Reader reader;
+        QString error;
+        if (reader.open(source.sampleFile, &error)) {
+            source.count = reader.sampleCount();
+        } else {
+            LOG_WARN << "打开采样文件失败: " << error;
+        }
+        return source;
+    }
+
+    query.prepare("SELECT MAX(t) FROM MotionLog WHERE task_id = :tid");
+    query.bindValue(":tid", taskId);
+    if (!query.exec() || !query.next() || query.value(0).isNull()) return source;
+    source.tLast = query.value(0).toLongLong();
+    query.finish();
+
+    TaskStats stats;
+    if (TaskStats::load(db, taskId, stats) && stats.isValid() && stats.tLastUs == source.tLast) {
+        source.count = stats.samples;
+        return source;
+    }
+
+    query.prepare("SELECT COUNT(*) FROM MotionLog WHERE task_id = :tid AND t <= :last");
+    query.bindValue(":tid", taskId);
+    query.bindValue(":last", source.tLast);
+    if (query.exec() && query.next()) {
+        source.count = query.value(0).toLongLong();
+    } else {
+        LOG_WARN << "统计运动日志行数失败: " << query.lastError().text();
+    }
+    return source;
+}
+
+/**
+ * @brief 统计上次快照之后新增的采样
+ */
+MotionLogModel::Source MotionLogModel::refreshSource(const Source &previous) const
+{
+    Source source = previous;
+
+    if (!source.sampleFile.isEmpty()) {
+        SampleStore::Reader reader;
+        if (reader.open(source.sampleFile)) source.count = qMax(source.count, reader.sampleCount());
+        return source;
+    }
+
+    QSqlDatabase db = connection();
+    if (!db.isOpen()) return source;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT COUNT(*), MAX(t) FROM MotionLog WHERE task_id = :tid AND t > :last");
+    query.bindValue(":tid", source.taskId);
+    query.bindValue(":last", source.tLast);
+    if (query.exec() && query.next() && query.value(0).toLongLong() > 0) {
+        source.count += query.value(0).toLongLong();
+        source.tLast = query.value(1).toLongLong();
+    }
+    return source;
+}
+
+/**
+ * @brief 读取一页 (按时间正序)
+ * MotionLog 从最近的已知页边界向后偏移，或从快照的最后时间向前偏移，取两者中跳过行数较少的一侧；
+ * 从顶部 (最新数据) 开始浏览时总是无偏移的主键范围查询。
+ */
+SampleStore::Columns MotionLogModel::loadPage(const Source &source, int page,
+                                              const QMap<int, qint64> &after) const
+{
+    SampleStore::Columns out;
+    const qint64 first = qint64(page) * kPageRows;
+    const int rows = int(qMin<qint64>(kPageRows, source.count - first));
+    if (rows <= 0) return out;
+    out.reserve(rows);
+
+    if (!source.sampleFile.isEmpty()) {
+        SampleStore::Reader reader;
+        if (!reader.open(source.sampleFile)) return out;
+
+        // 按块索引中的采样数定位，只解码覆盖本页的块
+        SampleStore::Columns chunkSamples;
+        qint64 base = 0;
+        for (const SampleStore::ChunkInfo &chunk : reader.chunks()) {
+            const qint64 end = base + chunk.count;
+            if (end > first) {
+                chunkSamples.clear();
+                if (!SampleStore::decodeChunk(chunk, reader.payload(chunk), chunkSamples)) break;
+                const int from = int(qMax<qint64>(0, first - base));
+                const int to = int(qMin<qint64>(chunkSamples.size(), first + rows - base));
+                for (int i = from; i < to; ++i) {
+                    out.append({chunkSamples.t[i], chunkSamples.position[i], chunkSamples.speed[i],
+                                chunkSamples.status[i]});
+                }
+            }
+            if (end >= first + rows) break;
+            base = end;
+        }
+        return out;
+    }
+
+    QSqlDatabase db = connection();
+    if (!db.isOpen()) return out;
+
+    int anchorPage = 0;
+    qint64 anchorAfter = std::numeric_limits<qint64>::min();
+    auto it = after.upperBound(page);
+    if (it != after.constBegin()) {
+        --it;
+        anchorPage = it.key();
+        anchorAfter = it.value();
+    }
+    const qint64 skipForward = qint64(page - anchorPage) * kPageRows;
+    const qint64 skipBackward = source.count - first - rows;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    const bool backward = skipBackward < skipForward;
+    if (backward) {
+        query.prepare("SELECT t, position, speed, status FROM MotionLog "
+                      "WHERE task_id = :tid AND t <= :last ORDER BY t DESC LIMIT :limit OFFSET :skip");
+        query.bindValue(":last", source.tLast);
+        query.bindValue(":skip", skipBackward);
+    } else {
+        query.prepare("SELECT t, position, speed, status FROM MotionLog "
+                      "WHERE task_id = :tid AND t > :after ORDER BY t LIMIT :limit OFFSET :skip");
+        query.bindValue(":after", anchorAfter);
+        query.bindValue(":skip", skipForward);
+    }
+    query.bindValue(":tid", source.taskId);
+    query.bindValue(":limit", rows);
+    if (!query.exec()) {
+        LOG_WARN << "读取运动日志失败: " << query.lastError().text();
+        return out;
+    }
+    while (query.next()) {
+        out.append({query.value(0).toLongLong(), query.value(1).toDouble(), query.value(2).toDouble(),
+                    quint8(query.value(3).toInt())});
+    }
+
+    if (backward) {
+        std::reverse(out.t.begin(), out.t.end());
+        std::reverse(out.position.begin(), out.position.end());
+        std::reverse(out.speed.begin(), out.speed.end());
+        std::reverse(out.status.begin(), out.status.end());
+    }
+    return out;
+}
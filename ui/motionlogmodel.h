@@ -0,0 +1,102 @@
+#ifndef MOTIONLOGMODEL_H
+#define MOTIONLOGMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QList>
+#include <QMap>
+#include <QSqlDatabase>
+#include <QThreadPool>
+#include <limits>
+#include "../data/samplestore.h"
+
+/**
+ * @brief 单个任务运动日志的只读分页模型
+ *
+ * 按时间倒序显示 (与原 MotionLogView 的列相同)，但不把任务的全部采样读入界面线程：
+ *   - 行数取自 TaskStats (其最后采样时间与 MotionLog 一致时)，否则在后台 COUNT，打开任务只需一次索引查找；
+ *   - 数据按页 (kPageRows 行) 在后台只读连接上读取，视图访问到哪一页才读哪一页，并预取相邻页；
+ *     MotionLog 按 (task_id, t) 主键做键集分页，从最近的已知页边界或从末尾 (最新数据) 开始定位；
+ *   - 已读取的页保存在容量为 kMaxPages 的 LRU 缓存中，内存占用与任务大小无关；
+ *   - 已归档为列式采样文件的任务按数据块读取；
+ *   - 任务写入新采样时 refresh() 只统计新增部分并插入到顶部，已缓存的页仍然有效。
+ *
+ * 页号按时间正序编号 (第 0 页为最早的采样)，新数据只追加到末尾，页号不因新增而变化。
+ */
+class MotionLogModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column {
+        ColTaskId = 0,
+        ColTimestamp,
+        ColPosition,
+        ColSpeed,
+        ColStatus,
+        ColT,
+        ColumnCount
+    };
+
+    static constexpr int kPageRows = 1000;
+    static constexpr int kMaxPages = 64;        ///< LRU 缓存的页数
+    static constexpr int kMaxPendingPages = 8;  ///< 待读取页数上限 (快速拖动时丢弃过时的请求)
+
+    explicit MotionLogModel(const QString &dbPath, QObject *parent = nullptr);
+    ~MotionLogModel();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief 显示指定任务 (0 表示清空)，行数在后台确定后插入
+     */
+    void setTask(int taskId);
+    int taskId() const { return m_taskId; }
+
+    /**
+     * @brief 当前任务有新采样写入，只读取新增部分
+     */
+    void refresh();
+
+private:
+    /**
+     * @brief 任务数据的快照 (后台读取时按值传递)
+     */
+    struct Source {
+        int taskId = 0;
+        QString sampleFile;         ///< 列式采样文件 (绝对路径)，为空表示 MotionLog 表
+        qint64 count = 0;
+        qint64 tLast = std::numeric_limits<qint64>::min(); ///< MotionLog: 计数覆盖到的最后时间
+    };
+
+    // 以下在后台线程中执行
+    QSqlDatabase connection() const;
+    Source openSource(int taskId) const;
+    Source refreshSource(const Source &previous) const;
+    SampleStore::Columns loadPage(const Source &source, int page, const QMap<int, qint64> &after) const;
+
+    void requestPage(int page) const;
+    void fetchNext();
+    void onPageLoaded(int page, qint64 count, SampleStore::Columns samples);
+    void applySource(const Source &source);
+    int viewRow(qint64 ordinal) const { return int(m_source.count - 1 - ordinal); }
+
+    QString m_dbPath;
+    QString m_connName;
+    QThreadPool m_pool;                     ///< 单线程，持有只读连接
+    int m_taskId = 0;
+    int m_generation = 0;                   ///< 切换任务时递增，丢弃旧任务的结果
+    Source m_source;
+    bool m_sourcePending = false;
+    bool m_refreshAgain = false;
+
+    QMap<int, qint64> m_after;              ///< 页号 -> 该页之前最后一个采样的时间 (键集分页起点)
+    mutable QCache<int, SampleStore::Columns> m_pages;
+    mutable QList<int> m_wanted;            ///< 待读取的页 (最近请求的在末尾)
+    mutable bool m_fetchQueued = false;     ///< 已排队 fetchNext (同一次绘制中的请求合并处理)
+    bool m_loading = false;                 ///< 有页正在读取 (每次只读一页，按最新请求优先)
+};
+
+#endif // MOTIONLOGMODEL_H
@@ -54,7 +54,7 @@ void SettingsDialog::initUI()
 
     // --- 3. 数据存储 ---
     QGroupBox *grpData = new QGroupBox("数据存储");
-    QHBoxLayout *layoutData = new QHBoxLayout(grpData);
+    QVBoxLayout *layoutData = new QVBoxLayout(grpData);
     
     m_editDataPath = new QLineEdit();
     m_editDataPath->setReadOnly(true);
@@ -69,9 +69,39 @@ void SettingsDialog::initUI()
         }
     });
 
-    layoutData->addWidget(new QLabel("路径:"));
-    layoutData->addWidget(m_editDataPath);
-    layoutData->addWidget(m_btnBrowse);
+    QHBoxLayout *layoutPath = new QHBoxLayout();
+    layoutPath->addWidget(new QLabel("路径:"));
+    layoutPath->addWidget(m_editDataPath);
+    layoutPath->addWidget(m_btnBrowse);
+    layoutData->addLayout(layoutPath);
+
+    // 运动日志存储引擎 (重启后生效)
+    m_comboLogEngine = new QComboBox();
+    m_comboLogEngine->addItem("SQLite 表 (MotionLog)", "sqlite");
+    m_comboLogEngine->addItem("列式采样文件 (每任务一个文件)", "columnar");
+    QHBoxLayout *layoutEngine = new QHBoxLayout();
+    layoutEngine->addWidget(new QLabel("运动日志存储:"));
+    layoutEngine->addWidget(m_comboLogEngine, 1);
+    layoutData->addLayout(layoutEngine);
+
+    // 数据保留天数 (过期的运动日志先压缩归档，归档按归档保留天数删除)
+    m_spinLogDays = new QSpinBox();
+    m_spinLogDays->setRange(1, 3650);
+    m_spinLogDays->setSuffix(" 天");
+    m_spinTaskDays = new QSpinBox();
+    m_spinTaskDays->setRange(1, 3650);
+    m_spinTaskDays->setSuffix(" 天");
+    m_spinArchiveDays = new QSpinBox();
+    m_spinArchiveDays->setRange(1, 3650);
+    m_spinArchiveDays->setSuffix(" 天");
+    QHBoxLayout *layoutRetention = new QHBoxLayout();
+    layoutRetention->addWidget(new QLabel("保留 日志:"));
+    layoutRetention->addWidget(m_spinLogDays, 1);
+    layoutRetention->addWidget(new QLabel("任务:"));
+    layoutRetention->addWidget(m_spinTaskDays, 1);
+    layoutRetention->addWidget(new QLabel("归档:"));
+    layoutRetention->addWidget(m_spinArchiveDays, 1);
+    layoutData->addLayout(layoutRetention);
     mainLayout->addWidget(grpData);
 
     mainLayout->addStretch();
@@ -92,6 +122,11 @@ void SettingsDialog::loadSettings()
     m_spinMaxPos->setValue(cfg.maxPosition());
     m_spinTimeout->setValue(cfg.motionTimeout());
     m_editDataPath->setText(cfg.dataStoragePath());
+    int engineIndex = m_comboLogEngine->findData(cfg.motionLogEngine());
+    m_comboLogEngine->setCurrentIndex(engineIndex >= 0 ? engineIndex : 0);
+    m_spinLogDays->setValue(cfg.motionLogRetentionDays());
+    m_spinTaskDays->setValue(cfg.taskRetentionDays());
+    m_spinArchiveDays->setValue(cfg.archiveRetentionDays());
 }
 
 void SettingsDialog::accept()
@@ -103,6 +138,10 @@ void SettingsDialog::accept()
     cfg.setMaxPosition(m_spinMaxPos->value());
     cfg.setMotionTimeout(m_spinTimeout->value());
     cfg.setDataStoragePath(m_editDataPath->text());
+    cfg.setMotionLogEngine(m_comboLogEngine->currentData().toString());
+    cfg.setMotionLogRetentionDays(m_spinLogDays->value());
+    cfg.setTaskRetentionDays(m_spinTaskDays->value());
+    cfg.setArchiveRetentionDays(m_spinArchiveDays->value());
     
     // 确保目录存在
     cfg.ensureDataDirExists();
@@ -32,6 +32,10 @@ private:
     // Data
     QLineEdit *m_editDataPath;
     QPushButton *m_btnBrowse;
+    QComboBox *m_comboLogEngine;
+    QSpinBox *m_spinLogDays;
+    QSpinBox *m_spinTaskDays;
+    QSpinBox *m_spinArchiveDays;
 };
 
 #endif // SETTINGSDIALOG_H
@@ -4,13 +4,39 @@
 #include <QGraphicsDropShadowEffect>
 #include <QStyle>
 #include <QFrame>
-#include <QDateTime>
+#include <QScreen>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 指示灯和状态标签的外观按动态属性 "state" 选择，只在构造时设置一次样式表
+static const char *kStyleSheet =
+    "QGroupBox { border: none; margin-top: 0px; }"
+    "QLabel#StatusLed { background-color: #dcdcdc; border-radius: 5px; }"
+    "QLabel#StatusLed[state=\"on\"] { background-color: #e74c3c; }"
+    "QLabel#StatusLed[state=\"disconnected\"] { background-color: #BDC3C7; }"
+    "QLabel#StatusBadge { background-color: #ECF0F1; color: #7F8C8D; border-radius: 4px; font-size: 12px; font-weight: bold; }"
+    "QLabel#StatusBadge[state=\"moving\"] { background-color: #E8F8F5; color: #27AE60; }"
+    "QLabel#StatusBadge[state=\"error\"] { background-color: #FDEDEC; color: #C0392B; }"
+    "QLabel#StatusBadge[state=\"disconnected\"] { background-color: transparent; }";
+
+/**
+ * @brief 切换控件的 "state" 属性，只有变化时才重新 polish (setStyleSheet 每次都会重新解析样式)
+ */
+static void setVisualState(QWidget *widget, const char *state)
+{
+    if (widget->property("state").toByteArray() == state) return;
+    widget->setProperty("state", QByteArray(state));
+    widget->style()->unpolish(widget);
+    widget->style()->polish(widget);
+}
 
-StatusWidget::StatusWidget(QWidget *parent) : QGroupBox(parent)
+StatusWidget::StatusWidget(TelemetryHistory *history, QWidget *parent)
+    : QGroupBox(parent)
+    , m_history(history)
 {
     // 隐藏默认 GroupBox 标题和边框
     this->setTitle(""); 
-    this->setStyleSheet("QGroupBox { border: none; margin-top: 0px; }");
+    this->setStyleSheet(kStyleSheet);
     
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(0, 0, 0, 0);
@@ -34,10 +60,11 @@ StatusWidget::StatusWidget(QWidget *parent) : QGroupBox(parent)
     
     // 状态 Badge
     m_lblStatus = new QLabel("未连接", this);
+    m_lblStatus->setObjectName("StatusBadge");
     m_lblStatus->setAlignment(Qt::AlignCenter);
     m_lblStatus->setFixedSize(80, 26);
-    // 背景设为透明，避免灰色块，仅在 setStyleSheet 时动态设置背景
-    m_lblStatus->setStyleSheet("background-color: transparent; color: #7F8C8D; font-size: 12px; font-weight: bold;");
+    // 未连接时背景透明，避免灰色块
+    m_lblStatus->setProperty("state", QByteArray("disconnected"));
 
     QHBoxLayout *headerLayout = new QHBoxLayout();
     headerLayout->addWidget(lblTitle);
@@ -100,8 +127,9 @@ StatusWidget::StatusWidget(QWidget *parent) : QGroupBox(parent)
         QHBoxLayout *hl = new QHBoxLayout();
         hl->setSpacing(10);
         ledPtr = new QLabel();
+        ledPtr->setObjectName("StatusLed");
         ledPtr->setFixedSize(10, 10);
-        ledPtr->setStyleSheet("background-color: #BDC3C7; border-radius: 5px;"); // 亮色背景下的灰色
+        ledPtr->setProperty("state", QByteArray("disconnected")); // 亮色背景下的灰色
         QLabel *lbl = new QLabel(text);
         lbl->setStyleSheet("font-size: 12px; color: #7F8C8D;"); // 适配亮色
         hl->addWidget(ledPtr);
@@ -142,7 +170,12 @@ StatusWidget::StatusWidget(QWidget *parent) : QGroupBox(parent)
     cardLayout->addLayout(contentLayout);
     mainLayout->addWidget(cardFrame);
     
-    m_startTime = QDateTime::currentMSecsSinceEpoch();
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setSingleShot(true);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &StatusWidget::updateFrame);
+
+    connect(m_history, &TelemetryHistory::updated, this, &StatusWidget::onHistoryUpdated);
 }
 
 void StatusWidget::initChart()
@@ -169,7 +202,7 @@ void StatusWidget::initChart()
 
     // 坐标轴 X (时间)
     m_axisX = new QValueAxis();
-    m_axisX->setRange(0, 10); // 显示 10秒窗口
+    m_axisX->setRange(0, m_history->windowSec()); // 显示的时间窗口
     m_axisX->setLabelFormat("%.1f");
     m_axisX->setTitleText("时间 (s)");
     m_chart->addAxis(m_axisX, Qt::AlignBottom);
@@ -198,108 +231,120 @@ void StatusWidget::initChart()
     m_chart->legend()->setVisible(true);
 }
 
-void StatusWidget::updateStatus(const MotionFeedback &fb)
+void StatusWidget::onHistoryUpdated()
+{
+    // 隐藏页面上的实例不绘制，显示时由 showEvent 追上
+    if (!isVisible()) return;
+    scheduleFrame();
+}
+
+void StatusWidget::showEvent(QShowEvent *event)
+{
+    QGroupBox::showEvent(event);
+    m_frameTimer->stop();
+    updateFrame();
+}
+
+/**
+ * @brief 有新数据时按屏幕刷新间隔安排一次刷新，期间到达的帧只保留最新一帧
+ */
+void StatusWidget::scheduleFrame()
+{
+    if (m_frameTimer->isActive()) return;
+    const QScreen *s = screen();
+    const double hz = (s && s->refreshRate() > 0) ? s->refreshRate() : 60.0;
+    m_frameTimer->start(qMax(1, qRound(1000.0 / hz)));
+}
+
+void StatusWidget::updateFrame()
+{
+    QElapsedTimer timer;
+    timer.start();
+    updateIndicators();
+    updateChart();
+    m_history->addRenderTime(timer.nsecsElapsed() / 1e6);
+}
+
+void StatusWidget::updateIndicators()
 {
+    // QLabel::setText 对相同文本直接返回，数值不变时不会触发重绘
+    if (!m_history->isConnected()) {
+        m_lblStatus->setText("未连接");
+        setVisualState(m_lblStatus, "disconnected");
+
+        m_lblPos->setText("0.00");
+        m_lblSpeed->setText("0.0");
+
+        setVisualState(m_ledLeftLimit, "disconnected");
+        setVisualState(m_ledRightLimit, "disconnected");
+        setVisualState(m_ledEmergency, "disconnected");
+        return;
+    }
+
+    const MotionFeedback &fb = m_history->latest();
+
     // 1. 更新数值显示
     m_lblPos->setText(QString::number(fb.position_mm, 'f', 2));
     m_lblSpeed->setText(QString::number(fb.speed_mm_s, 'f', 1));
 
     // 2. 更新指示灯
-    QString redStyle = "background-color: #e74c3c; border-radius: 5px;";
-    QString grayStyle = "background-color: #dcdcdc; border-radius: 5px;";
-
-    m_ledLeftLimit->setStyleSheet(fb.leftLimit ? redStyle : grayStyle);
-    m_ledRightLimit->setStyleSheet(fb.rightLimit ? redStyle : grayStyle);
+    setVisualState(m_ledLeftLimit, fb.leftLimit ? "on" : "off");
+    setVisualState(m_ledRightLimit, fb.rightLimit ? "on" : "off");
     
     bool isAlarm = fb.emergencyStop || fb.overCurrent || fb.stalled;
-    m_ledEmergency->setStyleSheet(isAlarm ? redStyle : grayStyle);
+    setVisualState(m_ledEmergency, isAlarm ? "on" : "off");
 
     QString statusStr;
-    QString badgeStyle;
+    const char *badgeState;
     
     switch(fb.status) {
         case DeviceStatus::Idle: 
             statusStr = "空闲"; 
-            badgeStyle = "background-color: #ECF0F1; color: #7F8C8D;"; 
+            badgeState = "idle";
             break;
         case DeviceStatus::MovingForward: 
             statusStr = "推进中"; 
-            badgeStyle = "background-color: #E8F8F5; color: #27AE60;"; 
+            badgeState = "moving";
             break;
         case DeviceStatus::MovingBackward: 
             statusStr = "拉回中"; 
-            badgeStyle = "background-color: #E8F8F5; color: #27AE60;"; 
+            badgeState = "moving";
             break;
         case DeviceStatus::Error: 
             statusStr = "故障"; 
-            badgeStyle = "background-color: #FDEDEC; color: #C0392B;"; 
+            badgeState = "error";
             break;
         default: 
             statusStr = "未知"; 
-            badgeStyle = "background-color: #ECF0F1; color: #7F8C8D;"; 
+            badgeState = "unknown";
             break;
     }
     
     m_lblStatus->setText(statusStr);
-    m_lblStatus->setStyleSheet(QString("QLabel { %1 border-radius: 4px; font-size: 12px; font-weight: bold; }").arg(badgeStyle));
-
-    // 3. 更新图表数据
-    bool isMoving = (fb.status != DeviceStatus::Idle && fb.status != DeviceStatus::Unknown);
-
-    if (isMoving) {
-        if (!m_isRecording) {
-            // 刚开始运动：重置图表
-            m_isRecording = true;
-            m_startTime = QDateTime::currentMSecsSinceEpoch();
-            m_seriesPos->clear();
-            m_seriesSpeed->clear();
-            m_axisX->setRange(0, 10);
-            
-            // 重置 Y 轴范围 (可选)
-            m_axisYPos->setRange(0, 100); 
-            m_axisYSpeed->setRange(-10, 10);
-        }
-
-        double t = (QDateTime::currentMSecsSinceEpoch() - m_startTime) / 1000.0;
-        m_seriesPos->append(t, fb.position_mm);
-        m_seriesSpeed->append(t, fb.speed_mm_s);
-
-        // 滚动 X 轴 (保留最近 10 秒)
-        if (t > 10.0) {
-            m_axisX->setRange(t - 10.0, t);
-        }
-        
-        // 自动调整 Y 轴范围
-        if (fb.position_mm > m_axisYPos->max()) m_axisYPos->setMax(fb.position_mm * 1.1);
-        if (fb.speed_mm_s > m_axisYSpeed->max()) m_axisYSpeed->setMax(fb.speed_mm_s * 1.2);
-        if (fb.speed_mm_s < m_axisYSpeed->min()) m_axisYSpeed->setMin(fb.speed_mm_s * 1.2);
-    } 
-    else {
-        // 设备停止或空闲
-        if (m_isRecording) {
-            // 记录停止瞬间的状态，然后停止刷新
-            double t = (QDateTime::currentMSecsSinceEpoch() - m_startTime) / 1000.0;
-            m_seriesPos->append(t, fb.position_mm);
-            m_seriesSpeed->append(t, fb.speed_mm_s);
-            m_isRecording = false;
-        }
-    }
+    setVisualState(m_lblStatus, badgeState);
 }
 
-void StatusWidget::setDisconnected()
+/**
+ * @brief 按共享缓冲重绘整条曲线 (不依赖之前绘制过的内容，隐藏后再显示也能直接追上)
+ * 缓冲内容未变 (设备空闲时的反馈帧) 时不替换曲线，Y 轴范围也只随追加的点变化。
+ */
+void StatusWidget::updateChart()
 {
-    m_lblStatus->setText("未连接");
-    
-    QString badgeStyle = "background-color: transparent; color: #7F8C8D;";
-    m_lblStatus->setStyleSheet(QString("QLabel { %1 border-radius: 4px; font-size: 12px; font-weight: bold; }").arg(badgeStyle));
-
-    m_lblPos->setText("0.00");
-    m_lblSpeed->setText("0.0");
-
-    QString grayStyle = "background-color: #BDC3C7; border-radius: 5px;";
-    m_ledLeftLimit->setStyleSheet(grayStyle);
-    m_ledRightLimit->setStyleSheet(grayStyle);
-    m_ledEmergency->setStyleSheet(grayStyle);
-
-    m_isRecording = false;
+    const ChartRingBuffer &buffer = m_history->buffer();
+    if (buffer.generation() == m_chartGeneration) return;
+    m_chartGeneration = buffer.generation();
+
+    const double window = m_history->windowSec();
+    const double t = buffer.lastTime();
+    buffer.points(t - window, m_posPoints, m_speedPoints);
+    m_seriesPos->replace(m_posPoints);
+    m_seriesSpeed->replace(m_speedPoints);
+
+    // 滚动 X 轴 (保留最近的时间窗口)
+    const double xMin = t > window ? t - window : 0.0;
+    if (m_axisX->min() != xMin) m_axisX->setRange(xMin, xMin + window);
+    if (m_axisYPos->max() != m_history->posMax()) m_axisYPos->setMax(m_history->posMax());
+    if (m_axisYSpeed->min() != m_history->speedMin() || m_axisYSpeed->max() != m_history->speedMax()) {
+        m_axisYSpeed->setRange(m_history->speedMin(), m_history->speedMax());
+    }
 }
@@ -7,17 +7,36 @@
 #include <QtCharts/QLineSeries>
 #include <QtCharts/QValueAxis>
 #include "../communication/protocol.h"
+#include "telemetryhistory.h"
 
+class QTimer;
+
+/**
+ * @brief 实时状态监控 (TelemetryHistory 的视图)
+ *
+ * 多个页面的 StatusWidget 共享同一个 TelemetryHistory，只有可见的实例绘制，
+ * 隐藏的实例在 showEvent 中按最新数据一次性刷新。
+ * 反馈帧只启动显示帧定时器，数值、指示灯和曲线按屏幕刷新率合并刷新 (取最新一帧)；
+ * 指示灯和状态标签的外观由动态属性 "state" 选择，状态不变时不做任何样式更新。
+ */
 class StatusWidget : public QGroupBox
 {
     Q_OBJECT
 public:
-    explicit StatusWidget(QWidget *parent = nullptr);
-    void updateStatus(const MotionFeedback &fb);
-    void setDisconnected();
+    explicit StatusWidget(TelemetryHistory *history, QWidget *parent = nullptr);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private slots:
+    void onHistoryUpdated();
 
 private:
     void initChart();
+    void scheduleFrame();
+    void updateFrame();
+    void updateIndicators();
+    void updateChart();
 
     QLabel *m_lblPos;
     QLabel *m_lblSpeed;
@@ -35,8 +54,13 @@ private:
     QValueAxis *m_axisX;
     QValueAxis *m_axisYPos;
     QValueAxis *m_axisYSpeed;
-    qint64 m_startTime;
-    bool m_isRecording = false;
+
+    // 数据来自共享的遥测数据，按显示帧率整体刷新
+    TelemetryHistory *m_history;
+    QTimer *m_frameTimer;               ///< 单次定时器，有新数据时启动
+    QList<QPointF> m_posPoints;
+    QList<QPointF> m_speedPoints;
+    quint64 m_chartGeneration = 0;      ///< 已绘制的缓冲版本
 };
 
 #endif // STATUSWIDGET_H
@@ -0,0 +1,132 @@
+#include "taskactiondelegate.h"
+#include "taskhistorymodel.h"
+#include <QApplication>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QStyle>
+
+namespace {
+constexpr int kMarginX = 5;
+constexpr int kMarginY = 2;
+constexpr int kSpacing = 5;
+}
+
+TaskActionDelegate::TaskActionDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+bool TaskActionDelegate::isEnabled(const QString &status, Action action)
+{
+    if (status == "create") {
+        return action == Config || action == Delete;
+    } else if (status == "configured") {
+        return action == Config || action == Execute || action == Delete;
+    } else if (status == "running") {
+        return action == Stop;
+    } else if (status == "completed") {
+        return action == Result || action == Delete;
+    } else if (status == "failed" || status == "stopped") {
+        // 失败/停止后可以重新配置、重新执行、查看原因
+        return action != Stop;
+    }
+    // 其他状态（如stop等）
+    return action == Delete;
+}
+
+TaskActionDelegate::Action TaskActionDelegate::slotAction(int slot, const QString &status)
+{
+    switch (slot) {
+    case 0: return Config;
+    case 1: return status == "running" ? Stop : Execute;
+    case 2: return Result;
+    case 3: return Delete;
+    default: return None;
+    }
+}
+
+QString TaskActionDelegate::actionText(Action action)
+{
+    switch (action) {
+    case Config:  return "配置";
+    case Execute: return "执行";
+    case Stop:    return "停止";
+    case Result:  return "结果";
+    case Delete:  return "删除";
+    default:      return QString();
+    }
+}
+
+QRect TaskActionDelegate::buttonRect(const QRect &cell, int slot) const
+{
+    const QRect area = cell.adjusted(kMarginX, kMarginY, -kMarginX, -kMarginY);
+    const int width = (area.width() - kSpacing * (kButtonCount - 1)) / kButtonCount;
+    return QRect(area.left() + slot * (width + kSpacing), area.top(), width, area.height());
+}
+
+void TaskActionDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    const QString status = index.data(TaskHistoryModel::StatusRole).toString();
+    const QWidget *widget = option.widget;
+    QStyle *style = widget ? widget->style() : QApplication::style();
+
+    for (int slot = 0; slot < kButtonCount; ++slot) {
+        const Action action = slotAction(slot, status);
+
+        QStyleOptionButton button;
+        button.rect = buttonRect(option.rect, slot);
+        button.text = actionText(action);
+        button.fontMetrics = option.fontMetrics;
+        button.palette = option.palette;
+        button.state = QStyle::State_Raised;
+        if (isEnabled(status, action)) button.state |= QStyle::State_Enabled;
+        style->drawControl(QStyle::CE_PushButton, &button, painter, widget);
+    }
+}
+
+QSize TaskActionDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    Q_UNUSED(index);
+    const int textWidth = option.fontMetrics.horizontalAdvance("配置") + 16;
+    const int height = option.fontMetrics.height() + 10;
+    return QSize(kMarginX * 2 + kSpacing * (kButtonCount - 1) + textWidth * kButtonCount,
+                 height + kMarginY * 2);
+}
+
+bool TaskActionDelegate::editorEvent(QEvent *event, QAbstractItemModel *model,
+                                     const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    Q_UNUSED(model);
+    if (event->type() != QEvent::MouseButtonPress && event->type() != QEvent::MouseButtonRelease) {
+        return false;
+    }
+
+    const auto *mouse = static_cast<QMouseEvent *>(event);
+    if (mouse->button() != Qt::LeftButton) return false;
+
+    const QString status = index.data(TaskHistoryModel::StatusRole).toString();
+    int slot = -1;
+    for (int i = 0; i < kButtonCount; ++i) {
+        if (buttonRect(option.rect, i).contains(mouse->position().toPoint())) {
+            slot = i;
+            break;
+        }
+    }
+    const Action action = slotAction(slot, status);
+    const bool enabled = slot >= 0 && isEnabled(status, action);
+
+    if (event->type() == QEvent::MouseButtonPress) {
+        m_pressedIndex = enabled ? QPersistentModelIndex(index) : QPersistentModelIndex();
+        m_pressedSlot = enabled ? slot : -1;
+        return enabled;
+    }
+
+    // 释放时仍在按下的按钮上才触发
+    const bool clicked = enabled && m_pressedIndex == index && m_pressedSlot == slot;
+    m_pressedIndex = QPersistentModelIndex();
+    m_pressedSlot = -1;
+    if (clicked) {
+        emit actionTriggered(index.data(TaskHistoryModel::TaskIdRole).toInt(), action);
+    }
+    return clicked;
+}
@@ -0,0 +1,53 @@
+#ifndef TASKACTIONDELEGATE_H
+#define TASKACTIONDELEGATE_H
+
+#include <QPersistentModelIndex>
+#include <QStyledItemDelegate>
+
+/**
+ * @brief 任务列表操作列的委托
+ *
+ * 在单元格内直接绘制 "配置/执行/结果/删除" 四个按钮 (按任务状态决定是否可用)，
+ * 鼠标点击由 editorEvent 命中测试后发出 actionTriggered，不为每行创建按钮控件。
+ */
+class TaskActionDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+public:
+    enum Action {
+        Config = 0,
+        Execute,                ///< 运行中的任务显示为 "停止"
+        Stop,
+        Result,
+        Delete,
+        None = -1
+    };
+    Q_ENUM(Action)
+
+    explicit TaskActionDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model,
+                     const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+    /**
+     * @brief 指定状态下按钮是否可用
+     */
+    static bool isEnabled(const QString &status, Action action);
+
+signals:
+    void actionTriggered(int taskId, TaskActionDelegate::Action action);
+
+private:
+    static constexpr int kButtonCount = 4;
+
+    QRect buttonRect(const QRect &cell, int slot) const;
+    static Action slotAction(int slot, const QString &status);
+    static QString actionText(Action action);
+
+    QPersistentModelIndex m_pressedIndex;
+    int m_pressedSlot = -1;
+};
+
+#endif // TASKACTIONDELEGATE_H
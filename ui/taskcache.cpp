@@ -0,0 +1,360 @@
+#include "taskcache.h"
+#include <QtAlgorithms>
+#include <QtConcurrent>
+#include <algorithm>
+#include <numeric>
+
+void TaskCache::assign(const QVector<TaskRecord> &records)
+{
+    clear();
+    reserve(records.size());
+    for (const TaskRecord &record : records) appendRecord(record);
+    finish();
+}
+
+void TaskCache::prepend(const QVector<TaskRecord> &records)
+{
+    if (records.isEmpty()) return;
+
+    TaskCache merged;
+    merged.clear();
+    merged.reserve(records.size() + size());
+    merged.m_keys.reserve(m_keys.size() + records.size() * 32);
+    for (const TaskRecord &record : records) merged.appendRecord(record);
+    for (int row = 0; row < size(); ++row) merged.appendRow(*this, row);
+    merged.finish();
+    *this = std::move(merged);
+}
+
+QVector<int> TaskCache::remove(const QSet<int> &taskIds)
+{
+    QVector<int> newRow(size(), -1);
+
+    TaskCache kept;
+    kept.clear();
+    kept.reserve(size());
+    kept.m_keys.reserve(m_keys.size());
+    for (int row = 0; row < size(); ++row) {
+        if (taskIds.contains(m_ids[row])) continue;
+        newRow[row] = kept.size();
+        kept.appendRow(*this, row);
+    }
+    kept.finish();
+    *this = std::move(kept);
+    return newRow;
+}
+
+void TaskCache::update(int row, const TaskRecord &record)
+{
+    const qint32 day = record.startTime.isValid() ? qint32(record.startTime.date().toJulianDay()) : kNoDay;
+    if (day != m_day[row] || record.operatorName != operatorName(row) || record.tubeId != m_tube[row]) {
+        TaskCache rebuilt;
+        rebuilt.clear();
+        rebuilt.reserve(size());
+        rebuilt.m_keys.reserve(m_keys.size() + record.operatorName.size() + record.tubeId.size());
+        for (int r = 0; r < size(); ++r) {
+            if (r == row) {
+                rebuilt.appendRecord(record);
+            } else {
+                rebuilt.appendRow(*this, r);
+            }
+        }
+        rebuilt.finish();
+        *this = std::move(rebuilt);
+        return;
+    }
+
+    m_startMs[row] = record.startTime.isValid() ? record.startTime.toMSecsSinceEpoch() : kNoTime;
+    m_status[row] = statusCode(record.status);
+    m_statsText[row] = record.statsText;
+    m_statsTip[row] = record.statsTip;
+}
+
+QDateTime TaskCache::startTime(int row) const
+{
+    return m_startMs[row] == kNoTime ? QDateTime() : QDateTime::fromMSecsSinceEpoch(m_startMs[row]);
+}
+
+void TaskCache::setStatus(int row, const QString &status)
+{
+    m_status[row] = statusCode(status);
+}
+
+void TaskCache::clear()
+{
+    m_ids.clear();
+    m_startMs.clear();
+    m_day.clear();
+    m_operator.clear();
+    m_status.clear();
+    m_tube.clear();
+    m_statsText.clear();
+    m_statsTip.clear();
+    m_keys.clear();
+    m_keyOffset = {0};
+    m_tubeOffset.clear();
+    m_operators.clear();
+    m_operatorCodes.clear();
+    m_statuses.clear();
+    m_statusKeys.clear();
+    m_statusCodes.clear();
+    m_byDay.clear();
+    m_noDay.clear();
+    m_rowOf.clear();
+}
+
+void TaskCache::reserve(int rows)
+{
+    m_ids.reserve(rows);
+    m_startMs.reserve(rows);
+    m_day.reserve(rows);
+    m_operator.reserve(rows);
+    m_status.reserve(rows);
+    m_tube.reserve(rows);
+    m_statsText.reserve(rows);
+    m_statsTip.reserve(rows);
+    m_keyOffset.reserve(rows + 1);
+    m_tubeOffset.reserve(rows);
+}
+
+void TaskCache::appendRecord(const TaskRecord &record)
+{
+    m_ids.append(record.id);
+    if (record.startTime.isValid()) {
+        m_startMs.append(record.startTime.toMSecsSinceEpoch());
+        m_day.append(qint32(record.startTime.date().toJulianDay()));
+    } else {
+        m_startMs.append(kNoTime);
+        m_day.append(kNoDay);
+    }
+    m_operator.append(operatorCode(record.operatorName));
+    m_status.append(statusCode(record.status));
+    m_tube.append(record.tubeId);
+    m_statsText.append(record.statsText);
+    m_statsTip.append(record.statsTip);
+
+    m_keys.append(QString::number(record.id)).append(' ').append(record.operatorName.toLower()).append(' ');
+    m_tubeOffset.append(m_keys.size());
+    m_keys.append(record.tubeId.toLower());
+    m_keyOffset.append(m_keys.size());
+}
+
+void TaskCache::appendRow(const TaskCache &other, int row)
+{
+    m_ids.append(other.m_ids[row]);
+    m_startMs.append(other.m_startMs[row]);
+    m_day.append(other.m_day[row]);
+    m_operator.append(operatorCode(other.m_operators[other.m_operator[row]]));
+    m_status.append(statusCode(other.m_statuses[other.m_status[row]]));
+    m_tube.append(other.m_tube[row]);
+    m_statsText.append(other.m_statsText[row]);
+    m_statsTip.append(other.m_statsTip[row]);
+
+    // 小写文本直接拷贝
+    const int begin = other.m_keyOffset[row];
+    const int end = other.m_keyOffset[row + 1];
+    m_tubeOffset.append(m_keys.size() + other.m_tubeOffset[row] - begin);
+    m_keys.append(QStringView(other.m_keys).mid(begin, end - begin));
+    m_keyOffset.append(m_keys.size());
+}
+
+void TaskCache::finish()
+{
+    m_rowOf.clear();
+    m_rowOf.reserve(size());
+    for (int row = 0; row < size(); ++row) m_rowOf.insert(m_ids[row], row);
+
+    m_byDay.clear();
+    m_noDay.clear();
+    m_byDay.reserve(size());
+    for (int row = 0; row < size(); ++row) {
+        if (m_day[row] == kNoDay) {
+            m_noDay.append(row);
+        } else {
+            m_byDay.append(row);
+        }
+    }
+    std::sort(m_byDay.begin(), m_byDay.end(), [this](int a, int b) {
+        return m_day[a] != m_day[b] ? m_day[a] < m_day[b] : a < b;
+    });
+}
+
+int TaskCache::operatorCode(const QString &name)
+{
+    auto it = m_operatorCodes.constFind(name);
+    if (it != m_operatorCodes.constEnd()) return it.value();
+    const int code = m_operators.size();
+    m_operators.append(name);
+    m_operatorCodes.insert(name, code);
+    return code;
+}
+
+int TaskCache::statusCode(const QString &name)
+{
+    auto it = m_statusCodes.constFind(name);
+    if (it != m_statusCodes.constEnd()) return it.value();
+    const int code = m_statuses.size();
+    m_statuses.append(name);
+    m_statusKeys.append(name.toLower());
+    m_statusCodes.insert(name, code);
+    return code;
+}
+
+TaskCache::Compiled TaskCache::compile(const Query &query) const
+{
+    Compiled c;
+    c.text = query.text.trimmed().toLower();
+    if (!c.text.isEmpty()) {
+        c.all = false;
+        c.textHasSpace = c.text.contains(' ');
+        c.statusText.resize(m_statusKeys.size());
+        for (int i = 0; i < m_statusKeys.size(); ++i) {
+            c.statusText[i] = m_statusKeys[i].contains(c.text);
+        }
+    }
+
+    if (!query.advanced) return c;
+
+    const QString idText = query.taskId.trimmed();
+    if (!idText.isEmpty()) {
+        c.all = false;
+        bool ok = false;
+        const int taskId = idText.toInt(&ok);
+        // 与 "任务ID文本完全相同" 等价 (如 "007" 不匹配任务 7)
+        c.onlyRow = (ok && QString::number(taskId) == idText) ? rowOf(taskId) : -1;
+        if (c.onlyRow < 0) c.none = true;
+    }
+    if (query.from.isValid() && query.to.isValid()) {
+        c.all = false;
+        c.dateActive = true;
+        c.fromDay = qint32(query.from.toJulianDay());
+        c.toDay = qint32(query.to.toJulianDay());
+    }
+    if (!query.operatorName.isEmpty()) {
+        c.all = false;
+        c.operatorCode = m_operatorCodes.value(query.operatorName, -1);
+        if (c.operatorCode < 0) c.none = true;
+    }
+    c.tube = query.tube.trimmed().toLower();
+    if (!c.tube.isEmpty()) c.all = false;
+    if (!query.status.isEmpty()) {
+        c.all = false;
+        c.statusCode = m_statusCodes.value(query.status, -1);
+        if (c.statusCode < 0) c.none = true;
+    }
+    return c;
+}
+
+/**
+ * @brief 除时间范围外的条件 (时间范围由 m_byDay 生成位图)
+ */
+bool TaskCache::rowMatches(const Compiled &c, int row) const
+{
+    if (c.operatorCode >= 0 && m_operator[row] != c.operatorCode) return false;
+    if (c.statusCode >= 0 && m_status[row] != c.statusCode) return false;
+
+    const int begin = m_keyOffset[row];
+    const QStringView key = QStringView(m_keys).mid(begin, m_keyOffset[row + 1] - begin);
+    if (!c.tube.isEmpty() && !key.mid(m_tubeOffset[row] - begin).contains(c.tube)) return false;
+
+    if (!c.text.isEmpty()) {
+        const int status = m_status[row];
+        if (c.textHasSpace) {
+            // 搜索文本可能跨越管道编号和状态，按整行文本比较
+            const QString line = key.toString() + QLatin1Char(' ') + m_statusKeys[status];
+            if (!line.contains(c.text)) return false;
+        } else if (!(status < c.statusText.size() && c.statusText[status]) && !key.contains(c.text)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TaskCache::matchWords(const Compiled &c, const quint64 *dateMask, quint64 *words, int firstWord, int lastWord) const
+{
+    const int n = size();
+    for (int w = firstWord; w < lastWord; ++w) {
+        const int base = w * 64;
+        const int count = qMin(64, n - base);
+        quint64 bits = count == 64 ? ~quint64(0) : ((quint64(1) << count) - 1);
+        if (dateMask) bits &= dateMask[w];
+
+        quint64 result = 0;
+        while (bits) {
+            const int bit = qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            if (rowMatches(c, base + bit)) result |= quint64(1) << bit;
+        }
+        words[w] = result;
+    }
+}
+
+QVector<int> TaskCache::match(const Query &query) const
+{
+    const int n = size();
+    QVector<int> rows;
+    const Compiled c = compile(query);
+    if (c.none || n == 0) return rows;
+
+    if (c.all) {
+        rows.resize(n);
+        std::iota(rows.begin(), rows.end(), 0);
+        return rows;
+    }
+    if (c.onlyRow >= 0) {
+        if (matches(c.onlyRow, query)) rows.append(c.onlyRow);
+        return rows;
+    }
+
+    const int wordCount = (n + 63) / 64;
+
+    // 时间范围：在按日期排序的行号中二分得到区间，日期无效的行不受限制
+    QVector<quint64> dateMask;
+    if (c.dateActive) {
+        dateMask.fill(0, wordCount);
+        const auto lo = std::lower_bound(m_byDay.cbegin(), m_byDay.cend(), c.fromDay,
+                                         [this](int row, qint32 day) { return m_day[row] < day; });
+        const auto hi = std::upper_bound(lo, m_byDay.cend(), c.toDay,
+                                         [this](qint32 day, int row) { return day < m_day[row]; });
+        for (auto it = lo; it < hi; ++it) dateMask[*it >> 6] |= quint64(1) << (*it & 63);
+        for (int row : m_noDay) dateMask[row >> 6] |= quint64(1) << (row & 63);
+    }
+    const quint64 *mask = c.dateActive ? dateMask.constData() : nullptr;
+
+    QVector<quint64> words(wordCount);
+    if (n >= kParallelRows) {
+        QVector<int> chunks;
+        for (int w = 0; w < wordCount; w += kWordsPerChunk) chunks.append(w);
+        quint64 *out = words.data();
+        QtConcurrent::blockingMap(chunks, [&](const int &first) {
+            matchWords(c, mask, out, first, qMin(first + kWordsPerChunk, wordCount));
+        });
+    } else {
+        matchWords(c, mask, words.data(), 0, wordCount);
+    }
+
+    // 位图 -> 递增行号
+    int total = 0;
+    for (quint64 word : std::as_const(words)) total += qPopulationCount(word);
+    rows.reserve(total);
+    for (int w = 0; w < wordCount; ++w) {
+        quint64 bits = words[w];
+        while (bits) {
+            rows.append(w * 64 + qCountTrailingZeroBits(bits));
+            bits &= bits - 1;
+        }
+    }
+    return rows;
+}
+
+bool TaskCache::matches(int row, const Query &query) const
+{
+    const Compiled c = compile(query);
+    if (c.none) return false;
+    if (c.all) return true;
+    if (c.onlyRow >= 0 && row != c.onlyRow) return false;
+    if (c.dateActive && m_day[row] != kNoDay && (m_day[row] < c.fromDay || m_day[row] > c.toDay)) {
+        return false;
+    }
+    return rowMatches(c, row);
+}
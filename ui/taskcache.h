@@ -0,0 +1,165 @@
+#ifndef TASKCACHE_H
+#define TASKCACHE_H
+
+#include <QDate>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QVector>
+#include <limits>
+
+/**
+ * @brief 任务列表中的一行 (导入/插入时使用的类型化记录)
+ */
+struct TaskRecord {
+    int id = 0;
+    QDateTime startTime;
+    QString operatorName;
+    QString tubeId;
+    QString status;
+    QString statsText;          ///< 扫描统计摘要 (TaskStats)
+    QString statsTip;           ///< 扫描统计明细 (悬停提示)
+};
+
+/**
+ * @brief 任务列表的列式缓存和筛选索引
+ *
+ * 每列一个数组 (按显示顺序，即任务ID倒序)：
+ *   - 操作员、状态编码为字典下标，等值筛选只比较整数；
+ *   - "任务ID 操作员 管道编号" 预先转小写后连续存放在一个字符串中 (按偏移访问)，
+ *     快速搜索不再逐行格式化/转小写；状态只在字典中匹配一次；
+ *   - 另存按日期排序的行号数组，时间范围筛选用二分查找得到区间。
+ * 筛选结果先按 64 行一个字生成位图 (时间区间位图与其余条件逐字求交)，
+ * 行数较多时分块在线程池中并行，最后转换为递增的行号数组。
+ */
+class TaskCache
+{
+public:
+    /**
+     * @brief 筛选条件 (与任务配置页的搜索/高级筛选控件一一对应)
+     */
+    struct Query {
+        QString text;               ///< 快速搜索
+        bool advanced = false;      ///< 高级筛选是否生效 (以下条件只在展开时生效)
+        QString taskId;
+        QDate from;
+        QDate to;
+        QString operatorName;       ///< 为空表示全部
+        QString tube;               ///< 管道编号包含 (不区分大小写)
+        QString status;             ///< 为空表示全部
+    };
+
+    static constexpr int kParallelRows = 1 << 17;  ///< 超过此行数时并行筛选
+
+    int size() const { return m_ids.size(); }
+    bool isEmpty() const { return m_ids.isEmpty(); }
+
+    /**
+     * @brief 用记录重建缓存 (records 按显示顺序)
+     */
+    void assign(const QVector<TaskRecord> &records);
+
+    /**
+     * @brief 在最前面插入记录
+     */
+    void prepend(const QVector<TaskRecord> &records);
+
+    /**
+     * @brief 用新记录替换第 row 行 (任务ID不变)
+     * 只有状态/统计变化时原地修改；操作员、管道编号或日期变化时重建搜索文本和日期索引。
+     */
+    void update(int row, const TaskRecord &record);
+
+    /**
+     * @brief 删除指定任务
+     * @return 旧行号 -> 新行号 (已删除的为 -1)
+     */
+    QVector<int> remove(const QSet<int> &taskIds);
+
+    int rowOf(int taskId) const { return m_rowOf.value(taskId, -1); }
+    int id(int row) const { return m_ids[row]; }
+    QDateTime startTime(int row) const;
+    const QString &operatorName(int row) const { return m_operators[m_operator[row]]; }
+    const QString &tubeId(int row) const { return m_tube[row]; }
+    const QString &status(int row) const { return m_statuses[m_status[row]]; }
+    const QString &statsText(int row) const { return m_statsText[row]; }
+    const QString &statsTip(int row) const { return m_statsTip[row]; }
+    void setStatus(int row, const QString &status);
+
+    /**
+     * @brief 出现过的操作员/状态 (字典)
+     */
+    const QStringList &operators() const { return m_operators; }
+    const QStringList &statuses() const { return m_statuses; }
+
+    /**
+     * @brief 满足条件的行号 (递增)
+     */
+    QVector<int> match(const Query &query) const;
+
+    /**
+     * @brief 单行是否满足条件
+     */
+    bool matches(int row, const Query &query) const;
+
+private:
+    static constexpr qint64 kNoTime = std::numeric_limits<qint64>::min();
+    static constexpr qint32 kNoDay = std::numeric_limits<qint32>::min();
+    static constexpr int kWordsPerChunk = 1024;    ///< 并行时每块的字数 (64K 行)
+
+    /**
+     * @brief 预处理后的筛选条件
+     */
+    struct Compiled {
+        bool all = true;            ///< 无任何条件
+        bool none = false;          ///< 条件不可能满足
+        QString text;
+        bool textHasSpace = false;  ///< 含空格时可能跨字段匹配，按整行文本比较
+        QVector<char> statusText;   ///< 各状态是否包含搜索文本
+        int onlyRow = -1;           ///< 任务ID条件命中的行
+        bool dateActive = false;
+        qint32 fromDay = 0;
+        qint32 toDay = 0;
+        int operatorCode = -1;      ///< -1 不限
+        QString tube;
+        int statusCode = -1;        ///< -1 不限
+    };
+
+    void clear();
+    void reserve(int rows);
+    void appendRecord(const TaskRecord &record);
+    void appendRow(const TaskCache &other, int row);
+    void finish();
+    int operatorCode(const QString &name);
+    int statusCode(const QString &name);
+
+    Compiled compile(const Query &query) const;
+    bool rowMatches(const Compiled &c, int row) const;
+    void matchWords(const Compiled &c, const quint64 *dateMask, quint64 *words, int firstWord, int lastWord) const;
+
+    QVector<int> m_ids;
+    QVector<qint64> m_startMs;      ///< 创建时间 (ms)，无效时为 kNoTime
+    QVector<qint32> m_day;          ///< 创建日期 (儒略日)，无效时为 kNoDay
+    QVector<int> m_operator;        ///< m_operators 下标
+    QVector<int> m_status;          ///< m_statuses 下标
+    QVector<QString> m_tube;
+    QVector<QString> m_statsText;
+    QVector<QString> m_statsTip;
+
+    QString m_keys;                 ///< 各行 "任务ID 操作员 管道编号" 的小写文本，首尾相接
+    QVector<int> m_keyOffset;       ///< 第 row 行的文本为 [m_keyOffset[row], m_keyOffset[row + 1])
+    QVector<int> m_tubeOffset;      ///< 第 row 行管道编号在 m_keys 中的起点
+
+    QStringList m_operators;
+    QHash<QString, int> m_operatorCodes;
+    QStringList m_statuses;
+    QStringList m_statusKeys;       ///< 状态的小写文本
+    QHash<QString, int> m_statusCodes;
+
+    QVector<int> m_byDay;           ///< 有效日期的行号，按日期递增
+    QVector<int> m_noDay;           ///< 日期无效的行号
+    QHash<int, int> m_rowOf;        ///< 任务ID -> 行号
+};
+
+#endif // TASKCACHE_H
@@ -4,6 +4,7 @@
 #include <QFormLayout>
 #include <QHeaderView>
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -31,6 +32,10 @@ TaskConfigWidget::TaskConfigWidget(int taskId, QWidget *parent)
     
     mainLayout->addWidget(m_tabWidget);
 
+    m_chkDeviceExec = new QCheckBox("下位机执行 (整体下发扫描程序，由设备自主换向)");
+    m_chkDeviceExec->setToolTip("勾选后换向不再经过上位机往返，上位机仅负责监控与中止");
+    mainLayout->addWidget(m_chkDeviceExec);
+
     // 按钮区域
     QHBoxLayout *buttonLayout = new QHBoxLayout();
     m_btnOk = new QPushButton("确定");
@@ -82,6 +87,30 @@ void TaskConfigWidget::setupAutoScanTab(QWidget *tab)
     formLayout->addRow("扫描速度:", m_spinSpeed);
     formLayout->addRow("往返次数:", m_spinCycles);
 
+    // 自适应速度：重点区域慢速，其余区域按扫描速度
+    m_chkAdaptiveSpeed = new QCheckBox("按同一管道上次扫描数据自动识别重点区域");
+    m_chkAdaptiveSpeed->setToolTip("上次扫描中停留或慢速通过的位置 (支撑板、缺陷复查等) 将以重点区域速度扫描");
+    
+    m_spinRoiSpeed = new QDoubleSpinBox();
+    m_spinRoiSpeed->setRange(1, 100);
+    m_spinRoiSpeed->setSuffix(" %");
+    m_spinRoiSpeed->setValue(5.0);
+    
+    m_editSpeedMapFile = new QLineEdit();
+    m_editSpeedMapFile->setPlaceholderText("可选：每行 起点,终点,速度");
+    QPushButton *btnBrowse = new QPushButton("浏览...");
+    connect(btnBrowse, &QPushButton::clicked, this, [this](){
+        QString file = QFileDialog::getOpenFileName(this, "选择速度表文件", QString(), "速度表 (*.csv *.txt);;所有文件 (*)");
+        if (!file.isEmpty()) m_editSpeedMapFile->setText(file);
+    });
+    QHBoxLayout *fileLayout = new QHBoxLayout();
+    fileLayout->addWidget(m_editSpeedMapFile);
+    fileLayout->addWidget(btnBrowse);
+    
+    formLayout->addRow("自适应速度:", m_chkAdaptiveSpeed);
+    formLayout->addRow("重点区域速度:", m_spinRoiSpeed);
+    formLayout->addRow("速度表文件:", fileLayout);
+
     layout->addLayout(formLayout);
     layout->addStretch();
 }
@@ -235,12 +264,16 @@ void TaskConfigWidget::loadConfigFromJson(const QString &taskType, const QString
     }
     
     QJsonObject config = doc.object();
+    m_chkDeviceExec->setChecked(config["deviceExecution"].toBool(false));
     
     if (taskType == "auto_scan") {
         m_spinMinPos->setValue(config["minPos"].toDouble(0.0));
         m_spinMaxPos->setValue(config["maxPos"].toDouble(100.0));
         m_spinSpeed->setValue(config["speed"].toDouble(20.0));
         m_spinCycles->setValue(config["cycles"].toInt(5));
+        m_chkAdaptiveSpeed->setChecked(config["adaptiveSpeed"].toBool(false));
+        m_spinRoiSpeed->setValue(config["roiSpeed"].toDouble(5.0));
+        m_editSpeedMapFile->setText(config["speedMapFile"].toString());
     } else if (taskType == "sequence") {
         m_spinSeqCycles->setValue(config["cycles"].toInt(1));
         
@@ -282,6 +315,11 @@ QString TaskConfigWidget::generateConfigJson() const
         config["maxPos"] = m_spinMaxPos->value();
         config["speed"] = m_spinSpeed->value();
         config["cycles"] = m_spinCycles->value();
+        config["adaptiveSpeed"] = m_chkAdaptiveSpeed->isChecked();
+        config["roiSpeed"] = m_spinRoiSpeed->value();
+        if (!m_editSpeedMapFile->text().trimmed().isEmpty()) {
+            config["speedMapFile"] = m_editSpeedMapFile->text().trimmed();
+        }
     } else {
         config["cycles"] = m_spinSeqCycles->value();
         
@@ -296,6 +334,8 @@ QString TaskConfigWidget::generateConfigJson() const
         config["steps"] = steps;
     }
     
+    config["deviceExecution"] = m_chkDeviceExec->isChecked();
+    
     QJsonDocument doc(config);
     return doc.toJson(QJsonDocument::Compact);
 }
\ No newline at end of file
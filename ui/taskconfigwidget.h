@@ -9,6 +9,8 @@
 #include <QComboBox>
 #include <QPushButton>
 #include <QLabel>
+#include <QCheckBox>
+#include <QLineEdit>
 #include "../core/taskmanager.h"
 
 /**
@@ -64,6 +66,9 @@ private:
     QDoubleSpinBox *m_spinMaxPos;
     QDoubleSpinBox *m_spinSpeed;
     QSpinBox *m_spinCycles;
+    QCheckBox *m_chkAdaptiveSpeed;   ///< 按同管道历史数据自适应速度
+    QDoubleSpinBox *m_spinRoiSpeed;  ///< 重点区域速度
+    QLineEdit *m_editSpeedMapFile;   ///< 速度表文件 (可选)
 
     // 脚本序列配置
     QTableWidget *m_stepsTable;
@@ -72,6 +77,9 @@ private:
     QDoubleSpinBox *m_spinParam2;
     QSpinBox *m_spinSeqCycles;
 
+    // 执行方式：勾选后整体编译下发由下位机执行
+    QCheckBox *m_chkDeviceExec;
+
     QPushButton *m_btnOk;
     QPushButton *m_btnCancel;
 };
@@ -0,0 +1,306 @@
+#include "taskhistorymodel.h"
+#include <algorithm>
+
+TaskHistoryModel::TaskHistoryModel(QObject *parent)
+    : QAbstractTableModel(parent)
+{
+}
+
+int TaskHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+int TaskHistoryModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant TaskHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_fetched) return QVariant();
+    const int row = m_visible[index.row()];
+
+    switch (role) {
+    case Qt::DisplayRole:
+        switch (index.column()) {
+        case ColId:
+            return m_cache.id(row);
+        case ColStartTime: {
+            const QDateTime startTime = m_cache.startTime(row);
+            return startTime.isValid() ? startTime.toString("yyyy-MM-dd HH:mm:ss") : QString("-");
+        }
+        case ColOperator: {
+            const QString &opName = m_cache.operatorName(row);
+            return opName.isEmpty() ? QString("-") : opName;
+        }
+        case ColTube: {
+            const QString &tube = m_cache.tubeId(row);
+            return tube.isEmpty() ? QString("-") : tube;
+        }
+        case ColStatus:
+            return m_cache.status(row);
+        case ColStats:
+            return m_cache.statsText(row);
+        default:
+            return QVariant();
+        }
+    case Qt::CheckStateRole:
+        if (index.column() == ColCheck) {
+            return m_checked.contains(m_cache.id(row)) ? Qt::Checked : Qt::Unchecked;
+        }
+        return QVariant();
+    case Qt::ToolTipRole:
+        if (index.column() == ColStats && !m_cache.statsTip(row).isEmpty()) return m_cache.statsTip(row);
+        return QVariant();
+    case TaskIdRole:
+        return m_cache.id(row);
+    case StatusRole:
+        return m_cache.status(row);
+    default:
+        return QVariant();
+    }
+}
+
+bool TaskHistoryModel::setData(const QModelIndex &index, const QVariant &value, int role)
+{
+    if (!index.isValid() || index.row() >= m_fetched) return false;
+    if (role != Qt::CheckStateRole || index.column() != ColCheck) return false;
+
+    const int taskId = m_cache.id(m_visible[index.row()]);
+    if (value.toInt() == Qt::Checked) {
+        m_checked.insert(taskId);
+    } else {
+        m_checked.remove(taskId);
+    }
+    emit dataChanged(index, index, {Qt::CheckStateRole});
+    emit checkedChanged();
+    return true;
+}
+
+Qt::ItemFlags TaskHistoryModel::flags(const QModelIndex &index) const
+{
+    if (!index.isValid()) return Qt::NoItemFlags;
+    if (index.column() == ColCheck) return Qt::ItemIsEnabled | Qt::ItemIsUserCheckable;
+    return Qt::ItemIsEnabled;
+}
+
+QVariant TaskHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+    static const char *labels[ColumnCount] = {
+        "选择", "任务ID", "创建时间", "操作员", "管道编号", "当前状态", "扫描统计", "操作"
+    };
+    return (section >= 0 && section < ColumnCount) ? QString(labels[section]) : QVariant();
+}
+
+bool TaskHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < m_visible.size();
+}
+
+void TaskHistoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) return;
+    const int count = qMin(kFetchBatch, int(m_visible.size()) - m_fetched);
+    if (count <= 0) return;
+
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + count - 1);
+    m_fetched += count;
+    endInsertRows();
+}
+
+void TaskHistoryModel::setRecords(const QVector<TaskRecord> &records, const TaskCache::Query &query)
+{
+    const bool hadChecked = !m_checked.isEmpty();
+
+    beginResetModel();
+    m_cache.assign(records);
+    m_query = query;
+    m_checked.clear();
+    refilter();
+    endResetModel();
+
+    if (hadChecked) emit checkedChanged();
+}
+
+void TaskHistoryModel::prependRecords(const QVector<TaskRecord> &records)
+{
+    if (records.isEmpty()) return;
+    const int n = records.size();
+
+    // 新记录先单独建缓存判断是否满足当前条件
+    TaskCache incoming;
+    incoming.assign(records);
+    const QVector<int> shown = incoming.match(m_query);
+
+    if (!shown.isEmpty()) beginInsertRows(QModelIndex(), 0, shown.size() - 1);
+
+    m_cache.prepend(records);
+    for (int &cacheRow : m_visible) cacheRow += n;
+    m_visible = shown + m_visible;
+    m_fetched += shown.size();
+
+    if (!shown.isEmpty()) endInsertRows();
+}
+
+void TaskHistoryModel::upsertRecords(const QVector<TaskRecord> &records, bool insertMissing)
+{
+    QVector<TaskRecord> missing;
+    for (const TaskRecord &record : records) {
+        const int cacheRow = m_cache.rowOf(record.id);
+        if (cacheRow >= 0) {
+            updateRecord(cacheRow, record);
+        } else if (insertMissing) {
+            missing.append(record);
+        }
+    }
+    prependRecords(missing);
+}
+
+void TaskHistoryModel::updateRecord(int cacheRow, const TaskRecord &record)
+{
+    // 行号即显示顺序，更新前后不变
+    const auto it = std::lower_bound(m_visible.begin(), m_visible.end(), cacheRow);
+    const int pos = int(it - m_visible.begin());
+    const bool wasShown = it != m_visible.end() && *it == cacheRow;
+
+    m_cache.update(cacheRow, record);
+    const bool shown = m_cache.matches(cacheRow, m_query);
+
+    if (wasShown && shown) {
+        if (pos < m_fetched) emit dataChanged(index(pos, 0), index(pos, ColumnCount - 1));
+    } else if (wasShown) {
+        // 不再满足筛选条件 (如按状态筛选时任务结束)
+        if (pos < m_fetched) {
+            beginRemoveRows(QModelIndex(), pos, pos);
+            m_visible.remove(pos);
+            --m_fetched;
+            endRemoveRows();
+        } else {
+            m_visible.remove(pos);
+        }
+        if (m_checked.remove(record.id)) emit checkedChanged();
+    } else if (shown) {
+        // 已全部暴露时插在末尾也需通知视图，否则只在尚未 fetchMore 的部分中插入
+        if (pos < m_fetched || m_fetched == m_visible.size()) {
+            beginInsertRows(QModelIndex(), pos, pos);
+            m_visible.insert(pos, cacheRow);
+            ++m_fetched;
+            endInsertRows();
+        } else {
+            m_visible.insert(pos, cacheRow);
+        }
+    }
+}
+
+void TaskHistoryModel::removeTasks(const QSet<int> &taskIds)
+{
+    const bool any = std::any_of(taskIds.begin(), taskIds.end(), [this](int id) { return contains(id); });
+    if (!any) return;
+
+    auto removed = [&](int row) { return taskIds.contains(m_cache.id(m_visible[row])); };
+
+    // 从后往前按连续段移除筛选结果中的行，只有已暴露给视图的部分需要通知
+    int row = m_visible.size() - 1;
+    while (row >= 0) {
+        if (!removed(row)) {
+            --row;
+            continue;
+        }
+        int first = row;
+        while (first > 0 && removed(first - 1)) --first;
+
+        if (first < m_fetched) {
+            const int last = qMin(row, m_fetched - 1);
+            if (row > last) m_visible.remove(last + 1, row - last);
+            beginRemoveRows(QModelIndex(), first, last);
+            m_visible.remove(first, last - first + 1);
+            m_fetched -= last - first + 1;
+            endRemoveRows();
+        } else {
+            m_visible.remove(first, row - first + 1);
+        }
+        row = first - 1;
+    }
+
+    // 压缩缓存，筛选结果中的行号随之重映射 (行内容不变，无需通知视图)
+    const QVector<int> newRow = m_cache.remove(taskIds);
+    for (int &cacheRow : m_visible) cacheRow = newRow[cacheRow];
+
+    bool checkedRemoved = false;
+    for (int id : taskIds) checkedRemoved |= m_checked.remove(id);
+    if (checkedRemoved) emit checkedChanged();
+}
+
+bool TaskHistoryModel::setStatus(int taskId, const QString &status)
+{
+    const int cacheRow = m_cache.rowOf(taskId);
+    if (cacheRow < 0) return false;
+
+    m_cache.setStatus(cacheRow, status);
+    const int row = rowOfRecord(cacheRow);
+    if (row >= 0) {
+        emit dataChanged(index(row, ColStatus), index(row, ColActions));
+    }
+    return true;
+}
+
+void TaskHistoryModel::setQuery(const TaskCache::Query &query)
+{
+    const bool hadChecked = !m_checked.isEmpty();
+
+    beginResetModel();
+    m_query = query;
+    m_checked.clear();
+    refilter();
+    endResetModel();
+
+    if (hadChecked) emit checkedChanged();
+}
+
+void TaskHistoryModel::setAllChecked(bool checked)
+{
+    if (checked) {
+        m_checked.reserve(m_visible.size());
+        for (int cacheRow : std::as_const(m_visible)) m_checked.insert(m_cache.id(cacheRow));
+    } else {
+        if (m_checked.isEmpty()) return;
+        m_checked.clear();
+    }
+
+    if (m_fetched > 0) {
+        emit dataChanged(index(0, ColCheck), index(m_fetched - 1, ColCheck), {Qt::CheckStateRole});
+    }
+    emit checkedChanged();
+}
+
+QList<int> TaskHistoryModel::checkedTaskIds() const
+{
+    // 缓存行号即显示顺序
+    QVector<int> rows;
+    rows.reserve(m_checked.size());
+    for (int id : m_checked) {
+        const int cacheRow = m_cache.rowOf(id);
+        if (cacheRow >= 0) rows.append(cacheRow);
+    }
+    std::sort(rows.begin(), rows.end());
+
+    QList<int> taskIds;
+    taskIds.reserve(rows.size());
+    for (int cacheRow : std::as_const(rows)) taskIds.append(m_cache.id(cacheRow));
+    return taskIds;
+}
+
+void TaskHistoryModel::refilter()
+{
+    m_visible = m_cache.match(m_query);
+    m_fetched = qMin(kFetchBatch, int(m_visible.size()));
+}
+
+int TaskHistoryModel::rowOfRecord(int cacheRow) const
+{
+    const auto it = std::lower_bound(m_visible.begin(), m_visible.begin() + m_fetched, cacheRow);
+    if (it == m_visible.begin() + m_fetched || *it != cacheRow) return -1;
+    return int(it - m_visible.begin());
+}
@@ -0,0 +1,119 @@
+#ifndef TASKHISTORYMODEL_H
+#define TASKHISTORYMODEL_H
+
+#include <QAbstractTableModel>
+#include <QSet>
+#include <QVector>
+#include "taskcache.h"
+
+/**
+ * @brief 任务配置页的任务列表模型
+ *
+ * 全部任务保存在列式缓存 TaskCache 中 (按任务ID倒序)，筛选结果只是行号数组，视图按需取数据：
+ *   - 复选框由模型的 CheckStateRole 提供，操作按钮由 TaskActionDelegate 绘制，不为每行创建控件；
+ *   - 筛选后先只暴露 kFetchBatch 行，滚动到底部时视图通过 fetchMore() 再取下一批；
+ *   - 勾选状态按任务ID保存，筛选条件变化时清空 (与重新生成表格时的行为一致)。
+ */
+class TaskHistoryModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    enum Column {
+        ColCheck = 0,
+        ColId,
+        ColStartTime,
+        ColOperator,
+        ColTube,
+        ColStatus,
+        ColStats,
+        ColActions,
+        ColumnCount
+    };
+
+    enum Role {
+        TaskIdRole = Qt::UserRole + 1,
+        StatusRole
+    };
+
+    static constexpr int kFetchBatch = 500;
+
+    explicit TaskHistoryModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool setData(const QModelIndex &index, const QVariant &value, int role = Qt::EditRole) override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    /**
+     * @brief 替换全部记录 (按显示顺序) 和筛选条件
+     */
+    void setRecords(const QVector<TaskRecord> &records, const TaskCache::Query &query);
+
+    /**
+     * @brief 在最前面插入新记录 (records 按显示顺序)
+     */
+    void prependRecords(const QVector<TaskRecord> &records);
+
+    /**
+     * @brief 按任务ID更新记录 (records 按显示顺序)
+     * 已有的任务逐行更新，按当前筛选条件可能显示或隐藏；
+     * @param insertMissing 为 true 时不存在的任务插入到最前面，否则忽略
+     */
+    void upsertRecords(const QVector<TaskRecord> &records, bool insertMissing);
+
+    /**
+     * @brief 移除指定任务 (已显示的行逐段发出 rowsRemoved，滚动位置不变)
+     */
+    void removeTasks(const QSet<int> &taskIds);
+
+    /**
+     * @brief 更新任务状态
+     * @return false 任务不存在
+     */
+    bool setStatus(int taskId, const QString &status);
+
+    /**
+     * @brief 设置筛选条件并重新筛选
+     */
+    void setQuery(const TaskCache::Query &query);
+
+    bool contains(int taskId) const { return m_cache.rowOf(taskId) >= 0; }
+    const TaskCache &cache() const { return m_cache; }
+
+    /**
+     * @brief 筛选后的任务数 (包括尚未 fetchMore 的行)
+     */
+    int matchedCount() const { return m_visible.size(); }
+
+    /**
+     * @brief 勾选/取消勾选全部筛选结果
+     */
+    void setAllChecked(bool checked);
+
+    bool hasChecked() const { return !m_checked.isEmpty(); }
+
+    /**
+     * @brief 勾选的任务ID (按显示顺序)
+     */
+    QList<int> checkedTaskIds() const;
+
+signals:
+    void checkedChanged();
+
+private:
+    void refilter();
+    int rowOfRecord(int cacheRow) const;
+    void updateRecord(int cacheRow, const TaskRecord &record);
+
+    TaskCache m_cache;
+    QVector<int> m_visible;         ///< 筛选结果 (m_cache 行号，递增)
+    int m_fetched = 0;              ///< 已暴露给视图的行数
+    TaskCache::Query m_query;
+    QSet<int> m_checked;
+};
+
+#endif // TASKHISTORYMODEL_H
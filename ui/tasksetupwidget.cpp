@@ -9,11 +9,11 @@
 #include <QDebug>
 #include <QSqlTableModel>
 #include <QMessageBox>
-#include <QCheckBox>
 #include <QComboBox>
 #include <QDateEdit>
 #include <QGroupBox>
 #include <QSplitter>
+#include <QTimer>
 
 TaskSetupWidget::TaskSetupWidget(QWidget *parent)
     : QGroupBox("任务配置管理", parent)
@@ -144,16 +144,26 @@ TaskSetupWidget::TaskSetupWidget(QWidget *parent)
     
     mainLayout->addWidget(filterGroup);
 
-    // 3. 任务列表
-    m_taskTable = new QTableWidget(this);
-    m_taskTable->setColumnCount(7);
-    m_taskTable->setHorizontalHeaderLabels({"选择", "任务ID", "创建时间", "操作员", "管道编号", "当前状态", "操作"});
+    // 3. 任务列表 (模型 + 委托，不为每行创建控件)
+    m_taskModel = new TaskHistoryModel(this);
+    m_actionDelegate = new TaskActionDelegate(this);
+    m_taskTable = new QTableView(this);
+    m_taskTable->setModel(m_taskModel);
+    m_taskTable->setItemDelegateForColumn(TaskHistoryModel::ColActions, m_actionDelegate);
+    // 固定行高和列宽模式，绘制代价与任务总数无关 (ResizeToContents 会逐行测量)
+    m_taskTable->verticalHeader()->setVisible(false);
+    m_taskTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    m_taskTable->verticalHeader()->setDefaultSectionSize(m_taskTable->fontMetrics().height() + 14);
     m_taskTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
-    m_taskTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::ResizeToContents); // 选择列
-    m_taskTable->horizontalHeader()->setSectionResizeMode(1, QHeaderView::ResizeToContents); // 任务ID列
-    m_taskTable->horizontalHeader()->setSectionResizeMode(5, QHeaderView::ResizeToContents); // 状态列
+    m_taskTable->horizontalHeader()->setSectionResizeMode(TaskHistoryModel::ColCheck, QHeaderView::Fixed);
+    m_taskTable->horizontalHeader()->setSectionResizeMode(TaskHistoryModel::ColId, QHeaderView::Fixed);
+    m_taskTable->horizontalHeader()->setSectionResizeMode(TaskHistoryModel::ColStatus, QHeaderView::Fixed);
+    m_taskTable->horizontalHeader()->resizeSection(TaskHistoryModel::ColCheck, 50);
+    m_taskTable->horizontalHeader()->resizeSection(TaskHistoryModel::ColId, 70);
+    m_taskTable->horizontalHeader()->resizeSection(TaskHistoryModel::ColStatus, 90);
     m_taskTable->setSelectionMode(QAbstractItemView::NoSelection);
     m_taskTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_taskTable->setWordWrap(false);
     
     mainLayout->addWidget(m_taskTable);
 
@@ -173,13 +183,31 @@ TaskSetupWidget::TaskSetupWidget(QWidget *parent)
     m_btnDeleteSelected->setMaximumWidth(80);
     m_btnDeleteSelected->setEnabled(false);
     
+    m_btnExecuteSelected = new QPushButton("批量执行", this);
+    m_btnExecuteSelected->setObjectName("btnAction");
+    m_btnExecuteSelected->setMaximumWidth(80);
+    m_btnExecuteSelected->setEnabled(false);
+    
+    m_btnImport = new QPushButton("导入工单", this);
+    m_btnImport->setObjectName("btnSecondary");
+    m_btnImport->setMaximumWidth(80);
+    m_btnImport->setToolTip("从 CSV/JSON 工单批量创建任务");
+    
     batchLayout->addWidget(m_btnSelectAll);
     batchLayout->addWidget(m_btnSelectNone);
     batchLayout->addWidget(m_btnDeleteSelected);
+    batchLayout->addWidget(m_btnExecuteSelected);
     batchLayout->addStretch();
+    batchLayout->addWidget(m_btnImport);
     
     mainLayout->addLayout(batchLayout);
 
+    // 筛选防抖
+    m_filterTimer = new QTimer(this);
+    m_filterTimer->setSingleShot(true);
+    m_filterTimer->setInterval(150);
+    connect(m_filterTimer, &QTimer::timeout, this, &TaskSetupWidget::applyFilters);
+
     // 信号连接
     connect(m_editOperator, &QLineEdit::textChanged, this, &TaskSetupWidget::checkInput);
     connect(m_editTubeId, &QLineEdit::textChanged, this, &TaskSetupWidget::checkInput);
@@ -194,6 +222,10 @@ TaskSetupWidget::TaskSetupWidget(QWidget *parent)
     connect(m_btnSelectAll, &QPushButton::clicked, this, &TaskSetupWidget::selectAllTasks);
     connect(m_btnSelectNone, &QPushButton::clicked, this, &TaskSetupWidget::selectNoneTasks);
     connect(m_btnDeleteSelected, &QPushButton::clicked, this, &TaskSetupWidget::deleteSelectedTasks);
+    connect(m_btnExecuteSelected, &QPushButton::clicked, this, &TaskSetupWidget::executeSelectedTasks);
+    connect(m_btnImport, &QPushButton::clicked, this, &TaskSetupWidget::importTasksClicked);
+    connect(m_taskModel, &TaskHistoryModel::checkedChanged, this, &TaskSetupWidget::onCheckboxStateChanged);
+    connect(m_actionDelegate, &TaskActionDelegate::actionTriggered, this, &TaskSetupWidget::onTaskAction);
     
     // 搜索和筛选信号连接
     connect(m_searchEdit, &QLineEdit::textChanged, this, &TaskSetupWidget::onSearchTextChanged);
@@ -217,51 +249,39 @@ QString TaskSetupWidget::tubeId() const
     return m_editTubeId->text().trimmed();
 }
 
+
 void TaskSetupWidget::loadHistory(QSqlTableModel *model)
 {
     if (!model) return;
 
     m_model = model;
     model->select();
+    // QSqlTableModel 同样按需取数，这里需要全部任务
+    while (model->canFetchMore()) model->fetchMore();
 
-    // 存储所有数据用于筛选
-    m_allTaskData.clear();
-    
     // 收集所有操作员和状态用于筛选下拉框
     QSet<QString> operators;
     QSet<QString> statuses;
-    
-    const int idCol = model->fieldIndex("id");
-    const int timeCol = model->fieldIndex("start_time");
-    const int opCol = model->fieldIndex("operator_name");
-    const int tubeCol = model->fieldIndex("tube_id");
-    const int statusCol = model->fieldIndex("status");
+
     const int rows = model->rowCount();
+    QVector<TaskRecord> records;
+    records.reserve(rows);
     
     for (int r = 0; r < rows; ++r) {
-        QList<QVariant> rowData;
-        const int taskId = model->data(model->index(r, idCol)).toInt();
-        const QDateTime startTime = model->data(model->index(r, timeCol)).toDateTime();
-        const QString opName = model->data(model->index(r, opCol)).toString();
-        const QString tube = model->data(model->index(r, tubeCol)).toString();
-        QString status = "stop";
-        if (statusCol != -1) {
-            status = model->data(model->index(r, statusCol)).toString();
-        } else if (taskId == m_activeTaskId) {
-            status = "create";
+        TaskRecord record = toTaskRecord(model->record(r));
+        if (!record.operatorName.isEmpty()) {
+            operators.insert(record.operatorName);
         }
-        
-        rowData << taskId << startTime << opName << tube << status;
-        m_allTaskData.append(rowData);
-        
-        if (!opName.isEmpty()) {
-            operators.insert(opName);
-        }
-        if (!status.isEmpty()) {
-            statuses.insert(status);
+        if (!record.status.isEmpty()) {
+            statuses.insert(record.status);
         }
+        records.append(std::move(record));
     }
     
+    // 更新下拉框时不触发逐项筛选，最后统一筛选一次
+    const QSignalBlocker blockOperator(m_filterOperator);
+    const QSignalBlocker blockStatus(m_filterStatus);
+
     // 更新操作员筛选下拉框
     QString currentOperator = m_filterOperator->currentText();
     m_filterOperator->clear();
@@ -288,168 +308,139 @@ void TaskSetupWidget::loadHistory(QSqlTableModel *model)
         m_filterStatus->setCurrentIndex(index);
     }
     
-    // 应用当前筛选条件
-    populateFilteredTable();
+    // 替换记录的同时应用当前筛选条件 (只筛选一次)
+    m_filterTimer->stop();
+    m_taskModel->setRecords(records, currentQuery());
 }
 
-void TaskSetupWidget::populateFilteredTable()
+TaskRecord TaskSetupWidget::toTaskRecord(const QSqlRecord &row) const
 {
-    m_taskTable->setRowCount(0);
-    
-    for (int i = 0; i < m_allTaskData.size(); ++i) {
-        if (matchesFilters(i)) {
-            const QList<QVariant> &rowData = m_allTaskData[i];
-            const int taskId = rowData[0].toInt();
-            const QDateTime startTime = rowData[1].toDateTime();
-            const QString opName = rowData[2].toString();
-            const QString tube = rowData[3].toString();
-            const QString status = rowData[4].toString();
-            
-            const int row = m_taskTable->rowCount();
-            m_taskTable->insertRow(row);
-
-            // 第0列：复选框
-            QCheckBox *checkbox = new QCheckBox();
-            checkbox->setProperty("taskId", taskId);
-            connect(checkbox, &QCheckBox::checkStateChanged, this, &TaskSetupWidget::onCheckboxStateChanged);
-            m_taskTable->setCellWidget(row, 0, checkbox);
-
-            // 其他列数据
-            m_taskTable->setItem(row, 1, new QTableWidgetItem(QString::number(taskId)));
-            m_taskTable->setItem(row, 2, new QTableWidgetItem(startTime.isValid() ? startTime.toString("yyyy-MM-dd HH:mm:ss") : "-"));
-            m_taskTable->setItem(row, 3, new QTableWidgetItem(opName.isEmpty() ? "-" : opName));
-            m_taskTable->setItem(row, 4, new QTableWidgetItem(tube.isEmpty() ? "-" : tube));
-            m_taskTable->setItem(row, 5, new QTableWidgetItem(status));
-
-            // 操作按钮
-            QWidget *btnWidget = new QWidget();
-            QHBoxLayout *layout = new QHBoxLayout(btnWidget);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(5);
-
-            QPushButton *btnConfig = new QPushButton("配置");
-            QPushButton *btnExecute = new QPushButton("执行");
-            QPushButton *btnResult = new QPushButton("结果");
-            QPushButton *btnDelete = new QPushButton("删除");
-
-            btnConfig->setObjectName("btnConfig");
-            btnExecute->setObjectName("btnExecute");
-            btnResult->setObjectName("btnResult");
-            btnDelete->setObjectName("btnDelete");
-
-            btnConfig->setProperty("taskId", taskId);
-            btnExecute->setProperty("taskId", taskId);
-            btnResult->setProperty("taskId", taskId);
-            btnDelete->setProperty("taskId", taskId);
-
-            connect(btnConfig, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            connect(btnExecute, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            connect(btnResult, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            connect(btnDelete, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-
-            layout->addWidget(btnConfig);
-            layout->addWidget(btnExecute);
-            layout->addWidget(btnResult);
-            layout->addWidget(btnDelete);
-            m_taskTable->setCellWidget(row, 6, btnWidget);
-        }
+    TaskRecord record;
+    record.id = row.value("id").toInt();
+    record.startTime = row.value("start_time").toDateTime();
+    record.operatorName = row.value("operator_name").toString();
+    record.tubeId = row.value("tube_id").toString();
+    record.status = "stop";
+    if (row.indexOf("status") != -1) {
+        record.status = row.value("status").toString();
+    } else if (record.id == m_activeTaskId) {
+        record.status = "create";
     }
 
-    updateTaskState(m_activeTaskId);
+    // 扫描统计 (TaskListView 才有这些列)
+    if (row.indexOf("sample_count") != -1 && !row.isNull("sample_count")) {
+        auto value = [&](const char *name) { return row.value(name).toDouble(); };
+        record.statsText = QString("%1 s | %2 mm | %3 mm/s | 换向 %4 | 故障 %5")
+                               .arg(value("duration_s"), 0, 'f', 1)
+                               .arg(value("distance_mm"), 0, 'f', 0)
+                               .arg(value("max_speed"), 0, 'f', 1)
+                               .arg(int(value("reversals")))
+                               .arg(int(value("faults")));
+        record.statsTip = QString("采样数: %1\n时长: %2 s\n行程: %3 mm\n最大速度: %4 mm/s\n"
+                                  "平均速度: %5 ± %6 mm/s\n换向: %7 次\n故障: %8 次")
+                              .arg(qint64(value("sample_count")))
+                              .arg(value("duration_s"), 0, 'f', 1)
+                              .arg(value("distance_mm"), 0, 'f', 1)
+                              .arg(value("max_speed"), 0, 'f', 1)
+                              .arg(value("mean_speed"), 0, 'f', 1)
+                              .arg(value("speed_std"), 0, 'f', 2)
+                              .arg(int(value("reversals")))
+                              .arg(int(value("faults")));
+    }
+    return record;
 }
 
-bool TaskSetupWidget::matchesFilters(int row) const
+void TaskSetupWidget::applyTaskRows(const QVector<QSqlRecord> &rows, bool insertMissing)
 {
-    if (row < 0 || row >= m_allTaskData.size()) return false;
-    
-    const QList<QVariant> &rowData = m_allTaskData[row];
-    const int taskId = rowData[0].toInt();
-    const QDateTime startTime = rowData[1].toDateTime();
-    const QString opName = rowData[2].toString();
-    const QString tube = rowData[3].toString();
-    const QString status = rowData[4].toString();
-    
-    // 快速搜索（始终生效）
-    QString searchText = m_searchEdit->text().trimmed().toLower();
-    if (!searchText.isEmpty()) {
-        QString searchContent = QString("%1 %2 %3 %4")
-            .arg(taskId)
-            .arg(opName)
-            .arg(tube)
-            .arg(status).toLower();
-        if (!searchContent.contains(searchText)) {
-            return false;
-        }
+    if (rows.isEmpty()) return;
+
+    QVector<TaskRecord> records;
+    records.reserve(rows.size());
+    for (const QSqlRecord &row : rows) {
+        records.append(toTaskRecord(row));
+        addFilterChoices(records.last().operatorName, records.last().status);
     }
-    
-    // 高级筛选（只在展开时生效）
-    if (m_btnAdvancedFilter->isChecked()) {
-        // 任务ID筛选
-        QString filterTaskId = m_filterTaskId->text().trimmed();
-        if (!filterTaskId.isEmpty()) {
-            if (QString::number(taskId) != filterTaskId) {
-                return false;
-            }
-        }
-        
-        // 时间范围筛选
-        QDate startDate = m_filterStartDate->date();
-        QDate endDate = m_filterEndDate->date();
-        if (startTime.isValid()) {
-            QDate taskDate = startTime.date();
-            if (taskDate < startDate || taskDate > endDate) {
-                return false;
-            }
-        }
-        
-        // 操作员筛选
-        QString filterOperator = m_filterOperator->currentText();
-        if (filterOperator != "全部操作员" && !filterOperator.isEmpty()) {
-            if (opName != filterOperator) {
-                return false;
-            }
-        }
-        
-        // 管道编号筛选
-        QString filterTube = m_filterTubeId->text().trimmed().toLower();
-        if (!filterTube.isEmpty()) {
-            if (!tube.toLower().contains(filterTube)) {
-                return false;
-            }
-        }
-        
-        // 状态筛选
-        QString filterStatus = m_filterStatus->currentText();
-        if (filterStatus != "全部状态" && !filterStatus.isEmpty()) {
-            if (status != filterStatus) {
-                return false;
-            }
-        }
+    m_taskModel->upsertRecords(records, insertMissing);
+    onCheckboxStateChanged();
+}
+
+void TaskSetupWidget::removeTasks(const QList<int> &taskIds)
+{
+    if (taskIds.isEmpty()) return;
+    const QSet<int> removed(taskIds.begin(), taskIds.end());
+
+    m_taskModel->removeTasks(removed);
+
+    if (removed.contains(m_activeTaskId)) {
+        m_activeTaskId = -1;
     }
-    
-    return true;
+    onCheckboxStateChanged();
+}
+
+void TaskSetupWidget::addFilterChoices(const QString &opName, const QString &status)
+{
+    const QSignalBlocker blockOperator(m_filterOperator);
+    const QSignalBlocker blockStatus(m_filterStatus);
+    if (!opName.isEmpty() && m_filterOperator->findText(opName) < 0) {
+        m_filterOperator->addItem(opName);
+    }
+    if (!status.isEmpty() && m_filterStatus->findText(status) < 0) {
+        m_filterStatus->addItem(status);
+    }
+}
+
+void TaskSetupWidget::applyFilters()
+{
+    m_filterTimer->stop();
+    m_taskModel->setQuery(currentQuery());
+}
+
+TaskCache::Query TaskSetupWidget::currentQuery() const
+{
+    TaskCache::Query query;
+    query.text = m_searchEdit->text();
+    query.advanced = m_btnAdvancedFilter->isChecked();
+    if (query.advanced) {
+        query.taskId = m_filterTaskId->text();
+        query.from = m_filterStartDate->date();
+        query.to = m_filterEndDate->date();
+        query.operatorName = m_filterOperator->currentText();
+        if (query.operatorName == "全部操作员") query.operatorName.clear();
+        query.tube = m_filterTubeId->text();
+        query.status = m_filterStatus->currentText();
+        if (query.status == "全部状态") query.status.clear();
+    }
+    return query;
 }
 
 void TaskSetupWidget::onSearchTextChanged()
 {
-    populateFilteredTable();
+    // 连续输入时只在停顿后筛选一次
+    m_filterTimer->start();
 }
 
 void TaskSetupWidget::onFilterChanged()
 {
-    populateFilteredTable();
+    m_filterTimer->start();
 }
 
 void TaskSetupWidget::onResetFilters()
 {
-    m_searchEdit->clear();
-    m_filterTaskId->clear();
-    m_filterStartDate->setDate(QDate::currentDate().addDays(-30));
-    m_filterEndDate->setDate(QDate::currentDate());
-    m_filterOperator->setCurrentIndex(0);
-    m_filterTubeId->clear();
-    m_filterStatus->setCurrentIndex(0);
-    populateFilteredTable();
+    {
+        const QSignalBlocker blockers[] = {
+            QSignalBlocker(m_searchEdit), QSignalBlocker(m_filterTaskId), QSignalBlocker(m_filterStartDate),
+            QSignalBlocker(m_filterEndDate), QSignalBlocker(m_filterOperator), QSignalBlocker(m_filterTubeId),
+            QSignalBlocker(m_filterStatus)
+        };
+        m_searchEdit->clear();
+        m_filterTaskId->clear();
+        m_filterStartDate->setDate(QDate::currentDate().addDays(-30));
+        m_filterEndDate->setDate(QDate::currentDate());
+        m_filterOperator->setCurrentIndex(0);
+        m_filterTubeId->clear();
+        m_filterStatus->setCurrentIndex(0);
+    }
+    applyFilters();
 }
 
 void TaskSetupWidget::onAdvancedFilterToggled()
@@ -463,13 +454,17 @@ void TaskSetupWidget::onAdvancedFilterToggled()
     } else {
         m_btnAdvancedFilter->setText("高级筛选");
         // 收起时清空高级筛选条件，只保留快速搜索
+        const QSignalBlocker blockers[] = {
+            QSignalBlocker(m_filterTaskId), QSignalBlocker(m_filterStartDate), QSignalBlocker(m_filterEndDate),
+            QSignalBlocker(m_filterOperator), QSignalBlocker(m_filterTubeId), QSignalBlocker(m_filterStatus)
+        };
         m_filterTaskId->clear();
         m_filterStartDate->setDate(QDate::currentDate().addDays(-30));
         m_filterEndDate->setDate(QDate::currentDate());
         m_filterOperator->setCurrentIndex(0);
         m_filterTubeId->clear();
         m_filterStatus->setCurrentIndex(0);
-        populateFilteredTable();
+        applyFilters();
     }
 }
 
@@ -478,156 +473,23 @@ void TaskSetupWidget::updateTaskState(int taskId, const QString& opName, const Q
     m_activeTaskId = taskId;
     
     // 如果有新任务ID且列表中没有，则添加一行
-    if (taskId != -1) {
-        // 检查列表中是否已存在
-        bool exists = false;
-        for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-            if (m_taskTable->item(i, 1)->text().toInt() == taskId) { // 任务ID现在在第1列
-                exists = true;
-                break;
-            }
-        }
-        
-        if (!exists) {
-            int row = m_taskTable->rowCount();
-            m_taskTable->insertRow(row);
-            
-            // 第0列：复选框
-            QCheckBox *checkbox = new QCheckBox();
-            checkbox->setProperty("taskId", taskId);
-            connect(checkbox, &QCheckBox::checkStateChanged, this, &TaskSetupWidget::onCheckboxStateChanged);
-            m_taskTable->setCellWidget(row, 0, checkbox);
-            
-            // 其他列数据（索引+1）
-            m_taskTable->setItem(row, 1, new QTableWidgetItem(QString::number(taskId)));
-            m_taskTable->setItem(row, 2, new QTableWidgetItem(QDateTime::currentDateTime().toString("HH:mm:ss")));
-            // 使用传入的参数填充，或者用"-"占位（如果未提供）
-            m_taskTable->setItem(row, 3, new QTableWidgetItem(opName.isEmpty() ? "-" : opName)); 
-            m_taskTable->setItem(row, 4, new QTableWidgetItem(tubeId.isEmpty() ? "-" : tubeId));
-            m_taskTable->setItem(row, 5, new QTableWidgetItem("create"));
-            
-            // 操作按钮
-            QWidget *btnWidget = new QWidget();
-            QHBoxLayout *layout = new QHBoxLayout(btnWidget);
-            layout->setContentsMargins(5, 2, 5, 2);
-            layout->setSpacing(5);
-            
-            QPushButton *btnConfig = new QPushButton("配置");
-            QPushButton *btnExecute = new QPushButton("执行");
-            QPushButton *btnResult = new QPushButton("结果");
-            QPushButton *btnDelete = new QPushButton("删除");
-
-            btnConfig->setObjectName("btnConfig");
-            btnExecute->setObjectName("btnExecute");
-            btnResult->setObjectName("btnResult");
-            btnDelete->setObjectName("btnDelete");
-            
-            // 存入 ID
-            btnConfig->setProperty("taskId", taskId);
-            btnExecute->setProperty("taskId", taskId);
-            btnResult->setProperty("taskId", taskId);
-            btnDelete->setProperty("taskId", taskId);
-            
-            connect(btnConfig, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            connect(btnExecute, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            connect(btnResult, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            connect(btnDelete, &QPushButton::clicked, this, &TaskSetupWidget::onTableBtnClicked);
-            
-            layout->addWidget(btnConfig);
-            layout->addWidget(btnExecute);
-            layout->addWidget(btnResult);
-            layout->addWidget(btnDelete);
-            m_taskTable->setCellWidget(row, 6, btnWidget); // 操作列现在是第6列
-        }
-    }
-    
-    // 刷新所有按钮状态
-    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-        QWidget *w = m_taskTable->cellWidget(i, 6); // 操作列现在是第6列
-        if (!w) continue;
-        
-        QPushButton *btnConfig = w->findChild<QPushButton*>("btnConfig");
-        QPushButton *btnExecute = w->findChild<QPushButton*>("btnExecute");
-        QPushButton *btnResult = w->findChild<QPushButton*>("btnResult");
-        QPushButton *btnDelete = w->findChild<QPushButton*>("btnDelete");
-        if (!btnDelete) continue;
-        
-        int rowTaskId = m_taskTable->item(i, 1)->text().toInt(); // 任务ID现在在第1列
-        QString status = m_taskTable->item(i, 5)->text(); // 状态现在在第5列
-
-        // 根据状态控制按钮可见性
-        if (status == "create") {
-            if (btnConfig) btnConfig->setEnabled(true);
-            if (btnExecute) {
-                btnExecute->setEnabled(false);
-                btnExecute->setText("执行");
-            }
-            if (btnResult) btnResult->setEnabled(false);
-            btnDelete->setEnabled(true);
-        } else if (status == "configured") {
-            if (btnConfig) btnConfig->setEnabled(true);
-            if (btnExecute) {
-                btnExecute->setEnabled(true);
-                btnExecute->setText("执行");
-            }
-            if (btnResult) btnResult->setEnabled(false);
-            btnDelete->setEnabled(true);
-        } else if (status == "running") {
-            if (btnConfig) btnConfig->setEnabled(false);
-            if (btnExecute) {
-                btnExecute->setEnabled(true);
-                btnExecute->setText("停止");
-            }
-            if (btnResult) btnResult->setEnabled(false);
-            btnDelete->setEnabled(false);
-        } else if (status == "completed") {
-            if (btnConfig) btnConfig->setEnabled(false);
-            if (btnExecute) {
-                btnExecute->setEnabled(false);
-                btnExecute->setText("执行");
-            }
-            if (btnResult) btnResult->setEnabled(true);
-            btnDelete->setEnabled(true);
-        } else if (status == "failed") {
-            if (btnConfig) btnConfig->setEnabled(true);  // 失败后可以重新配置
-            if (btnExecute) {
-                btnExecute->setEnabled(true); // 失败后可以重新执行
-                btnExecute->setText("执行");
-            }
-            if (btnResult) btnResult->setEnabled(true);   // 可以查看失败原因
-            btnDelete->setEnabled(true);
-        } else if (status == "stopped") {
-            if (btnConfig) btnConfig->setEnabled(true);  // 停止后可以重新配置
-            if (btnExecute) {
-                btnExecute->setEnabled(true); // 停止后可以重新执行
-                btnExecute->setText("执行");
-            }
-            if (btnResult) btnResult->setEnabled(true);   // 可以查看停止原因
-            btnDelete->setEnabled(true);
-        } else {
-            // 其他状态（如stop等）
-            if (btnConfig) btnConfig->setEnabled(false);
-            if (btnExecute) {
-                btnExecute->setEnabled(false);
-                btnExecute->setText("执行");
-            }
-            if (btnResult) btnResult->setEnabled(false);
-            btnDelete->setEnabled(true);
-        }
+    if (taskId != -1 && !m_taskModel->contains(taskId)) {
+        TaskRecord record;
+        record.id = taskId;
+        record.startTime = QDateTime::currentDateTime();
+        record.operatorName = opName;
+        record.tubeId = tubeId;
+        record.status = "create";
+        m_taskModel->prependRecords({record});
     }
+    // 按钮状态由委托按任务状态绘制，无需逐行刷新
 }
 
 void TaskSetupWidget::updateTaskStatusInTable(int taskId, const QString& status)
 {
-    // 在表格中找到对应的任务并更新状态
-    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-        if (m_taskTable->item(i, 1)->text().toInt() == taskId) { // 任务ID现在在第1列
-            m_taskTable->item(i, 5)->setText(status); // 状态现在在第5列
-            break;
-        }
+    if (m_taskModel->setStatus(taskId, status)) {
+        addFilterChoices(QString(), status);
     }
-    // 更新按钮状态
-    updateTaskState(m_activeTaskId);
 }
 
 void TaskSetupWidget::checkInput()
@@ -637,60 +499,59 @@ void TaskSetupWidget::checkInput()
     m_btnCreate->setEnabled(valid);
 }
 
-void TaskSetupWidget::onTableBtnClicked()
+void TaskSetupWidget::onTaskAction(int taskId, TaskActionDelegate::Action action)
 {
-    QPushButton *btn = qobject_cast<QPushButton*>(sender());
-    if (!btn) return;
-    
-    int taskId = btn->property("taskId").toInt();
-    QString text = btn->text();
-    
-    if (text == "配置") {
+    switch (action) {
+    case TaskActionDelegate::Config:
         emit configTaskClicked(taskId);
-    } else if (text == "执行") {
+        break;
+    case TaskActionDelegate::Execute:
         // 不在这里更新状态，让MainWindow在设备连接检查通过后再更新
         emit executeTaskClicked(taskId);
-    } else if (text == "停止") {
+        break;
+    case TaskActionDelegate::Stop:
         emit stopTaskClicked(taskId);
-    } else if (text == "结果") {
+        break;
+    case TaskActionDelegate::Result:
         emit viewResultClicked(taskId);
-    } else if (text == "删除") {
+        break;
+    case TaskActionDelegate::Delete:
         emit deleteTaskClicked(taskId);
+        break;
+    default:
+        break;
     }
-    updateTaskState(m_activeTaskId);
 }
+
 void TaskSetupWidget::selectAllTasks()
 {
-    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-        QCheckBox *checkbox = qobject_cast<QCheckBox*>(m_taskTable->cellWidget(i, 0));
-        if (checkbox) {
-            checkbox->setChecked(true);
-        }
-    }
+    m_taskModel->setAllChecked(true);
 }
 
 void TaskSetupWidget::selectNoneTasks()
 {
-    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-        QCheckBox *checkbox = qobject_cast<QCheckBox*>(m_taskTable->cellWidget(i, 0));
-        if (checkbox) {
-            checkbox->setChecked(false);
-        }
+    m_taskModel->setAllChecked(false);
+}
+
+QList<int> TaskSetupWidget::selectedTaskIds() const
+{
+    // 按列表顺序返回选中的任务ID
+    return m_taskModel->checkedTaskIds();
+}
+
+void TaskSetupWidget::executeSelectedTasks()
+{
+    const QList<int> taskIds = selectedTaskIds();
+    if (taskIds.isEmpty()) {
+        QMessageBox::information(this, "提示", "请先选择要执行的任务");
+        return;
     }
+    emit batchExecuteTasksClicked(taskIds);
 }
 
 void TaskSetupWidget::deleteSelectedTasks()
 {
-    QList<int> selectedTaskIds;
-    
-    // 收集选中的任务ID
-    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-        QCheckBox *checkbox = qobject_cast<QCheckBox*>(m_taskTable->cellWidget(i, 0));
-        if (checkbox && checkbox->isChecked()) {
-            int taskId = checkbox->property("taskId").toInt();
-            selectedTaskIds.append(taskId);
-        }
-    }
+    const QList<int> selectedTaskIds = this->selectedTaskIds();
     
     if (selectedTaskIds.isEmpty()) {
         QMessageBox::information(this, "提示", "请先选择要删除的任务");
@@ -713,15 +574,8 @@ void TaskSetupWidget::deleteSelectedTasks()
 
 void TaskSetupWidget::onCheckboxStateChanged()
 {
-    // 检查是否有选中的任务，控制删除按钮状态
-    bool hasSelected = false;
-    for (int i = 0; i < m_taskTable->rowCount(); ++i) {
-        QCheckBox *checkbox = qobject_cast<QCheckBox*>(m_taskTable->cellWidget(i, 0));
-        if (checkbox && checkbox->isChecked()) {
-            hasSelected = true;
-            break;
-        }
-    }
-    
+    // 检查是否有选中的任务，控制批量按钮状态
+    const bool hasSelected = m_taskModel->hasChecked();
     m_btnDeleteSelected->setEnabled(hasSelected);
-}
\ No newline at end of file
+    m_btnExecuteSelected->setEnabled(hasSelected);
+}
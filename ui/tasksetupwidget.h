@@ -6,11 +6,15 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
-#include <QTableWidget>
+#include <QTableView>
 #include <QComboBox>
 #include <QDateEdit>
+#include <QSqlRecord>
+#include "taskhistorymodel.h"
+#include "taskactiondelegate.h"
 
 class QSqlTableModel;
+class QTimer;
 
 /**
  * @brief 任务配置页面
@@ -40,6 +44,18 @@ public:
     
     void loadHistory(QSqlTableModel *model);
 
+    /**
+     * @brief 按 TaskListView 行增量更新列表 (收到 DataManager::taskChanged 后调用)
+     * @param rows 按任务ID倒序
+     * @param insertMissing 列表中没有的任务是否插入到最前面 (新建的任务)
+     */
+    void applyTaskRows(const QVector<QSqlRecord> &rows, bool insertMissing);
+
+    /**
+     * @brief 增量移除已删除的任务 (不重新查询数据库)
+     */
+    void removeTasks(const QList<int> &taskIds);
+
     QString operatorName() const;
     QString tubeId() const;
 
@@ -51,13 +67,16 @@ signals:
     void viewResultClicked(int taskId);
     void deleteTaskClicked(int taskId);
     void batchDeleteTasksClicked(const QList<int> &taskIds);
+    void batchExecuteTasksClicked(const QList<int> &taskIds);
+    void importTasksClicked();
 
 private slots:
     void checkInput();
-    void onTableBtnClicked();
+    void onTaskAction(int taskId, TaskActionDelegate::Action action);
     void selectAllTasks();
     void selectNoneTasks();
     void deleteSelectedTasks();
+    void executeSelectedTasks();
     void onCheckboxStateChanged();
     
     // 新增：高级筛选相关槽函数
@@ -68,8 +87,10 @@ private slots:
 
 private:
     void applyFilters();
-    void populateFilteredTable();
-    bool matchesFilters(int row) const;
+    TaskCache::Query currentQuery() const;
+    TaskRecord toTaskRecord(const QSqlRecord &row) const;
+    void addFilterChoices(const QString &opName, const QString &status);
+    QList<int> selectedTaskIds() const;
 
 private:
     QLineEdit *m_editOperator;
@@ -89,19 +110,23 @@ private:
     QPushButton *m_btnResetFilters;
     
     // 任务列表相关
-    QTableWidget *m_taskTable;
+    QTableView *m_taskTable;
+    TaskHistoryModel *m_taskModel;
+    TaskActionDelegate *m_actionDelegate;
+    QTimer *m_filterTimer;
     
     // 批量操作按钮
     QPushButton *m_btnSelectAll;
     QPushButton *m_btnSelectNone;
     QPushButton *m_btnDeleteSelected;
+    QPushButton *m_btnExecuteSelected;
+    QPushButton *m_btnImport;
     
     // 当前活跃任务ID
     int m_activeTaskId = -1;
     
     // 数据存储
     QSqlTableModel *m_model = nullptr;
-    QList<QList<QVariant>> m_allTaskData; // 存储所有任务数据用于筛选
 };
 
 #endif // TASKSETUPWIDGET_H
@@ -0,0 +1,96 @@
+#include "telemetryhistory.h"
+#include "../core/configmanager.h"
+#include "../utils/logger.h"
+#include <QDateTime>
+
+// 反馈帧率上限 (Hz)，决定环形缓冲的容量
+static const int kMaxFeedbackRateHz = 1000;
+
+// GUI 线程每秒用于遥测显示的时间超过该值时告警
+static const double kUiBusyWarnMs = 100.0;
+
+TelemetryHistory::TelemetryHistory(QObject *parent)
+    : QObject(parent)
+{
+    // 曲线时间窗口可配置，缓冲按最高反馈频率一次性分配
+    m_windowSec = ConfigManager::instance().chartWindowSec();
+    m_buffer.setCapacity(int(m_windowSec * kMaxFeedbackRateHz) + 1);
+    m_loadTimer.start();
+}
+
+void TelemetryHistory::append(const MotionFeedback &fb)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_latest = fb;
+    m_connected = true;
+
+    bool isMoving = (fb.status != DeviceStatus::Idle && fb.status != DeviceStatus::Unknown);
+
+    if (isMoving) {
+        if (!m_isRecording) {
+            // 刚开始运动：重置曲线和 Y 轴范围
+            m_isRecording = true;
+            m_startTime = QDateTime::currentMSecsSinceEpoch();
+            m_buffer.clear();
+            m_posMax = 100.0;
+            m_speedMin = -10.0;
+            m_speedMax = 10.0;
+        }
+
+        double t = (QDateTime::currentMSecsSinceEpoch() - m_startTime) / 1000.0;
+        m_buffer.append(t, fb.position_mm, fb.speed_mm_s);
+
+        // 自动调整 Y 轴范围
+        if (fb.position_mm > m_posMax) m_posMax = fb.position_mm * 1.1;
+        if (fb.speed_mm_s > m_speedMax) m_speedMax = fb.speed_mm_s * 1.2;
+        if (fb.speed_mm_s < m_speedMin) m_speedMin = fb.speed_mm_s * 1.2;
+    } else if (m_isRecording) {
+        // 设备停止或空闲：记录停止瞬间的状态，然后停止记录
+        double t = (QDateTime::currentMSecsSinceEpoch() - m_startTime) / 1000.0;
+        m_buffer.append(t, fb.position_mm, fb.speed_mm_s);
+        m_isRecording = false;
+    }
+
+    // 视图在这里只启动显示帧定时器
+    emit updated();
+
+    ++m_loadCurrent.frames;
+    addLoad(timer.nsecsElapsed() / 1e6);
+}
+
+void TelemetryHistory::setDisconnected()
+{
+    m_connected = false;
+    m_isRecording = false;
+    m_latest = MotionFeedback();
+    emit updated();
+}
+
+void TelemetryHistory::addRenderTime(double ms)
+{
+    ++m_loadCurrent.repaints;
+    addLoad(ms);
+}
+
+void TelemetryHistory::addLoad(double ms)
+{
+    m_loadCurrent.busyMs += ms;
+    m_loadCurrent.maxMs = qMax(m_loadCurrent.maxMs, ms);
+
+    const qint64 elapsed = m_loadTimer.elapsed();
+    if (elapsed < 1000) return;
+
+    // 换算为每秒
+    const double scale = 1000.0 / elapsed;
+    m_uiLoad = m_loadCurrent;
+    m_uiLoad.busyMs *= scale;
+    m_loadCurrent = UiLoad();
+    m_loadTimer.restart();
+
+    if (m_uiLoad.busyMs > kUiBusyWarnMs) {
+        LOG_WARN << "遥测显示占用 GUI 线程 " << m_uiLoad.busyMs << " ms/秒: " << m_uiLoad.frames << " 帧, "
+                 << m_uiLoad.repaints << " 次刷新, 单次最长 " << m_uiLoad.maxMs << " ms";
+    }
+}
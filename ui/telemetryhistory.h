@@ -0,0 +1,81 @@
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include "../communication/protocol.h"
+#include "chartringbuffer.h"
+
+/**
+ * @brief 实时遥测数据 (各页面的状态监控共享一份)
+ *
+ * 每个反馈帧只在这里写入一次：最新一帧、连接状态、曲线环形缓冲和 Y 轴范围。
+ * StatusWidget 只是它的视图：可见时绘制，隐藏页面上的视图不做任何工作，显示时一次追上。
+ * 同时统计 GUI 线程每秒花在遥测显示上的时间 (写入 + 视图刷新)。
+ */
+class TelemetryHistory : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief GUI 线程的遥测显示负载 (最近一个完整的统计周期，约 1 秒)
+     */
+    struct UiLoad {
+        int frames = 0;         ///< 写入的反馈帧数
+        int repaints = 0;       ///< 视图刷新次数
+        double busyMs = 0.0;    ///< 写入和刷新的总耗时 (换算为每秒)
+        double maxMs = 0.0;     ///< 单次最长耗时
+    };
+
+    explicit TelemetryHistory(QObject *parent = nullptr);
+
+    /**
+     * @brief 写入一帧反馈 (开始运动时清空曲线，运动中追加，停止时记录最后一点)
+     */
+    void append(const MotionFeedback &fb);
+
+    void setDisconnected();
+
+    bool isConnected() const { return m_connected; }
+    const MotionFeedback &latest() const { return m_latest; }
+
+    const ChartRingBuffer &buffer() const { return m_buffer; }
+    double windowSec() const { return m_windowSec; }
+
+    // Y 轴范围 (本次运动中只增不减)
+    double posMax() const { return m_posMax; }
+    double speedMin() const { return m_speedMin; }
+    double speedMax() const { return m_speedMax; }
+
+    /**
+     * @brief 视图刷新一次的耗时，计入 GUI 线程负载
+     */
+    void addRenderTime(double ms);
+
+    UiLoad uiLoad() const { return m_uiLoad; }
+
+signals:
+    /**
+     * @brief 数据变化 (每帧一次，视图自行决定何时绘制)
+     */
+    void updated();
+
+private:
+    ChartRingBuffer m_buffer;
+    double m_windowSec = 10.0;          ///< 曲线时间窗口 (s)
+    MotionFeedback m_latest;
+    bool m_connected = false;
+    bool m_isRecording = false;
+    qint64 m_startTime = 0;
+    double m_posMax = 100.0;
+    double m_speedMin = -10.0;
+    double m_speedMax = 10.0;
+
+    void addLoad(double ms);
+
+    UiLoad m_loadCurrent;               ///< 当前统计周期
+    UiLoad m_uiLoad;                    ///< 最近一个完整周期
+    QElapsedTimer m_loadTimer;
+};
+
+#endif // TELEMETRYHISTORY_H
@@ -0,0 +1,80 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QtGlobal>
+#include <QVector>
+#include <atomic>
+
+/**
+ * @brief 单生产者/单消费者无锁环形队列
+ *
+ * 一个线程只调用 tryPush()，另一个线程只调用 tryPop()，两端都不加锁、不阻塞。
+ * 容量向上取整为 2 的幂，实际可用容量为 capacity - 1。
+ * 队列满时 tryPush() 返回 false，由调用方决定丢弃或重试。
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(int capacity = 4096)
+    {
+        int size = 2;
+        while (size < capacity) size <<= 1;
+        m_buffer.resize(size);
+        m_mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    /**
+     * @brief 入队 (仅生产者线程调用)
+     */
+    bool tryPush(const T &value)
+    {
+        const quint32 head = m_head.load(std::memory_order_relaxed);
+        const quint32 next = (head + 1) & m_mask;
+        if (next == m_tail.load(std::memory_order_acquire)) {
+            return false; // 满
+        }
+        m_buffer[head] = value;
+        m_head.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 出队 (仅消费者线程调用)
+     */
+    bool tryPop(T &value)
+    {
+        const quint32 tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) {
+            return false; // 空
+        }
+        value = m_buffer[tail];
+        m_tail.store((tail + 1) & m_mask, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief 当前元素个数 (近似值，仅用于统计)
+     */
+    int sizeApprox() const
+    {
+        const quint32 head = m_head.load(std::memory_order_acquire);
+        const quint32 tail = m_tail.load(std::memory_order_acquire);
+        return static_cast<int>((head - tail) & m_mask);
+    }
+
+    int capacity() const { return static_cast<int>(m_mask); }
+
+private:
+    QVector<T> m_buffer;
+    quint32 m_mask = 0;
+
+    // 生产者与消费者各自修改的索引放在不同缓存行，避免伪共享
+    alignas(64) std::atomic<quint32> m_head {0};
+    alignas(64) std::atomic<quint32> m_tail {0};
+};
+
+#endif // SPSCQUEUE_H